@@ -6,7 +6,7 @@ Image::Image(std::size_t width, std::size_t height, Dash::EDASH_FORMAT format)
 	, mFormat(format)
 	, mData(nullptr)
 {
-	std::size_t formatSize = Dash::GetDashFormatSize(format);
+	std::size_t formatSize = Dash::GetByteSizeForFormat(format);
 	mData = new std::uint8_t[mWidth * mHeight * formatSize];
 }
 
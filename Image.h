@@ -1,8 +1,10 @@
 #pragma once
 
 #include "src/math/MathType.h"
+#include "src/utility/ImageIO.h"
 #include <vector>
 #include <fstream>
+#include <cstring>
 
 class Image
 {
@@ -44,7 +46,7 @@ template<typename T>
 FORCEINLINE void Image::SetPixel(const T& value, std::size_t x, std::size_t y)
 {
 	ASSERT(x < mWidth && y < mHeight);
-	ASSERT(sizeof(T) == Dash::GetDashFormatSize(mFormat));
+	ASSERT(sizeof(T) == Dash::GetByteSizeForFormat(mFormat));
 
 	std::size_t pixelIndex = x + y * mWidth;
 	*(static_cast<T*>(mData) + pixelIndex) = value;
@@ -60,7 +62,7 @@ template<typename T>
 FORCEINLINE T Image::GetPixel(std::size_t x, std::size_t y)
 {
 	ASSERT(x < mWidth&& y < mHeight);
-	ASSERT(sizeof(T) == Dash::GetDashFormatSize(mFormat));
+	ASSERT(sizeof(T) == Dash::GetByteSizeForFormat(mFormat));
 
 	std::size_t pixelIndex = x + y * mWidth;
 	return *(static_cast<T*>(mData) + pixelIndex);
@@ -75,7 +77,7 @@ FORCEINLINE T Image::GetPixel(Dash::FVector2i index)
 template<typename T>
 FORCEINLINE void Image::ClearImage(const T& value)
 {
-	ASSERT(sizeof(T) == Dash::GetDashFormatSize(mFormat));
+	ASSERT(sizeof(T) == Dash::GetByteSizeForFormat(mFormat));
 
 	for (std::size_t i = 0; i < mWidth * mHeight; i++)
 	{
@@ -86,6 +88,7 @@ FORCEINLINE void Image::ClearImage(const T& value)
 
 //Helper Function
 
+/** Reads a single pixel scaled to [0, 255], whole images go through Dash::ExportPPMImage instead. */
 FORCEINLINE void GetImageColor(Dash::FVector3f& color, const Dash::FVector2i& index, std::shared_ptr<Image> image, bool repeat = false)
 {
 	switch (image->GetFormat())
@@ -161,40 +164,25 @@ FORCEINLINE void GetImageColor(Dash::FVector3f& color, const Dash::FVector2i& in
 
 FORCEINLINE void SavePPMImage(std::shared_ptr<Image> image, const std::string& name)
 {
-	std::ofstream output;
-	output.open(name, std::ios::binary);
+	Dash::EDASH_FORMAT format = image->GetFormat();
+	std::size_t rowPitch = image->GetWidth() * Dash::GetByteSizeForFormat(format);
+	const std::uint8_t* data = static_cast<const std::uint8_t*>(image->GetRawData());
 
-	if (output.fail())
+	// R8G8B8A8_UINT images keep the layout of the old writer: bottom row first, red and blue swapped
+	std::vector<std::uint8_t> flipped;
+	if (format == Dash::EDASH_FORMAT::R8G8B8A8_UINT)
 	{
-		output.close();
-		return;
-	}
-
-	std::size_t imageWidth = image->GetWidth();
-	std::size_t imageHeight = image->GetHeight();
-
-	output << "P6\n" << imageWidth << " " << imageHeight << "\n";
-
-	float maxValue = 255.0f;
-	output << maxValue << "\n";
-
-	for (std::size_t i = 0; i < imageHeight; ++i)
-	{
-		for (std::size_t j = 0; j < imageWidth; ++j)
+		flipped.resize(rowPitch * image->GetHeight());
+		for (std::size_t y = 0; y < image->GetHeight(); y++)
 		{
-			Dash::FVector3f color;
-
-			GetImageColor(color, Dash::FVector2i{ j, i }, image);
-
-			std::uint8_t r = static_cast<std::uint8_t>(Dash::FMath::Max(0.0f, Dash::FMath::Min(maxValue, color.x + 0.5f)));
-			std::uint8_t g = static_cast<std::uint8_t>(Dash::FMath::Max(0.0f, Dash::FMath::Min(maxValue, color.y + 0.5f)));
-			std::uint8_t b = static_cast<std::uint8_t>(Dash::FMath::Max(0.0f, Dash::FMath::Min(maxValue, color.z + 0.5f)));
-
-			output << r << g << b;
+			std::memcpy(&flipped[y * rowPitch], data + (image->GetHeight() - 1 - y) * rowPitch, rowPitch);
 		}
+
+		data = flipped.data();
+		format = Dash::EDASH_FORMAT::B8G8R8A8_UNORM;
 	}
 
-	output.close();
+	Dash::ExportPPMImage(name, data, image->GetWidth(), image->GetHeight(), rowPitch, format, false);
 }
 
 FORCEINLINE std::shared_ptr<Image> LoadPPMImage(const std::string& name)
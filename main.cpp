@@ -6,6 +6,10 @@
 #include "src/shapes/Sphere.h"
 
 #include "src/shapes/Plane.h"
+#include "src/shapes/MeshTangents.h"
+#include "src/shapes/MeshImporter.h"
+
+#include "src/scene/BVH.h"
 
 #include "src/graphic/Camera.h"
 
@@ -15,6 +19,11 @@
 
 #include <iostream>
 #include <chrono>
+#include <string_view>
+#include <fstream>
+#include <filesystem>
+#include <random>
+#include <functional>
 
 #include "src/utility/Keyboard.h"
 #include "src/graphic/Application.h"
@@ -26,6 +35,7 @@
 #include "src/utility/Image.h"
 
 #include "src/utility/ImageHelper.h"
+#include "src/utility/ImageIO.h"
 
 
 namespace DMath = Dash::FMath;
@@ -66,7 +76,6 @@ std::shared_ptr<Dash::TriangleMesh> CreateTriangleMesh()
 
 	std::size_t positionOffset = triangleMesh->InputElementMap["POSITION"];
 	std::size_t normalOffset = triangleMesh->InputElementMap["NORMAL"];
-	std::size_t tangentOffset = triangleMesh->InputElementMap["TANGENT"];
 	std::size_t texCoordOffset = triangleMesh->InputElementMap["TEXCOORD"];
 
 	Dash::FVector3f pos1{ 0.0f, 0.5f, 0.0f };
@@ -78,23 +87,19 @@ std::shared_ptr<Dash::TriangleMesh> CreateTriangleMesh()
 	Dash::FVector2f uv3{ 0.0f, 1.0f };
 
 	Dash::FVector3f normal{ 0.0f, 0.0f, -1.0f };
-	Dash::FVector3f tangent{ 1.0f, 0.0f, 0.0f };
 
-	triangleMesh->Vertices.reserve((std::size_t)(triangleMesh->VertexStride) * 3);
+	triangleMesh->Vertices.resize((std::size_t)(triangleMesh->VertexStride) * 3);
 
 	WriteData(pos1, triangleMesh->Vertices.data(), 0 * triangleMesh->VertexStride + positionOffset);
 	WriteData(normal, triangleMesh->Vertices.data(), 0 * triangleMesh->VertexStride + normalOffset);
-	WriteData(tangent, triangleMesh->Vertices.data(), 0 * triangleMesh->VertexStride + tangentOffset);
 	WriteData(uv1, triangleMesh->Vertices.data(), 0 * triangleMesh->VertexStride + texCoordOffset);
 
 	WriteData(pos2, triangleMesh->Vertices.data(), 1 * triangleMesh->VertexStride + positionOffset);
 	WriteData(normal, triangleMesh->Vertices.data(), 1 * triangleMesh->VertexStride + normalOffset);
-	WriteData(tangent, triangleMesh->Vertices.data(), 1 * triangleMesh->VertexStride + tangentOffset);
 	WriteData(uv2, triangleMesh->Vertices.data(), 1 * triangleMesh->VertexStride + texCoordOffset);
 
 	WriteData(pos3, triangleMesh->Vertices.data(), (std::size_t)2 * triangleMesh->VertexStride + positionOffset);
 	WriteData(normal, triangleMesh->Vertices.data(), (std::size_t)2 * triangleMesh->VertexStride + normalOffset);
-	WriteData(tangent, triangleMesh->Vertices.data(), (std::size_t)2 * triangleMesh->VertexStride + tangentOffset);
 	WriteData(uv3, triangleMesh->Vertices.data(), (std::size_t)2 * triangleMesh->VertexStride + texCoordOffset);
 
 	triangleMesh->Indices.resize(sizeof(std::uint32_t) * 3);
@@ -103,6 +108,8 @@ std::shared_ptr<Dash::TriangleMesh> CreateTriangleMesh()
 
 	std::memcpy(triangleMesh->Indices.data(), indices, sizeof(indices));
 
+	Dash::GenerateTangents(*triangleMesh);
+
 	return triangleMesh;
 }
 
@@ -152,6 +159,441 @@ Dash::FVector3f GetRayColor(const Dash::FRay& r, std::shared_ptr<Dash::Shape> sh
 	return DMath::Lerp(Dash::FVector3f{1.0f, 1.0f, 1.0f}, Dash::FVector3f{ 0.5f, 0.7f, 1.0f }, lerpVal);
 }
 
+template<typename Func>
+double MeasureMilliseconds(Func&& func)
+{
+	auto start = std::chrono::steady_clock::now();
+	func();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** Per pixel PPM writer and reader as SavePPMImage / LoadPPMImage worked before the bulk conversion, kept as the baseline. */
+void LegacySavePPMImage(const Dash::FTexture& image, const std::string& name)
+{
+	std::ofstream output(name, std::ios::binary);
+	output << "P6\n" << image.GetWidth() << " " << image.GetHeight() << "\n" << 255.0f << "\n";
+
+	auto toSRGB = [](float value)
+	{
+		value = DMath::Clamp(value, 0.0f, 1.0f);
+		value = value <= 0.0031308f ? value * 12.92f : DMath::Pow(value, 1.0f / 2.4f) * 1.055f - 0.055f;
+		return static_cast<uint8_t>(DMath::FloorToInt(value * 255.999f));
+	};
+
+	for (std::size_t i = 0; i < image.GetHeight(); i++)
+	{
+		for (std::size_t j = 0; j < image.GetWidth(); j++)
+		{
+			const Dash::FVector3f& color = image.GetPixel<Dash::FVector3f>(j, i);
+			output << toSRGB(color.x) << toSRGB(color.y) << toSRGB(color.z);
+		}
+	}
+}
+
+Dash::FTexture LegacyLoadPPMImage(const std::string& name)
+{
+	std::ifstream input(name, std::ios::binary);
+
+	std::string fileType;
+	std::size_t imageWidth;
+	std::size_t imageHeight;
+	float maxValue;
+	input >> fileType >> imageWidth >> imageHeight >> maxValue;
+	input.ignore(256, '\n');
+
+	Dash::FTexture image{ imageWidth, imageHeight, Dash::EDASH_FORMAT::R32G32B32_FLOAT };
+
+	const float invMaxValue = 1 / maxValue;
+	uint8_t currentPixel[3];
+	for (std::size_t i = 0; i < imageHeight; i++)
+	{
+		for (std::size_t j = 0; j < imageWidth; j++)
+		{
+			input.read(reinterpret_cast<char*>(currentPixel), 3);
+			image.SetPixel(Dash::FVector3f{ currentPixel[0] * invMaxValue, currentPixel[1] * invMaxValue, currentPixel[2] * invMaxValue }, j, i);
+		}
+	}
+
+	return image;
+}
+
+void ImageIOBenchmark()
+{
+	const std::size_t size = 2048;
+	const double megaPixels = static_cast<double>(size * size) / 1000000.0;
+
+	Dash::FTexture image{ size, size, Dash::EDASH_FORMAT::R8G8B8A8_UNORM };
+
+	uint8_t* pixels = image.GetRawData();
+	for (std::size_t y = 0; y < size; y++)
+	{
+		for (std::size_t x = 0; x < size; x++)
+		{
+			uint8_t* pixel = pixels + y * image.GetRowPitch() + x * 4;
+			pixel[0] = static_cast<uint8_t>(x);
+			pixel[1] = static_cast<uint8_t>(y);
+			pixel[2] = static_cast<uint8_t>(x + y);
+			pixel[3] = 255;
+		}
+	}
+
+	const double megaBytes = static_cast<double>(image.GetRowPitch() * size) / (1024.0 * 1024.0);
+
+	double encodeTime = MeasureMilliseconds([&]() { Dash::ExportPNGTexture("benchmark.png", image); });
+
+	Dash::FTexture loaded;
+	double decodeTime = MeasureMilliseconds([&]() { loaded = Dash::LoadPNGTexture("benchmark.png"); });
+
+	bool identical = loaded.GetRowPitch() == image.GetRowPitch() && loaded.GetHeight() == size &&
+		std::memcmp(loaded.GetRawData(), image.GetRawData(), image.GetRowPitch() * size) == 0;
+
+	LOG_INFO << "PNG 2048x2048 RGBA8: encode " << megaBytes * 1000.0 / encodeTime << " MB/s, decode "
+		<< megaBytes * 1000.0 / decodeTime << " MB/s, round trip " << (identical ? "exact" : "MISMATCH");
+
+	// a linear render target, the format the ray tracer hands to SavePPMImage
+	Dash::FTexture render{ size, size, Dash::EDASH_FORMAT::R32G32B32_FLOAT };
+	for (std::size_t y = 0; y < size; y++)
+	{
+		for (std::size_t x = 0; x < size; x++)
+		{
+			render.SetPixel(Dash::FVector3f{ x / Dash::Scalar(size), y / Dash::Scalar(size), 0.5f }, x, y);
+		}
+	}
+
+	auto print = [&](const char* name, double writeTime, double readTime)
+	{
+		LOG_INFO << name << " 2048x2048 RGB32F: write " << writeTime << " ms (" << megaPixels * 1000.0 / writeTime << " MP/s), read "
+			<< readTime << " ms (" << megaPixels * 1000.0 / readTime << " MP/s)";
+	};
+
+	double writeTime = MeasureMilliseconds([&]() { LegacySavePPMImage(render, "benchmark_legacy.ppm"); });
+	double readTime = MeasureMilliseconds([&]() { loaded = LegacyLoadPPMImage("benchmark_legacy.ppm"); });
+	print("PPM per pixel", writeTime, readTime);
+
+	writeTime = MeasureMilliseconds([&]() { Dash::ExportPPMTexture("benchmark.ppm", render); });
+	readTime = MeasureMilliseconds([&]() { loaded = Dash::LoadPPMTexture("benchmark.ppm"); });
+	print("PPM", writeTime, readTime);
+
+	writeTime = MeasureMilliseconds([&]() { Dash::ExportPFMTexture("benchmark.pfm", render); });
+	readTime = MeasureMilliseconds([&]() { loaded = Dash::LoadPFMTexture("benchmark.pfm"); });
+	print("PFM", writeTime, readTime);
+
+	writeTime = MeasureMilliseconds([&]() { Dash::ExportHDRTexture("benchmark.hdr", render); });
+	readTime = MeasureMilliseconds([&]() { loaded = Dash::LoadHDRTexture("benchmark.hdr"); });
+	print("HDR", writeTime, readTime);
+}
+
+void ColorConversionBenchmark()
+{
+	const std::size_t count = 2048 * 2048;
+	const double megaPixels = static_cast<double>(count) / 1000000.0;
+
+	std::mt19937 random{ 11 };
+	std::uniform_real_distribution<float> channel{ 0.0f, 1.0f };
+
+	std::vector<Dash::FLinearColor> linear(count);
+	for (Dash::FLinearColor& color : linear)
+	{
+		color = Dash::FLinearColor{ channel(random), channel(random), channel(random), channel(random) };
+	}
+
+	std::vector<Dash::FColor> scalarColors(count);
+	std::vector<Dash::FColor> bulkColors(count);
+	std::vector<Dash::FLinearColor> scalarLinear(count);
+	std::vector<Dash::FLinearColor> bulkLinear(count);
+
+	auto print = [&](const char* name, double scalarTime, double bulkTime)
+	{
+		LOG_INFO << name << " 4M colors: scalar " << megaPixels * 1000.0 / scalarTime << " MP/s, bulk " << megaPixels * 1000.0 / bulkTime
+			<< " MP/s, " << scalarTime / bulkTime << "x";
+	};
+
+	double scalarTime = MeasureMilliseconds([&]()
+	{
+		for (std::size_t i = 0; i < count; i++)
+		{
+			scalarColors[i] = linear[i].ToFColor(true);
+		}
+	});
+	double bulkTime = MeasureMilliseconds([&]() { Dash::ConvertLinearToColor(linear.data(), count, bulkColors.data()); });
+	print("sRGB encode", scalarTime, bulkTime);
+
+	int worstStep = 0;
+	for (std::size_t i = 0; i < count; i++)
+	{
+		worstStep = DMath::Max(worstStep, DMath::Abs(int(scalarColors[i].r) - int(bulkColors[i].r)));
+		worstStep = DMath::Max(worstStep, DMath::Abs(int(scalarColors[i].g) - int(bulkColors[i].g)));
+		worstStep = DMath::Max(worstStep, DMath::Abs(int(scalarColors[i].b) - int(bulkColors[i].b)));
+	}
+	LOG_INFO << "sRGB encode differs from ToFColor by at most " << worstStep << " steps";
+
+	scalarTime = MeasureMilliseconds([&]()
+	{
+		for (std::size_t i = 0; i < count; i++)
+		{
+			scalarLinear[i] = Dash::FLinearColor{ scalarColors[i] };
+		}
+	});
+	bulkTime = MeasureMilliseconds([&]() { Dash::ConvertColorToLinear(scalarColors.data(), count, bulkLinear.data()); });
+	print("sRGB decode", scalarTime, bulkTime);
+
+	scalarLinear = linear;
+	bulkLinear = linear;
+	scalarTime = MeasureMilliseconds([&]()
+	{
+		for (Dash::FLinearColor& color : scalarLinear)
+		{
+			color = Dash::FLinearColor{ color.r * color.a, color.g * color.a, color.b * color.a, color.a };
+		}
+	});
+	bulkTime = MeasureMilliseconds([&]() { Dash::PremultiplyAlpha(bulkLinear.data(), count); });
+	print("premultiply", scalarTime, bulkTime);
+
+	scalarTime = MeasureMilliseconds([&]()
+	{
+		for (Dash::FLinearColor& color : scalarLinear)
+		{
+			if (color.a != 0.0f)
+			{
+				color = Dash::FLinearColor{ color.r / color.a, color.g / color.a, color.b / color.a, color.a };
+			}
+		}
+	});
+	bulkTime = MeasureMilliseconds([&]() { Dash::UnpremultiplyAlpha(bulkLinear.data(), count); });
+	print("unpremultiply", scalarTime, bulkTime);
+}
+
+void TextureLayoutBenchmark()
+{
+	const std::size_t size = 2048;
+	const std::size_t sampleCount = size * size;
+
+	Dash::FTexture linear{ size, size, Dash::EDASH_FORMAT::R8G8B8A8_UNORM };
+	for (std::size_t y = 0; y < size; y++)
+	{
+		for (std::size_t x = 0; x < size; x++)
+		{
+			linear.SetPixel(Dash::FColor{ uint8_t(x), uint8_t(y), uint8_t(x ^ y), 255 }, x, y);
+		}
+	}
+
+	const std::pair<const char*, Dash::FTexture> textures[] =
+	{
+		{ "Linear", linear },
+		{ "Tiled8x8", linear.ConvertLayout(Dash::ETextureLayout::Tiled8x8) },
+		{ "Morton", linear.ConvertLayout(Dash::ETextureLayout::Morton) },
+	};
+
+	// bilinear footprint, every sample touches a 2x2 pixel block
+	auto sample = [size](const Dash::FTexture& texture, Dash::FVector2f uv)
+	{
+		const std::size_t x0 = static_cast<std::size_t>(uv.x);
+		const std::size_t y0 = static_cast<std::size_t>(uv.y);
+		const std::size_t x1 = DMath::Min(x0 + 1, size - 1);
+		const std::size_t y1 = DMath::Min(y0 + 1, size - 1);
+		const float fx = uv.x - x0;
+		const float fy = uv.y - y0;
+
+		const Dash::FLinearColor top = DMath::Lerp(Dash::FLinearColor{ texture.GetPixel<Dash::FColor>(x0, y0) }, Dash::FLinearColor{ texture.GetPixel<Dash::FColor>(x1, y0) }, fx);
+		const Dash::FLinearColor bottom = DMath::Lerp(Dash::FLinearColor{ texture.GetPixel<Dash::FColor>(x0, y1) }, Dash::FLinearColor{ texture.GetPixel<Dash::FColor>(x1, y1) }, fx);
+		return DMath::Lerp(top, bottom, fy);
+	};
+
+	std::mt19937 random{ 13 };
+	std::uniform_real_distribution<float> position{ 0.0f, static_cast<float>(size - 1) };
+
+	// walk i of the path, the horizontal, vertical and diagonal walks cover the texture once
+	const std::pair<const char*, std::function<Dash::FVector2f(std::size_t)>> paths[] =
+	{
+		{ "horizontal", [size](std::size_t i) { return Dash::FVector2f{ i % size + 0.25f, i / size + 0.25f }; } },
+		{ "vertical", [size](std::size_t i) { return Dash::FVector2f{ i / size + 0.25f, i % size + 0.25f }; } },
+		{ "diagonal", [size](std::size_t i) { return Dash::FVector2f{ (i / size + i % size) % size + 0.25f, i % size + 0.25f }; } },
+		{ "random", [&](std::size_t) { return Dash::FVector2f{ position(random), position(random) }; } },
+	};
+
+	std::vector<Dash::FVector2f> coordinates(sampleCount);
+	for (const auto& [pathName, path] : paths)
+	{
+		for (std::size_t i = 0; i < sampleCount; i++)
+		{
+			coordinates[i] = path(i);
+		}
+
+		double linearTime = 0.0;
+		for (const auto& [layoutName, texture] : textures)
+		{
+			Dash::FLinearColor sum{ Dash::FZero{} };
+			const double time = MeasureMilliseconds([&]()
+			{
+				for (const Dash::FVector2f& uv : coordinates)
+				{
+					sum += sample(texture, uv);
+				}
+			});
+
+			linearTime = texture.GetLayout() == Dash::ETextureLayout::Linear ? time : linearTime;
+			LOG_INFO << "bilinear " << pathName << " " << layoutName << ": " << static_cast<double>(sampleCount) / (time * 1000.0) << " MS/s, "
+				<< linearTime / time << "x of Linear, checksum " << sum.r + sum.g + sum.b;
+		}
+	}
+}
+
+/** Grid of (size + 1)^2 vertices and 2 * size^2 triangles with normals and texcoords, as text OBJ and binary PLY. */
+void WriteBenchmarkGrid(std::size_t size, const std::string& objName, const std::string& plyName)
+{
+	const std::size_t vertexCount = (size + 1) * (size + 1);
+	const std::size_t triangleCount = 2 * size * size;
+
+	std::ofstream obj(objName, std::ios::binary);
+	std::ofstream ply(plyName, std::ios::binary);
+	ply << "ply\nformat binary_little_endian 1.0\nelement vertex " << vertexCount
+		<< "\nproperty float x\nproperty float y\nproperty float z\nproperty float nx\nproperty float ny\nproperty float nz"
+		<< "\nproperty float u\nproperty float v\nelement face " << triangleCount << "\nproperty list uchar int vertex_indices\nend_header\n";
+
+	char line[128];
+	for (std::size_t y = 0; y <= size; y++)
+	{
+		for (std::size_t x = 0; x <= size; x++)
+		{
+			const float u = static_cast<float>(x) / size;
+			const float v = static_cast<float>(y) / size;
+			const float vertex[8] = { u, 0.1f * std::sin(u * 20.0f) * std::cos(v * 20.0f), v, 0.0f, 1.0f, 0.0f, u, v };
+
+			obj.write(line, std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn 0 1 0\n", vertex[0], vertex[1], vertex[2], u, v));
+			ply.write(reinterpret_cast<const char*>(vertex), sizeof(vertex));
+		}
+	}
+
+	for (std::size_t y = 0; y < size; y++)
+	{
+		for (std::size_t x = 0; x < size; x++)
+		{
+			const int32_t a = static_cast<int32_t>(y * (size + 1) + x);
+			const int32_t triangles[2][3] = { { a, a + static_cast<int32_t>(size) + 1, a + 1 }, { a + 1, a + static_cast<int32_t>(size) + 1, a + static_cast<int32_t>(size) + 2 } };
+			for (const int32_t* triangle : triangles)
+			{
+				obj.write(line, std::snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d\n", triangle[0] + 1, triangle[0] + 1, triangle[0] + 1,
+					triangle[1] + 1, triangle[1] + 1, triangle[1] + 1, triangle[2] + 1, triangle[2] + 1, triangle[2] + 1));
+
+				const uint8_t count = 3;
+				ply.write(reinterpret_cast<const char*>(&count), 1);
+				ply.write(reinterpret_cast<const char*>(triangle), sizeof(int32_t) * 3);
+			}
+		}
+	}
+}
+
+void MeshImportBenchmark()
+{
+	const std::size_t size = 1024;
+	WriteBenchmarkGrid(size, "benchmark.obj", "benchmark.ply");
+
+	// parsing only, without tangent generation
+	Dash::FMeshImportSettings settings;
+	settings.GenerateTangents = false;
+
+	for (const char* fileName : { "benchmark.obj", "benchmark.ply" })
+	{
+		Dash::FMeshImportResult result;
+		double time = MeasureMilliseconds([&]() { result = Dash::ImportMesh(fileName, settings); });
+
+		const double megaBytes = static_cast<double>(std::filesystem::file_size(fileName)) / (1024.0 * 1024.0);
+		const bool complete = result.Mesh && result.Mesh->NumVertices == (size + 1) * (size + 1) && result.Mesh->NumIndices == 6 * size * size;
+
+		LOG_INFO << fileName << " " << megaBytes << " MB: " << time << " ms, " << megaBytes * 1000.0 / time << " MB/s, "
+			<< (complete ? "complete" : "MISMATCH");
+	}
+}
+
+void TangentBenchmark()
+{
+	const std::size_t size = 1024;
+	if (!std::filesystem::exists("benchmark.ply"))
+	{
+		WriteBenchmarkGrid(size, "benchmark.obj", "benchmark.ply");
+	}
+
+	Dash::FMeshImportSettings settings;
+	settings.GenerateTangents = false;
+	std::shared_ptr<Dash::TriangleMesh> mesh = Dash::ImportMesh("benchmark.ply", settings).Mesh;
+
+	double time = MeasureMilliseconds([&]() { Dash::GenerateTangents(*mesh); });
+
+	// u runs along x and every normal is +y, so the tangent plane projection leaves exactly +x
+	Dash::TStridedSpan<const Dash::FVector3f> tangents = mesh->GetVertexAttribute<Dash::FVector3f>(mesh->FindVertexAttribute(Dash::VertexAttribute::Tangent::Name));
+	Dash::Scalar worstDot = 1;
+	for (std::size_t i = 0; i < tangents.Size(); i++)
+	{
+		worstDot = DMath::Min(worstDot, tangents[i].x);
+	}
+
+	LOG_INFO << "GenerateTangents " << mesh->NumVertices << " vertices, " << mesh->NumIndices / 3 << " triangles: " << time
+		<< " ms, worst dot with the analytic tangent " << worstDot;
+}
+
+void BVHBenchmark()
+{
+	const std::size_t primitiveCount = 500000;
+	std::mt19937 random{ 7 };
+	std::uniform_real_distribution<Dash::Scalar> position{ 0.0f, 1.0f };
+
+	std::vector<Dash::FVector3f> centers(primitiveCount);
+	for (Dash::FVector3f& center : centers)
+	{
+		center = Dash::FVector3f{ position(random), position(random), position(random) };
+	}
+
+	// small boxes around the centers, about the size of the triangles of a 500k triangle mesh in the unit cube
+	std::vector<Dash::FBoundingBox> bounds(primitiveCount);
+	auto updateBounds = [&]()
+	{
+		const Dash::FVector3f halfSize{ 0.002f, 0.002f, 0.002f };
+		for (std::size_t i = 0; i < primitiveCount; i++)
+		{
+			bounds[i] = Dash::FBoundingBox{ centers[i] - halfSize, centers[i] + halfSize };
+		}
+	};
+
+	auto print = [](const char* name, const Dash::FBVHUpdateStats& stats)
+	{
+		LOG_INFO << "BVH " << name << ": " << stats.Seconds * 1000.0 << " ms, SAH " << stats.SAHCost << ", " << stats.RebuiltSubtrees
+			<< " subtrees rebuilt" << (stats.FullRebuild ? " (full)" : "");
+	};
+
+	updateBounds();
+	Dash::FBVH bvh;
+	print("build 500k", bvh.Build(bounds.data(), primitiveCount));
+	print("refit only", bvh.Refit(bounds.data(), false));
+
+	// primitives inside a growing sphere are scattered, the rest of the scene stays where it was built
+	const std::vector<Dash::FVector3f> restCenters = centers;
+	std::uniform_real_distribution<Dash::Scalar> offset{ -0.05f, 0.05f };
+	for (Dash::Scalar radius : { 0.1f, 0.2f, 0.4f })
+	{
+		for (std::size_t i = 0; i < primitiveCount; i++)
+		{
+			const Dash::FVector3f& rest = restCenters[i];
+			const bool moved = DMath::Length(rest - Dash::FVector3f{ 0.5f, 0.5f, 0.5f }) < radius;
+			centers[i] = moved ? rest + Dash::FVector3f{ offset(random), offset(random), offset(random) } : rest;
+		}
+		updateBounds();
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "refit, scatter radius %.1f", radius);
+		print(name, bvh.Refit(bounds.data()));
+	}
+}
+
+void RunBenchmarks()
+{
+	ImageIOBenchmark();
+	ColorConversionBenchmark();
+	TextureLayoutBenchmark();
+	MeshImportBenchmark();
+	TangentBenchmark();
+	BVHBenchmark();
+}
+
 //int main()
 //{
 //	const Dash::Scalar aspectRatio = 16.0f / 9.0f;
@@ -230,6 +672,13 @@ int CALLBACK WinMain(HINSTANCE hInstance,
 	Dash::FLogManager::Get()->Init();
 	Dash::FLogManager::Get()->RegisterLogStream(std::make_shared<Dash::FLogStreamConsole>());
 
+	if (std::string_view{ lpCmdLine }.find("-benchmark") != std::string_view::npos)
+	{
+		RunBenchmarks();
+		Dash::FLogManager::Get()->Shutdown();
+		return 0;
+	}
+
 	//LOG_INFO << "FApplication Run";
 
 	//Dash::FTexture<Dash::FLinearColor> image;
@@ -5,7 +5,9 @@
 #include <cinttypes>
 #include <cstring>
 
+#if defined(_WIN32)
 #include "DashWinAPI.h"
+#endif
 
 #include "../utility/Assert.h"
 #include "../utility/LogManager.h"
@@ -44,6 +46,7 @@ void GetData(T& dest, void* src, std::size_t offset = 0)
 	std::memcpy(&dest, static_cast<uint8_t*>(src) + offset, sizeof(T));
 }
 
+#if defined(_WIN32)
 const DWORD MS_VC_EXCEPTION = 0x406D1388;
 
 // Set the name of a running thread (for debugging)
@@ -85,4 +88,5 @@ struct handle_closer { void operator()(HANDLE h) noexcept { if (h) CloseHandle(h
 
 using ScopedHandle = std::unique_ptr<void, handle_closer>;
 
-inline HANDLE safe_handle(HANDLE h) noexcept { return (h == INVALID_HANDLE_VALUE) ? nullptr : h; }
\ No newline at end of file
+inline HANDLE safe_handle(HANDLE h) noexcept { return (h == INVALID_HANDLE_VALUE) ? nullptr : h; }
+#endif
\ No newline at end of file
@@ -49,6 +49,11 @@ namespace Dash
 		return mViewProjectionMatrix;
 	}
 
+	FFrustum FCamera::GetFrustum() const
+	{
+		return FFrustum(GetViewProjectionMatrix());
+	}
+
 	FVector3f FCamera::GetPosition() const
 	{
 		return mTransform.GetPosition();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../math/Transform.h"
+#include "../math/Frustum.h"
 #include "Viewport.h"
 
 namespace Dash
@@ -15,6 +16,9 @@ namespace Dash
 		FMatrix4x4 GetProjectionMatrix() const;
 		FMatrix4x4 GetViewProjectionMatrix() const;
 
+		/** World space frustum planes of the current view projection matrix. */
+		FFrustum GetFrustum() const;
+
 		FVector3f GetPosition() const;
 		FQuaternion GetRotation() const;
 
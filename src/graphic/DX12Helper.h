@@ -121,6 +121,7 @@ namespace Dash
         size_t textureRowPitch = texture.GetRowPitch();
         const uint8_t* textureData = texture.GetRawData();
 
+        ASSERT(texture.GetLayout() == ETextureLayout::Linear);
         ASSERT(footprint.Footprint.RowPitch == textureRowPitch);
         ASSERT(numRows == texture.GetHeight());
         ASSERT(footprint.Footprint.Width == texture.GetWidth());
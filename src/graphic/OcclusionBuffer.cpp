@@ -0,0 +1,323 @@
+#include "OcclusionBuffer.h"
+#include "Camera.h"
+#include "../utility/ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Dash
+{
+	namespace
+	{
+		FORCEINLINE FVector4f TransformPoint(const FVector3f& p, const FMatrix4x4& m)
+		{
+			return FVector4f{ p.x * m[0][0] + p.y * m[1][0] + p.z * m[2][0] + m[3][0],
+				p.x * m[0][1] + p.y * m[1][1] + p.z * m[2][1] + m[3][1],
+				p.x * m[0][2] + p.y * m[1][2] + p.z * m[2][2] + m[3][2],
+				p.x * m[0][3] + p.y * m[1][3] + p.z * m[2][3] + m[3][3] };
+		}
+
+		/** Pixels whose centers lie in [minCoord, maxCoord], clamped to the buffer. */
+		FORCEINLINE bool GetPixelRange(Scalar minCoord, Scalar maxCoord, size_t size, size_t& first, size_t& last)
+		{
+			const Scalar lower = FMath::Max(std::ceil(minCoord - Scalar{ 0.5 }), Scalar{ 0 });
+			const Scalar upper = FMath::Min(std::floor(maxCoord - Scalar{ 0.5 }), static_cast<Scalar>(size - 1));
+			if (lower > upper)
+			{
+				return false;
+			}
+
+			first = static_cast<size_t>(lower);
+			last = static_cast<size_t>(upper);
+			return true;
+		}
+	}
+
+	FOcclusionBuffer::FOcclusionBuffer(size_t width, size_t height)
+		: mWidth((std::max<size_t>(width, 1) + TileSize - 1) / TileSize * TileSize)
+		, mHeight((std::max<size_t>(height, 1) + TileSize - 1) / TileSize * TileSize)
+		, mTilesX(mWidth / TileSize)
+		, mTilesY(mHeight / TileSize)
+		, mViewProjection(FIdentity{})
+		, mFrustum(mViewProjection)
+		, mDepth(mWidth * mHeight, Scalar{ 1 })
+		, mTileMaxDepth(mTilesX * mTilesY, Scalar{ 1 })
+	{
+	}
+
+	void FOcclusionBuffer::Begin(const FMatrix4x4& viewProjection)
+	{
+		mViewProjection = viewProjection;
+		mFrustum = FFrustum(viewProjection);
+
+		std::fill(mDepth.begin(), mDepth.end(), Scalar{ 1 });
+		std::fill(mTileMaxDepth.begin(), mTileMaxDepth.end(), Scalar{ 1 });
+	}
+
+	void FOcclusionBuffer::Begin(const FCamera& camera)
+	{
+		Begin(camera.GetViewProjectionMatrix());
+	}
+
+	void FOcclusionBuffer::RasterizeOccluder(TStridedSpan<const FVector3f> positions, const uint32_t* indices, size_t indexCount, const FMatrix4x4& objectToWorld)
+	{
+		ASSERT(indexCount % 3 == 0);
+
+		const FMatrix4x4 objectToClip = objectToWorld * mViewProjection;
+
+		std::vector<FVector4f> clipPositions(positions.Size());
+		for (size_t i = 0; i < positions.Size(); ++i)
+		{
+			clipPositions[i] = TransformPoint(positions[i], objectToClip);
+		}
+
+		FDirtyRect dirty;
+		for (size_t i = 0; i < indexCount; i += 3)
+		{
+			RasterizeClipTriangle(clipPositions[indices[i]], clipPositions[indices[i + 1]], clipPositions[indices[i + 2]], dirty);
+		}
+
+		UpdateTileDepth(dirty);
+	}
+
+	void FOcclusionBuffer::RasterizeOccluder(const TriangleMesh& mesh, const FMatrix4x4& objectToWorld)
+	{
+		const FVertexAttributeHandle positionHandle = mesh.FindVertexAttribute(VertexAttribute::Position::Name);
+		ASSERT(positionHandle.IsValid());
+		const TStridedSpan<const FVector3f> positions = mesh.GetVertexAttribute<FVector3f>(positionHandle);
+
+		std::vector<uint32_t> indices;
+		mesh.ReadAbsoluteIndices(indices);
+
+		RasterizeOccluder(positions, indices.data(), indices.size(), objectToWorld);
+	}
+
+	bool FOcclusionBuffer::IsVisible(const FBoundingBox& box) const
+	{
+		return mFrustum.IntersectsBox(box) && IsDepthVisible(box);
+	}
+
+	size_t FOcclusionBuffer::CullBoxes(const FBoundingBox* boxes, size_t count, uint8_t* visible) const
+	{
+		mFrustum.IntersectsBoxes(boxes, count, visible);
+
+		ParallelFor(0, count, [&](size_t i)
+		{
+			if (visible[i] && !IsDepthVisible(boxes[i]))
+			{
+				visible[i] = 0;
+			}
+		}, 64);
+
+		size_t visibleCount = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			visibleCount += visible[i];
+		}
+		return visibleCount;
+	}
+
+	void FOcclusionBuffer::RasterizeClipTriangle(const FVector4f& c0, const FVector4f& c1, const FVector4f& c2, FDirtyRect& dirty)
+	{
+		// trivially outside one of the side planes
+		if ((c0.x > c0.w && c1.x > c1.w && c2.x > c2.w) || (c0.x < -c0.w && c1.x < -c1.w && c2.x < -c2.w) ||
+			(c0.y > c0.w && c1.y > c1.w && c2.y > c2.w) || (c0.y < -c0.w && c1.y < -c1.w && c2.y < -c2.w))
+		{
+			return;
+		}
+
+		// clip against the near plane z >= 0, a triangle becomes at most a quad
+		const FVector4f* corners[3] = { &c0, &c1, &c2 };
+		FVector4f polygon[4];
+		size_t polygonSize = 0;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			const FVector4f& a = *corners[i];
+			const FVector4f& b = *corners[(i + 1) % 3];
+
+			if (a.z >= 0)
+			{
+				polygon[polygonSize++] = a;
+			}
+			if ((a.z >= 0) != (b.z >= 0))
+			{
+				polygon[polygonSize++] = a + (b - a) * (a.z / (a.z - b.z));
+			}
+		}
+
+		if (polygonSize < 3)
+		{
+			return;
+		}
+
+		FVector3f screen[4];
+		for (size_t i = 0; i < polygonSize; ++i)
+		{
+			const FVector4f& c = polygon[i];
+			if (c.w <= 0)
+			{
+				return;
+			}
+
+			const Scalar invW = Scalar{ 1 } / c.w;
+			screen[i] = FVector3f{ (c.x * invW * Scalar{ 0.5 } + Scalar{ 0.5 }) * mWidth,
+				(Scalar{ 0.5 } - c.y * invW * Scalar{ 0.5 }) * mHeight, c.z * invW };
+		}
+
+		for (size_t i = 2; i < polygonSize; ++i)
+		{
+			RasterizeScreenTriangle(screen[0], screen[i - 1], screen[i], dirty);
+		}
+	}
+
+	void FOcclusionBuffer::RasterizeScreenTriangle(const FVector3f& p0, const FVector3f& p1, const FVector3f& p2, FDirtyRect& dirty)
+	{
+		Scalar area = (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+		if (area == 0)
+		{
+			return;
+		}
+
+		// counter clockwise in pixel coordinates so every edge function is positive inside
+		const FVector3f& a = p0;
+		const FVector3f& b = area > 0 ? p1 : p2;
+		const FVector3f& c = area > 0 ? p2 : p1;
+		area = FMath::Abs(area);
+
+		size_t x0, x1, y0, y1;
+		if (!GetPixelRange(FMath::Min(a.x, FMath::Min(b.x, c.x)), FMath::Max(a.x, FMath::Max(b.x, c.x)), mWidth, x0, x1) ||
+			!GetPixelRange(FMath::Min(a.y, FMath::Min(b.y, c.y)), FMath::Max(a.y, FMath::Max(b.y, c.y)), mHeight, y0, y1))
+		{
+			return;
+		}
+
+		const Scalar invArea = Scalar{ 1 } / area;
+		const Scalar stepX0 = b.y - c.y;
+		const Scalar stepX1 = c.y - a.y;
+		const Scalar stepX2 = a.y - b.y;
+
+		bool covered = false;
+		for (size_t y = y0; y <= y1; ++y)
+		{
+			const Scalar py = y + Scalar{ 0.5 };
+			const Scalar px = x0 + Scalar{ 0.5 };
+			Scalar e0 = (c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x);
+			Scalar e1 = (a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x);
+			Scalar e2 = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+
+			float* row = mDepth.data() + y * mWidth;
+			for (size_t x = x0; x <= x1; ++x)
+			{
+				if (e0 >= 0 && e1 >= 0 && e2 >= 0)
+				{
+					const Scalar depth = FMath::Max((e0 * a.z + e1 * b.z + e2 * c.z) * invArea, Scalar{ 0 });
+					row[x] = FMath::Min(row[x], depth);
+					covered = true;
+				}
+
+				e0 += stepX0;
+				e1 += stepX1;
+				e2 += stepX2;
+			}
+		}
+
+		if (covered)
+		{
+			dirty.MinX = FMath::Min(dirty.MinX, x0);
+			dirty.MinY = FMath::Min(dirty.MinY, y0);
+			dirty.MaxX = FMath::Max(dirty.MaxX, x1);
+			dirty.MaxY = FMath::Max(dirty.MaxY, y1);
+		}
+	}
+
+	void FOcclusionBuffer::UpdateTileDepth(const FDirtyRect& dirty)
+	{
+		if (dirty.MinX > dirty.MaxX || dirty.MinY > dirty.MaxY)
+		{
+			return;
+		}
+
+		for (size_t ty = dirty.MinY / TileSize; ty <= dirty.MaxY / TileSize; ++ty)
+		{
+			for (size_t tx = dirty.MinX / TileSize; tx <= dirty.MaxX / TileSize; ++tx)
+			{
+				Scalar maxDepth = 0;
+				for (size_t y = ty * TileSize; y < (ty + 1) * TileSize; ++y)
+				{
+					const float* row = mDepth.data() + y * mWidth + tx * TileSize;
+					for (size_t x = 0; x < TileSize; ++x)
+					{
+						maxDepth = FMath::Max(maxDepth, row[x]);
+					}
+				}
+				mTileMaxDepth[ty * mTilesX + tx] = maxDepth;
+			}
+		}
+	}
+
+	bool FOcclusionBuffer::IsDepthVisible(const FBoundingBox& box) const
+	{
+		Scalar minX = TScalarTraits<Scalar>::Infinity();
+		Scalar minY = TScalarTraits<Scalar>::Infinity();
+		Scalar maxX = -TScalarTraits<Scalar>::Infinity();
+		Scalar maxY = -TScalarTraits<Scalar>::Infinity();
+		Scalar minZ = TScalarTraits<Scalar>::Infinity();
+
+		for (size_t k = 0; k < 8; ++k)
+		{
+			const FVector3f corner{ k & 1 ? box.Upper.x : box.Lower.x, k & 2 ? box.Upper.y : box.Lower.y, k & 4 ? box.Upper.z : box.Lower.z };
+			const FVector4f c = TransformPoint(corner, mViewProjection);
+
+			// the projected rectangle is unbounded once a corner is in front of the near plane
+			if (c.z < 0 || c.w <= 0)
+			{
+				return true;
+			}
+
+			const Scalar invW = Scalar{ 1 } / c.w;
+			const Scalar x = (c.x * invW * Scalar{ 0.5 } + Scalar{ 0.5 }) * mWidth;
+			const Scalar y = (Scalar{ 0.5 } - c.y * invW * Scalar{ 0.5 }) * mHeight;
+			minX = FMath::Min(minX, x);
+			minY = FMath::Min(minY, y);
+			maxX = FMath::Max(maxX, x);
+			maxY = FMath::Max(maxY, y);
+			minZ = FMath::Min(minZ, c.z * invW);
+		}
+
+		// every pixel the rectangle touches, not only those whose centers it covers
+		size_t x0, x1, y0, y1;
+		if (!GetPixelRange(std::floor(minX) + Scalar{ 0.5 }, std::floor(maxX) + Scalar{ 0.5 }, mWidth, x0, x1) ||
+			!GetPixelRange(std::floor(minY) + Scalar{ 0.5 }, std::floor(maxY) + Scalar{ 0.5 }, mHeight, y0, y1))
+		{
+			return false;
+		}
+
+		for (size_t ty = y0 / TileSize; ty <= y1 / TileSize; ++ty)
+		{
+			for (size_t tx = x0 / TileSize; tx <= x1 / TileSize; ++tx)
+			{
+				if (minZ > mTileMaxDepth[ty * mTilesX + tx])
+				{
+					continue;
+				}
+
+				const size_t tileX0 = FMath::Max(x0, tx * TileSize);
+				const size_t tileX1 = FMath::Min(x1, tx * TileSize + TileSize - 1);
+				const size_t tileY0 = FMath::Max(y0, ty * TileSize);
+				const size_t tileY1 = FMath::Min(y1, ty * TileSize + TileSize - 1);
+				for (size_t y = tileY0; y <= tileY1; ++y)
+				{
+					const float* row = mDepth.data() + y * mWidth;
+					for (size_t x = tileX0; x <= tileX1; ++x)
+					{
+						if (minZ <= row[x])
+						{
+							return true;
+						}
+					}
+				}
+			}
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../math/Frustum.h"
+#include "../shapes/Shape.h"
+
+namespace Dash
+{
+	class FCamera;
+
+	/**
+	 * Coarse software depth buffer of large occluders, used to reject hidden objects before they are submitted.
+	 * Occluders are clipped to the near plane and rasterized at pixel centers keeping the nearest post projection depth,
+	 * a farthest depth per tile lets most box tests finish without touching single pixels.
+	 *
+	 * A covered pixel center counts the whole pixel as covered, so occluders should lie inside the geometry they stand
+	 * for, e.g. a simplified LOD or an inner box, otherwise objects peeking out behind a silhouette may be rejected.
+	 */
+	class FOcclusionBuffer
+	{
+	public:
+		static constexpr size_t TileSize = 8;
+
+		/** The size is rounded up to whole tiles. */
+		FOcclusionBuffer(size_t width = 320, size_t height = 192);
+
+		/** Clears the buffer and sets the view projection used by the following occluders and tests. */
+		void Begin(const FMatrix4x4& viewProjection);
+		void Begin(const FCamera& camera);
+
+		/** Triangles are rasterized regardless of winding, objectToWorld is a row-vector matrix. */
+		void RasterizeOccluder(TStridedSpan<const FVector3f> positions, const uint32_t* indices, size_t indexCount, const FMatrix4x4& objectToWorld);
+		void RasterizeOccluder(const TriangleMesh& mesh, const FMatrix4x4& objectToWorld);
+
+		/** False when the world space box is off screen or completely behind occluders, boxes crossing the near plane are visible. */
+		bool IsVisible(const FBoundingBox& box) const;
+
+		/** Batched frustum test followed by the depth test in parallel, returns the number of visible boxes. */
+		size_t CullBoxes(const FBoundingBox* boxes, size_t count, uint8_t* visible) const;
+
+		size_t GetWidth() const { return mWidth; }
+		size_t GetHeight() const { return mHeight; }
+
+		/** Row major, one value per pixel, 1 where nothing was drawn. */
+		const float* GetDepth() const { return mDepth.data(); }
+
+		const FFrustum& GetFrustum() const { return mFrustum; }
+
+	private:
+		struct FDirtyRect
+		{
+			size_t MinX = ~size_t{ 0 };
+			size_t MinY = ~size_t{ 0 };
+			size_t MaxX = 0;
+			size_t MaxY = 0;
+		};
+
+		void RasterizeClipTriangle(const FVector4f& c0, const FVector4f& c1, const FVector4f& c2, FDirtyRect& dirty);
+		void RasterizeScreenTriangle(const FVector3f& p0, const FVector3f& p1, const FVector3f& p2, FDirtyRect& dirty);
+		void UpdateTileDepth(const FDirtyRect& dirty);
+		bool IsDepthVisible(const FBoundingBox& box) const;
+
+		size_t mWidth;
+		size_t mHeight;
+		size_t mTilesX;
+		size_t mTilesY;
+
+		FMatrix4x4 mViewProjection;
+		FFrustum mFrustum;
+
+		std::vector<float> mDepth;
+		std::vector<float> mTileMaxDepth;
+	};
+}
@@ -0,0 +1,590 @@
+#include "SoftwareRasterizer.h"
+#include "Camera.h"
+#include "../utility/HighResolutionTimer.h"
+#include "../utility/ParallelFor.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace Dash
+{
+	namespace
+	{
+		constexpr size_t SetupChunkSize = 4096;
+		constexpr size_t BinChunkSize = 16384;
+		constexpr uint32_t NoTriangle = ~0u;
+
+		/**
+		 * Triangles reaching further than this from the screen center are clipped, which keeps fixed point coordinates
+		 * below 2^20 and the edge functions of a partially covered block within 32 bits.
+		 */
+		constexpr Scalar MaxScreenOffset = 32768;
+
+		constexpr uint8_t BitCount4[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+		enum EClipPlane
+		{
+			ClipNear,
+			ClipFar,
+			ClipLeft,
+			ClipRight,
+			ClipBottom,
+			ClipTop,
+			ClipPlaneCount
+		};
+
+		FORCEINLINE Scalar GetClipDistance(size_t plane, const FVector4f& p, Scalar guardX, Scalar guardY)
+		{
+			switch (plane)
+			{
+			case ClipNear: return p.z;
+			case ClipFar: return p.w - p.z;
+			case ClipLeft: return p.x + guardX * p.w;
+			case ClipRight: return guardX * p.w - p.x;
+			case ClipBottom: return p.y + guardY * p.w;
+			default: return guardY * p.w - p.y;
+			}
+		}
+
+		/** Floor of a fixed point coordinate in pixels, relies on the arithmetic shift of negative values. */
+		FORCEINLINE int32_t FloorToPixel(int32_t v)
+		{
+			return v >> FSoftwareRasterizer::SubPixelBits;
+		}
+	}
+
+	FSoftwareRasterizer::FSoftwareRasterizer(size_t width, size_t height)
+		: mWidth(width)
+		, mHeight(height)
+		, mTilesX((width + TileSize - 1) / TileSize)
+		, mTilesY((height + TileSize - 1) / TileSize)
+		, mPaddedWidth(mTilesX * TileSize)
+		, mBlocksX(mPaddedWidth / BlockSize)
+		, mViewProjection(FIdentity{})
+		, mClearColor(0, 0, 0, 1)
+		, mDepth(mPaddedWidth * mTilesY * TileSize, Scalar{ 1 })
+		, mTriangleIds(mDepth.size(), NoTriangle)
+		, mBlockMaxDepth(mBlocksX * (mTilesY * TileSize / BlockSize), Scalar{ 1 })
+		, mColorTarget(width, height, EDASH_FORMAT::R8G8B8A8_UNORM)
+		, mDepthTarget(width, height, EDASH_FORMAT::R32_FLOAT)
+	{
+		ASSERT(width > 0 && height > 0);
+	}
+
+	void FSoftwareRasterizer::Begin(const FMatrix4x4& viewProjection, const FLinearColor& clearColor)
+	{
+		mViewProjection = viewProjection;
+		mClearColor = clearColor;
+
+		mTriangles.clear();
+		std::fill(mDepth.begin(), mDepth.end(), Scalar{ 1 });
+		std::fill(mTriangleIds.begin(), mTriangleIds.end(), NoTriangle);
+		std::fill(mBlockMaxDepth.begin(), mBlockMaxDepth.end(), Scalar{ 1 });
+
+		mStats = FRasterStats{};
+	}
+
+	void FSoftwareRasterizer::Begin(const FCamera& camera, const FLinearColor& clearColor)
+	{
+		Begin(camera.GetViewProjectionMatrix(), clearColor);
+	}
+
+	void FSoftwareRasterizer::DrawMesh(const TriangleMesh& mesh, const FMatrix4x4& objectToWorld)
+	{
+		FHighResolutionTimer timer;
+
+		const FVertexAttributeHandle positionHandle = mesh.FindVertexAttribute(VertexAttribute::Position::Name);
+		ASSERT(positionHandle.IsValid());
+		const TStridedSpan<const FVector3f> positions = mesh.GetVertexAttribute<FVector3f>(positionHandle);
+
+		const FVertexAttributeHandle normalHandle = mesh.FindVertexAttribute(VertexAttribute::Normal::Name);
+		const bool hasNormals = normalHandle.IsValid() && normalHandle.Format == VertexAttribute::Normal::Format;
+
+		std::vector<uint32_t> indices;
+		mesh.ReadAbsoluteIndices(indices);
+
+		const FMatrix4x4 objectToClip = objectToWorld * mViewProjection;
+		const FMatrix4x4 normalMatrix = FMath::Transpose(FMath::Inverse(objectToWorld));
+
+		std::vector<FClipVertex> vertices(mesh.NumVertices);
+		std::vector<FVector3f> worldPositions(hasNormals ? 0 : mesh.NumVertices);
+		ParallelFor(0, mesh.NumVertices, [&](size_t i)
+		{
+			const FVector3f& p = positions[i];
+			const FMatrix4x4& m = objectToClip;
+			vertices[i].Position = FVector4f{ p.x * m[0][0] + p.y * m[1][0] + p.z * m[2][0] + m[3][0],
+				p.x * m[0][1] + p.y * m[1][1] + p.z * m[2][1] + m[3][1],
+				p.x * m[0][2] + p.y * m[1][2] + p.z * m[2][2] + m[3][2],
+				p.x * m[0][3] + p.y * m[1][3] + p.z * m[2][3] + m[3][3] };
+
+			if (hasNormals)
+			{
+				const FVector3f n = mesh.GetVertexAttribute<FVector3f>(normalHandle)[i];
+				const FMatrix4x4& nm = normalMatrix;
+				const FVector3f worldNormal{ n.x * nm[0][0] + n.y * nm[1][0] + n.z * nm[2][0],
+					n.x * nm[0][1] + n.y * nm[1][1] + n.z * nm[2][1],
+					n.x * nm[0][2] + n.y * nm[1][2] + n.z * nm[2][2] };
+
+				const Scalar length = FMath::Length(worldNormal);
+				vertices[i].Normal = length > 0 ? worldNormal * (Scalar{ 1 } / length) : worldNormal;
+			}
+			else
+			{
+				const FMatrix4x4& w = objectToWorld;
+				worldPositions[i] = FVector3f{ p.x * w[0][0] + p.y * w[1][0] + p.z * w[2][0] + w[3][0],
+					p.x * w[0][1] + p.y * w[1][1] + p.z * w[2][1] + w[3][1],
+					p.x * w[0][2] + p.y * w[1][2] + p.z * w[2][2] + w[3][2] };
+			}
+		}, 4096);
+
+		const size_t triangleCount = indices.size() / 3;
+		const size_t chunkCount = (triangleCount + SetupChunkSize - 1) / SetupChunkSize;
+		std::vector<std::vector<FTriangle>> chunkTriangles(chunkCount);
+
+		ParallelFor(0, chunkCount, [&](size_t chunk)
+		{
+			chunkTriangles[chunk].reserve(SetupChunkSize);
+			const size_t end = std::min((chunk + 1) * SetupChunkSize, triangleCount);
+			for (size_t t = chunk * SetupChunkSize; t < end; ++t)
+			{
+				FClipVertex v0 = vertices[indices[t * 3 + 0]];
+				FClipVertex v1 = vertices[indices[t * 3 + 1]];
+				FClipVertex v2 = vertices[indices[t * 3 + 2]];
+
+				if (!hasNormals)
+				{
+					const FVector3f& p0 = worldPositions[indices[t * 3 + 0]];
+					const FVector3f faceNormal = FMath::Cross(worldPositions[indices[t * 3 + 1]] - p0, worldPositions[indices[t * 3 + 2]] - p0);
+					const Scalar length = FMath::Length(faceNormal);
+					v0.Normal = v1.Normal = v2.Normal = length > 0 ? faceNormal * (Scalar{ 1 } / length) : faceNormal;
+				}
+
+				SetupTriangle(v0, v1, v2, chunkTriangles[chunk]);
+			}
+		});
+
+		for (const std::vector<FTriangle>& triangles : chunkTriangles)
+		{
+			mTriangles.insert(mTriangles.end(), triangles.begin(), triangles.end());
+		}
+		ASSERT(mTriangles.size() < NoTriangle);
+
+		mStats.SubmittedTriangles += triangleCount;
+		mStats.RasterizedTriangles = mTriangles.size();
+
+		timer.Update();
+		mStats.SetupSeconds += timer.ElapsedSeconds();
+	}
+
+	void FSoftwareRasterizer::End()
+	{
+		FHighResolutionTimer timer;
+
+		const size_t tileCount = mTilesX * mTilesY;
+		const size_t chunkCount = (mTriangles.size() + BinChunkSize - 1) / BinChunkSize;
+		mBins.resize(chunkCount * tileCount);
+
+		ParallelFor(0, chunkCount, [&](size_t chunk)
+		{
+			std::vector<uint32_t>* bins = mBins.data() + chunk * tileCount;
+			for (size_t tile = 0; tile < tileCount; ++tile)
+			{
+				bins[tile].clear();
+			}
+
+			const size_t end = std::min((chunk + 1) * BinChunkSize, mTriangles.size());
+			for (size_t t = chunk * BinChunkSize; t < end; ++t)
+			{
+				const FTriangle& triangle = mTriangles[t];
+				for (size_t ty = triangle.MinY / TileSize; ty <= triangle.MaxY / TileSize; ++ty)
+				{
+					for (size_t tx = triangle.MinX / TileSize; tx <= triangle.MaxX / TileSize; ++tx)
+					{
+						bins[ty * mTilesX + tx].push_back(static_cast<uint32_t>(t));
+					}
+				}
+			}
+		});
+
+		std::atomic<size_t> pixels{ 0 };
+		ParallelFor(0, tileCount, [&](size_t tile)
+		{
+			pixels += RasterizeTile(tile, chunkCount);
+		});
+
+		mStats.DepthPassedPixels = pixels;
+		timer.Update();
+		mStats.RasterSeconds = timer.ElapsedSeconds();
+
+		ParallelFor(0, mHeight, [&](size_t y)
+		{
+			std::vector<float> colors(mWidth * 4);
+			const uint32_t* ids = mTriangleIds.data() + y * mPaddedWidth;
+			const Scalar py = y + Scalar{ 0.5 };
+
+			for (size_t x = 0; x < mWidth; ++x)
+			{
+				FLinearColor color = mClearColor;
+				if (ids[x] != NoTriangle)
+				{
+					const FTriangle& t = mTriangles[ids[x]];
+					const Scalar px = x + Scalar{ 0.5 };
+					const Scalar scale = Scalar{ 1 } / (1 << SubPixelBits);
+
+					Scalar sx[3];
+					Scalar sy[3];
+					for (size_t k = 0; k < 3; ++k)
+					{
+						sx[k] = t.X[k] * scale;
+						sy[k] = t.Y[k] * scale;
+					}
+
+					// screen space barycentrics made perspective correct through 1/w
+					const Scalar b0 = FMath::Max((sx[2] - sx[1]) * (py - sy[1]) - (sy[2] - sy[1]) * (px - sx[1]), Scalar{ 0 }) * t.InvW[0];
+					const Scalar b1 = FMath::Max((sx[0] - sx[2]) * (py - sy[2]) - (sy[0] - sy[2]) * (px - sx[2]), Scalar{ 0 }) * t.InvW[1];
+					const Scalar b2 = FMath::Max((sx[1] - sx[0]) * (py - sy[0]) - (sy[1] - sy[0]) * (px - sx[0]), Scalar{ 0 }) * t.InvW[2];
+
+					FVector3f normal = t.Normals[0] * b0 + t.Normals[1] * b1 + t.Normals[2] * b2;
+					const Scalar length = FMath::Length(normal);
+					normal = length > 0 ? normal * (Scalar{ 0.5 } / length) : normal;
+
+					color = FLinearColor(normal.x + Scalar{ 0.5 }, normal.y + Scalar{ 0.5 }, normal.z + Scalar{ 0.5 }, 1);
+				}
+
+				colors[x * 4 + 0] = color.r;
+				colors[x * 4 + 1] = color.g;
+				colors[x * 4 + 2] = color.b;
+				colors[x * 4 + 3] = color.a;
+			}
+
+			QuantizeLinearToUNorm8(colors.data(), colors.size(), mColorTarget.GetRawData() + y * mColorTarget.GetRowPitch(), false);
+			std::memcpy(mDepthTarget.GetRawData() + y * mDepthTarget.GetRowPitch(), mDepth.data() + y * mPaddedWidth, mWidth * sizeof(float));
+		}, 16);
+
+		timer.Update();
+		mStats.ResolveSeconds = timer.ElapsedSeconds() - mStats.RasterSeconds;
+	}
+
+	void FSoftwareRasterizer::SetupTriangle(const FClipVertex& v0, const FClipVertex& v1, const FClipVertex& v2, std::vector<FTriangle>& triangles) const
+	{
+		const FVector4f& p0 = v0.Position;
+		const FVector4f& p1 = v1.Position;
+		const FVector4f& p2 = v2.Position;
+
+		// entirely outside one side of the view volume
+		if ((p0.x < -p0.w && p1.x < -p1.w && p2.x < -p2.w) || (p0.x > p0.w && p1.x > p1.w && p2.x > p2.w) ||
+			(p0.y < -p0.w && p1.y < -p1.w && p2.y < -p2.w) || (p0.y > p0.w && p1.y > p1.w && p2.y > p2.w) ||
+			(p0.z < 0 && p1.z < 0 && p2.z < 0) || (p0.z > p0.w && p1.z > p1.w && p2.z > p2.w))
+		{
+			return;
+		}
+
+		const Scalar guardX = MaxScreenOffset * 2 / mWidth;
+		const Scalar guardY = MaxScreenOffset * 2 / mHeight;
+
+		bool needsClipping = false;
+		for (const FVector4f* p : { &p0, &p1, &p2 })
+		{
+			needsClipping |= p->z < 0 || p->z > p->w || FMath::Abs(p->x) > guardX * p->w || FMath::Abs(p->y) > guardY * p->w;
+		}
+
+		if (!needsClipping)
+		{
+			EmitTriangle(v0, v1, v2, triangles);
+			return;
+		}
+
+		// every plane adds at most one vertex
+		FClipVertex buffers[2][3 + ClipPlaneCount];
+		size_t count = 3;
+		buffers[0][0] = v0;
+		buffers[0][1] = v1;
+		buffers[0][2] = v2;
+
+		for (size_t plane = 0; plane < ClipPlaneCount; ++plane)
+		{
+			const FClipVertex* input = buffers[plane & 1];
+			FClipVertex* output = buffers[(plane + 1) & 1];
+			size_t outputCount = 0;
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				const FClipVertex& a = input[i];
+				const FClipVertex& b = input[(i + 1) % count];
+				const Scalar da = GetClipDistance(plane, a.Position, guardX, guardY);
+				const Scalar db = GetClipDistance(plane, b.Position, guardX, guardY);
+
+				if (da >= 0)
+				{
+					output[outputCount++] = a;
+				}
+				if ((da >= 0) != (db >= 0))
+				{
+					const Scalar t = da / (da - db);
+					output[outputCount].Position = a.Position + (b.Position - a.Position) * t;
+					output[outputCount].Normal = a.Normal + (b.Normal - a.Normal) * t;
+					++outputCount;
+				}
+			}
+
+			count = outputCount;
+			if (count < 3)
+			{
+				return;
+			}
+		}
+
+		const FClipVertex* polygon = buffers[ClipPlaneCount & 1];
+		for (size_t i = 2; i < count; ++i)
+		{
+			EmitTriangle(polygon[0], polygon[i - 1], polygon[i], triangles);
+		}
+	}
+
+	void FSoftwareRasterizer::EmitTriangle(const FClipVertex& v0, const FClipVertex& v1, const FClipVertex& v2, std::vector<FTriangle>& triangles) const
+	{
+		const FClipVertex* vertices[3] = { &v0, &v1, &v2 };
+		const Scalar subPixelScale = static_cast<Scalar>(1 << SubPixelBits);
+
+		FTriangle triangle;
+		for (size_t k = 0; k < 3; ++k)
+		{
+			const FVector4f& p = vertices[k]->Position;
+			if (p.w <= 0)
+			{
+				return;
+			}
+
+			const Scalar invW = Scalar{ 1 } / p.w;
+			triangle.X[k] = _mm_cvtss_si32(_mm_set_ss((p.x * invW * Scalar{ 0.5 } + Scalar{ 0.5 }) * mWidth * subPixelScale));
+			triangle.Y[k] = _mm_cvtss_si32(_mm_set_ss((Scalar{ 0.5 } - p.y * invW * Scalar{ 0.5 }) * mHeight * subPixelScale));
+			triangle.Z[k] = FMath::Clamp(p.z * invW, Scalar{ 0 }, Scalar{ 1 });
+			triangle.InvW[k] = invW;
+			triangle.Normals[k] = vertices[k]->Normal;
+		}
+
+		const int64_t area = int64_t(triangle.X[1] - triangle.X[0]) * (triangle.Y[2] - triangle.Y[0]) -
+			int64_t(triangle.X[2] - triangle.X[0]) * (triangle.Y[1] - triangle.Y[0]);
+		if (area == 0)
+		{
+			return;
+		}
+
+		// y points down on screen, so a positive area is a front face
+		const bool frontFace = area > 0;
+		if ((mCullMode == ERasterCullMode::Back && !frontFace) || (mCullMode == ERasterCullMode::Front && frontFace))
+		{
+			return;
+		}
+
+		if (!frontFace)
+		{
+			std::swap(triangle.X[1], triangle.X[2]);
+			std::swap(triangle.Y[1], triangle.Y[2]);
+			std::swap(triangle.Z[1], triangle.Z[2]);
+			std::swap(triangle.InvW[1], triangle.InvW[2]);
+			std::swap(triangle.Normals[1], triangle.Normals[2]);
+		}
+
+		// pixels whose centers lie inside the fixed point bounds
+		const int32_t half = 1 << (SubPixelBits - 1);
+		const int32_t lastX = static_cast<int32_t>(mWidth) - 1;
+		const int32_t lastY = static_cast<int32_t>(mHeight) - 1;
+		triangle.MinX = std::max(FloorToPixel(std::min({ triangle.X[0], triangle.X[1], triangle.X[2] }) - half + (1 << SubPixelBits) - 1), 0);
+		triangle.MinY = std::max(FloorToPixel(std::min({ triangle.Y[0], triangle.Y[1], triangle.Y[2] }) - half + (1 << SubPixelBits) - 1), 0);
+		triangle.MaxX = std::min(FloorToPixel(std::max({ triangle.X[0], triangle.X[1], triangle.X[2] }) - half), lastX);
+		triangle.MaxY = std::min(FloorToPixel(std::max({ triangle.Y[0], triangle.Y[1], triangle.Y[2] }) - half), lastY);
+
+		if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+		{
+			return;
+		}
+
+		triangles.push_back(triangle);
+	}
+
+	size_t FSoftwareRasterizer::RasterizeTile(size_t tileIndex, size_t chunkCount)
+	{
+		const size_t tileCount = mTilesX * mTilesY;
+		const size_t tileX = tileIndex % mTilesX;
+		const size_t tileY = tileIndex / mTilesX;
+
+		size_t pixels = 0;
+		for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			for (uint32_t id : mBins[chunk * tileCount + tileIndex])
+			{
+				pixels += RasterizeTriangle(mTriangles[id], id, tileX, tileY);
+			}
+		}
+		return pixels;
+	}
+
+	size_t FSoftwareRasterizer::RasterizeTriangle(const FTriangle& t, uint32_t triangleId, size_t tileX, size_t tileY)
+	{
+		const int32_t x0 = std::max(t.MinX, static_cast<int32_t>(tileX * TileSize));
+		const int32_t y0 = std::max(t.MinY, static_cast<int32_t>(tileY * TileSize));
+		const int32_t x1 = std::min(t.MaxX, static_cast<int32_t>(tileX * TileSize + TileSize - 1));
+		const int32_t y1 = std::min(t.MaxY, static_cast<int32_t>(tileY * TileSize + TileSize - 1));
+		if (x0 > x1 || y0 > y1)
+		{
+			return 0;
+		}
+
+		// E(x, y) = A x + B y + C is positive inside, edges that are not top or left lose their boundary pixels
+		int64_t edgeA[3];
+		int64_t edgeB[3];
+		int64_t edgeC[3];
+		for (size_t e = 0; e < 3; ++e)
+		{
+			const size_t a = e;
+			const size_t b = (e + 1) % 3;
+			edgeA[e] = int64_t(t.Y[a]) - t.Y[b];
+			edgeB[e] = int64_t(t.X[b]) - t.X[a];
+			edgeC[e] = -(edgeA[e] * t.X[a] + edgeB[e] * t.Y[a]);
+
+			const bool topLeft = edgeA[e] > 0 || (edgeA[e] == 0 && edgeB[e] > 0);
+			edgeC[e] -= topLeft ? 0 : 1;
+		}
+
+		// depth plane in pixel units
+		const Scalar scale = Scalar{ 1 } / (1 << SubPixelBits);
+		const Scalar sx0 = t.X[0] * scale;
+		const Scalar sy0 = t.Y[0] * scale;
+		const Scalar dx1 = t.X[1] * scale - sx0;
+		const Scalar dy1 = t.Y[1] * scale - sy0;
+		const Scalar dx2 = t.X[2] * scale - sx0;
+		const Scalar dy2 = t.Y[2] * scale - sy0;
+		const Scalar invArea = Scalar{ 1 } / (dx1 * dy2 - dx2 * dy1);
+		const Scalar dzdx = ((t.Z[1] - t.Z[0]) * dy2 - (t.Z[2] - t.Z[0]) * dy1) * invArea;
+		const Scalar dzdy = ((t.Z[2] - t.Z[0]) * dx1 - (t.Z[1] - t.Z[0]) * dx2) * invArea;
+		const Scalar minZ = FMath::Min(t.Z[0], FMath::Min(t.Z[1], t.Z[2]));
+		const Scalar maxZ = FMath::Max(t.Z[0], FMath::Max(t.Z[1], t.Z[2]));
+
+		// interpolated depth is clamped to the vertex range, so a triangle behind a block's farthest depth can never pass
+		const __m128 minZv = _mm_set1_ps(minZ);
+		const __m128 maxZv = _mm_set1_ps(maxZ);
+		const __m128 laneZ[2] = { _mm_setr_ps(0, dzdx, 2 * dzdx, 3 * dzdx), _mm_setr_ps(4 * dzdx, 5 * dzdx, 6 * dzdx, 7 * dzdx) };
+		const __m128i triangleIdv = _mm_set1_epi32(static_cast<int32_t>(triangleId));
+		const __m128i allOutside = _mm_set1_epi32(-1);
+
+		const int64_t pixelStep = int64_t{ 1 } << SubPixelBits;
+		const int64_t blockSpan = (BlockSize - 1) * pixelStep;
+		const int64_t half = pixelStep / 2;
+
+		size_t pixels = 0;
+		for (int32_t by = y0 / BlockSize * BlockSize; by <= y1; by += BlockSize)
+		{
+			for (int32_t bx = x0 / BlockSize * BlockSize; bx <= x1; bx += BlockSize)
+			{
+				float& blockMaxDepth = mBlockMaxDepth[(by / BlockSize) * mBlocksX + bx / BlockSize];
+				if (minZ >= blockMaxDepth)
+				{
+					continue;
+				}
+
+				// edges at the block corners: reject, accept the whole block or test per pixel
+				const int64_t cx = bx * pixelStep + half;
+				const int64_t cy = by * pixelStep + half;
+				__m128i rowEdges[3][2];
+				__m128i rowSteps[3];
+				size_t partialEdges = 0;
+				bool rejected = false;
+				for (size_t e = 0; e < 3; ++e)
+				{
+					const int64_t value = edgeA[e] * cx + edgeB[e] * cy + edgeC[e];
+					const int64_t maxValue = value + std::max<int64_t>(edgeA[e], 0) * blockSpan + std::max<int64_t>(edgeB[e], 0) * blockSpan;
+					const int64_t minValue = value + std::min<int64_t>(edgeA[e], 0) * blockSpan + std::min<int64_t>(edgeB[e], 0) * blockSpan;
+					if (maxValue < 0)
+					{
+						rejected = true;
+						break;
+					}
+					if (minValue >= 0)
+					{
+						continue;
+					}
+
+					// the edge crosses the block, which bounds every value in it to 32 bits
+					const int32_t v = static_cast<int32_t>(value);
+					const int32_t stepX = static_cast<int32_t>(edgeA[e] * pixelStep);
+					rowEdges[partialEdges][0] = _mm_setr_epi32(v, v + stepX, v + 2 * stepX, v + 3 * stepX);
+					rowEdges[partialEdges][1] = _mm_add_epi32(rowEdges[partialEdges][0], _mm_set1_epi32(4 * stepX));
+					rowSteps[partialEdges] = _mm_set1_epi32(static_cast<int32_t>(edgeB[e] * pixelStep));
+					++partialEdges;
+				}
+				if (rejected)
+				{
+					continue;
+				}
+
+				// blocks on the right and bottom border reach into the padding
+				const size_t rowCount = std::min(BlockSize, mHeight - by);
+				const __m128i columnLimit = _mm_set1_epi32(static_cast<int32_t>(mWidth) - bx);
+				const __m128i inside[2] = { _mm_cmpgt_epi32(columnLimit, _mm_setr_epi32(0, 1, 2, 3)), _mm_cmpgt_epi32(columnLimit, _mm_setr_epi32(4, 5, 6, 7)) };
+
+				const Scalar blockZ = t.Z[0] + dzdx * (bx + Scalar{ 0.5 } - sx0) + dzdy * (by + Scalar{ 0.5 } - sy0);
+				size_t blockPixels = 0;
+
+				for (size_t row = 0; row < rowCount; ++row)
+				{
+					float* depthRow = mDepth.data() + (by + row) * mPaddedWidth + bx;
+					uint32_t* idRow = mTriangleIds.data() + (by + row) * mPaddedWidth + bx;
+					const __m128 rowZ = _mm_set1_ps(blockZ + dzdy * row);
+
+					for (size_t group = 0; group < 2; ++group)
+					{
+						// a lane is inside when no edge value has its sign bit set
+						__m128i signs = _mm_setzero_si128();
+						for (size_t e = 0; e < partialEdges; ++e)
+						{
+							signs = _mm_or_si128(signs, rowEdges[e][group]);
+						}
+						const __m128i covered = _mm_and_si128(_mm_cmpgt_epi32(signs, allOutside), inside[group]);
+
+						const __m128 z = _mm_min_ps(_mm_max_ps(_mm_add_ps(rowZ, laneZ[group]), minZv), maxZv);
+						const __m128 depth = _mm_loadu_ps(depthRow + group * 4);
+						const __m128 pass = _mm_and_ps(_mm_castsi128_ps(covered), _mm_cmplt_ps(z, depth));
+
+						const int mask = _mm_movemask_ps(pass);
+						if (mask == 0)
+						{
+							continue;
+						}
+
+						const __m128i passi = _mm_castps_si128(pass);
+						__m128i* ids = reinterpret_cast<__m128i*>(idRow + group * 4);
+						_mm_storeu_ps(depthRow + group * 4, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, depth)));
+						_mm_storeu_si128(ids, _mm_or_si128(_mm_and_si128(passi, triangleIdv), _mm_andnot_si128(passi, _mm_loadu_si128(ids))));
+						blockPixels += BitCount4[mask];
+					}
+
+					for (size_t e = 0; e < partialEdges; ++e)
+					{
+						rowEdges[e][0] = _mm_add_epi32(rowEdges[e][0], rowSteps[e]);
+						rowEdges[e][1] = _mm_add_epi32(rowEdges[e][1], rowSteps[e]);
+					}
+				}
+
+				if (blockPixels > 0)
+				{
+					__m128 farthest = _mm_setzero_ps();
+					for (size_t row = 0; row < BlockSize; ++row)
+					{
+						const float* depthRow = mDepth.data() + (by + row) * mPaddedWidth + bx;
+						farthest = _mm_max_ps(farthest, _mm_max_ps(_mm_loadu_ps(depthRow), _mm_loadu_ps(depthRow + 4)));
+					}
+					farthest = _mm_max_ps(farthest, _mm_shuffle_ps(farthest, farthest, _MM_SHUFFLE(1, 0, 3, 2)));
+					farthest = _mm_max_ps(farthest, _mm_shuffle_ps(farthest, farthest, _MM_SHUFFLE(2, 3, 0, 1)));
+					blockMaxDepth = _mm_cvtss_f32(farthest);
+
+					pixels += blockPixels;
+				}
+			}
+		}
+
+		return pixels;
+	}
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "../shapes/Shape.h"
+#include "../utility/Image.h"
+
+namespace Dash
+{
+	class FCamera;
+
+	/** Front faces are those whose cross(p1 - p0, p2 - p0) points towards the camera. */
+	enum class ERasterCullMode : uint8_t
+	{
+		None,
+		Back,
+		Front
+	};
+
+	struct FRasterStats
+	{
+		size_t SubmittedTriangles = 0;
+
+		/** Triangles left after culling and clipping, a clipped triangle may count more than once. */
+		size_t RasterizedTriangles = 0;
+
+		/** Pixels that passed the depth test, overdraw included. */
+		size_t DepthPassedPixels = 0;
+
+		/** Vertex transform, clipping and triangle setup of all draws. */
+		double SetupSeconds = 0;
+
+		/** Binning and rasterization of all tiles. */
+		double RasterSeconds = 0;
+
+		/** Shading and writing the targets. */
+		double ResolveSeconds = 0;
+
+		double GetTotalSeconds() const { return SetupSeconds + RasterSeconds + ResolveSeconds; }
+
+		/** Submitted triangles over the whole frame time. */
+		double GetTrianglesPerSecond() const { return GetTotalSeconds() > 0 ? SubmittedTriangles / GetTotalSeconds() : 0; }
+
+		/** Depth passing pixels over the rasterization time. */
+		double GetPixelsPerSecond() const { return RasterSeconds > 0 ? DepthPassedPixels / RasterSeconds : 0; }
+	};
+
+	/**
+	 * Tiled CPU rasterizer for headless previews and image regression tests. Shading matches the CPU ray preview, the
+	 * world space normal mapped to [0, 1], written without gamma.
+	 *
+	 * Draws are transformed, clipped and set up when submitted. End bins the triangles into 64x64 pixel tiles and
+	 * rasterizes the tiles in parallel, each tile in submission order, so the image does not depend on the thread count.
+	 * Vertices snap to 1/16 pixel and coverage follows the top-left rule with integer edge functions, four pixels per
+	 * SSE2 step. 8x8 blocks are rejected or fully accepted from their corners first and skipped when the triangle is
+	 * behind the farthest depth of the block. Rasterization only writes depth and a triangle id per pixel, shading
+	 * runs once per visible pixel afterwards.
+	 */
+	class FSoftwareRasterizer
+	{
+	public:
+		static constexpr size_t TileSize = 64;
+		static constexpr size_t BlockSize = 8;
+		static constexpr int32_t SubPixelBits = 4;
+
+		FSoftwareRasterizer(size_t width, size_t height);
+
+		void SetCullMode(ERasterCullMode mode) { mCullMode = mode; }
+		ERasterCullMode GetCullMode() const { return mCullMode; }
+
+		/** Clears the targets and statistics and sets the view projection of the following draws. */
+		void Begin(const FMatrix4x4& viewProjection, const FLinearColor& clearColor = FLinearColor(0, 0, 0, 1));
+		void Begin(const FCamera& camera, const FLinearColor& clearColor = FLinearColor(0, 0, 0, 1));
+
+		/** objectToWorld is a row-vector matrix. Meshes without float3 normals are shaded with face normals. */
+		void DrawMesh(const TriangleMesh& mesh, const FMatrix4x4& objectToWorld = FMatrix4x4(FIdentity{}));
+
+		/** Rasterizes and shades everything drawn since Begin. */
+		void End();
+
+		/** R8G8B8A8_UNORM */
+		const FTexture& GetColorTarget() const { return mColorTarget; }
+
+		/** R32_FLOAT post projection depth, 1 where nothing was drawn. */
+		const FTexture& GetDepthTarget() const { return mDepthTarget; }
+
+		const FRasterStats& GetStats() const { return mStats; }
+
+		size_t GetWidth() const { return mWidth; }
+		size_t GetHeight() const { return mHeight; }
+
+	private:
+		struct FClipVertex
+		{
+			FVector4f Position;
+			FVector3f Normal;
+		};
+
+		struct FTriangle
+		{
+			/** Fixed point pixel coordinates, counter clockwise on screen so the edge functions are positive inside. */
+			int32_t X[3];
+			int32_t Y[3];
+
+			float Z[3];
+			float InvW[3];
+			FVector3f Normals[3];
+
+			/** Inclusive pixel bounds clamped to the target. */
+			int32_t MinX;
+			int32_t MinY;
+			int32_t MaxX;
+			int32_t MaxY;
+		};
+
+		void SetupTriangle(const FClipVertex& v0, const FClipVertex& v1, const FClipVertex& v2, std::vector<FTriangle>& triangles) const;
+		void EmitTriangle(const FClipVertex& v0, const FClipVertex& v1, const FClipVertex& v2, std::vector<FTriangle>& triangles) const;
+		size_t RasterizeTile(size_t tileIndex, size_t chunkCount);
+		size_t RasterizeTriangle(const FTriangle& triangle, uint32_t triangleId, size_t tileX, size_t tileY);
+
+		size_t mWidth;
+		size_t mHeight;
+		size_t mTilesX;
+		size_t mTilesY;
+		size_t mPaddedWidth;
+		size_t mBlocksX;
+
+		ERasterCullMode mCullMode = ERasterCullMode::Back;
+		FMatrix4x4 mViewProjection;
+		FLinearColor mClearColor;
+
+		std::vector<FTriangle> mTriangles;
+
+		/** Triangle ids per tile, one list per chunk of triangles so binning runs in parallel and keeps the order. */
+		std::vector<std::vector<uint32_t>> mBins;
+
+		// tile padded, the targets are written from these in End
+		std::vector<float> mDepth;
+		std::vector<uint32_t> mTriangleIds;
+		std::vector<float> mBlockMaxDepth;
+
+		FTexture mColorTarget;
+		FTexture mDepthTarget;
+
+		FRasterStats mStats;
+	};
+}
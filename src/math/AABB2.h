@@ -59,7 +59,7 @@ namespace Dash
     class AABB2iIterator : public std::forward_iterator_tag {
     public:
         AABB2iIterator(const TAABB<int, 2>& b, const TScalarArray<int, 2>& pt)
-            : p(pt), TAABB(&b) {}
+            : p(pt), mBounds(&b) {}
         AABB2iIterator operator++() {
             Advance();
             return *this;
@@ -70,10 +70,10 @@ namespace Dash
             return old;
         }
         bool operator==(const AABB2iIterator& bi) const {
-            return p == bi.p && TAABB == bi.TAABB;
+            return p == bi.p && mBounds == bi.mBounds;
         }
         bool operator!=(const AABB2iIterator& bi) const {
-            return p != bi.p || TAABB != bi.TAABB;
+            return p != bi.p || mBounds != bi.mBounds;
         }
 
         TScalarArray<int, 2> operator*() const { return p; }
@@ -81,13 +81,13 @@ namespace Dash
     private:
         void Advance() {
             ++p.x;
-            if (p.x == TAABB->Upper.x) {
-                p.x = TAABB->Lower.x;
+            if (p.x == mBounds->Upper.x) {
+                p.x = mBounds->Lower.x;
                 ++p.y;
             }
         }
         TScalarArray<int, 2> p;
-        const TAABB<int, 2>* TAABB;
+        const TAABB<int, 2>* mBounds;
     };
 }
 
@@ -225,9 +225,9 @@ namespace Dash
 		template<typename Scalar>
 		FORCEINLINE bool Overlaps(const TAABB<Scalar, 3>& b1, const TAABB<Scalar, 3>& b2) noexcept
 		{
-			bool x = (b1.Upper.x >= b2.Lower.y) && (b1.Lower.x <= b2.Upper.x);
-			bool y = (b1.Upper.x >= b2.Lower.y) && (b1.Lower.x <= b2.Upper.x);
-			bool z = (b1.Upper.x >= b2.Lower.y) && (b1.Lower.x <= b2.Upper.x);
+			bool x = (b1.Upper.x >= b2.Lower.x) && (b1.Lower.x <= b2.Upper.x);
+			bool y = (b1.Upper.y >= b2.Lower.y) && (b1.Lower.y <= b2.Upper.y);
+			bool z = (b1.Upper.z >= b2.Lower.z) && (b1.Lower.z <= b2.Upper.z);
 
 			return x && y && z;
 		}
@@ -1,5 +1,9 @@
 #include "Color.h"
 #include "ScalarArray.h"
+#include "Float16.h"
+#include <cstddef>
+#include <cmath>
+#include <vector>
 
 namespace Dash
 {
@@ -33,7 +37,7 @@ namespace Dash
 	*/
 	static const float OneOver255 = 1.0f / 255.0f;
 
-	static FORCEINLINE int HexDigit(TCHAR c)
+	static FORCEINLINE int HexDigit(char c)
 	{
 		int Result = 0;
 
@@ -80,13 +84,13 @@ namespace Dash
 		a(Vector.w)
 	{}
 
-	//FLinearColor::FLinearColor(const FFloat16Color& C)
-	//{
-	//	r = C.r.GetFloat();
-	//	g = C.g.GetFloat();
-	//	b = C.b.GetFloat();
-	//	a = C.a.GetFloat();
-	//}
+	FLinearColor::FLinearColor(const FFloat16Color& C)
+	{
+		r = C.r.GetFloat();
+		g = C.g.GetFloat();
+		b = C.b.GetFloat();
+		a = C.a.GetFloat();
+	}
 
 	FLinearColor FLinearColor::FromSRGBColor(const FColor& Color)
 	{
@@ -195,7 +199,7 @@ namespace Dash
 
 	FColor FColor::FromHex(const std::string& HexString)
 	{
-		size_t StartIndex = (!HexString.empty() && HexString[0] == TCHAR('#')) ? 1 : 0;
+		size_t StartIndex = (!HexString.empty() && HexString[0] == '#') ? 1 : 0;
 
 		if (HexString.length() == (3 + StartIndex))
 		{
@@ -431,6 +435,229 @@ namespace Dash
 	}
 
 
+	// -- Bulk conversion -- //
+
+	/** Byte offsets of the FColor channels, the SIMD paths shuffle with these instead of assuming a layout. */
+	static constexpr int ColorOffsetR = offsetof(FColor, r);
+	static constexpr int ColorOffsetG = offsetof(FColor, g);
+	static constexpr int ColorOffsetB = offsetof(FColor, b);
+	static constexpr int ColorOffsetA = offsetof(FColor, a);
+
+	static constexpr uint32_t LinearToSRGBTableSize = 4096;
+
+	/** 8 bit sRGB values for linear values quantized to 12 bits, rounded to nearest. */
+	static const uint8_t* GetLinearToSRGBTable()
+	{
+		static const auto Table = []()
+		{
+			std::vector<uint8_t> table(LinearToSRGBTableSize);
+			for (uint32_t i = 0; i < LinearToSRGBTableSize; ++i)
+			{
+				float value = static_cast<float>(i) / (LinearToSRGBTableSize - 1);
+				value = value <= 0.0031308f ? value * 12.92f : std::pow(value, 1.0f / 2.4f) * 1.055f - 0.055f;
+				table[i] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+			}
+			return table;
+		}();
+
+		return Table.data();
+	}
+
+	void QuantizeLinearToUNorm8(const float* src, std::size_t count, uint8_t* dest, bool bSRGB)
+	{
+		const uint8_t* srgbTable = bSRGB ? GetLinearToSRGBTable() : nullptr;
+		const float scale = bSRGB ? float(LinearToSRGBTableSize - 1) : 255.0f;
+
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 scaleVector = _mm_set1_ps(scale);
+		const __m128 half = _mm_set1_ps(0.5f);
+
+		std::size_t i = 0;
+		for (; i + 16 <= count; i += 16)
+		{
+			__m128i quantized[4];
+			for (int j = 0; j < 4; ++j)
+			{
+				// max with zero first so that NaN ends up as zero
+				__m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + j * 4), zero), one);
+				quantized[j] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scaleVector), half));
+			}
+
+			if (srgbTable == nullptr)
+			{
+				__m128i low = _mm_packs_epi32(quantized[0], quantized[1]);
+				__m128i high = _mm_packs_epi32(quantized[2], quantized[3]);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(low, high));
+			}
+			else
+			{
+				alignas(16) int32_t indices[16];
+				for (int j = 0; j < 4; ++j)
+				{
+					_mm_store_si128(reinterpret_cast<__m128i*>(indices + j * 4), quantized[j]);
+				}
+
+				for (int j = 0; j < 16; ++j)
+				{
+					dest[i + j] = srgbTable[indices[j]];
+				}
+			}
+		}
+
+		for (; i < count; ++i)
+		{
+			float value = src[i] > 0.0f ? FMath::Min(src[i], 1.0f) : 0.0f;
+			uint32_t index = static_cast<uint32_t>(value * scale + 0.5f);
+			dest[i] = srgbTable ? srgbTable[index] : static_cast<uint8_t>(index);
+		}
+	}
+
+	void ConvertLinearToColor(const FLinearColor* src, std::size_t count, FColor* dest, bool bSRGB)
+	{
+		const uint8_t* srgbTable = bSRGB ? GetLinearToSRGBTable() : nullptr;
+		const float colorScale = bSRGB ? float(LinearToSRGBTableSize - 1) : 255.0f;
+
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 scale = _mm_setr_ps(colorScale, colorScale, colorScale, 255.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+
+		const float* floats = reinterpret_cast<const float*>(src);
+#if defined(__AVX__) || defined(__SSSE3__)
+		uint8_t* bytes = reinterpret_cast<uint8_t*>(dest);
+
+		// moves the packed r, g, b, a bytes of four pixels to the FColor channel offsets
+		alignas(16) int8_t shuffleBytes[16];
+		for (int i = 0; i < 4; ++i)
+		{
+			shuffleBytes[i * 4 + ColorOffsetR] = static_cast<int8_t>(i * 4);
+			shuffleBytes[i * 4 + ColorOffsetG] = static_cast<int8_t>(i * 4 + 1);
+			shuffleBytes[i * 4 + ColorOffsetB] = static_cast<int8_t>(i * 4 + 2);
+			shuffleBytes[i * 4 + ColorOffsetA] = static_cast<int8_t>(i * 4 + 3);
+		}
+		const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(shuffleBytes));
+#endif
+
+		std::size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i pixels[4];
+			for (int j = 0; j < 4; ++j)
+			{
+				__m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(floats + (i + j) * 4), zero), one);
+				pixels[j] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), half));
+			}
+
+			if (srgbTable == nullptr)
+			{
+				__m128i packed = _mm_packus_epi16(_mm_packs_epi32(pixels[0], pixels[1]), _mm_packs_epi32(pixels[2], pixels[3]));
+#if defined(__AVX__) || defined(__SSSE3__)
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(bytes + i * 4), _mm_shuffle_epi8(packed, shuffle));
+#else
+				alignas(16) uint8_t channels[16];
+				_mm_store_si128(reinterpret_cast<__m128i*>(channels), packed);
+				for (int j = 0; j < 4; ++j)
+				{
+					dest[i + j] = FColor(channels[j * 4], channels[j * 4 + 1], channels[j * 4 + 2], channels[j * 4 + 3]);
+				}
+#endif
+			}
+			else
+			{
+				alignas(16) int32_t indices[16];
+				for (int j = 0; j < 4; ++j)
+				{
+					_mm_store_si128(reinterpret_cast<__m128i*>(indices + j * 4), pixels[j]);
+				}
+
+				for (int j = 0; j < 4; ++j)
+				{
+					dest[i + j] = FColor(srgbTable[indices[j * 4]], srgbTable[indices[j * 4 + 1]], srgbTable[indices[j * 4 + 2]], static_cast<uint8_t>(indices[j * 4 + 3]));
+				}
+			}
+		}
+
+		for (; i < count; ++i)
+		{
+			uint8_t channels[4];
+			QuantizeLinearToUNorm8(&src[i].r, 3, channels, bSRGB);
+			QuantizeLinearToUNorm8(&src[i].a, 1, channels + 3, false);
+			dest[i] = FColor(channels[0], channels[1], channels[2], channels[3]);
+		}
+	}
+
+	void ConvertColorToLinear(const FColor* src, std::size_t count, FLinearColor* dest, bool bSRGB)
+	{
+		std::size_t i = 0;
+
+#if defined(__AVX2__)
+		// two pixels per iteration, the color channels are gathered from the decode table
+		const __m128i shuffle = _mm_setr_epi8(
+			ColorOffsetR, ColorOffsetG, ColorOffsetB, ColorOffsetA,
+			ColorOffsetR + 4, ColorOffsetG + 4, ColorOffsetB + 4, ColorOffsetA + 4,
+			-1, -1, -1, -1, -1, -1, -1, -1);
+		const __m256 oneOver255 = _mm256_set1_ps(OneOver255);
+		const float* table = FLinearColor::sRGBToLinearTable;
+
+		for (; i + 2 <= count; i += 2)
+		{
+			__m128i pixels = _mm_shuffle_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)), shuffle);
+			__m256i channels = _mm256_cvtepu8_epi32(pixels);
+			__m256 unorm = _mm256_mul_ps(_mm256_cvtepi32_ps(channels), oneOver255);
+
+			if (bSRGB)
+			{
+				unorm = _mm256_blend_ps(_mm256_i32gather_ps(table, channels, 4), unorm, 0x88);
+			}
+
+			_mm256_storeu_ps(&dest[i].r, unorm);
+		}
+#endif
+
+		const float* colorTable = bSRGB ? FLinearColor::sRGBToLinearTable : nullptr;
+		for (; i < count; ++i)
+		{
+			const FColor& color = src[i];
+			dest[i].r = colorTable ? colorTable[color.r] : color.r * OneOver255;
+			dest[i].g = colorTable ? colorTable[color.g] : color.g * OneOver255;
+			dest[i].b = colorTable ? colorTable[color.b] : color.b * OneOver255;
+			dest[i].a = color.a * OneOver255;
+		}
+	}
+
+	void PremultiplyAlpha(FLinearColor* colors, std::size_t count)
+	{
+		const __m128 colorMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			__m128 color = _mm_loadu_ps(&colors[i].r);
+			__m128 alpha = _mm_shuffle_ps(color, color, _MM_SHUFFLE(3, 3, 3, 3));
+			__m128 premultiplied = _mm_mul_ps(color, alpha);
+			_mm_storeu_ps(&colors[i].r, _mm_or_ps(_mm_and_ps(colorMask, premultiplied), _mm_andnot_ps(colorMask, color)));
+		}
+	}
+
+	void UnpremultiplyAlpha(FLinearColor* colors, std::size_t count)
+	{
+		const __m128 colorMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			__m128 color = _mm_loadu_ps(&colors[i].r);
+			__m128 alpha = _mm_shuffle_ps(color, color, _MM_SHUFFLE(3, 3, 3, 3));
+
+			// fully transparent colors carry no color information and are left as they are
+			__m128 inverseAlpha = _mm_and_ps(_mm_cmpgt_ps(alpha, zero), _mm_div_ps(one, alpha));
+			__m128 unpremultiplied = _mm_mul_ps(color, inverseAlpha);
+			_mm_storeu_ps(&colors[i].r, _mm_or_ps(_mm_and_ps(colorMask, unpremultiplied), _mm_andnot_ps(colorMask, color)));
+		}
+	}
+
+
 	/**
 	 * Pow table for fast FColor -> FLinearColor conversion.
 	 *
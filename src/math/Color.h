@@ -65,6 +65,8 @@ namespace Dash
 
 		explicit FLinearColor(const TScalarArray<float, 4>& Vector);
 
+		FLinearColor(const FFloat16Color& C);
+
 		// Conversions.
 		FColor ToRGBE() const;
 
@@ -597,5 +599,22 @@ namespace Dash
 	/** Computes a brightness and a fixed point color from a floating point color. */
 	extern void ComputeAndFixedColorAndIntensity(const FLinearColor& InLinearColor, FColor& OutColor, float& OutIntensity);
 
+	/**
+	 * Quantizes floats clamped to [0, 1] to 8 bit values, sRGB encoding every sample when bSRGB is set.
+	 * sRGB encoding goes through a 4096 entry table and is within one step of the exact result.
+	 */
+	extern void QuantizeLinearToUNorm8(const float* src, std::size_t count, uint8_t* dest, bool bSRGB);
+
+	/** Bulk FLinearColor -> FColor conversion, alpha is never sRGB encoded. Unlike ToFColor the result is rounded. */
+	extern void ConvertLinearToColor(const FLinearColor* src, std::size_t count, FColor* dest, bool bSRGB = true);
+
+	/** Bulk FColor -> FLinearColor conversion through sRGBToLinearTable, gathered eight channels at a time with AVX2. */
+	extern void ConvertColorToLinear(const FColor* src, std::size_t count, FLinearColor* dest, bool bSRGB = true);
+
+	extern void PremultiplyAlpha(FLinearColor* colors, std::size_t count);
+
+	/** Colors with zero alpha are left untouched. */
+	extern void UnpremultiplyAlpha(FLinearColor* colors, std::size_t count);
+
 }
 
@@ -33,16 +33,30 @@ namespace Dash
 	{
 		switch (format)
 		{
+		case EDASH_FORMAT::R8_UNORM:
+		case EDASH_FORMAT::A8_UNORM:
+			return 1;
+			break;
+		case EDASH_FORMAT::R16_UNORM:
 		case EDASH_FORMAT::R16_UINT:
+		case EDASH_FORMAT::R16_FLOAT:
+		case EDASH_FORMAT::B5G6R5_UNORM:
+		case EDASH_FORMAT::B5G5R5A1_UNORM:
 			return 2;
 			break;
 		case EDASH_FORMAT::R8G8B8A8_UINT:
 		case EDASH_FORMAT::R8G8B8A8_UNORM:
+		case EDASH_FORMAT::B8G8R8A8_UNORM:
+		case EDASH_FORMAT::B8G8R8X8_UNORM:
+		case EDASH_FORMAT::R10G10B10A2_UNORM:
+		case EDASH_FORMAT::R10G10B10_XR_BIAS_A2_UNORM:
 		case EDASH_FORMAT::R32_UINT:
 		case EDASH_FORMAT::R32_FLOAT:
 			return 4;
 			break;
 		case EDASH_FORMAT::R32G32_FLOAT:
+		case EDASH_FORMAT::R16G16B16A16_FLOAT:
+		case EDASH_FORMAT::R16G16B16A16_UNORM:
 			return 8;
 			break;
 		case EDASH_FORMAT::R32G32B32_FLOAT:
@@ -0,0 +1,40 @@
+#include "Float16.h"
+
+namespace Dash
+{
+	void ConvertFloatToHalf(const float* src, std::size_t count, uint16_t* dest)
+	{
+		std::size_t i = 0;
+
+#if defined(__AVX2__)
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i halfs = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), halfs);
+		}
+#endif
+
+		for (; i < count; ++i)
+		{
+			dest[i] = FloatToHalf(src[i]);
+		}
+	}
+
+	void ConvertHalfToFloat(const uint16_t* src, std::size_t count, float* dest)
+	{
+		std::size_t i = 0;
+
+#if defined(__AVX2__)
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i halfs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			_mm256_storeu_ps(dest + i, _mm256_cvtph_ps(halfs));
+		}
+#endif
+
+		for (; i < count; ++i)
+		{
+			dest[i] = HalfToFloat(src[i]);
+		}
+	}
+}
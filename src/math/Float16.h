@@ -0,0 +1,158 @@
+#pragma once
+
+#include "Color.h"
+#include <cstdint>
+#include <cstring>
+
+namespace Dash
+{
+	/** IEEE 754 binary32 -> binary16, rounded to nearest even. Overflow becomes infinity, NaN stays NaN. */
+	FORCEINLINE uint16_t FloatToHalf(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(float));
+
+		const uint32_t sign = bits & 0x80000000u;
+		bits ^= sign;
+
+		uint16_t half;
+		if (bits >= (143u << 23))
+		{
+			// too large for a half, or infinity / NaN
+			half = bits > (255u << 23) ? 0x7E00 : 0x7C00;
+		}
+		else if (bits < (113u << 23))
+		{
+			// denormal or zero, the float addition does the rounding
+			const uint32_t magicBits = 126u << 23;
+			float magic, shifted;
+			std::memcpy(&magic, &magicBits, sizeof(float));
+			std::memcpy(&shifted, &bits, sizeof(float));
+			shifted += magic;
+			std::memcpy(&bits, &shifted, sizeof(float));
+			half = static_cast<uint16_t>(bits - magicBits);
+		}
+		else
+		{
+			const uint32_t mantissaOdd = (bits >> 13) & 1;
+			bits += (uint32_t(15 - 127) << 23) + 0xFFF + mantissaOdd;
+			half = static_cast<uint16_t>(bits >> 13);
+		}
+
+		return half | static_cast<uint16_t>(sign >> 16);
+	}
+
+	/** IEEE 754 binary16 -> binary32, exact. */
+	FORCEINLINE float HalfToFloat(uint16_t half)
+	{
+		const uint32_t shiftedExponent = 0x7C00u << 13;
+
+		uint32_t bits = uint32_t(half & 0x7FFF) << 13;
+		const uint32_t exponent = bits & shiftedExponent;
+		bits += uint32_t(127 - 15) << 23;
+
+		float value;
+		if (exponent == shiftedExponent)
+		{
+			// infinity / NaN
+			bits += uint32_t(128 - 16) << 23;
+			std::memcpy(&value, &bits, sizeof(float));
+		}
+		else if (exponent == 0)
+		{
+			// zero / denormal, renormalized by subtracting the implicit one
+			const uint32_t magicBits = 113u << 23;
+			float magic;
+			std::memcpy(&magic, &magicBits, sizeof(float));
+			bits += 1u << 23;
+			std::memcpy(&value, &bits, sizeof(float));
+			value -= magic;
+		}
+		else
+		{
+			std::memcpy(&value, &bits, sizeof(float));
+		}
+
+		return (half & 0x8000) ? -value : value;
+	}
+
+	/** Bulk float -> half conversion, eight values at a time with F16C. */
+	void ConvertFloatToHalf(const float* src, std::size_t count, uint16_t* dest);
+
+	/** Bulk half -> float conversion, eight values at a time with F16C. */
+	void ConvertHalfToFloat(const uint16_t* src, std::size_t count, float* dest);
+
+	/**
+	 * 16 bit floating point number.
+	 */
+	class FFloat16
+	{
+	public:
+		uint16_t Encoded;
+
+		FORCEINLINE FFloat16() : Encoded(0) {}
+
+		FORCEINLINE FFloat16(float value) : Encoded(FloatToHalf(value)) {}
+
+		FORCEINLINE FFloat16& operator=(float value)
+		{
+			Encoded = FloatToHalf(value);
+			return *this;
+		}
+
+		FORCEINLINE operator float() const { return GetFloat(); }
+
+		FORCEINLINE float GetFloat() const { return HalfToFloat(Encoded); }
+
+		FORCEINLINE bool operator==(const FFloat16& other) const { return Encoded == other.Encoded; }
+
+		FORCEINLINE bool operator!=(const FFloat16& other) const { return Encoded != other.Encoded; }
+	};
+
+	/**
+	 * RGBA color made up of FFloat16, laid out like R16G16B16A16_FLOAT.
+	 */
+	class FFloat16Color
+	{
+	public:
+		FFloat16 r;
+		FFloat16 g;
+		FFloat16 b;
+		FFloat16 a;
+
+		FORCEINLINE FFloat16Color() {}
+
+		FORCEINLINE FFloat16Color(const FLinearColor& color) : r(color.r), g(color.g), b(color.b), a(color.a) {}
+
+		FORCEINLINE FFloat16Color& operator=(const FLinearColor& color)
+		{
+			r = color.r;
+			g = color.g;
+			b = color.b;
+			a = color.a;
+			return *this;
+		}
+
+		FORCEINLINE bool operator==(const FFloat16Color& other) const
+		{
+			return r == other.r && g == other.g && b == other.b && a == other.a;
+		}
+
+		FORCEINLINE bool operator!=(const FFloat16Color& other) const
+		{
+			return !(*this == other);
+		}
+	};
+
+	static_assert(sizeof(FFloat16Color) == 8, "FFloat16Color must match R16G16B16A16_FLOAT");
+
+	FORCEINLINE void ConvertLinearToFloat16Color(const FLinearColor* src, std::size_t count, FFloat16Color* dest)
+	{
+		ConvertFloatToHalf(&src->r, count * 4, &dest->r.Encoded);
+	}
+
+	FORCEINLINE void ConvertFloat16ColorToLinear(const FFloat16Color* src, std::size_t count, FLinearColor* dest)
+	{
+		ConvertHalfToFloat(&src->r.Encoded, count * 4, &dest->r);
+	}
+}
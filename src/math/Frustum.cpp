@@ -0,0 +1,197 @@
+#include "Frustum.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+namespace Dash
+{
+	namespace
+	{
+		static_assert(sizeof(FBoundingBox) == sizeof(float) * 6, "boxes are loaded as six packed floats");
+
+		enum EBoxLane
+		{
+			LowerX,
+			LowerY,
+			LowerZ,
+			UpperX,
+			UpperY,
+			UpperZ,
+			BoxLaneCount
+		};
+
+		/** Transposes four boxes into one register per coordinate. */
+		FORCEINLINE void LoadBoxes(const FBoundingBox* boxes, __m128 lanes[BoxLaneCount])
+		{
+			const float* b0 = &boxes[0].Lower.x;
+			const float* b1 = &boxes[1].Lower.x;
+			const float* b2 = &boxes[2].Lower.x;
+			const float* b3 = &boxes[3].Lower.x;
+
+			__m128 r0 = _mm_loadu_ps(b0);
+			__m128 r1 = _mm_loadu_ps(b1);
+			__m128 r2 = _mm_loadu_ps(b2);
+			__m128 r3 = _mm_loadu_ps(b3);
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+			lanes[LowerX] = r0;
+			lanes[LowerY] = r1;
+			lanes[LowerZ] = r2;
+			lanes[UpperX] = r3;
+
+			const __m128 yz01 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(b0 + 4)), reinterpret_cast<const __m64*>(b1 + 4));
+			const __m128 yz23 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(b2 + 4)), reinterpret_cast<const __m64*>(b3 + 4));
+			lanes[UpperY] = _mm_shuffle_ps(yz01, yz23, _MM_SHUFFLE(2, 0, 2, 0));
+			lanes[UpperZ] = _mm_shuffle_ps(yz01, yz23, _MM_SHUFFLE(3, 1, 3, 1));
+		}
+
+		/** Per plane the coordinate of the box corner furthest along the normal, the same for every box. */
+		struct FBoxPlane
+		{
+			int Lanes[3];
+			float Normal[3];
+			float Distance;
+
+			explicit FBoxPlane(const FVector4f& plane)
+				: Lanes{ plane.x >= 0 ? UpperX : LowerX, plane.y >= 0 ? UpperY : LowerY, plane.z >= 0 ? UpperZ : LowerZ }
+				, Normal{ plane.x, plane.y, plane.z }
+				, Distance(plane.w)
+			{
+			}
+		};
+
+		FORCEINLINE void StoreVisible(int outsideMask, size_t lanes, uint8_t* visible, size_t& visibleCount)
+		{
+			for (size_t k = 0; k < lanes; ++k)
+			{
+				visible[k] = (outsideMask >> k) & 1 ? 0 : 1;
+				visibleCount += visible[k];
+			}
+		}
+	}
+
+	size_t FFrustum::IntersectsBoxes(const FBoundingBox* boxes, size_t count, uint8_t* visible) const
+	{
+		const FBoxPlane planes[PlaneCount] = { FBoxPlane(Planes[0]), FBoxPlane(Planes[1]), FBoxPlane(Planes[2]),
+			FBoxPlane(Planes[3]), FBoxPlane(Planes[4]), FBoxPlane(Planes[5]) };
+
+		size_t visibleCount = 0;
+		size_t i = 0;
+
+		// same operation order as IntersectsBox so the batched and scalar tests agree exactly
+#if defined(__AVX__)
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128 lo[BoxLaneCount];
+			__m128 hi[BoxLaneCount];
+			LoadBoxes(boxes + i, lo);
+			LoadBoxes(boxes + i + 4, hi);
+
+			__m256 lanes[BoxLaneCount];
+			for (size_t k = 0; k < BoxLaneCount; ++k)
+			{
+				lanes[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(lo[k]), hi[k], 1);
+			}
+
+			__m256 outside = _mm256_setzero_ps();
+			for (const FBoxPlane& plane : planes)
+			{
+				__m256 d = _mm256_mul_ps(_mm256_set1_ps(plane.Normal[0]), lanes[plane.Lanes[0]]);
+				d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(plane.Normal[1]), lanes[plane.Lanes[1]]));
+				d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(plane.Normal[2]), lanes[plane.Lanes[2]]));
+				d = _mm256_add_ps(d, _mm256_set1_ps(plane.Distance));
+				outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_LT_OQ));
+			}
+
+			StoreVisible(_mm256_movemask_ps(outside), 8, visible + i, visibleCount);
+		}
+#endif
+
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 lanes[BoxLaneCount];
+			LoadBoxes(boxes + i, lanes);
+
+			__m128 outside = _mm_setzero_ps();
+			for (const FBoxPlane& plane : planes)
+			{
+				__m128 d = _mm_mul_ps(_mm_set1_ps(plane.Normal[0]), lanes[plane.Lanes[0]]);
+				d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(plane.Normal[1]), lanes[plane.Lanes[1]]));
+				d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(plane.Normal[2]), lanes[plane.Lanes[2]]));
+				d = _mm_add_ps(d, _mm_set1_ps(plane.Distance));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(d, _mm_setzero_ps()));
+			}
+
+			StoreVisible(_mm_movemask_ps(outside), 4, visible + i, visibleCount);
+		}
+
+		for (; i < count; ++i)
+		{
+			visible[i] = IntersectsBox(boxes[i]) ? 1 : 0;
+			visibleCount += visible[i];
+		}
+
+		return visibleCount;
+	}
+
+	size_t FFrustum::IntersectsSpheres(const FVector3f* centers, const Scalar* radii, size_t count, uint8_t* visible) const
+	{
+		size_t visibleCount = 0;
+		size_t i = 0;
+
+#if defined(__AVX__)
+		for (; i + 8 <= count; i += 8)
+		{
+			const FVector3f* c = centers + i;
+			const __m256 x = _mm256_setr_ps(c[0].x, c[1].x, c[2].x, c[3].x, c[4].x, c[5].x, c[6].x, c[7].x);
+			const __m256 y = _mm256_setr_ps(c[0].y, c[1].y, c[2].y, c[3].y, c[4].y, c[5].y, c[6].y, c[7].y);
+			const __m256 z = _mm256_setr_ps(c[0].z, c[1].z, c[2].z, c[3].z, c[4].z, c[5].z, c[6].z, c[7].z);
+			const __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radii + i));
+
+			__m256 outside = _mm256_setzero_ps();
+			for (const FVector4f& plane : Planes)
+			{
+				__m256 d = _mm256_mul_ps(_mm256_set1_ps(plane.x), x);
+				d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(plane.y), y));
+				d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(plane.z), z));
+				d = _mm256_add_ps(d, _mm256_set1_ps(plane.w));
+				outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, negRadius, _CMP_LT_OQ));
+			}
+
+			StoreVisible(_mm256_movemask_ps(outside), 8, visible + i, visibleCount);
+		}
+#endif
+
+		for (; i + 4 <= count; i += 4)
+		{
+			const FVector3f* c = centers + i;
+			const __m128 x = _mm_setr_ps(c[0].x, c[1].x, c[2].x, c[3].x);
+			const __m128 y = _mm_setr_ps(c[0].y, c[1].y, c[2].y, c[3].y);
+			const __m128 z = _mm_setr_ps(c[0].z, c[1].z, c[2].z, c[3].z);
+			const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radii + i));
+
+			__m128 outside = _mm_setzero_ps();
+			for (const FVector4f& plane : Planes)
+			{
+				__m128 d = _mm_mul_ps(_mm_set1_ps(plane.x), x);
+				d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(plane.y), y));
+				d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(plane.z), z));
+				d = _mm_add_ps(d, _mm_set1_ps(plane.w));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(d, negRadius));
+			}
+
+			StoreVisible(_mm_movemask_ps(outside), 4, visible + i, visibleCount);
+		}
+
+		for (; i < count; ++i)
+		{
+			visible[i] = IntersectsSphere(centers[i], radii[i]) ? 1 : 0;
+			visibleCount += visible[i];
+		}
+
+		return visibleCount;
+	}
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "MathType.h"
+
+namespace Dash
+{
+	/**
+	 * View frustum as six planes with normals pointing inside, a point p is inside a plane when
+	 * dot(plane.xyz, p) + plane.w >= 0. Built from a row-vector view projection matrix with depth in [0, 1].
+	 */
+	struct FFrustum
+	{
+		enum EPlane
+		{
+			Left,
+			Right,
+			Bottom,
+			Top,
+			Near,
+			Far,
+			PlaneCount
+		};
+
+		FVector4f Planes[PlaneCount];
+
+		FFrustum() = default;
+
+		explicit FFrustum(const FMatrix4x4& viewProjection)
+		{
+			const FVector4f c0 = FMath::Column(viewProjection, 0);
+			const FVector4f c1 = FMath::Column(viewProjection, 1);
+			const FVector4f c2 = FMath::Column(viewProjection, 2);
+			const FVector4f c3 = FMath::Column(viewProjection, 3);
+
+			Planes[Left] = c3 + c0;
+			Planes[Right] = c3 - c0;
+			Planes[Bottom] = c3 + c1;
+			Planes[Top] = c3 - c1;
+			Planes[Near] = c2;
+			Planes[Far] = c3 - c2;
+
+			for (FVector4f& plane : Planes)
+			{
+				const Scalar invLength = Scalar{ 1 } / FMath::Sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+				plane = plane * invLength;
+			}
+		}
+
+		FORCEINLINE Scalar GetSignedDistance(EPlane plane, const FVector3f& p) const
+		{
+			const FVector4f& n = Planes[plane];
+			return n.x * p.x + n.y * p.y + n.z * p.z + n.w;
+		}
+
+		/** Conservative: true unless the sphere is fully outside one plane. */
+		bool IntersectsSphere(const FVector3f& center, Scalar radius) const
+		{
+			for (size_t i = 0; i < PlaneCount; ++i)
+			{
+				if (GetSignedDistance(static_cast<EPlane>(i), center) < -radius)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/** Conservative: true unless the box is fully outside one plane. */
+		bool IntersectsBox(const FBoundingBox& box) const
+		{
+			for (const FVector4f& plane : Planes)
+			{
+				// the box corner furthest along the plane normal
+				const FVector3f p{ plane.x >= 0 ? box.Upper.x : box.Lower.x,
+					plane.y >= 0 ? box.Upper.y : box.Lower.y,
+					plane.z >= 0 ? box.Upper.z : box.Lower.z };
+
+				if (plane.x * p.x + plane.y * p.y + plane.z * p.z + plane.w < 0)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/**
+		 * Batched IntersectsBox, planes against four boxes per SSE step or eight with AVX. visible[i] receives 1 when box i
+		 * intersects the frustum and 0 otherwise, returns the number of visible boxes.
+		 */
+		size_t IntersectsBoxes(const FBoundingBox* boxes, size_t count, uint8_t* visible) const;
+
+		/** Batched IntersectsSphere with the same layout as IntersectsBoxes. */
+		size_t IntersectsSpheres(const FVector3f* centers, const Scalar* radii, size_t count, uint8_t* visible) const;
+	};
+}
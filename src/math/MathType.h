@@ -3,6 +3,7 @@
 #include "ScalarArray.h"
 #include "ScalarMatrix.h"
 #include "Color.h"
+#include "Float16.h"
 #include "Quaternion.h"
 #include "Interval.h"
 #include "AABB.h"
@@ -59,6 +60,12 @@ namespace Dash
 		return EDASH_FORMAT::R32_FLOAT;
 	}
 
+	template<>
+	FORCEINLINE EDASH_FORMAT GetFormatForType<FFloat16>()
+	{
+		return EDASH_FORMAT::R16_FLOAT;
+	}
+
 	template<>
 	FORCEINLINE EDASH_FORMAT GetFormatForType<unsigned short>()
 	{
@@ -100,4 +107,10 @@ namespace Dash
 	{
 		return EDASH_FORMAT::R32G32B32A32_FLOAT;
 	}
+
+	template<>
+	FORCEINLINE EDASH_FORMAT GetFormatForType<FFloat16Color>()
+	{
+		return EDASH_FORMAT::R16G16B16A16_FLOAT;
+	}
 }
\ No newline at end of file
@@ -232,7 +232,7 @@ namespace Dash {
 		template<typename Scalar>
 		FORCEINLINE constexpr Scalar Sign(Scalar x) noexcept
 		{
-			return IsPositive(x) ? Scalar{ 1 } : IsZero(x) ? Scalar{} : Scalar{ -1 };
+			return IsPositive(x) ? Scalar{ 1 } : IsZero(x) ? Scalar{} : Scalar{ -1 };
 		}
 
 		template<typename Scalar>
@@ -0,0 +1,179 @@
+#include "AccelerationStructure.h"
+#include "../math/Intersection.h"
+#include "../utility/ParallelFor.h"
+#include <algorithm>
+
+namespace Dash
+{
+	namespace
+	{
+		/** Instance leaves transform the ray, so the top level favours smaller leaves than the triangle BVHs. */
+		FBVHSettings GetTopLevelSettings(FBVHSettings settings)
+		{
+			settings.MaxLeafSize = std::min<uint32_t>(settings.MaxLeafSize, 2);
+			return settings;
+		}
+
+		template<typename T>
+		FORCEINLINE T Interpolate(const TriangleMesh& mesh, const FVertexAttributeHandle& handle, const uint32_t* corners, Scalar u, Scalar v)
+		{
+			T a, b, c;
+			mesh.GetVertexProperty(handle, corners[0], a);
+			mesh.GetVertexProperty(handle, corners[1], b);
+			mesh.GetVertexProperty(handle, corners[2], c);
+			return (Scalar{ 1 } - u - v) * a + u * b + v * c;
+		}
+	}
+
+	FBottomLevelAS::FBottomLevelAS(std::shared_ptr<const TriangleMesh> mesh, const FBVHSettings& settings)
+		: mMesh(std::move(mesh))
+		, mBVH(settings)
+	{
+		const FVertexAttributeHandle positionHandle = mMesh->FindVertexAttribute(VertexAttribute::Position::Name);
+		ASSERT(positionHandle.IsValid());
+
+		mNormalHandle = mMesh->FindVertexAttribute(VertexAttribute::Normal::Name);
+		mTangentHandle = mMesh->FindVertexAttribute(VertexAttribute::Tangent::Name);
+		mTexCoordHandle = mMesh->FindVertexAttribute(VertexAttribute::TexCoord::Name);
+
+		mMesh->ReadAbsoluteIndices(mIndices);
+		ASSERT(mIndices.size() % 3 == 0);
+
+		const TStridedSpan<const FVector3f> positions = mMesh->GetVertexAttribute<FVector3f>(positionHandle);
+		mCorners.resize(mIndices.size());
+
+		const size_t triangleCount = GetTriangleCount();
+		std::vector<FBoundingBox> triangleBounds(triangleCount);
+		for (size_t i = 0; i < triangleCount; ++i)
+		{
+			FVector3f* corners = &mCorners[i * 3];
+			corners[0] = positions[mIndices[i * 3]];
+			corners[1] = positions[mIndices[i * 3 + 1]];
+			corners[2] = positions[mIndices[i * 3 + 2]];
+			triangleBounds[i] = FMath::Union(FMath::Union(FBoundingBox(corners[0]), corners[1]), corners[2]);
+		}
+
+		mBVH.Build(triangleBounds.data(), triangleCount);
+	}
+
+	bool FBottomLevelAS::Intersect(FRay& ray, uint32_t& triangle, Scalar& u, Scalar& v) const
+	{
+		Scalar closest = ray.TMax;
+		const bool hit = mBVH.Intersect(ray, [&](uint32_t primitive, FRay& r)
+		{
+			const FVector3f* corners = &mCorners[primitive * 3];
+
+			Scalar uu, vv, t;
+			if (!FMath::RayTriangleIntersection(r, corners[0], corners[1], corners[2], uu, vv, t) || uu + vv > Scalar{ 1 } || t < r.TMin || t > r.TMax)
+			{
+				return false;
+			}
+
+			triangle = primitive;
+			u = uu;
+			v = vv;
+			r.TMax = t;
+			closest = t;
+			return true;
+		});
+
+		ray.TMax = closest;
+		return hit;
+	}
+
+	HitInfo FBottomLevelAS::GetHitInfo(uint32_t triangle, Scalar u, Scalar v) const
+	{
+		const FVector3f* corners = &mCorners[triangle * 3];
+		const uint32_t* indices = &mIndices[triangle * 3];
+
+		HitInfo hitInfo;
+		hitInfo.Position = (Scalar{ 1 } - u - v) * corners[0] + u * corners[1] + v * corners[2];
+		hitInfo.Normal = mNormalHandle.IsValid() ? FMath::Normalize(Interpolate<FVector3f>(*mMesh, mNormalHandle, indices, u, v))
+			: FMath::Normalize(FMath::Cross(corners[1] - corners[0], corners[2] - corners[0]));
+		hitInfo.Tangent = mTangentHandle.IsValid() ? FMath::Normalize(Interpolate<FVector3f>(*mMesh, mTangentHandle, indices, u, v))
+			: FMath::Normalize(corners[1] - corners[0]);
+		hitInfo.TexCoord = mTexCoordHandle.IsValid() ? Interpolate<FVector2f>(*mMesh, mTexCoordHandle, indices, u, v) : FVector2f{ u, v };
+		return hitInfo;
+	}
+
+	FTopLevelAS::FTopLevelAS(const FBVHSettings& settings)
+		: mBVH(GetTopLevelSettings(settings))
+	{
+	}
+
+	uint32_t FTopLevelAS::AddMesh(std::shared_ptr<const TriangleMesh> mesh, const FBVHSettings& settings)
+	{
+		mMeshes.emplace_back(std::move(mesh), settings);
+		return static_cast<uint32_t>(mMeshes.size() - 1);
+	}
+
+	uint32_t FTopLevelAS::AddInstance(uint32_t mesh, const FTransform& objectToWorld)
+	{
+		ASSERT(mesh < mMeshes.size());
+
+		mInstances.push_back(FInstance{ mesh });
+		const uint32_t instance = static_cast<uint32_t>(mInstances.size() - 1);
+		SetInstanceTransform(instance, objectToWorld);
+		return instance;
+	}
+
+	void FTopLevelAS::SetInstanceTransform(uint32_t instance, const FTransform& objectToWorld)
+	{
+		// both transforms are stored with their matrices up to date, so traversal never writes to them
+		FInstance& entry = mInstances[instance];
+		entry.ObjectToWorld = FTransform{ objectToWorld.GetMatrix(), objectToWorld.GetInverseMatrix() };
+		entry.WorldToObject = FMath::Inverse(entry.ObjectToWorld);
+	}
+
+	void FTopLevelAS::Build()
+	{
+		mInstanceBounds.resize(mInstances.size());
+		ParallelFor(0, mInstances.size(), [&](size_t i)
+		{
+			const FInstance& instance = mInstances[i];
+			mInstanceBounds[i] = instance.ObjectToWorld.TransformBoundingBox(mMeshes[instance.Mesh].GetBounds());
+		}, 256);
+
+		mBVH.Build(mInstanceBounds.data(), mInstanceBounds.size());
+	}
+
+	bool FTopLevelAS::Intersect(const FRay& r, FInstanceHit& hit) const
+	{
+		return mBVH.Intersect(r, [&](uint32_t primitive, FRay& ray)
+		{
+			const FInstance& instance = mInstances[primitive];
+
+			// TransformRay renormalizes the direction, distances scale by the length of the transformed direction
+			FRay objectRay = instance.WorldToObject.TransformRay(ray);
+			const Scalar scale = FMath::Length(instance.WorldToObject.TransformVector(ray.Direction));
+			objectRay.TMin = ray.TMin * scale;
+			objectRay.TMax = ray.TMax * scale;
+
+			uint32_t triangle;
+			Scalar u, v;
+			if (!mMeshes[instance.Mesh].Intersect(objectRay, triangle, u, v))
+			{
+				return false;
+			}
+
+			hit.Instance = primitive;
+			hit.Triangle = triangle;
+			hit.T = objectRay.TMax / scale;
+			hit.U = u;
+			hit.V = v;
+			ray.TMax = hit.T;
+			return true;
+		});
+	}
+
+	HitInfo FTopLevelAS::GetHitInfo(const FInstanceHit& hit) const
+	{
+		const FInstance& instance = mInstances[hit.Instance];
+
+		HitInfo hitInfo = mMeshes[instance.Mesh].GetHitInfo(hit.Triangle, hit.U, hit.V);
+		hitInfo.Position = instance.ObjectToWorld.TransformPoint(hitInfo.Position);
+		hitInfo.Normal = FMath::Normalize(instance.ObjectToWorld.TransformNormal(hitInfo.Normal));
+		hitInfo.Tangent = FMath::Normalize(instance.ObjectToWorld.TransformVector(hitInfo.Tangent));
+		return hitInfo;
+	}
+}
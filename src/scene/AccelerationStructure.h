@@ -0,0 +1,117 @@
+#pragma once
+
+#include "BVH.h"
+#include "../math/Transform.h"
+#include "../shapes/Shape.h"
+
+#include <memory>
+#include <vector>
+
+namespace Dash
+{
+	/**
+	 * Bottom level: a BVH over the triangles of one TriangleMesh in object space, built once and shared by every
+	 * instance of the mesh. Triangle corners are copied into a flat array so leaves don't go through the index and
+	 * strided vertex buffers.
+	 */
+	class FBottomLevelAS
+	{
+	public:
+		/** All mesh parts, indices offset by each part's VertexStart. */
+		explicit FBottomLevelAS(std::shared_ptr<const TriangleMesh> mesh, const FBVHSettings& settings = FBVHSettings());
+
+		const std::shared_ptr<const TriangleMesh>& GetMesh() const { return mMesh; }
+		const FBVH& GetBVH() const { return mBVH; }
+
+		size_t GetTriangleCount() const { return mIndices.size() / 3; }
+		FBoundingBox GetBounds() const { return mBVH.GetBounds(); }
+
+		/**
+		 * Closest hit of an object space ray in [TMin, TMax], lowers ray.TMax to it. u and v weight the second and
+		 * third corner of the triangle.
+		 */
+		bool Intersect(FRay& ray, uint32_t& triangle, Scalar& u, Scalar& v) const;
+
+		/** Object space hit point, the normal, tangent and texcoord are interpolated when the mesh has them. */
+		HitInfo GetHitInfo(uint32_t triangle, Scalar u, Scalar v) const;
+
+	private:
+		std::shared_ptr<const TriangleMesh> mMesh;
+
+		std::vector<uint32_t> mIndices;
+		std::vector<FVector3f> mCorners;
+
+		FVertexAttributeHandle mNormalHandle;
+		FVertexAttributeHandle mTangentHandle;
+		FVertexAttributeHandle mTexCoordHandle;
+
+		FBVH mBVH;
+	};
+
+	struct FInstanceHit
+	{
+		uint32_t Instance;
+		uint32_t Triangle;
+
+		/** World space distance along the ray. */
+		Scalar T;
+
+		/** Barycentrics of the second and third corner. */
+		Scalar U;
+		Scalar V;
+	};
+
+	/**
+	 * Top level: instances place a bottom level structure in the world with an FTransform, Build rebuilds the BVH over
+	 * their world bounds, which is cheap enough to do every frame for thousands of instances. Rays stay in world space
+	 * while traversing the top level and are moved to object space with FTransform::TransformRay at instance leaves.
+	 *
+	 * Meshes are built once when added, so memory and build time grow with the unique meshes, not the instances.
+	 * Intersect may run from several threads, instances and meshes must not change while it does.
+	 */
+	class FTopLevelAS
+	{
+	public:
+		explicit FTopLevelAS(const FBVHSettings& settings = FBVHSettings());
+
+		/** Builds the bottom level structure of the mesh and returns its index. */
+		uint32_t AddMesh(std::shared_ptr<const TriangleMesh> mesh, const FBVHSettings& settings = FBVHSettings());
+
+		uint32_t AddInstance(uint32_t mesh, const FTransform& objectToWorld);
+
+		/** Takes effect on the next Build. */
+		void SetInstanceTransform(uint32_t instance, const FTransform& objectToWorld);
+
+		/** Refreshes the world bounds of all instances in parallel and rebuilds the top level BVH. */
+		void Build();
+
+		/** Closest hit over all instances in [r.TMin, r.TMax]. */
+		bool Intersect(const FRay& r, FInstanceHit& hit) const;
+
+		/** World space hit info. */
+		HitInfo GetHitInfo(const FInstanceHit& hit) const;
+
+		size_t GetMeshCount() const { return mMeshes.size(); }
+		const FBottomLevelAS& GetMesh(uint32_t mesh) const { return mMeshes[mesh]; }
+
+		size_t GetInstanceCount() const { return mInstances.size(); }
+		uint32_t GetInstanceMesh(uint32_t instance) const { return mInstances[instance].Mesh; }
+		const FTransform& GetInstanceTransform(uint32_t instance) const { return mInstances[instance].ObjectToWorld; }
+
+		const FBVH& GetBVH() const { return mBVH; }
+
+	private:
+		struct FInstance
+		{
+			uint32_t Mesh;
+			FTransform ObjectToWorld = {};
+			FTransform WorldToObject = {};
+		};
+
+		std::vector<FBottomLevelAS> mMeshes;
+		std::vector<FInstance> mInstances;
+		std::vector<FBoundingBox> mInstanceBounds;
+
+		FBVH mBVH;
+	};
+}
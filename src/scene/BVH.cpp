@@ -0,0 +1,823 @@
+#include "BVH.h"
+#include "../utility/HighResolutionTimer.h"
+#include "../utility/ParallelFor.h"
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+namespace Dash
+{
+	namespace
+	{
+		constexpr uint32_t MaxBinCount = 64;
+
+		/** Below this depth splits are binned, deeper ones halve the range so the tree stays within FBVH::MaxDepth. */
+		constexpr uint32_t MedianSplitDepth = FBVH::MaxDepth / 2;
+
+		/** Refit splits the tree into about this many subtrees, each with at least MinSubtreeSize primitives. */
+		constexpr uint32_t SubtreeCount = 256;
+		constexpr uint32_t MinSubtreeSize = 256;
+
+		/** Build splits the top levels until there are about this many ranges per thread, then builds the ranges as tasks. */
+		constexpr uint32_t BuildTasksPerThread = 8;
+		constexpr uint32_t MinBuildTaskSize = 1024;
+
+		/** Primitives per work item while the top levels are split, all nodes of a level are processed together. */
+		constexpr uint32_t BuildChunkSize = 8192;
+
+		struct FBin
+		{
+			FBoundingBox Bounds;
+			uint32_t Count = 0;
+		};
+
+		struct FBinGrid
+		{
+			FBin Bins[3][MaxBinCount];
+		};
+
+		struct FSplit
+		{
+			int Axis = -1;
+			uint32_t Bin = 0;
+
+			/** Sum of child half areas times their primitive counts. */
+			Scalar Cost = TScalarTraits<Scalar>::Max();
+		};
+
+		FORCEINLINE Scalar HalfArea(const FBoundingBox& b)
+		{
+			const FVector3f d = b.Upper - b.Lower;
+			return d.x * d.y + d.y * d.z + d.z * d.x;
+		}
+
+		FORCEINLINE FVector3f GetCentroid(const FBoundingBox& b)
+		{
+			return (b.Lower + b.Upper) * Scalar{ 0.5 };
+		}
+
+		FORCEINLINE int GetLargestAxis(const FVector3f& extent)
+		{
+			return extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+		}
+
+		FORCEINLINE void GetBinScales(const FVector3f& extent, uint32_t binCount, Scalar* scales)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				scales[axis] = extent[axis] > 0 ? binCount / extent[axis] : 0;
+			}
+		}
+
+		FORCEINLINE uint32_t GetBin(Scalar centroid, Scalar lower, Scalar scale, uint32_t binCount)
+		{
+			return std::min(static_cast<uint32_t>((centroid - lower) * scale), binCount - 1);
+		}
+
+		/** Bounds of the primitives and of their centroids. */
+		void GetRangeBounds(const uint32_t* indices, size_t count, const FBoundingBox* primitiveBounds, const FVector3f* centroids,
+			FBoundingBox& bounds, FBoundingBox& centroidBounds)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				bounds = FMath::Union(bounds, primitiveBounds[indices[i]]);
+				centroidBounds = FMath::Union(centroidBounds, centroids[indices[i]]);
+			}
+		}
+
+		/** All three axes binned in one pass over the primitives. */
+		void BinPrimitives(const uint32_t* indices, size_t count, const FBoundingBox* primitiveBounds, const FVector3f* centroids,
+			const FVector3f& lower, const Scalar* scales, uint32_t binCount, FBinGrid& grid)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				const FBoundingBox& b = primitiveBounds[indices[i]];
+				const FVector3f& centroid = centroids[indices[i]];
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					FBin& bin = grid.Bins[axis][GetBin(centroid[axis], lower[axis], scales[axis], binCount)];
+					bin.Bounds = FMath::Union(bin.Bounds, b);
+					++bin.Count;
+				}
+			}
+		}
+
+		void MergeBins(FBinGrid& dest, const FBinGrid& src, uint32_t binCount)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				for (uint32_t bin = 0; bin < binCount; ++bin)
+				{
+					dest.Bins[axis][bin].Bounds = FMath::Union(dest.Bins[axis][bin].Bounds, src.Bins[axis][bin].Bounds);
+					dest.Bins[axis][bin].Count += src.Bins[axis][bin].Count;
+				}
+			}
+		}
+
+		/** Cheapest plane between two bins, Axis stays -1 when every plane leaves one side empty. */
+		FSplit FindBestSplit(const FBinGrid& grid, uint32_t binCount, uint32_t count, const FVector3f& extent)
+		{
+			FSplit best;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				if (extent[axis] <= 0)
+				{
+					continue;
+				}
+
+				const FBin* bins = grid.Bins[axis];
+
+				// right to left sweep stores the cost terms of the right side of every plane
+				Scalar rightCosts[MaxBinCount];
+				FBoundingBox rightBounds;
+				uint32_t rightCount = 0;
+				for (uint32_t bin = binCount - 1; bin > 0; --bin)
+				{
+					rightBounds = FMath::Union(rightBounds, bins[bin].Bounds);
+					rightCount += bins[bin].Count;
+					rightCosts[bin] = rightCount > 0 ? HalfArea(rightBounds) * rightCount : 0;
+				}
+
+				FBoundingBox leftBounds;
+				uint32_t leftCount = 0;
+				for (uint32_t bin = 1; bin < binCount; ++bin)
+				{
+					leftBounds = FMath::Union(leftBounds, bins[bin - 1].Bounds);
+					leftCount += bins[bin - 1].Count;
+					if (leftCount == 0 || leftCount == count)
+					{
+						continue;
+					}
+
+					const Scalar cost = HalfArea(leftBounds) * leftCount + rightCosts[bin];
+					if (cost < best.Cost)
+					{
+						best.Axis = axis;
+						best.Bin = bin;
+						best.Cost = cost;
+					}
+				}
+			}
+
+			return best;
+		}
+	}
+
+	FBVH::FBVH(const FBVHSettings& settings)
+		: mSettings(settings)
+	{
+		mSettings.MaxLeafSize = std::max<uint32_t>(mSettings.MaxLeafSize, 1);
+		mSettings.BinCount = std::clamp<uint32_t>(mSettings.BinCount, 2, MaxBinCount);
+	}
+
+	FBVHUpdateStats FBVH::Build(const FBoundingBox* primitiveBounds, size_t primitiveCount)
+	{
+		FHighResolutionTimer timer;
+		FBVHUpdateStats stats;
+
+		mNodes.clear();
+		mSubtrees.clear();
+		mTopNodes.clear();
+		mPrimitiveIndices.resize(primitiveCount);
+		std::iota(mPrimitiveIndices.begin(), mPrimitiveIndices.end(), 0u);
+
+		mSAHCost = 0;
+		mBuildSAHCost = 0;
+		if (primitiveCount == 0)
+		{
+			return stats;
+		}
+
+		mPrimitiveBounds = primitiveBounds;
+		UpdateCentroids();
+
+		const size_t hardwareThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		const uint32_t taskSize = std::max(static_cast<uint32_t>(primitiveCount / (hardwareThreads * BuildTasksPerThread)), MinBuildTaskSize);
+
+		std::vector<FBuildNode> topNodes;
+		std::vector<FBuildTask> tasks;
+		SplitTopLevels(static_cast<uint32_t>(primitiveCount), taskSize, topNodes, tasks);
+
+		ParallelFor(0, tasks.size(), [&](size_t i)
+		{
+			FBuildTask& task = tasks[i];
+			task.Nodes.reserve((task.End - task.Begin) * 2);
+			BuildNode(task.Begin, task.End, task.Depth, task.Nodes);
+		});
+
+		mNodes.reserve(primitiveCount * 2);
+		AppendBuildNode(topNodes, 0, tasks);
+
+		CreateSubtrees();
+
+		ParallelFor(0, mSubtrees.size(), [&](size_t i)
+		{
+			FSubtree& subtree = mSubtrees[i];
+			const Scalar area = HalfArea(mNodes[subtree.NodeBegin].Bounds);
+			const Scalar cost = GetRangeCost(mNodes.data() + subtree.NodeBegin, subtree.NodeEnd - subtree.NodeBegin);
+			subtree.Cost = area > 0 ? cost / area : 0;
+			subtree.BuildCost = subtree.Cost;
+		});
+
+		Scalar topCost = 0;
+		for (uint32_t node : mTopNodes)
+		{
+			topCost += GetNodeCost(mNodes[node]);
+		}
+
+		UpdateSAHCost(topCost);
+		mBuildSAHCost = mSAHCost;
+		mPrimitiveBounds = nullptr;
+		mCentroids.clear();
+
+		timer.Update();
+		stats.Seconds = timer.ElapsedSeconds();
+		stats.SAHCost = mSAHCost;
+		stats.RebuiltSubtrees = 1;
+		stats.RebuiltPrimitives = primitiveCount;
+		stats.FullRebuild = true;
+		return stats;
+	}
+
+	FBVHUpdateStats FBVH::Refit(const FBoundingBox* primitiveBounds, bool allowRebuild)
+	{
+		FHighResolutionTimer timer;
+		FBVHUpdateStats stats;
+		if (mNodes.empty())
+		{
+			return stats;
+		}
+
+		mPrimitiveBounds = primitiveBounds;
+
+		ParallelFor(0, mSubtrees.size(), [&](size_t i)
+		{
+			FSubtree& subtree = mSubtrees[i];
+			const Scalar cost = RefitRange(subtree.NodeBegin, subtree.NodeEnd);
+			const Scalar area = HalfArea(mNodes[subtree.NodeBegin].Bounds);
+			subtree.Cost = area > 0 ? cost / area : 0;
+		});
+
+		// depth first, so walking backwards refits children before their parents
+		Scalar topCost = 0;
+		for (size_t i = mTopNodes.size(); i-- > 0;)
+		{
+			topCost += RefitRange(mTopNodes[i], mTopNodes[i] + 1);
+		}
+
+		UpdateSAHCost(topCost);
+
+		if (allowRebuild && mSAHCost > mBuildSAHCost * mSettings.FullRebuildRatio)
+		{
+			stats = Build(primitiveBounds, mPrimitiveIndices.size());
+		}
+		else if (allowRebuild)
+		{
+			std::vector<size_t> degraded;
+			for (size_t i = 0; i < mSubtrees.size(); ++i)
+			{
+				const FSubtree& subtree = mSubtrees[i];
+				if (subtree.PrimitiveEnd - subtree.PrimitiveBegin > mSettings.MaxLeafSize && subtree.Cost > subtree.BuildCost * mSettings.SubtreeRebuildRatio)
+				{
+					degraded.push_back(i);
+					stats.RebuiltPrimitives += subtree.PrimitiveEnd - subtree.PrimitiveBegin;
+				}
+			}
+
+			if (!degraded.empty())
+			{
+				UpdateCentroids();
+				RebuildSubtrees(degraded);
+				UpdateSAHCost(topCost);
+				stats.RebuiltSubtrees = degraded.size();
+				mCentroids.clear();
+			}
+		}
+
+		mPrimitiveBounds = nullptr;
+
+		timer.Update();
+		stats.Seconds = timer.ElapsedSeconds();
+		stats.SAHCost = mSAHCost;
+		stats.CostRatio = mBuildSAHCost > 0 ? mSAHCost / mBuildSAHCost : 1;
+		return stats;
+	}
+
+	void FBVH::UpdateCentroids()
+	{
+		mCentroids.resize(mPrimitiveIndices.size());
+		ParallelFor(0, mCentroids.size(), [&](size_t i)
+		{
+			mCentroids[i] = GetCentroid(mPrimitiveBounds[i]);
+		}, BuildChunkSize);
+	}
+
+	void FBVH::SplitTopLevels(uint32_t primitiveCount, uint32_t taskSize, std::vector<FBuildNode>& nodes, std::vector<FBuildTask>& tasks)
+	{
+		struct FRange
+		{
+			uint32_t Begin;
+			uint32_t End;
+			uint32_t Depth;
+			uint32_t Node;
+
+			FBoundingBox Bounds = {};
+			FBoundingBox CentroidBounds = {};
+			FSplit Split = {};
+			uint32_t Middle = 0;
+		};
+
+		struct FChunk
+		{
+			uint32_t Range;
+			uint32_t Begin;
+			uint32_t End;
+			uint32_t LeftCount;
+		};
+
+		const uint32_t binCount = mSettings.BinCount;
+		uint32_t* indices = mPrimitiveIndices.data();
+
+		std::vector<FRange> level{ FRange{ 0, primitiveCount, 0, 0 } };
+		std::vector<FRange> nextLevel;
+		std::vector<FChunk> chunks;
+		std::vector<FBoundingBox> chunkBounds;
+		std::vector<FBoundingBox> chunkCentroidBounds;
+		std::vector<FBinGrid> chunkBins;
+		std::vector<uint32_t> scratch;
+		nodes.emplace_back();
+
+		// one level at a time, every pass runs over the chunks of all ranges of the level at once
+		while (!level.empty())
+		{
+			std::vector<FRange> splitting;
+			for (const FRange& range : level)
+			{
+				if (range.End - range.Begin <= taskSize || range.Depth >= MedianSplitDepth)
+				{
+					nodes[range.Node].Task = static_cast<uint32_t>(tasks.size());
+					tasks.push_back(FBuildTask{ range.Begin, range.End, range.Depth });
+				}
+				else
+				{
+					splitting.push_back(range);
+				}
+			}
+
+			if (splitting.empty())
+			{
+				break;
+			}
+
+			chunks.clear();
+			for (uint32_t r = 0; r < splitting.size(); ++r)
+			{
+				for (uint32_t begin = splitting[r].Begin; begin < splitting[r].End; begin += BuildChunkSize)
+				{
+					chunks.push_back(FChunk{ r, begin, std::min(begin + BuildChunkSize, splitting[r].End), 0 });
+				}
+			}
+
+			chunkBounds.assign(chunks.size(), FBoundingBox());
+			chunkCentroidBounds.assign(chunks.size(), FBoundingBox());
+			ParallelFor(0, chunks.size(), [&](size_t c)
+			{
+				const FChunk& chunk = chunks[c];
+				GetRangeBounds(indices + chunk.Begin, chunk.End - chunk.Begin, mPrimitiveBounds, mCentroids.data(), chunkBounds[c], chunkCentroidBounds[c]);
+			});
+
+			for (size_t c = 0; c < chunks.size(); ++c)
+			{
+				FRange& range = splitting[chunks[c].Range];
+				range.Bounds = FMath::Union(range.Bounds, chunkBounds[c]);
+				range.CentroidBounds = FMath::Union(range.CentroidBounds, chunkCentroidBounds[c]);
+			}
+
+			chunkBins.assign(chunks.size(), FBinGrid());
+			ParallelFor(0, chunks.size(), [&](size_t c)
+			{
+				const FChunk& chunk = chunks[c];
+				const FRange& range = splitting[chunk.Range];
+
+				Scalar scales[3];
+				GetBinScales(range.CentroidBounds.Upper - range.CentroidBounds.Lower, binCount, scales);
+				BinPrimitives(indices + chunk.Begin, chunk.End - chunk.Begin, mPrimitiveBounds, mCentroids.data(), range.CentroidBounds.Lower, scales, binCount, chunkBins[c]);
+			});
+
+			for (size_t begin = 0; begin < chunks.size();)
+			{
+				FRange& range = splitting[chunks[begin].Range];
+
+				size_t end = begin + 1;
+				while (end < chunks.size() && chunks[end].Range == chunks[begin].Range)
+				{
+					MergeBins(chunkBins[begin], chunkBins[end], binCount);
+					++end;
+				}
+
+				range.Split = FindBestSplit(chunkBins[begin], binCount, range.End - range.Begin, range.CentroidBounds.Upper - range.CentroidBounds.Lower);
+				begin = end;
+			}
+
+			// count the left side of every chunk, then scatter both sides to their offsets within the range
+			ParallelFor(0, chunks.size(), [&](size_t c)
+			{
+				FChunk& chunk = chunks[c];
+				const FRange& range = splitting[chunk.Range];
+				if (range.Split.Axis < 0)
+				{
+					return;
+				}
+
+				Scalar scales[3];
+				GetBinScales(range.CentroidBounds.Upper - range.CentroidBounds.Lower, binCount, scales);
+
+				const int axis = range.Split.Axis;
+				for (uint32_t i = chunk.Begin; i < chunk.End; ++i)
+				{
+					chunk.LeftCount += GetBin(mCentroids[indices[i]][axis], range.CentroidBounds.Lower[axis], scales[axis], binCount) < range.Split.Bin;
+				}
+			});
+
+			std::vector<uint32_t> leftOffsets(chunks.size());
+			std::vector<uint32_t> rightOffsets(chunks.size());
+			for (size_t begin = 0; begin < chunks.size();)
+			{
+				FRange& range = splitting[chunks[begin].Range];
+
+				uint32_t leftCount = 0;
+				size_t end = begin;
+				for (; end < chunks.size() && chunks[end].Range == chunks[begin].Range; ++end)
+				{
+					leftCount += chunks[end].LeftCount;
+				}
+
+				range.Middle = range.Begin + leftCount;
+
+				uint32_t left = range.Begin;
+				uint32_t right = range.Middle;
+				for (size_t c = begin; c < end; ++c)
+				{
+					leftOffsets[c] = left;
+					rightOffsets[c] = right;
+					left += chunks[c].LeftCount;
+					right += chunks[c].End - chunks[c].Begin - chunks[c].LeftCount;
+				}
+
+				begin = end;
+			}
+
+			scratch.resize(primitiveCount);
+			ParallelFor(0, chunks.size(), [&](size_t c)
+			{
+				const FChunk& chunk = chunks[c];
+				const FRange& range = splitting[chunk.Range];
+				if (range.Split.Axis < 0)
+				{
+					return;
+				}
+
+				Scalar scales[3];
+				GetBinScales(range.CentroidBounds.Upper - range.CentroidBounds.Lower, binCount, scales);
+
+				const int axis = range.Split.Axis;
+				uint32_t left = leftOffsets[c];
+				uint32_t right = rightOffsets[c];
+				for (uint32_t i = chunk.Begin; i < chunk.End; ++i)
+				{
+					const bool isLeft = GetBin(mCentroids[indices[i]][axis], range.CentroidBounds.Lower[axis], scales[axis], binCount) < range.Split.Bin;
+					scratch[isLeft ? left++ : right++] = indices[i];
+				}
+			});
+
+			ParallelFor(0, chunks.size(), [&](size_t c)
+			{
+				const FChunk& chunk = chunks[c];
+				if (splitting[chunk.Range].Split.Axis >= 0)
+				{
+					std::copy(scratch.begin() + chunk.Begin, scratch.begin() + chunk.End, indices + chunk.Begin);
+				}
+			});
+
+			nextLevel.clear();
+			for (FRange& range : splitting)
+			{
+				if (range.Split.Axis < 0)
+				{
+					// no binned plane separates the centroids, halve the range along the largest centroid extent
+					const int axis = GetLargestAxis(range.CentroidBounds.Upper - range.CentroidBounds.Lower);
+					range.Middle = range.Begin + (range.End - range.Begin) / 2;
+					std::nth_element(indices + range.Begin, indices + range.Middle, indices + range.End, [&](uint32_t a, uint32_t b)
+					{
+						return mCentroids[a][axis] < mCentroids[b][axis];
+					});
+				}
+
+				const uint32_t first = static_cast<uint32_t>(nodes.size());
+				nodes.emplace_back();
+				nodes.emplace_back();
+
+				nodes[range.Node].Bounds = range.Bounds;
+				nodes[range.Node].Children[0] = first;
+				nodes[range.Node].Children[1] = first + 1;
+
+				nextLevel.push_back(FRange{ range.Begin, range.Middle, range.Depth + 1, first });
+				nextLevel.push_back(FRange{ range.Middle, range.End, range.Depth + 1, first + 1 });
+			}
+
+			std::swap(level, nextLevel);
+		}
+	}
+
+	void FBVH::AppendBuildNode(const std::vector<FBuildNode>& nodes, uint32_t node, const std::vector<FBuildTask>& tasks)
+	{
+		const FBuildNode& buildNode = nodes[node];
+		if (buildNode.Task != FBuildNode::InvalidTask)
+		{
+			const uint32_t base = static_cast<uint32_t>(mNodes.size());
+			for (FBVHNode taskNode : tasks[buildNode.Task].Nodes)
+			{
+				taskNode.Offset += taskNode.IsLeaf() ? 0 : base;
+				mNodes.push_back(taskNode);
+			}
+			return;
+		}
+
+		const size_t index = mNodes.size();
+		mNodes.emplace_back();
+
+		AppendBuildNode(nodes, buildNode.Children[0], tasks);
+		const uint32_t second = static_cast<uint32_t>(mNodes.size());
+		AppendBuildNode(nodes, buildNode.Children[1], tasks);
+
+		mNodes[index] = FBVHNode{ buildNode.Bounds, second, 0 };
+	}
+
+	void FBVH::BuildNode(uint32_t begin, uint32_t end, uint32_t depth, std::vector<FBVHNode>& nodes)
+	{
+		const size_t index = nodes.size();
+		nodes.emplace_back();
+
+		FBoundingBox bounds;
+		FBoundingBox centroidBounds;
+		GetRangeBounds(mPrimitiveIndices.data() + begin, end - begin, mPrimitiveBounds, mCentroids.data(), bounds, centroidBounds);
+
+		const uint32_t split = end - begin > 1 ? PartitionPrimitives(begin, end, depth, bounds, centroidBounds) : begin;
+		if (split == begin)
+		{
+			nodes[index] = FBVHNode{ bounds, begin, end - begin };
+			return;
+		}
+
+		BuildNode(begin, split, depth + 1, nodes);
+		const uint32_t second = static_cast<uint32_t>(nodes.size());
+		BuildNode(split, end, depth + 1, nodes);
+
+		nodes[index] = FBVHNode{ bounds, second, 0 };
+	}
+
+	uint32_t FBVH::PartitionPrimitives(uint32_t begin, uint32_t end, uint32_t depth, const FBoundingBox& bounds, const FBoundingBox& centroidBounds)
+	{
+		const uint32_t count = end - begin;
+		const FVector3f extent = centroidBounds.Upper - centroidBounds.Lower;
+
+		int largestAxis = GetLargestAxis(extent);
+
+		auto medianSplit = [&]()
+		{
+			const uint32_t middle = begin + count / 2;
+			std::nth_element(mPrimitiveIndices.begin() + begin, mPrimitiveIndices.begin() + middle, mPrimitiveIndices.begin() + end, [&](uint32_t a, uint32_t b)
+			{
+				return mCentroids[a][largestAxis] < mCentroids[b][largestAxis];
+			});
+			return middle;
+		};
+
+		if (extent[largestAxis] <= 0)
+		{
+			// all centroids coincide, any split is as good as another
+			return count <= mSettings.MaxLeafSize ? begin : begin + count / 2;
+		}
+
+		if (depth >= MedianSplitDepth)
+		{
+			return medianSplit();
+		}
+
+		const uint32_t binCount = mSettings.BinCount;
+
+		Scalar scales[3];
+		GetBinScales(extent, binCount, scales);
+
+		FBinGrid grid;
+		BinPrimitives(mPrimitiveIndices.data() + begin, count, mPrimitiveBounds, mCentroids.data(), centroidBounds.Lower, scales, binCount, grid);
+
+		const FSplit best = FindBestSplit(grid, binCount, count, extent);
+		if (best.Axis < 0)
+		{
+			return medianSplit();
+		}
+
+		const Scalar splitCost = mSettings.TraversalCost + mSettings.IntersectionCost * best.Cost / HalfArea(bounds);
+		const Scalar leafCost = mSettings.IntersectionCost * count;
+		if (count <= mSettings.MaxLeafSize && leafCost <= splitCost)
+		{
+			return begin;
+		}
+
+		const Scalar lower = centroidBounds.Lower[best.Axis];
+		const Scalar scale = scales[best.Axis];
+		const auto middle = std::partition(mPrimitiveIndices.begin() + begin, mPrimitiveIndices.begin() + end, [&](uint32_t primitive)
+		{
+			return GetBin(mCentroids[primitive][best.Axis], lower, scale, binCount) < best.Bin;
+		});
+
+		const uint32_t split = static_cast<uint32_t>(middle - mPrimitiveIndices.begin());
+		if (split == begin || split == end)
+		{
+			largestAxis = best.Axis;
+			return medianSplit();
+		}
+
+		return split;
+	}
+
+	void FBVH::CreateSubtrees()
+	{
+		mSubtrees.clear();
+		mTopNodes.clear();
+
+		const uint32_t targetSize = std::max(static_cast<uint32_t>(mPrimitiveIndices.size() / SubtreeCount), MinSubtreeSize);
+		CollectSubtrees(0, 0, targetSize);
+	}
+
+	void FBVH::CollectSubtrees(uint32_t node, uint32_t depth, uint32_t targetSize)
+	{
+		const FSubtree subtree = GetSubtree(node, depth);
+		if (mNodes[node].IsLeaf() || subtree.PrimitiveEnd - subtree.PrimitiveBegin <= targetSize)
+		{
+			mSubtrees.push_back(subtree);
+			return;
+		}
+
+		mTopNodes.push_back(node);
+		CollectSubtrees(node + 1, depth + 1, targetSize);
+		CollectSubtrees(mNodes[node].Offset, depth + 1, targetSize);
+	}
+
+	FBVH::FSubtree FBVH::GetSubtree(uint32_t node, uint32_t depth) const
+	{
+		// the leftmost and rightmost leaves bound the primitive range, the rightmost leaf is also the last node
+		uint32_t first = node;
+		while (!mNodes[first].IsLeaf())
+		{
+			++first;
+		}
+
+		uint32_t last = node;
+		while (!mNodes[last].IsLeaf())
+		{
+			last = mNodes[last].Offset;
+		}
+
+		return FSubtree{ node, last + 1, mNodes[first].Offset, mNodes[last].Offset + mNodes[last].PrimitiveCount, depth, 0, 0 };
+	}
+
+	Scalar FBVH::RefitRange(uint32_t begin, uint32_t end)
+	{
+		Scalar cost = 0;
+		for (uint32_t index = end; index-- > begin;)
+		{
+			FBVHNode& node = mNodes[index];
+			if (node.IsLeaf())
+			{
+				FBoundingBox bounds = mPrimitiveBounds[mPrimitiveIndices[node.Offset]];
+				for (uint32_t i = 1; i < node.PrimitiveCount; ++i)
+				{
+					bounds = FMath::Union(bounds, mPrimitiveBounds[mPrimitiveIndices[node.Offset + i]]);
+				}
+				node.Bounds = bounds;
+			}
+			else
+			{
+				node.Bounds = FMath::Union(mNodes[index + 1].Bounds, mNodes[node.Offset].Bounds);
+			}
+
+			cost += GetNodeCost(node);
+		}
+
+		return cost;
+	}
+
+	Scalar FBVH::GetNodeCost(const FBVHNode& node) const
+	{
+		const Scalar area = HalfArea(node.Bounds);
+		return node.IsLeaf() ? mSettings.IntersectionCost * node.PrimitiveCount * area : mSettings.TraversalCost * area;
+	}
+
+	Scalar FBVH::GetRangeCost(const FBVHNode* nodes, size_t count) const
+	{
+		Scalar cost = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			cost += GetNodeCost(nodes[i]);
+		}
+		return cost;
+	}
+
+	void FBVH::RebuildSubtrees(const std::vector<size_t>& subtrees)
+	{
+		std::vector<std::vector<FBVHNode>> rebuilt(subtrees.size());
+
+		ParallelFor(0, subtrees.size(), [&](size_t k)
+		{
+			const FSubtree& subtree = mSubtrees[subtrees[k]];
+			rebuilt[k].reserve((subtree.PrimitiveEnd - subtree.PrimitiveBegin) * 2);
+			BuildNode(subtree.PrimitiveBegin, subtree.PrimitiveEnd, subtree.Depth, rebuilt[k]);
+		});
+
+		// old index to new index: shifted by the size change of every rebuilt subtree ending before it
+		std::vector<uint32_t> oldEnds(subtrees.size());
+		std::vector<int64_t> shifts(subtrees.size());
+		int64_t shift = 0;
+		for (size_t k = 0; k < subtrees.size(); ++k)
+		{
+			const FSubtree& subtree = mSubtrees[subtrees[k]];
+			shift += static_cast<int64_t>(rebuilt[k].size()) - (subtree.NodeEnd - subtree.NodeBegin);
+			oldEnds[k] = subtree.NodeEnd;
+			shifts[k] = shift;
+		}
+
+		auto remap = [&](uint32_t index)
+		{
+			const size_t k = std::upper_bound(oldEnds.begin(), oldEnds.end(), index) - oldEnds.begin();
+			return static_cast<uint32_t>(index + (k > 0 ? shifts[k - 1] : 0));
+		};
+
+		std::vector<FBVHNode> nodes;
+		nodes.reserve(static_cast<size_t>(mNodes.size() + shift));
+
+		size_t next = 0;
+		for (uint32_t index = 0; index < mNodes.size();)
+		{
+			if (next < subtrees.size() && index == mSubtrees[subtrees[next]].NodeBegin)
+			{
+				const uint32_t base = static_cast<uint32_t>(nodes.size());
+				for (FBVHNode node : rebuilt[next])
+				{
+					node.Offset += node.IsLeaf() ? 0 : base;
+					nodes.push_back(node);
+				}
+
+				index = mSubtrees[subtrees[next]].NodeEnd;
+				++next;
+				continue;
+			}
+
+			FBVHNode node = mNodes[index];
+			if (!node.IsLeaf())
+			{
+				node.Offset = remap(node.Offset);
+			}
+			nodes.push_back(node);
+			++index;
+		}
+
+		for (FSubtree& subtree : mSubtrees)
+		{
+			const uint32_t size = subtree.NodeEnd - subtree.NodeBegin;
+			subtree.NodeBegin = remap(subtree.NodeBegin);
+			subtree.NodeEnd = subtree.NodeBegin + size;
+		}
+
+		for (uint32_t& node : mTopNodes)
+		{
+			node = remap(node);
+		}
+
+		mNodes = std::move(nodes);
+
+		for (size_t k = 0; k < subtrees.size(); ++k)
+		{
+			FSubtree& subtree = mSubtrees[subtrees[k]];
+			subtree.NodeEnd = subtree.NodeBegin + static_cast<uint32_t>(rebuilt[k].size());
+
+			const Scalar area = HalfArea(mNodes[subtree.NodeBegin].Bounds);
+			const Scalar cost = GetRangeCost(mNodes.data() + subtree.NodeBegin, rebuilt[k].size());
+			subtree.Cost = area > 0 ? cost / area : 0;
+			subtree.BuildCost = subtree.Cost;
+		}
+	}
+
+	void FBVH::UpdateSAHCost(Scalar topCost)
+	{
+		Scalar cost = topCost;
+		for (const FSubtree& subtree : mSubtrees)
+		{
+			cost += subtree.Cost * HalfArea(mNodes[subtree.NodeBegin].Bounds);
+		}
+
+		const Scalar rootArea = HalfArea(mNodes[0].Bounds);
+		mSAHCost = rootArea > 0 ? cost / rootArea : 0;
+	}
+}
@@ -0,0 +1,324 @@
+#pragma once
+
+#include "../math/MathType.h"
+
+#include <vector>
+
+namespace Dash
+{
+	/** Nodes are stored depth first, the first child of an inner node directly follows it. */
+	struct FBVHNode
+	{
+		FBoundingBox Bounds;
+
+		/** Inner nodes: index of the second child. Leaves: first entry in the primitive indices. */
+		uint32_t Offset;
+
+		/** Primitives of a leaf, 0 for inner nodes. */
+		uint32_t PrimitiveCount;
+
+		bool IsLeaf() const { return PrimitiveCount > 0; }
+	};
+
+	struct FBVHSettings
+	{
+		uint32_t MaxLeafSize = 4;
+		uint32_t BinCount = 16;
+
+		/** SAH weights of visiting an inner node and of testing one primitive. */
+		Scalar TraversalCost = 1;
+		Scalar IntersectionCost = 1;
+
+		/** A subtree is rebuilt once its SAH cost exceeds its cost after the last build by this factor. */
+		Scalar SubtreeRebuildRatio = Scalar{ 1.3 };
+
+		/** The whole tree is rebuilt once its SAH cost exceeds the cost after the last full build by this factor. */
+		Scalar FullRebuildRatio = Scalar{ 2 };
+	};
+
+	struct FBVHUpdateStats
+	{
+		double Seconds = 0;
+
+		/** SAH cost relative to a ray hitting the root box. */
+		Scalar SAHCost = 0;
+
+		/** SAHCost over the cost right after the last full build. */
+		Scalar CostRatio = 1;
+
+		size_t RebuiltSubtrees = 0;
+		size_t RebuiltPrimitives = 0;
+		bool FullRebuild = false;
+	};
+
+	/**
+	 * Binary BVH over primitive bounding boxes, built top-down with binned SAH. Primitives are referenced by index, the
+	 * caller keeps the bounds and hands in updated ones to Refit when transforms or vertices change.
+	 *
+	 * The tree is cut into subtrees of roughly equal primitive count, each a contiguous node range. Refit runs the
+	 * subtrees in parallel, children before parents by walking each range backwards, then the few nodes above the cut.
+	 * The SAH cost of every subtree is compared to its cost after it was last built, degraded subtrees are rebuilt in
+	 * parallel and spliced back, a tree that degraded as a whole is rebuilt completely.
+	 *
+	 * Build splits the top levels one level at a time, binning and partitioning chunks of all ranges of a level in
+	 * parallel, until there are a few ranges per thread. The ranges are then built as independent tasks.
+	 */
+	class FBVH
+	{
+	public:
+		/** Traversal stack size, deeper splits fall back to median splits while building. */
+		static constexpr uint32_t MaxDepth = 64;
+
+		explicit FBVH(const FBVHSettings& settings = FBVHSettings());
+
+		/** The stats report the build time and the SAH cost of the new tree. */
+		FBVHUpdateStats Build(const FBoundingBox* primitiveBounds, size_t primitiveCount);
+
+		/** primitiveBounds holds the new bounds of the primitives the tree was built with. */
+		FBVHUpdateStats Refit(const FBoundingBox* primitiveBounds, bool allowRebuild = true);
+
+		const FBVHSettings& GetSettings() const { return mSettings; }
+
+		size_t GetPrimitiveCount() const { return mPrimitiveIndices.size(); }
+		const std::vector<FBVHNode>& GetNodes() const { return mNodes; }
+		const std::vector<uint32_t>& GetPrimitiveIndices() const { return mPrimitiveIndices; }
+
+		FBoundingBox GetBounds() const { return mNodes.empty() ? FBoundingBox() : mNodes[0].Bounds; }
+
+		Scalar GetSAHCost() const { return mSAHCost; }
+		Scalar GetBuildSAHCost() const { return mBuildSAHCost; }
+
+		/**
+		 * Closest hit. intersect(uint32_t primitive, FRay& ray) returns true on a hit and lowers ray.TMax to it, nodes
+		 * are visited near child first and skipped once they start behind ray.TMax.
+		 */
+		template<typename Func>
+		bool Intersect(const FRay& r, Func&& intersect) const;
+
+		/** func(uint32_t primitive) for the primitives of every leaf overlapping the box, the caller tests the primitives. */
+		template<typename Func>
+		void QueryOverlaps(const FBoundingBox& box, Func&& func) const;
+
+		/** Entry distance of the ray into the box clamped to [TMin, TMax], or false when it misses. */
+		static bool IntersectBounds(const FBoundingBox& b, const FRay& r, const FVector3f& invDirection, Scalar& tNear);
+
+	private:
+		/** Contiguous node and primitive range of a subtree refit as one task. */
+		struct FSubtree
+		{
+			uint32_t NodeBegin;
+			uint32_t NodeEnd;
+			uint32_t PrimitiveBegin;
+			uint32_t PrimitiveEnd;
+
+			/** Depth of the subtree root, a rebuild continues from it so the tree stays within MaxDepth. */
+			uint32_t Depth;
+
+			/** SAH cost relative to the subtree root, now and when it was last built. */
+			Scalar Cost;
+			Scalar BuildCost;
+		};
+
+		/** Top of the tree while building, a node is either split further or built as a task. */
+		struct FBuildNode
+		{
+			static constexpr uint32_t InvalidTask = ~0u;
+
+			FBoundingBox Bounds;
+			uint32_t Children[2] = {};
+			uint32_t Task = InvalidTask;
+		};
+
+		struct FBuildTask
+		{
+			uint32_t Begin;
+			uint32_t End;
+			uint32_t Depth;
+			std::vector<FBVHNode> Nodes = {};
+		};
+
+		void UpdateCentroids();
+
+		/** Splits ranges larger than taskSize level by level, the remaining ranges are handed back as tasks. */
+		void SplitTopLevels(uint32_t primitiveCount, uint32_t taskSize, std::vector<FBuildNode>& nodes, std::vector<FBuildTask>& tasks);
+
+		/** Appends the node and the nodes of its tasks to mNodes depth first. */
+		void AppendBuildNode(const std::vector<FBuildNode>& nodes, uint32_t node, const std::vector<FBuildTask>& tasks);
+
+		/** Appends the subtree over primitive indices [begin, end), node offsets are relative to the first node appended. */
+		void BuildNode(uint32_t begin, uint32_t end, uint32_t depth, std::vector<FBVHNode>& nodes);
+
+		/** Split position in [begin, end) after partitioning the primitive indices, begin to make a leaf. */
+		uint32_t PartitionPrimitives(uint32_t begin, uint32_t end, uint32_t depth, const FBoundingBox& bounds, const FBoundingBox& centroidBounds);
+
+		void CreateSubtrees();
+		void CollectSubtrees(uint32_t node, uint32_t depth, uint32_t targetSize);
+		FSubtree GetSubtree(uint32_t node, uint32_t depth) const;
+
+		/** Refits nodes [begin, end) backwards and returns their SAH sum. */
+		Scalar RefitRange(uint32_t begin, uint32_t end);
+		Scalar GetNodeCost(const FBVHNode& node) const;
+		Scalar GetRangeCost(const FBVHNode* nodes, size_t count) const;
+
+		void RebuildSubtrees(const std::vector<size_t>& subtrees);
+		void UpdateSAHCost(Scalar topCost);
+
+		FBVHSettings mSettings;
+
+		std::vector<FBVHNode> mNodes;
+		std::vector<uint32_t> mPrimitiveIndices;
+
+		/** Set while building or refitting. */
+		const FBoundingBox* mPrimitiveBounds = nullptr;
+		std::vector<FVector3f> mCentroids;
+
+		std::vector<FSubtree> mSubtrees;
+
+		/** Nodes above the subtrees, depth first. */
+		std::vector<uint32_t> mTopNodes;
+
+		Scalar mSAHCost = 0;
+		Scalar mBuildSAHCost = 0;
+	};
+
+
+
+
+	// Member Function
+
+	// --Implementation-- //
+
+	FORCEINLINE bool FBVH::IntersectBounds(const FBoundingBox& b, const FRay& r, const FVector3f& invDirection, Scalar& tNear)
+	{
+		const Scalar tx0 = (b.Lower.x - r.Origin.x) * invDirection.x;
+		const Scalar tx1 = (b.Upper.x - r.Origin.x) * invDirection.x;
+		const Scalar ty0 = (b.Lower.y - r.Origin.y) * invDirection.y;
+		const Scalar ty1 = (b.Upper.y - r.Origin.y) * invDirection.y;
+		const Scalar tz0 = (b.Lower.z - r.Origin.z) * invDirection.z;
+		const Scalar tz1 = (b.Upper.z - r.Origin.z) * invDirection.z;
+
+		const Scalar tMin = FMath::Max(FMath::Max(FMath::Min(tx0, tx1), FMath::Min(ty0, ty1)), FMath::Max(FMath::Min(tz0, tz1), r.TMin));
+		const Scalar tMax = FMath::Min(FMath::Min(FMath::Max(tx0, tx1), FMath::Max(ty0, ty1)), FMath::Min(FMath::Max(tz0, tz1), r.TMax));
+
+		tNear = tMin;
+		return tMin <= tMax;
+	}
+
+	template<typename Func>
+	FORCEINLINE bool FBVH::Intersect(const FRay& r, Func&& intersect) const
+	{
+		if (mNodes.empty())
+		{
+			return false;
+		}
+
+		FRay ray = r;
+		const FVector3f invDirection{ Scalar{ 1 } / ray.Direction.x, Scalar{ 1 } / ray.Direction.y, Scalar{ 1 } / ray.Direction.z };
+
+		Scalar tNear;
+		if (!IntersectBounds(mNodes[0].Bounds, ray, invDirection, tNear))
+		{
+			return false;
+		}
+
+		struct FStackEntry
+		{
+			uint32_t Node;
+			Scalar TNear;
+		};
+
+		FStackEntry stack[MaxDepth];
+		size_t stackSize = 0;
+		stack[stackSize++] = FStackEntry{ 0, tNear };
+
+		bool hit = false;
+		while (stackSize > 0)
+		{
+			const FStackEntry entry = stack[--stackSize];
+			if (entry.TNear > ray.TMax)
+			{
+				continue;
+			}
+
+			const FBVHNode& node = mNodes[entry.Node];
+			if (node.IsLeaf())
+			{
+				for (uint32_t i = 0; i < node.PrimitiveCount; ++i)
+				{
+					hit |= intersect(mPrimitiveIndices[node.Offset + i], ray);
+				}
+				continue;
+			}
+
+			const uint32_t first = entry.Node + 1;
+			const uint32_t second = node.Offset;
+
+			Scalar tFirst, tSecond;
+			const bool hitFirst = IntersectBounds(mNodes[first].Bounds, ray, invDirection, tFirst);
+			const bool hitSecond = IntersectBounds(mNodes[second].Bounds, ray, invDirection, tSecond);
+
+			// the nearer child is pushed last so it is visited first
+			if (hitFirst && hitSecond)
+			{
+				ASSERT(stackSize + 2 <= MaxDepth);
+				if (tFirst <= tSecond)
+				{
+					stack[stackSize++] = FStackEntry{ second, tSecond };
+					stack[stackSize++] = FStackEntry{ first, tFirst };
+				}
+				else
+				{
+					stack[stackSize++] = FStackEntry{ first, tFirst };
+					stack[stackSize++] = FStackEntry{ second, tSecond };
+				}
+			}
+			else if (hitFirst)
+			{
+				stack[stackSize++] = FStackEntry{ first, tFirst };
+			}
+			else if (hitSecond)
+			{
+				stack[stackSize++] = FStackEntry{ second, tSecond };
+			}
+		}
+
+		return hit;
+	}
+
+	template<typename Func>
+	FORCEINLINE void FBVH::QueryOverlaps(const FBoundingBox& box, Func&& func) const
+	{
+		if (mNodes.empty())
+		{
+			return;
+		}
+
+		uint32_t stack[MaxDepth];
+		size_t stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const FBVHNode& node = mNodes[stack[--stackSize]];
+			if (!FMath::Overlaps(node.Bounds, box))
+			{
+				continue;
+			}
+
+			if (node.IsLeaf())
+			{
+				for (uint32_t i = 0; i < node.PrimitiveCount; ++i)
+				{
+					func(mPrimitiveIndices[node.Offset + i]);
+				}
+			}
+			else
+			{
+				ASSERT(stackSize + 2 <= MaxDepth);
+				const uint32_t self = static_cast<uint32_t>(&node - mNodes.data());
+				stack[stackSize++] = node.Offset;
+				stack[stackSize++] = self + 1;
+			}
+		}
+	}
+}
@@ -0,0 +1,198 @@
+#include "EntityRegistry.h"
+#include <algorithm>
+#include <atomic>
+
+namespace Dash
+{
+	uint32_t FComponentInfo::AllocateId()
+	{
+		static std::atomic<uint32_t> nextId{ 0 };
+
+		const uint32_t id = nextId++;
+		ASSERT_MSG(id < MaxComponentTypes, "too many component types");
+		return id;
+	}
+
+	FArchetype::FArchetype(FComponentMask mask, std::vector<const FComponentInfo*> components, std::pmr::memory_resource* resource)
+		: mMask(mask)
+		, mComponents(std::move(components))
+		, mColumns(mComponents.size(), nullptr)
+		, mResource(resource)
+	{
+	}
+
+	FArchetype::~FArchetype()
+	{
+		for (size_t column = 0; column < mComponents.size(); ++column)
+		{
+			const FComponentInfo& info = *mComponents[column];
+			for (size_t row = 0; row < mEntities.size(); ++row)
+			{
+				info.Destroy(GetElement(column, row));
+			}
+
+			if (mColumns[column] != nullptr)
+			{
+				mResource->deallocate(mColumns[column], mCapacity * info.Size, info.Alignment);
+			}
+		}
+	}
+
+	size_t FArchetype::AppendRow(FEntity entity)
+	{
+		if (mEntities.size() == mCapacity)
+		{
+			Grow();
+		}
+
+		mEntities.push_back(entity);
+		return mEntities.size() - 1;
+	}
+
+	FEntity FArchetype::RemoveRow(size_t row)
+	{
+		ASSERT(row < mEntities.size());
+
+		const size_t last = mEntities.size() - 1;
+		for (size_t column = 0; column < mComponents.size(); ++column)
+		{
+			const FComponentInfo& info = *mComponents[column];
+			info.Destroy(GetElement(column, row));
+
+			if (row != last)
+			{
+				info.MoveConstruct(GetElement(column, row), GetElement(column, last));
+				info.Destroy(GetElement(column, last));
+			}
+		}
+
+		FEntity moved;
+		if (row != last)
+		{
+			moved = mEntities[last];
+			mEntities[row] = moved;
+		}
+
+		mEntities.pop_back();
+		return moved;
+	}
+
+	void FArchetype::Grow()
+	{
+		const size_t capacity = std::max<size_t>(mCapacity * 2, 64);
+
+		for (size_t column = 0; column < mComponents.size(); ++column)
+		{
+			const FComponentInfo& info = *mComponents[column];
+			uint8_t* data = static_cast<uint8_t*>(mResource->allocate(capacity * info.Size, info.Alignment));
+
+			if (mColumns[column] != nullptr)
+			{
+				for (size_t row = 0; row < mEntities.size(); ++row)
+				{
+					info.MoveConstruct(data + row * info.Size, GetElement(column, row));
+					info.Destroy(GetElement(column, row));
+				}
+
+				mResource->deallocate(mColumns[column], mCapacity * info.Size, info.Alignment);
+			}
+
+			mColumns[column] = data;
+		}
+
+		mCapacity = capacity;
+	}
+
+	FEntityRegistry::FEntityRegistry(std::pmr::memory_resource* resource)
+		: mResource(resource)
+	{
+	}
+
+	void FEntityRegistry::DestroyEntity(FEntity entity)
+	{
+		ASSERT(IsAlive(entity));
+
+		FEntityRecord& record = mRecords[entity.Index];
+		RemoveRow(*record.Archetype, record.Row);
+
+		record.Archetype = nullptr;
+		++record.Generation;
+		mFreeIndices.push_back(entity.Index);
+		--mEntityCount;
+	}
+
+	FEntity FEntityRegistry::AllocateEntity()
+	{
+		FEntity entity;
+		if (mFreeIndices.empty())
+		{
+			entity.Index = static_cast<uint32_t>(mRecords.size());
+			mRecords.emplace_back();
+		}
+		else
+		{
+			entity.Index = mFreeIndices.back();
+			mFreeIndices.pop_back();
+		}
+
+		entity.Generation = mRecords[entity.Index].Generation;
+		++mEntityCount;
+		return entity;
+	}
+
+	FArchetype& FEntityRegistry::GetArchetype(FComponentMask mask)
+	{
+		auto iter = mArchetypeMap.find(mask);
+		if (iter != mArchetypeMap.end())
+		{
+			return *iter->second;
+		}
+
+		std::vector<const FComponentInfo*> components;
+		for (uint32_t id = 0; id < FComponentInfo::MaxComponentTypes; ++id)
+		{
+			if ((mask >> id) & 1)
+			{
+				ASSERT(mComponentInfos[id] != nullptr);
+				components.push_back(mComponentInfos[id]);
+			}
+		}
+
+		mArchetypes.push_back(std::make_unique<FArchetype>(mask, std::move(components), mResource));
+		mArchetypeMap.emplace(mask, mArchetypes.back().get());
+		return *mArchetypes.back();
+	}
+
+	size_t FEntityRegistry::MoveEntity(FEntity entity, FComponentMask mask)
+	{
+		FEntityRecord& record = mRecords[entity.Index];
+		FArchetype& source = *record.Archetype;
+		FArchetype& target = GetArchetype(mask);
+
+		const size_t row = target.AppendRow(entity);
+		for (size_t column = 0; column < target.GetColumnCount(); ++column)
+		{
+			const FComponentInfo& info = target.GetComponentInfo(column);
+			if (source.HasComponent(info.Id))
+			{
+				info.MoveConstruct(target.GetElement(column, row), source.GetElement(source.GetColumnIndex(info.Id), record.Row));
+			}
+		}
+
+		// destroys the moved-from components and those not in the target
+		RemoveRow(source, record.Row);
+
+		record.Archetype = &target;
+		record.Row = static_cast<uint32_t>(row);
+		return row;
+	}
+
+	void FEntityRegistry::RemoveRow(FArchetype& archetype, size_t row)
+	{
+		const FEntity moved = archetype.RemoveRow(row);
+		if (moved.IsValid())
+		{
+			mRecords[moved.Index].Row = static_cast<uint32_t>(row);
+		}
+	}
+}
@@ -0,0 +1,359 @@
+#pragma once
+
+#include "../math/MathType.h"
+#include "../utility/ParallelFor.h"
+
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace Dash
+{
+	struct FEntity
+	{
+		uint32_t Index = ~0u;
+
+		/** Bumped when the index is destroyed, so stale handles of a reused index are rejected. */
+		uint32_t Generation = 0;
+
+		bool IsValid() const { return Index != ~0u; }
+
+		bool operator==(const FEntity& other) const { return Index == other.Index && Generation == other.Generation; }
+		bool operator!=(const FEntity& other) const { return !(*this == other); }
+	};
+
+	/** One bit per component type id. */
+	using FComponentMask = uint64_t;
+
+	/** Type erased size and lifetime operations of a component type, ids are handed out on first use. */
+	struct FComponentInfo
+	{
+		static constexpr uint32_t MaxComponentTypes = 64;
+
+		uint32_t Id;
+		size_t Size;
+		size_t Alignment;
+		void (*MoveConstruct)(void* dest, void* src);
+		void (*Destroy)(void* object);
+
+		template<typename T>
+		static const FComponentInfo& Get()
+		{
+			static_assert(std::is_same_v<T, std::remove_cv_t<T>>, "component types are unqualified");
+
+			static const FComponentInfo info{ AllocateId(), sizeof(T), alignof(T),
+				[](void* dest, void* src) { new (dest) T(std::move(*static_cast<T*>(src))); },
+				[](void* object) { static_cast<T*>(object)->~T(); } };
+			return info;
+		}
+
+		template<typename... Components>
+		static FComponentMask GetMask()
+		{
+			return (FComponentMask{ 0 } | ... | (FComponentMask{ 1 } << Get<std::remove_cv_t<Components>>().Id));
+		}
+
+	private:
+		static uint32_t AllocateId();
+	};
+
+	/**
+	 * All entities with exactly the same set of components. Each component type is one contiguous column indexed by
+	 * row, columns are ordered by component id so the column of an id is the number of lower bits set in the mask.
+	 */
+	class FArchetype
+	{
+	public:
+		FArchetype(FComponentMask mask, std::vector<const FComponentInfo*> components, std::pmr::memory_resource* resource);
+		~FArchetype();
+
+		FArchetype(const FArchetype&) = delete;
+		FArchetype& operator=(const FArchetype&) = delete;
+
+		FComponentMask GetMask() const { return mMask; }
+		bool HasComponent(uint32_t id) const { return (mMask >> id) & 1; }
+
+		size_t GetSize() const { return mEntities.size(); }
+		const FEntity* GetEntities() const { return mEntities.data(); }
+
+		size_t GetColumnCount() const { return mComponents.size(); }
+		const FComponentInfo& GetComponentInfo(size_t column) const { return *mComponents[column]; }
+
+		size_t GetColumnIndex(uint32_t id) const { return CountBits(mMask & ((FComponentMask{ 1 } << id) - 1)); }
+
+		void* GetElement(size_t column, size_t row) { return static_cast<uint8_t*>(mColumns[column]) + row * mComponents[column]->Size; }
+
+		/** The archetype must have the component, const T gives a read-only column. */
+		template<typename T>
+		T* GetColumn()
+		{
+			return static_cast<T*>(mColumns[GetColumnIndex(FComponentInfo::Get<std::remove_cv_t<T>>().Id)]);
+		}
+
+		/** Appends a row whose components are left unconstructed, the caller constructs every column. */
+		size_t AppendRow(FEntity entity);
+
+		/** Destroys the components of the row and moves the last row into it, returns the moved entity or an invalid one. */
+		FEntity RemoveRow(size_t row);
+
+	private:
+		static size_t CountBits(FComponentMask mask)
+		{
+			mask = mask - ((mask >> 1) & 0x5555555555555555ull);
+			mask = (mask & 0x3333333333333333ull) + ((mask >> 2) & 0x3333333333333333ull);
+			mask = (mask + (mask >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+			return static_cast<size_t>((mask * 0x0101010101010101ull) >> 56);
+		}
+
+		void Grow();
+
+		FComponentMask mMask;
+		std::vector<const FComponentInfo*> mComponents;
+		std::vector<void*> mColumns;
+		std::vector<FEntity> mEntities;
+		size_t mCapacity = 0;
+		std::pmr::memory_resource* mResource;
+	};
+
+	/**
+	 * Archetype based component store. Entities with the same component set share an FArchetype, so a system that
+	 * reads a few components streams over dense columns instead of following pointers to heap objects. Adding or
+	 * removing a component moves the entity's components to the matching archetype, destroying an entity moves the
+	 * last row of its archetype into the hole.
+	 *
+	 * Column memory comes from the resource given at construction. Entities may not be created, destroyed or change
+	 * their component set while iterating, components of different entities may be written in parallel.
+	 */
+	class FEntityRegistry
+	{
+	public:
+		explicit FEntityRegistry(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		FEntityRegistry(const FEntityRegistry&) = delete;
+		FEntityRegistry& operator=(const FEntityRegistry&) = delete;
+
+		/** Every component type at most once. */
+		template<typename... Components>
+		FEntity CreateEntity(Components... components);
+
+		void DestroyEntity(FEntity entity);
+
+		bool IsAlive(FEntity entity) const { return entity.Index < mRecords.size() && mRecords[entity.Index].Generation == entity.Generation && mRecords[entity.Index].Archetype != nullptr; }
+
+		/** Replaces the component when the entity already has one. */
+		template<typename T>
+		void AddComponent(FEntity entity, T component);
+
+		template<typename T>
+		void RemoveComponent(FEntity entity);
+
+		template<typename T>
+		bool HasComponent(FEntity entity) const;
+
+		/** Null when the entity has no such component, the pointer is invalidated by structural changes. */
+		template<typename T>
+		T* GetComponent(FEntity entity);
+
+		size_t GetEntityCount() const { return mEntityCount; }
+		size_t GetArchetypeCount() const { return mArchetypes.size(); }
+
+		/**
+		 * func(const FEntity* entities, size_t count, Components*... columns) once per non-empty archetype having all
+		 * Components, a const component type gives a read-only column.
+		 */
+		template<typename... Components, typename Func>
+		void ForEachChunk(Func&& func);
+
+		/** Like ForEachChunk with archetypes split into ranges of at most chunkSize rows, run with ParallelFor. */
+		template<typename... Components, typename Func>
+		void ParallelForEachChunk(Func&& func, size_t chunkSize = 4096);
+
+		/** func(FEntity, Components&...) for every entity having all Components. */
+		template<typename... Components, typename Func>
+		void ForEach(Func&& func);
+
+		template<typename... Components, typename Func>
+		void ParallelForEach(Func&& func, size_t chunkSize = 4096);
+
+	private:
+		struct FEntityRecord
+		{
+			FArchetype* Archetype = nullptr;
+			uint32_t Row = 0;
+			uint32_t Generation = 0;
+		};
+
+		template<typename T>
+		const FComponentInfo& RegisterComponent();
+
+		FEntity AllocateEntity();
+		FArchetype& GetArchetype(FComponentMask mask);
+
+		/** Moves the entity's components shared with mask to that archetype, returns the new row. */
+		size_t MoveEntity(FEntity entity, FComponentMask mask);
+		void RemoveRow(FArchetype& archetype, size_t row);
+
+		std::pmr::memory_resource* mResource;
+
+		std::vector<FEntityRecord> mRecords;
+		std::vector<uint32_t> mFreeIndices;
+		size_t mEntityCount = 0;
+
+		std::vector<std::unique_ptr<FArchetype>> mArchetypes;
+		std::unordered_map<FComponentMask, FArchetype*> mArchetypeMap;
+
+		/** Registered component types by id, archetypes are created from these. */
+		const FComponentInfo* mComponentInfos[FComponentInfo::MaxComponentTypes] = {};
+	};
+
+
+
+
+	// Member Function
+
+	// --Implementation-- //
+
+	template<typename T>
+	FORCEINLINE const FComponentInfo& FEntityRegistry::RegisterComponent()
+	{
+		const FComponentInfo& info = FComponentInfo::Get<T>();
+		mComponentInfos[info.Id] = &info;
+		return info;
+	}
+
+	template<typename... Components>
+	FORCEINLINE FEntity FEntityRegistry::CreateEntity(Components... components)
+	{
+		(RegisterComponent<Components>(), ...);
+
+		const FEntity entity = AllocateEntity();
+		FArchetype& archetype = GetArchetype(FComponentInfo::GetMask<Components...>());
+		ASSERT_MSG(archetype.GetColumnCount() == sizeof...(Components), "a component type is given more than once");
+
+		const size_t row = archetype.AppendRow(entity);
+		(new (archetype.GetElement(archetype.GetColumnIndex(FComponentInfo::Get<Components>().Id), row)) Components(std::move(components)), ...);
+
+		mRecords[entity.Index].Archetype = &archetype;
+		mRecords[entity.Index].Row = static_cast<uint32_t>(row);
+		return entity;
+	}
+
+	template<typename T>
+	FORCEINLINE void FEntityRegistry::AddComponent(FEntity entity, T component)
+	{
+		ASSERT(IsAlive(entity));
+
+		const FComponentInfo& info = RegisterComponent<T>();
+		FEntityRecord& record = mRecords[entity.Index];
+		if (record.Archetype->HasComponent(info.Id))
+		{
+			record.Archetype->GetColumn<T>()[record.Row] = std::move(component);
+			return;
+		}
+
+		const size_t row = MoveEntity(entity, record.Archetype->GetMask() | (FComponentMask{ 1 } << info.Id));
+		new (&record.Archetype->GetColumn<T>()[row]) T(std::move(component));
+	}
+
+	template<typename T>
+	FORCEINLINE void FEntityRegistry::RemoveComponent(FEntity entity)
+	{
+		ASSERT(IsAlive(entity));
+
+		const FComponentInfo& info = FComponentInfo::Get<T>();
+		if (mRecords[entity.Index].Archetype->HasComponent(info.Id))
+		{
+			MoveEntity(entity, mRecords[entity.Index].Archetype->GetMask() & ~(FComponentMask{ 1 } << info.Id));
+		}
+	}
+
+	template<typename T>
+	FORCEINLINE bool FEntityRegistry::HasComponent(FEntity entity) const
+	{
+		return IsAlive(entity) && mRecords[entity.Index].Archetype->HasComponent(FComponentInfo::Get<T>().Id);
+	}
+
+	template<typename T>
+	FORCEINLINE T* FEntityRegistry::GetComponent(FEntity entity)
+	{
+		if (!HasComponent<std::remove_cv_t<T>>(entity))
+		{
+			return nullptr;
+		}
+
+		const FEntityRecord& record = mRecords[entity.Index];
+		return record.Archetype->GetColumn<T>() + record.Row;
+	}
+
+	template<typename... Components, typename Func>
+	FORCEINLINE void FEntityRegistry::ForEachChunk(Func&& func)
+	{
+		const FComponentMask mask = FComponentInfo::GetMask<Components...>();
+		for (const std::unique_ptr<FArchetype>& archetype : mArchetypes)
+		{
+			if ((archetype->GetMask() & mask) == mask && archetype->GetSize() > 0)
+			{
+				func(archetype->GetEntities(), archetype->GetSize(), archetype->GetColumn<Components>()...);
+			}
+		}
+	}
+
+	template<typename... Components, typename Func>
+	FORCEINLINE void FEntityRegistry::ParallelForEachChunk(Func&& func, size_t chunkSize)
+	{
+		struct FRange
+		{
+			FArchetype* Archetype;
+			size_t First;
+			size_t Count;
+		};
+
+		chunkSize = std::max<size_t>(chunkSize, 1);
+
+		const FComponentMask mask = FComponentInfo::GetMask<Components...>();
+		std::vector<FRange> ranges;
+		for (const std::unique_ptr<FArchetype>& archetype : mArchetypes)
+		{
+			if ((archetype->GetMask() & mask) == mask)
+			{
+				for (size_t first = 0; first < archetype->GetSize(); first += chunkSize)
+				{
+					ranges.push_back(FRange{ archetype.get(), first, std::min(chunkSize, archetype->GetSize() - first) });
+				}
+			}
+		}
+
+		ParallelFor(0, ranges.size(), [&](size_t i)
+		{
+			const FRange& range = ranges[i];
+			func(range.Archetype->GetEntities() + range.First, range.Count, (range.Archetype->template GetColumn<Components>() + range.First)...);
+		});
+	}
+
+	template<typename... Components, typename Func>
+	FORCEINLINE void FEntityRegistry::ForEach(Func&& func)
+	{
+		ForEachChunk<Components...>([&](const FEntity* entities, size_t count, Components*... columns)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				func(entities[i], columns[i]...);
+			}
+		});
+	}
+
+	template<typename... Components, typename Func>
+	FORCEINLINE void FEntityRegistry::ParallelForEach(Func&& func, size_t chunkSize)
+	{
+		ParallelForEachChunk<Components...>([&](const FEntity* entities, size_t count, Components*... columns)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				func(entities[i], columns[i]...);
+			}
+		}, chunkSize);
+	}
+}
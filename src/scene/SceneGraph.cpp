@@ -0,0 +1,354 @@
+#include "SceneGraph.h"
+#include "../utility/ParallelFor.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace Dash
+{
+	namespace
+	{
+		constexpr size_t NodeBlockSize = 512;
+
+		/** body(first, last) for blocks of NodeBlockSize slots of [begin, end) in parallel. */
+		template<typename Func>
+		void ParallelForBlocks(size_t begin, size_t end, Func&& body)
+		{
+			const size_t blockCount = (end - begin + NodeBlockSize - 1) / NodeBlockSize;
+			ParallelFor(0, blockCount, [&](size_t block)
+			{
+				const size_t first = begin + block * NodeBlockSize;
+				body(first, std::min(first + NodeBlockSize, end));
+			});
+		}
+
+		/** Center and extent form, exact for affine matrices and a lot cheaper than transforming eight corners. */
+		FORCEINLINE FBoundingBox TransformBounds(const FBoundingBox& b, const FMatrix4x4& m)
+		{
+			if (b.Lower.x > b.Upper.x || b.Lower.y > b.Upper.y || b.Lower.z > b.Upper.z)
+			{
+				return b;
+			}
+
+			const Scalar c[3] = { (b.Lower.x + b.Upper.x) * Scalar{ 0.5 }, (b.Lower.y + b.Upper.y) * Scalar{ 0.5 }, (b.Lower.z + b.Upper.z) * Scalar{ 0.5 } };
+			const Scalar e[3] = { (b.Upper.x - b.Lower.x) * Scalar{ 0.5 }, (b.Upper.y - b.Lower.y) * Scalar{ 0.5 }, (b.Upper.z - b.Lower.z) * Scalar{ 0.5 } };
+
+			Scalar center[3];
+			Scalar extent[3];
+			for (int j = 0; j < 3; ++j)
+			{
+				center[j] = c[0] * m[0][j] + c[1] * m[1][j] + c[2] * m[2][j] + m[3][j];
+				extent[j] = e[0] * std::abs(m[0][j]) + e[1] * std::abs(m[1][j]) + e[2] * std::abs(m[2][j]);
+			}
+
+			return FBoundingBox(FVector3f{ center[0] - extent[0], center[1] - extent[1], center[2] - extent[2] },
+				FVector3f{ center[0] + extent[0], center[1] + extent[1], center[2] + extent[2] });
+		}
+	}
+
+	uint32_t FSceneGraph::CreateNode(uint32_t parent, const FMatrix4x4& local, const FBoundingBox& localBounds)
+	{
+		ASSERT(parent == InvalidNode || IsValid(parent));
+
+		uint32_t node;
+		if (mFreeIds.empty())
+		{
+			node = static_cast<uint32_t>(mAlive.size());
+			mSlotOfId.push_back(InvalidNode);
+			mParentIds.push_back(InvalidNode);
+			mAlive.push_back(0);
+		}
+		else
+		{
+			node = mFreeIds.back();
+			mFreeIds.pop_back();
+		}
+
+		// appended unordered, RebuildOrder moves it in place
+		mSlotOfId[node] = static_cast<uint32_t>(mIdOfSlot.size());
+		mParentIds[node] = parent;
+		mAlive[node] = 1;
+
+		mIdOfSlot.push_back(node);
+		mParentSlots.push_back(InvalidNode);
+		mFirstChildSlots.push_back(0);
+		mChildCounts.push_back(0);
+		mFlags.push_back(LocalDirty | BoundsDirty);
+		mLocalMatrices.push_back(local);
+		mWorldMatrices.push_back(local);
+		mLocalBounds.push_back(localBounds);
+		mWorldBounds.push_back(localBounds);
+		mSubtreeBounds.push_back(localBounds);
+
+		mOrderDirty = true;
+		return node;
+	}
+
+	void FSceneGraph::DestroyNode(uint32_t node)
+	{
+		ASSERT(IsValid(node));
+
+		// descendants are dropped by RebuildOrder as they are no longer reachable from a root
+		mAlive[node] = 0;
+		mOrderDirty = true;
+	}
+
+	void FSceneGraph::SetParent(uint32_t node, uint32_t parent)
+	{
+		ASSERT(IsValid(node));
+		ASSERT(parent == InvalidNode || IsValid(parent));
+
+		for (uint32_t ancestor = parent; ancestor != InvalidNode; ancestor = mParentIds[ancestor])
+		{
+			ASSERT_MSG(ancestor != node, "SetParent would create a cycle");
+		}
+
+		mParentIds[node] = parent;
+		mFlags[mSlotOfId[node]] |= LocalDirty;
+		mOrderDirty = true;
+	}
+
+	void FSceneGraph::SetLocalMatrix(uint32_t node, const FMatrix4x4& local)
+	{
+		ASSERT(IsValid(node));
+
+		const uint32_t slot = mSlotOfId[node];
+		mLocalMatrices[slot] = local;
+		mFlags[slot] |= LocalDirty;
+	}
+
+	void FSceneGraph::SetLocalBounds(uint32_t node, const FBoundingBox& localBounds)
+	{
+		ASSERT(IsValid(node));
+
+		const uint32_t slot = mSlotOfId[node];
+		mLocalBounds[slot] = localBounds;
+		mFlags[slot] |= BoundsDirty;
+	}
+
+	FTransform FSceneGraph::GetWorldTransform(uint32_t node) const
+	{
+		const FMatrix4x4& world = GetWorldMatrix(node);
+		return FTransform(world, FMath::Inverse(world));
+	}
+
+	size_t FSceneGraph::Update()
+	{
+		if (mOrderDirty)
+		{
+			RebuildOrder();
+			mOrderDirty = false;
+		}
+
+		const size_t levelCount = GetLevelCount();
+		std::atomic<size_t> updated{ 0 };
+
+		// parents are final before their level is read, so each level only depends on the previous one
+		size_t changedLevels = 0;
+		for (size_t level = 0; level < levelCount; ++level)
+		{
+			std::atomic<bool> levelChanged{ false };
+			ParallelForBlocks(mLevelOffsets[level], mLevelOffsets[level + 1], [&](size_t first, size_t last)
+			{
+				if (UpdateWorldMatrices(first, last, updated))
+				{
+					levelChanged = true;
+				}
+			});
+
+			if (levelChanged)
+			{
+				changedLevels = level + 1;
+			}
+		}
+
+		// nothing below the deepest changed level needs a refit
+		for (size_t level = changedLevels; level-- > 0;)
+		{
+			ParallelForBlocks(mLevelOffsets[level], mLevelOffsets[level + 1], [&](size_t first, size_t last)
+			{
+				UpdateSubtreeBounds(first, last);
+			});
+		}
+
+		if (levelCount > 0)
+		{
+			std::fill(mFlags.begin(), mFlags.begin() + mLevelOffsets[1], uint8_t{ 0 });
+		}
+
+		return updated;
+	}
+
+	bool FSceneGraph::UpdateWorldMatrices(size_t begin, size_t end, std::atomic<size_t>& updated)
+	{
+		size_t blockUpdated = 0;
+		bool changed = false;
+		for (size_t slot = begin; slot < end; ++slot)
+		{
+			uint8_t flags = mFlags[slot];
+			const uint32_t parent = mParentSlots[slot];
+
+			if (parent != InvalidNode && (mFlags[parent] & WorldChanged))
+			{
+				flags |= LocalDirty;
+			}
+
+			if (flags & LocalDirty)
+			{
+				mWorldMatrices[slot] = parent == InvalidNode ? mLocalMatrices[slot] : mLocalMatrices[slot] * mWorldMatrices[parent];
+				flags |= WorldChanged;
+				++blockUpdated;
+			}
+
+			if (flags & (WorldChanged | BoundsDirty))
+			{
+				mWorldBounds[slot] = TransformBounds(mLocalBounds[slot], mWorldMatrices[slot]);
+				flags |= SubtreeChanged;
+				changed = true;
+			}
+
+			mFlags[slot] = flags;
+		}
+
+		updated += blockUpdated;
+		return changed;
+	}
+
+	void FSceneGraph::UpdateSubtreeBounds(size_t begin, size_t end)
+	{
+		for (size_t slot = begin; slot < end; ++slot)
+		{
+			const size_t firstChild = mFirstChildSlots[slot];
+			const size_t lastChild = firstChild + mChildCounts[slot];
+
+			bool changed = (mFlags[slot] & SubtreeChanged) != 0;
+			for (size_t child = firstChild; child < lastChild && !changed; ++child)
+			{
+				changed = (mFlags[child] & SubtreeChanged) != 0;
+			}
+
+			if (changed)
+			{
+				FBoundingBox bounds = mWorldBounds[slot];
+				for (size_t child = firstChild; child < lastChild; ++child)
+				{
+					bounds = FMath::Union(bounds, mSubtreeBounds[child]);
+				}
+				mSubtreeBounds[slot] = bounds;
+			}
+
+			// the children are only read by their parent, so they are done now
+			std::fill(mFlags.begin() + firstChild, mFlags.begin() + lastChild, uint8_t{ 0 });
+			mFlags[slot] = changed ? SubtreeChanged : 0;
+		}
+	}
+
+	void FSceneGraph::RebuildOrder()
+	{
+		const size_t idCount = mAlive.size();
+
+		auto isAttached = [&](uint32_t id) { return mAlive[id] && mParentIds[id] != InvalidNode && mAlive[mParentIds[id]]; };
+
+		// children per id in id order
+		std::vector<uint32_t> childOffsets(idCount + 1, 0);
+		for (uint32_t id = 0; id < idCount; ++id)
+		{
+			if (isAttached(id))
+			{
+				++childOffsets[mParentIds[id] + 1];
+			}
+		}
+
+		for (size_t id = 0; id < idCount; ++id)
+		{
+			childOffsets[id + 1] += childOffsets[id];
+		}
+
+		std::vector<uint32_t> children(childOffsets[idCount]);
+		std::vector<uint32_t> cursors(childOffsets.begin(), childOffsets.end() - 1);
+		for (uint32_t id = 0; id < idCount; ++id)
+		{
+			if (isAttached(id))
+			{
+				children[cursors[mParentIds[id]]++] = id;
+			}
+		}
+
+		// breadth first from the roots, children of destroyed nodes are never reached
+		std::vector<uint32_t> order;
+		order.reserve(mIdOfSlot.size());
+		for (uint32_t id = 0; id < idCount; ++id)
+		{
+			if (mAlive[id] && mParentIds[id] == InvalidNode)
+			{
+				order.push_back(id);
+			}
+		}
+
+		std::vector<uint32_t> firstChildSlots;
+		std::vector<uint32_t> childCounts;
+		firstChildSlots.reserve(mIdOfSlot.size());
+		childCounts.reserve(mIdOfSlot.size());
+
+		mLevelOffsets.assign(1, 0);
+		for (size_t levelBegin = 0; levelBegin < order.size();)
+		{
+			const size_t levelEnd = order.size();
+			mLevelOffsets.push_back(levelEnd);
+
+			for (size_t slot = levelBegin; slot < levelEnd; ++slot)
+			{
+				const uint32_t id = order[slot];
+				firstChildSlots.push_back(static_cast<uint32_t>(order.size()));
+				childCounts.push_back(childOffsets[id + 1] - childOffsets[id]);
+				order.insert(order.end(), children.begin() + childOffsets[id], children.begin() + childOffsets[id + 1]);
+			}
+
+			levelBegin = levelEnd;
+		}
+
+		std::vector<uint32_t> slotOfId(idCount, InvalidNode);
+		for (size_t slot = 0; slot < order.size(); ++slot)
+		{
+			slotOfId[order[slot]] = static_cast<uint32_t>(slot);
+		}
+
+		for (uint32_t id : mIdOfSlot)
+		{
+			if (slotOfId[id] == InvalidNode)
+			{
+				mAlive[id] = 0;
+				mParentIds[id] = InvalidNode;
+				mFreeIds.push_back(id);
+			}
+		}
+
+		const size_t nodeCount = order.size();
+		std::vector<uint32_t> parentSlots(nodeCount);
+		std::vector<FMatrix4x4> localMatrices(nodeCount);
+		std::vector<FBoundingBox> localBounds(nodeCount);
+
+		ParallelFor(0, nodeCount, [&](size_t slot)
+		{
+			const uint32_t id = order[slot];
+			const uint32_t oldSlot = mSlotOfId[id];
+			parentSlots[slot] = mParentIds[id] == InvalidNode ? InvalidNode : slotOfId[mParentIds[id]];
+			localMatrices[slot] = mLocalMatrices[oldSlot];
+			localBounds[slot] = mLocalBounds[oldSlot];
+		}, 4096);
+
+		mSlotOfId = std::move(slotOfId);
+		mIdOfSlot = std::move(order);
+		mParentSlots = std::move(parentSlots);
+		mFirstChildSlots = std::move(firstChildSlots);
+		mChildCounts = std::move(childCounts);
+		mLocalMatrices = std::move(localMatrices);
+		mLocalBounds = std::move(localBounds);
+
+		// the whole hierarchy is recomputed after a structural change
+		mFlags.assign(nodeCount, LocalDirty | BoundsDirty);
+		mWorldMatrices.resize(nodeCount);
+		mWorldBounds.resize(nodeCount);
+		mSubtreeBounds.resize(nodeCount);
+	}
+}
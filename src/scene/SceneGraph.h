@@ -0,0 +1,107 @@
+#pragma once
+
+#include "../math/MathType.h"
+#include "../math/Transform.h"
+
+#include <atomic>
+#include <vector>
+
+namespace Dash
+{
+	/**
+	 * Transform hierarchy with the nodes kept in flat arrays in breadth first order: every level of the tree is one
+	 * contiguous range, parents come before their children and the children of a node are adjacent.
+	 *
+	 * Setting a local transform or local bounds only flags the node. Update walks the levels top-down and recomputes
+	 * the world matrices of the flagged nodes and everything below them, then walks back up and refits the subtree
+	 * bounds along the changed paths. Each level runs with ParallelFor, unchanged nodes cost a flag test per pass.
+	 *
+	 * Nodes are addressed by stable ids. Creating, destroying or reparenting nodes reorders the arrays on the next
+	 * Update, local transforms and bounds of different nodes may be set from several threads between updates.
+	 */
+	class FSceneGraph
+	{
+	public:
+		static constexpr uint32_t InvalidNode = ~0u;
+
+		/** Row-vector matrices, a node's world matrix is its local matrix times the parent's world matrix. */
+		uint32_t CreateNode(uint32_t parent = InvalidNode, const FMatrix4x4& local = FMatrix4x4(FIdentity{}), const FBoundingBox& localBounds = FBoundingBox());
+
+		/** The node and all its descendants are removed, their ids are reused after the next Update. */
+		void DestroyNode(uint32_t node);
+
+		/** Keeps the local transform, so the world transform of the subtree changes with the new parent. */
+		void SetParent(uint32_t node, uint32_t parent);
+
+		void SetLocalTransform(uint32_t node, const FTransform& local) { SetLocalMatrix(node, local.GetMatrix()); }
+		void SetLocalMatrix(uint32_t node, const FMatrix4x4& local);
+
+		/** Bounds of the node's own geometry in its local space, empty for pure transform nodes. */
+		void SetLocalBounds(uint32_t node, const FBoundingBox& localBounds);
+
+		/** Propagates the changes since the last Update, returns the number of world matrices recomputed. */
+		size_t Update();
+
+		bool IsValid(uint32_t node) const { return node < mAlive.size() && mAlive[node]; }
+
+		uint32_t GetParent(uint32_t node) const { return mParentIds[node]; }
+
+		size_t GetNodeCount() const { return mIdOfSlot.size(); }
+		size_t GetLevelCount() const { return mLevelOffsets.empty() ? 0 : mLevelOffsets.size() - 1; }
+
+		const FMatrix4x4& GetLocalMatrix(uint32_t node) const { return mLocalMatrices[mSlotOfId[node]]; }
+		const FBoundingBox& GetLocalBounds(uint32_t node) const { return mLocalBounds[mSlotOfId[node]]; }
+
+		/** The following are current as of the last Update. */
+		const FMatrix4x4& GetWorldMatrix(uint32_t node) const { return mWorldMatrices[mSlotOfId[node]]; }
+
+		/** World matrix and its inverse, e.g. to place a Shape. */
+		FTransform GetWorldTransform(uint32_t node) const;
+
+		/** Own geometry in world space. */
+		const FBoundingBox& GetWorldBounds(uint32_t node) const { return mWorldBounds[mSlotOfId[node]]; }
+
+		/** Own geometry and all descendants in world space. */
+		const FBoundingBox& GetSubtreeBounds(uint32_t node) const { return mSubtreeBounds[mSlotOfId[node]]; }
+
+	private:
+		enum ENodeFlags : uint8_t
+		{
+			LocalDirty = 1 << 0,
+			BoundsDirty = 1 << 1,
+
+			// set during Update
+			WorldChanged = 1 << 2,
+			SubtreeChanged = 1 << 3,
+		};
+
+		void RebuildOrder();
+
+		/** True when a world bound in [begin, end) changed. */
+		bool UpdateWorldMatrices(size_t begin, size_t end, std::atomic<size_t>& updated);
+		void UpdateSubtreeBounds(size_t begin, size_t end);
+
+		// per id
+		std::vector<uint32_t> mSlotOfId;
+		std::vector<uint32_t> mParentIds;
+		std::vector<uint8_t> mAlive;
+		std::vector<uint32_t> mFreeIds;
+
+		// per slot, breadth first once mOrderDirty is cleared
+		std::vector<uint32_t> mIdOfSlot;
+		std::vector<uint32_t> mParentSlots;
+		std::vector<uint32_t> mFirstChildSlots;
+		std::vector<uint32_t> mChildCounts;
+		std::vector<uint8_t> mFlags;
+		std::vector<FMatrix4x4> mLocalMatrices;
+		std::vector<FMatrix4x4> mWorldMatrices;
+		std::vector<FBoundingBox> mLocalBounds;
+		std::vector<FBoundingBox> mWorldBounds;
+		std::vector<FBoundingBox> mSubtreeBounds;
+
+		/** First slot of each level plus the end. */
+		std::vector<size_t> mLevelOffsets;
+
+		bool mOrderDirty = false;
+	};
+}
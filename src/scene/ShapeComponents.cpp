@@ -0,0 +1,188 @@
+#include "ShapeComponents.h"
+#include "../math/Intersection.h"
+
+namespace Dash
+{
+	namespace
+	{
+		FORCEINLINE FBoundingBox GetSphereBounds(const FSphereShape& sphere, const FTransform& transform)
+		{
+			const FVector3f center = transform.GetPosition();
+			const FVector3f radius{ sphere.Radius, sphere.Radius, sphere.Radius };
+			return FBoundingBox{ center - radius, center + radius };
+		}
+
+		FORCEINLINE FBoundingBox GetPlaneBounds(const FPlaneShape& plane, const FTransform& transform)
+		{
+			const FVector3f worldTangent = transform.TransformVector(plane.Tangent) * plane.Width;
+			const FVector3f worldBinormal = transform.TransformVector(plane.Binormal) * plane.Height;
+			const FVector3f topLeft = transform.TransformPoint(plane.TopLeft);
+
+			FBoundingBox bounds = FMath::Union(topLeft, topLeft + worldTangent);
+			bounds = FMath::Union(bounds, topLeft + worldBinormal);
+			bounds = FMath::Union(bounds, topLeft + worldTangent + worldBinormal);
+
+			const FVector3f epsilon = FVector3f{ FIdentity{} } * TScalarTraits<Scalar>::Epsilon();
+			return FBoundingBox{ bounds.Lower - epsilon, bounds.Upper + epsilon };
+		}
+
+		FORCEINLINE bool IntersectSphere(const FSphereShape& sphere, const FTransform& transform, const FRay& r, Scalar& t, HitInfo& hitInfo)
+		{
+			const FVector3f center = transform.GetPosition();
+
+			Scalar t0, t1;
+			if (!FMath::RaySphereIntersection(r, center, sphere.Radius, t0, t1) || t0 > r.TMax || t1 < r.TMin)
+			{
+				return false;
+			}
+
+			// from inside the sphere the far root is the hit
+			t = t0 < r.TMin ? t1 : t0;
+			if (t > r.TMax)
+			{
+				return false;
+			}
+
+			hitInfo.Normal = (r(t) - center) / sphere.Radius;
+			hitInfo.Position = center + sphere.Radius * hitInfo.Normal;
+
+			const FVector2f spherical = FMath::CartesianToSpherical(hitInfo.Normal);
+			const Scalar theta = spherical.x;
+			const Scalar phi = spherical.y;
+			hitInfo.Tangent = FVector3f{ -FMath::Sin(theta), FMath::Cos(theta), 0.0f };
+			hitInfo.TexCoord = FVector2f{ (theta * TScalarTraits<Scalar>::InvPi() + Scalar{ 1 }) * Scalar{ 0.5 }, phi * TScalarTraits<Scalar>::InvPi() };
+			return true;
+		}
+
+		FORCEINLINE bool IntersectPlane(const FPlaneShape& plane, const FTransform& transform, const FRay& r, Scalar& t, HitInfo& hitInfo)
+		{
+			const FRay objectRay = FMath::Inverse(transform).TransformRay(r);
+
+			Scalar tp;
+			if (!FMath::RayPlaneIntersection(objectRay, plane.Normal, plane.TopLeft, tp) || tp > r.TMax || tp < r.TMin)
+			{
+				return false;
+			}
+
+			const FVector3f point = objectRay(tp);
+			const FVector3f offsetToTopLeft = point - plane.TopLeft;
+			const Scalar u = FMath::Dot(plane.Tangent, offsetToTopLeft);
+			const Scalar v = FMath::Dot(plane.Binormal, offsetToTopLeft);
+			if (u < Scalar{ 0 } || u > plane.Width || v < Scalar{ 0 } || v > plane.Height)
+			{
+				return false;
+			}
+
+			t = tp;
+			hitInfo.Position = transform.TransformPoint(point);
+			hitInfo.Normal = transform.TransformNormal(plane.Normal);
+			hitInfo.Tangent = transform.TransformVector(plane.Tangent);
+			hitInfo.TexCoord = FVector2f{ u / plane.Width, v / plane.Height };
+			return true;
+		}
+
+		/** Runs intersect on the rows whose bounds the ray enters before the current closest hit. */
+		template<typename ShapeType, typename IntersectFunc>
+		void IntersectColumns(FEntityRegistry& registry, FRay& ray, FShapeHit& hit, bool& found, IntersectFunc&& intersect)
+		{
+			registry.ForEachChunk<const ShapeType, const FTransform, const FBoundingBox>([&](const FEntity* entities, size_t count,
+				const ShapeType* shapes, const FTransform* transforms, const FBoundingBox* bounds)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					Scalar t0, t1;
+					if (!FMath::RayBoundingBoxIntersection(ray, bounds[i], t0, t1))
+					{
+						continue;
+					}
+
+					Scalar t;
+					HitInfo hitInfo;
+					if (intersect(shapes[i], transforms[i], ray, t, hitInfo))
+					{
+						hit.Entity = entities[i];
+						hit.T = t;
+						hit.Info = hitInfo;
+						ray.TMax = t;
+						found = true;
+					}
+				}
+			});
+		}
+	}
+
+	FPlaneShape FPlaneShape::Create(const FVector3f& normal, const FVector3f& topLeft, const FVector3f& topRight, const FVector3f& bottomLeft)
+	{
+		FPlaneShape plane;
+		plane.Normal = FMath::Normalize(normal);
+		plane.TopLeft = topLeft;
+
+		const FVector3f u = topRight - topLeft;
+		const FVector3f v = bottomLeft - topLeft;
+		plane.Width = FMath::Length(u);
+		plane.Height = FMath::Length(v);
+
+		ASSERT(!FMath::IsZero(plane.Width));
+		ASSERT(!FMath::IsZero(plane.Height));
+
+		plane.Tangent = u / plane.Width;
+		plane.Tangent = plane.Tangent - FMath::Dot(plane.Tangent, plane.Normal) * plane.Normal;
+		plane.Binormal = FMath::Cross(plane.Normal, plane.Tangent);
+		plane.Binormal = plane.Binormal - FMath::Dot(plane.Binormal, plane.Normal) * plane.Normal - FMath::Dot(plane.Binormal, plane.Tangent) * plane.Tangent;
+		return plane;
+	}
+
+	void UpdateShapeBounds(FEntityRegistry& registry)
+	{
+		registry.ParallelForEachChunk<const FSphereShape, const FTransform, FBoundingBox>([](const FEntity*, size_t count,
+			const FSphereShape* spheres, const FTransform* transforms, FBoundingBox* bounds)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				bounds[i] = GetSphereBounds(spheres[i], transforms[i]);
+			}
+		});
+
+		registry.ParallelForEachChunk<const FPlaneShape, const FTransform, FBoundingBox>([](const FEntity*, size_t count,
+			const FPlaneShape* planes, const FTransform* transforms, FBoundingBox* bounds)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				bounds[i] = GetPlaneBounds(planes[i], transforms[i]);
+			}
+		});
+	}
+
+	bool IntersectShapes(FEntityRegistry& registry, const FRay& r, FShapeHit& hit)
+	{
+		FRay ray = r;
+		bool found = false;
+
+		IntersectColumns<FSphereShape>(registry, ray, hit, found, IntersectSphere);
+		IntersectColumns<FPlaneShape>(registry, ray, hit, found, IntersectPlane);
+
+		return found;
+	}
+
+	size_t CullEntities(FEntityRegistry& registry, const FFrustum& frustum, std::vector<FEntity>& visibleEntities)
+	{
+		visibleEntities.clear();
+
+		std::vector<uint8_t> visible;
+		registry.ForEachChunk<const FBoundingBox>([&](const FEntity* entities, size_t count, const FBoundingBox* bounds)
+		{
+			visible.resize(count);
+			frustum.IntersectsBoxes(bounds, count, visible.data());
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (visible[i])
+				{
+					visibleEntities.push_back(entities[i]);
+				}
+			}
+		});
+
+		return visibleEntities.size();
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "EntityRegistry.h"
+#include "../math/Frustum.h"
+#include "../shapes/Shape.h"
+
+namespace Dash
+{
+	/**
+	 * Shape parameters as plain components. An entity with a shape component and an FTransform is placed in the world,
+	 * its FBoundingBox component holds the world bounds written by UpdateShapeBounds.
+	 */
+	struct FSphereShape
+	{
+		/** Centered at the transform's position, like Sphere the radius is not scaled. */
+		Scalar Radius;
+	};
+
+	/** Rectangle in object space with the same parameters as Plane. */
+	struct FPlaneShape
+	{
+		FVector3f Normal;
+		FVector3f Tangent;
+		FVector3f Binormal;
+		FVector3f TopLeft;
+		Scalar Width;
+		Scalar Height;
+
+		static FPlaneShape Create(const FVector3f& normal, const FVector3f& topLeft, const FVector3f& topRight, const FVector3f& bottomLeft);
+	};
+
+	struct FShapeHit
+	{
+		FEntity Entity;
+		Scalar T;
+		HitInfo Info;
+	};
+
+	/** World bounds of all sphere and plane entities in parallel, matching Sphere::WorldBound and Plane::WorldBound. */
+	void UpdateShapeBounds(FEntityRegistry& registry);
+
+	/**
+	 * Closest hit in [r.TMin, r.TMax] over the sphere and plane entities. The dense bounds column is tested first, the
+	 * transform and shape are only read for boxes the ray hits closer than the current hit.
+	 */
+	bool IntersectShapes(FEntityRegistry& registry, const FRay& r, FShapeHit& hit);
+
+	/** Entities whose FBoundingBox intersects the frustum, in registry order. */
+	size_t CullEntities(FEntityRegistry& registry, const FFrustum& frustum, std::vector<FEntity>& visibleEntities);
+}
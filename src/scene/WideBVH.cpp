@@ -0,0 +1,280 @@
+#include "WideBVH.h"
+#include "../utility/LogManager.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+namespace Dash
+{
+	namespace
+	{
+		constexpr uint32_t MaxQuantized = 255;
+
+		FORCEINLINE Scalar HalfArea(const FBoundingBox& b)
+		{
+			const FVector3f d = b.Upper - b.Lower;
+			return d.x * d.y + d.y * d.z + d.z * d.x;
+		}
+
+		/** Smallest power of two that covers the extent in MaxQuantized steps, 0 for a flat axis. */
+		Scalar GetQuantizationScale(Scalar extent)
+		{
+			if (extent <= 0)
+			{
+				return 0;
+			}
+
+			int exponent;
+			std::frexp(std::nextafter(extent, TScalarTraits<Scalar>::Infinity()) / MaxQuantized, &exponent);
+			return std::ldexp(Scalar{ 1 }, exponent);
+		}
+
+		/** Rounds down for lower planes and up for upper planes, checked against the decoded value. */
+		uint8_t QuantizeLower(Scalar value, Scalar origin, Scalar scale)
+		{
+			if (scale <= 0)
+			{
+				return 0;
+			}
+
+			uint32_t q = static_cast<uint32_t>(std::clamp(std::floor((value - origin) / scale), Scalar{ 0 }, Scalar{ MaxQuantized }));
+			while (q > 0 && origin + q * scale > value)
+			{
+				--q;
+			}
+			return static_cast<uint8_t>(q);
+		}
+
+		uint8_t QuantizeUpper(Scalar value, Scalar origin, Scalar scale)
+		{
+			if (scale <= 0)
+			{
+				return 0;
+			}
+
+			uint32_t q = static_cast<uint32_t>(std::clamp(std::ceil((value - origin) / scale), Scalar{ 0 }, Scalar{ MaxQuantized }));
+			while (q < MaxQuantized && origin + q * scale < value)
+			{
+				++q;
+			}
+			return static_cast<uint8_t>(q);
+		}
+
+		/** Four quantized planes widened to floats. */
+		FORCEINLINE __m128 LoadQuantized(const uint8_t* q)
+		{
+			int32_t bits;
+			std::memcpy(&bits, q, sizeof(bits));
+
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i bytes = _mm_cvtsi32_si128(bits);
+			return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero));
+		}
+
+		/** Decoded planes of one axis for four children starting at first. */
+		template<uint32_t Width>
+		FORCEINLINE void DecodePlanes(const TWideBVHNode<Width>& node, int axis, uint32_t first, __m128& lower, __m128& upper)
+		{
+			const __m128 origin = _mm_set1_ps(node.Origin[axis]);
+			const __m128 scale = _mm_set1_ps(node.Scale[axis]);
+			lower = _mm_add_ps(origin, _mm_mul_ps(LoadQuantized(node.Lower[axis] + first), scale));
+			upper = _mm_add_ps(origin, _mm_mul_ps(LoadQuantized(node.Upper[axis] + first), scale));
+		}
+	}
+
+	template<uint32_t Width>
+	bool TWideBVH<Width>::Build(const FBVH& bvh)
+	{
+		mNodes.clear();
+		mPrimitiveIndices.clear();
+		mBounds = FBoundingBox();
+
+		if (bvh.GetSettings().MaxLeafSize > MaxLeafSize)
+		{
+			LOG_ERROR << "Wide BVH leaves hold at most " << MaxLeafSize << " primitives, the BVH was built with MaxLeafSize " << bvh.GetSettings().MaxLeafSize;
+			return false;
+		}
+
+		mPrimitiveIndices = bvh.GetPrimitiveIndices();
+		mBounds = bvh.GetBounds();
+
+		const std::vector<FBVHNode>& nodes = bvh.GetNodes();
+		if (nodes.empty())
+		{
+			return true;
+		}
+
+		mNodes.reserve(nodes.size() / (Width - 1) + 1);
+		CollapseNode(bvh, 0);
+		return true;
+	}
+
+	template<uint32_t Width>
+	uint32_t TWideBVH<Width>::CollapseNode(const FBVH& bvh, uint32_t binaryNode)
+	{
+		const std::vector<FBVHNode>& nodes = bvh.GetNodes();
+		const FBVHNode& parent = nodes[binaryNode];
+
+		uint32_t children[Width];
+		uint32_t childCount = 0;
+		if (parent.IsLeaf())
+		{
+			// only a root leaf gets here, it becomes the single child of the root
+			children[childCount++] = binaryNode;
+		}
+		else
+		{
+			children[childCount++] = binaryNode + 1;
+			children[childCount++] = parent.Offset;
+		}
+
+		// open the inner child with the largest surface until the node is full
+		while (childCount < Width)
+		{
+			int largest = -1;
+			Scalar largestArea = -1;
+			for (uint32_t i = 0; i < childCount; ++i)
+			{
+				const FBVHNode& child = nodes[children[i]];
+				if (!child.IsLeaf() && HalfArea(child.Bounds) > largestArea)
+				{
+					largest = static_cast<int>(i);
+					largestArea = HalfArea(child.Bounds);
+				}
+			}
+
+			if (largest < 0)
+			{
+				break;
+			}
+
+			const uint32_t opened = children[largest];
+			children[largest] = opened + 1;
+			children[childCount++] = nodes[opened].Offset;
+		}
+
+		const uint32_t index = static_cast<uint32_t>(mNodes.size());
+		mNodes.emplace_back();
+
+		FNode node = {};
+		node.ChildCount = static_cast<uint8_t>(childCount);
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			node.Origin[axis] = parent.Bounds.Lower[axis];
+			node.Scale[axis] = GetQuantizationScale(parent.Bounds.Upper[axis] - parent.Bounds.Lower[axis]);
+		}
+
+		for (uint32_t i = 0; i < childCount; ++i)
+		{
+			const FBVHNode& child = nodes[children[i]];
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				node.Lower[axis][i] = QuantizeLower(child.Bounds.Lower[axis], node.Origin[axis], node.Scale[axis]);
+				node.Upper[axis][i] = QuantizeUpper(child.Bounds.Upper[axis], node.Origin[axis], node.Scale[axis]);
+			}
+
+			if (child.IsLeaf())
+			{
+				ASSERT(child.PrimitiveCount <= MaxLeafSize);
+				node.Child[i] = child.Offset;
+				node.PrimitiveCount[i] = static_cast<uint8_t>(child.PrimitiveCount);
+			}
+			else
+			{
+				node.Child[i] = CollapseNode(bvh, children[i]);
+			}
+		}
+
+		mNodes[index] = node;
+		return index;
+	}
+
+	template<uint32_t Width>
+	uint32_t TWideBVH<Width>::IntersectChildren(const FNode& node, const FRayData& ray, Scalar tNear[Width])
+	{
+		uint32_t mask = 0;
+
+#if defined(__AVX__)
+		if constexpr (Width == 8)
+		{
+			__m256 tMin = _mm256_set1_ps(ray.TMin);
+			__m256 tMax = _mm256_set1_ps(ray.TMax);
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				__m128 lower0, upper0, lower1, upper1;
+				DecodePlanes(node, axis, 0, lower0, upper0);
+				DecodePlanes(node, axis, 4, lower1, upper1);
+
+				const __m256 lower = _mm256_insertf128_ps(_mm256_castps128_ps256(lower0), lower1, 1);
+				const __m256 upper = _mm256_insertf128_ps(_mm256_castps128_ps256(upper0), upper1, 1);
+
+				const __m256 origin = _mm256_set1_ps(ray.Origin[axis]);
+				const __m256 invDirection = _mm256_set1_ps(ray.InvDirection[axis]);
+				const __m256 t0 = _mm256_mul_ps(_mm256_sub_ps(lower, origin), invDirection);
+				const __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(upper, origin), invDirection);
+
+				tMin = _mm256_max_ps(tMin, _mm256_min_ps(t0, t1));
+				tMax = _mm256_min_ps(tMax, _mm256_max_ps(t0, t1));
+			}
+
+			_mm256_storeu_ps(tNear, tMin);
+			return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(tMin, tMax, _CMP_LE_OQ)));
+		}
+#endif
+
+		for (uint32_t first = 0; first < Width; first += 4)
+		{
+			__m128 tMin = _mm_set1_ps(ray.TMin);
+			__m128 tMax = _mm_set1_ps(ray.TMax);
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				__m128 lower, upper;
+				DecodePlanes(node, axis, first, lower, upper);
+
+				const __m128 origin = _mm_set1_ps(ray.Origin[axis]);
+				const __m128 invDirection = _mm_set1_ps(ray.InvDirection[axis]);
+				const __m128 t0 = _mm_mul_ps(_mm_sub_ps(lower, origin), invDirection);
+				const __m128 t1 = _mm_mul_ps(_mm_sub_ps(upper, origin), invDirection);
+
+				tMin = _mm_max_ps(tMin, _mm_min_ps(t0, t1));
+				tMax = _mm_min_ps(tMax, _mm_max_ps(t0, t1));
+			}
+
+			_mm_storeu_ps(tNear + first, tMin);
+			mask |= static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tMin, tMax))) << first;
+		}
+
+		return mask;
+	}
+
+	template<uint32_t Width>
+	uint32_t TWideBVH<Width>::OverlapChildren(const FNode& node, const FBoundingBox& box)
+	{
+		uint32_t mask = 0;
+		for (uint32_t first = 0; first < Width; first += 4)
+		{
+			__m128 overlap = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				__m128 lower, upper;
+				DecodePlanes(node, axis, first, lower, upper);
+
+				overlap = _mm_and_ps(overlap, _mm_cmple_ps(lower, _mm_set1_ps(box.Upper[axis])));
+				overlap = _mm_and_ps(overlap, _mm_cmpge_ps(upper, _mm_set1_ps(box.Lower[axis])));
+			}
+
+			mask |= static_cast<uint32_t>(_mm_movemask_ps(overlap)) << first;
+		}
+
+		return mask;
+	}
+
+	template class TWideBVH<4>;
+	template class TWideBVH<8>;
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include "BVH.h"
+
+namespace Dash
+{
+	/**
+	 * Up to Width children with their bounds quantized to 8 bits per plane. A child plane decodes to
+	 * Origin + q * Scale, the scale is a power of two so q * Scale is exact and the decoded boxes always contain the
+	 * full precision ones. Children are packed at the front, ChildCount of them are valid.
+	 */
+	template<uint32_t Width>
+	struct TWideBVHNode
+	{
+		static_assert(Width == 4 || Width == 8, "wide nodes are tested in groups of four lanes");
+
+		FVector3f Origin;
+		FVector3f Scale;
+
+		uint8_t Lower[3][Width];
+		uint8_t Upper[3][Width];
+
+		/** Inner children: node index. Leaf children: first entry in the primitive indices. */
+		uint32_t Child[Width];
+
+		/** Primitives of leaf children, 0 for inner children. */
+		uint8_t PrimitiveCount[Width];
+
+		uint8_t ChildCount;
+
+		bool IsLeaf(uint32_t child) const { return PrimitiveCount[child] > 0; }
+
+		FBoundingBox GetChildBounds(uint32_t child) const;
+	};
+
+	/**
+	 * BVH4 / BVH8 collapsed from a binary FBVH. Every wide node replaces up to Width - 1 binary nodes, the larger
+	 * children are opened first. Nodes are a fraction of the size of the binary nodes they replace and a ray or box
+	 * tests all children of a node at once with SSE, or AVX for eight children when available.
+	 *
+	 * Primitive indices keep the order of the binary tree, binary leaves become leaf children.
+	 */
+	template<uint32_t Width>
+	class TWideBVH
+	{
+	public:
+		using FNode = TWideBVHNode<Width>;
+
+		/** The collapsed tree is at most as deep as the binary one, each level pushes at most Width - 1 entries. */
+		static constexpr uint32_t MaxStackSize = FBVH::MaxDepth * (Width - 1) + 1;
+
+		/** Leaf children count their primitives in 8 bits. */
+		static constexpr uint32_t MaxLeafSize = 0xFF;
+
+		TWideBVH() = default;
+		explicit TWideBVH(const FBVH& bvh) { Build(bvh); }
+
+		/** Fails and leaves the tree empty when the binary tree was built with a MaxLeafSize above MaxLeafSize. */
+		bool Build(const FBVH& bvh);
+
+		const std::vector<FNode>& GetNodes() const { return mNodes; }
+		const std::vector<uint32_t>& GetPrimitiveIndices() const { return mPrimitiveIndices; }
+
+		FBoundingBox GetBounds() const { return mBounds; }
+
+		/** Closest hit with the same contract as FBVH::Intersect. */
+		template<typename Func>
+		bool Intersect(const FRay& r, Func&& intersect) const;
+
+		/** func(uint32_t primitive) for the primitives of every leaf overlapping the box. */
+		template<typename Func>
+		void QueryOverlaps(const FBoundingBox& box, Func&& func) const;
+
+	private:
+		/** Ray data shared by the child tests of one traversal. */
+		struct FRayData
+		{
+			FVector3f Origin;
+			FVector3f InvDirection;
+			Scalar TMin;
+			Scalar TMax;
+		};
+
+		/** Bit i is set when the ray enters child i within [TMin, TMax], the entry distance is written to tNear[i]. */
+		static uint32_t IntersectChildren(const FNode& node, const FRayData& ray, Scalar tNear[Width]);
+
+		/** Bit i is set when child i overlaps the box. */
+		static uint32_t OverlapChildren(const FNode& node, const FBoundingBox& box);
+
+		struct FStackEntry
+		{
+			/** Node index, or the first primitive index of a leaf. */
+			uint32_t Item;
+			uint32_t PrimitiveCount;
+			Scalar TNear;
+		};
+
+		/** Collapses the binary subtree below an inner node into mNodes and returns the wide node index. */
+		uint32_t CollapseNode(const FBVH& bvh, uint32_t binaryNode);
+
+		std::vector<FNode> mNodes;
+		std::vector<uint32_t> mPrimitiveIndices;
+		FBoundingBox mBounds;
+	};
+
+	using FBVH4 = TWideBVH<4>;
+	using FBVH8 = TWideBVH<8>;
+
+
+
+
+	// Member Function
+
+	// --Implementation-- //
+
+	template<uint32_t Width>
+	FORCEINLINE FBoundingBox TWideBVHNode<Width>::GetChildBounds(uint32_t child) const
+	{
+		FBoundingBox bounds;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			bounds.Lower[axis] = Origin[axis] + Lower[axis][child] * Scale[axis];
+			bounds.Upper[axis] = Origin[axis] + Upper[axis][child] * Scale[axis];
+		}
+		return bounds;
+	}
+
+	template<uint32_t Width>
+	template<typename Func>
+	FORCEINLINE bool TWideBVH<Width>::Intersect(const FRay& r, Func&& intersect) const
+	{
+		if (mNodes.empty())
+		{
+			return false;
+		}
+
+		FRay ray = r;
+		FRayData rayData{ ray.Origin, FVector3f{ Scalar{ 1 } / ray.Direction.x, Scalar{ 1 } / ray.Direction.y, Scalar{ 1 } / ray.Direction.z }, ray.TMin, ray.TMax };
+
+		FStackEntry stack[MaxStackSize];
+		size_t stackSize = 0;
+		stack[stackSize++] = FStackEntry{ 0, 0, ray.TMin };
+
+		bool hit = false;
+		while (stackSize > 0)
+		{
+			const FStackEntry entry = stack[--stackSize];
+			if (entry.TNear > ray.TMax)
+			{
+				continue;
+			}
+
+			if (entry.PrimitiveCount > 0)
+			{
+				for (uint32_t i = 0; i < entry.PrimitiveCount; ++i)
+				{
+					hit |= intersect(mPrimitiveIndices[entry.Item + i], ray);
+				}
+				continue;
+			}
+
+			const FNode& node = mNodes[entry.Item];
+
+			rayData.TMax = ray.TMax;
+			Scalar tNear[Width];
+			const uint32_t mask = IntersectChildren(node, rayData, tNear);
+
+			// hit children sorted far to near, so the nearest is popped first
+			const size_t first = stackSize;
+			for (uint32_t child = 0; child < node.ChildCount; ++child)
+			{
+				if ((mask >> child) & 1)
+				{
+					size_t slot = stackSize++;
+					for (; slot > first && stack[slot - 1].TNear < tNear[child]; --slot)
+					{
+						stack[slot] = stack[slot - 1];
+					}
+					stack[slot] = FStackEntry{ node.Child[child], node.PrimitiveCount[child], tNear[child] };
+				}
+			}
+
+			ASSERT(stackSize <= MaxStackSize);
+		}
+
+		return hit;
+	}
+
+	template<uint32_t Width>
+	template<typename Func>
+	FORCEINLINE void TWideBVH<Width>::QueryOverlaps(const FBoundingBox& box, Func&& func) const
+	{
+		if (mNodes.empty() || !FMath::Overlaps(mBounds, box))
+		{
+			return;
+		}
+
+		uint32_t stack[MaxStackSize];
+		size_t stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const FNode& node = mNodes[stack[--stackSize]];
+			const uint32_t mask = OverlapChildren(node, box);
+
+			for (uint32_t child = 0; child < node.ChildCount; ++child)
+			{
+				if (((mask >> child) & 1) == 0)
+				{
+					continue;
+				}
+
+				if (node.IsLeaf(child))
+				{
+					for (uint32_t i = 0; i < node.PrimitiveCount[child]; ++i)
+					{
+						func(mPrimitiveIndices[node.Child[child] + i]);
+					}
+				}
+				else
+				{
+					stack[stackSize++] = node.Child[child];
+				}
+			}
+
+			ASSERT(stackSize <= MaxStackSize);
+		}
+	}
+}
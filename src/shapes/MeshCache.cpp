@@ -0,0 +1,285 @@
+#include "MeshCache.h"
+#include "../utility/LogManager.h"
+#include <fstream>
+
+namespace Dash
+{
+	namespace
+	{
+		std::uint64_t AlignSection(std::uint64_t offset)
+		{
+			const std::uint64_t alignment = FMeshCacheHeader::SectionAlignment;
+			return (offset + alignment - 1) / alignment * alignment;
+		}
+
+		bool IsSectionValid(std::uint64_t offset, std::uint64_t size, std::uint64_t fileSize)
+		{
+			return offset % FMeshCacheHeader::SectionAlignment == 0 && offset <= fileSize && size <= fileSize - offset;
+		}
+
+		void WritePadding(std::ofstream& output, std::uint64_t offset)
+		{
+			static const char zeros[FMeshCacheHeader::SectionAlignment] = {};
+			const std::uint64_t position = static_cast<std::uint64_t>(output.tellp());
+			output.write(zeros, static_cast<std::streamsize>(offset - position));
+		}
+	}
+
+	bool SaveMeshCache(const std::string& fileName, const TriangleMesh& mesh)
+	{
+		if (mesh.IndexType != EDASH_FORMAT::R16_UINT && mesh.IndexType != EDASH_FORMAT::R32_UINT)
+		{
+			LOG_ERROR << "Mesh cache doesn't support the index format " << static_cast<uint32_t>(mesh.IndexType);
+			return false;
+		}
+
+		FMeshCacheHeader header;
+		header.VertexStride = static_cast<std::uint32_t>(mesh.VertexStride);
+		header.IndexType = static_cast<std::uint32_t>(mesh.IndexType);
+		header.VertexCount = mesh.NumVertices;
+		header.IndexCount = mesh.NumIndices;
+		header.ElementCount = static_cast<std::uint32_t>(mesh.InputElements.size());
+		header.PartCount = static_cast<std::uint32_t>(mesh.MeshParts.size());
+		header.VertexBytes = std::uint64_t(mesh.NumVertices) * mesh.VertexStride;
+		header.IndexBytes = std::uint64_t(mesh.NumIndices) * GetByteSizeForFormat(mesh.IndexType);
+		ASSERT(header.VertexBytes <= mesh.Vertices.size() && header.IndexBytes <= mesh.Indices.size());
+
+		FBoundingBox bounds;
+		const FVertexAttributeHandle positionHandle = mesh.FindVertexAttribute(VertexAttribute::Position::Name);
+		if (positionHandle.IsValid() && positionHandle.Format == VertexAttribute::Position::Format)
+		{
+			for (const FVector3f& p : mesh.GetVertexAttribute<FVector3f>(positionHandle))
+			{
+				for (size_t k = 0; k < 3; ++k)
+				{
+					bounds.Lower[k] = FMath::Min(bounds.Lower[k], p[k]);
+					bounds.Upper[k] = FMath::Max(bounds.Upper[k], p[k]);
+				}
+			}
+		}
+		for (size_t k = 0; k < 3; ++k)
+		{
+			header.BoundsLower[k] = bounds.Lower[k];
+			header.BoundsUpper[k] = bounds.Upper[k];
+		}
+
+		std::vector<FMeshCacheElement> elements(mesh.InputElements.size());
+		for (size_t i = 0; i < elements.size(); ++i)
+		{
+			const InputLayoutElement& element = mesh.InputElements[i];
+			if (element.SemanticName.size() >= sizeof(elements[i].SemanticName))
+			{
+				LOG_ERROR << "Semantic name is too long for the mesh cache " << element.SemanticName.c_str();
+				return false;
+			}
+
+			std::memcpy(elements[i].SemanticName, element.SemanticName.c_str(), element.SemanticName.size());
+			elements[i].SemanticIndex = static_cast<std::uint32_t>(element.SemanticIndex);
+			elements[i].Format = static_cast<std::uint32_t>(element.Format);
+			elements[i].Offset = static_cast<std::uint32_t>(element.AlignedByteOffset);
+		}
+
+		std::vector<FMeshCachePart> parts(mesh.MeshParts.size());
+		for (size_t i = 0; i < parts.size(); ++i)
+		{
+			const MeshPart& part = mesh.MeshParts[i];
+			parts[i] = FMeshCachePart{ part.VertexStart, part.VertexCount, part.IndexStart, part.IndexCount, part.MaterialIdx };
+		}
+
+		header.ElementsOffset = AlignSection(sizeof(FMeshCacheHeader));
+		header.PartsOffset = AlignSection(header.ElementsOffset + elements.size() * sizeof(FMeshCacheElement));
+		header.VerticesOffset = AlignSection(header.PartsOffset + parts.size() * sizeof(FMeshCachePart));
+		header.IndicesOffset = AlignSection(header.VerticesOffset + header.VertexBytes);
+		header.FileSize = header.IndicesOffset + header.IndexBytes;
+
+		std::ofstream output(fileName, std::ios::binary);
+		if (!output)
+		{
+			LOG_ERROR << "Can't create mesh cache " << fileName.c_str();
+			return false;
+		}
+
+		output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		WritePadding(output, header.ElementsOffset);
+		output.write(reinterpret_cast<const char*>(elements.data()), elements.size() * sizeof(FMeshCacheElement));
+		WritePadding(output, header.PartsOffset);
+		output.write(reinterpret_cast<const char*>(parts.data()), parts.size() * sizeof(FMeshCachePart));
+		WritePadding(output, header.VerticesOffset);
+		output.write(reinterpret_cast<const char*>(mesh.Vertices.data()), static_cast<std::streamsize>(header.VertexBytes));
+		WritePadding(output, header.IndicesOffset);
+		output.write(reinterpret_cast<const char*>(mesh.Indices.data()), static_cast<std::streamsize>(header.IndexBytes));
+
+		if (!output)
+		{
+			LOG_ERROR << "Failed to write mesh cache " << fileName.c_str();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool FMeshCache::Open(const std::string& fileName)
+	{
+		Close();
+
+		if (!mFile.Open(fileName))
+		{
+			return false;
+		}
+
+		const std::uint64_t fileSize = mFile.GetSize();
+		const FMeshCacheHeader* header = reinterpret_cast<const FMeshCacheHeader*>(mFile.GetData());
+
+		auto fail = [&](const char* reason)
+		{
+			LOG_ERROR << "Invalid mesh cache " << fileName.c_str() << ": " << reason;
+			mFile.Close();
+			return false;
+		};
+
+		if (fileSize < sizeof(FMeshCacheHeader) || header->Magic != FMeshCacheHeader::MagicNumber)
+		{
+			return fail("not a mesh cache");
+		}
+
+		if (header->Version != FMeshCacheHeader::CurrentVersion)
+		{
+			return fail("unsupported version");
+		}
+
+		if (header->FileSize != fileSize)
+		{
+			return fail("truncated file");
+		}
+
+		const EDASH_FORMAT indexType = static_cast<EDASH_FORMAT>(header->IndexType);
+		if (indexType != EDASH_FORMAT::R16_UINT && indexType != EDASH_FORMAT::R32_UINT)
+		{
+			return fail("unsupported index format");
+		}
+
+		if (header->VertexStride == 0 || header->VertexBytes / header->VertexStride != header->VertexCount || header->VertexBytes % header->VertexStride != 0
+			|| header->IndexBytes != header->IndexCount * GetByteSizeForFormat(indexType))
+		{
+			return fail("inconsistent buffer sizes");
+		}
+
+		if (!IsSectionValid(header->ElementsOffset, std::uint64_t(header->ElementCount) * sizeof(FMeshCacheElement), fileSize)
+			|| !IsSectionValid(header->PartsOffset, std::uint64_t(header->PartCount) * sizeof(FMeshCachePart), fileSize)
+			|| !IsSectionValid(header->VerticesOffset, header->VertexBytes, fileSize)
+			|| !IsSectionValid(header->IndicesOffset, header->IndexBytes, fileSize))
+		{
+			return fail("section out of range");
+		}
+
+		mHeader = header;
+
+		const FMeshCacheElement* elements = GetElements();
+		for (std::uint32_t i = 0; i < header->ElementCount; ++i)
+		{
+			const FMeshCacheElement& element = elements[i];
+			if (element.SemanticName[sizeof(element.SemanticName) - 1] != '\0'
+				|| element.Offset + GetByteSizeForFormat(static_cast<EDASH_FORMAT>(element.Format)) > header->VertexStride)
+			{
+				mHeader = nullptr;
+				return fail("invalid vertex element");
+			}
+		}
+
+		const FMeshCachePart* parts = GetParts();
+		for (std::uint32_t i = 0; i < header->PartCount; ++i)
+		{
+			const FMeshCachePart& part = parts[i];
+			if (part.VertexStart > header->VertexCount || part.VertexCount > header->VertexCount - part.VertexStart
+				|| part.IndexStart > header->IndexCount || part.IndexCount > header->IndexCount - part.IndexStart)
+			{
+				mHeader = nullptr;
+				return fail("mesh part out of range");
+			}
+		}
+
+		return true;
+	}
+
+	void FMeshCache::Close()
+	{
+		mFile.Close();
+		mHeader = nullptr;
+	}
+
+	FBoundingBox FMeshCache::GetBounds() const
+	{
+		FBoundingBox bounds;
+		for (size_t k = 0; k < 3; ++k)
+		{
+			bounds.Lower[k] = mHeader->BoundsLower[k];
+			bounds.Upper[k] = mHeader->BoundsUpper[k];
+		}
+		return bounds;
+	}
+
+	std::vector<InputLayoutElement> FMeshCache::GetInputElements() const
+	{
+		std::vector<InputLayoutElement> elements;
+		elements.reserve(mHeader->ElementCount);
+
+		const FMeshCacheElement* cached = GetElements();
+		for (std::uint32_t i = 0; i < mHeader->ElementCount; ++i)
+		{
+			elements.emplace_back(cached[i].SemanticName, cached[i].SemanticIndex, static_cast<EDASH_FORMAT>(cached[i].Format), cached[i].Offset);
+		}
+		return elements;
+	}
+
+	std::vector<MeshPart> FMeshCache::GetMeshParts() const
+	{
+		std::vector<MeshPart> parts;
+		parts.reserve(mHeader->PartCount);
+
+		const FMeshCachePart* cached = GetParts();
+		for (std::uint32_t i = 0; i < mHeader->PartCount; ++i)
+		{
+			const FMeshCachePart& part = cached[i];
+			parts.emplace_back(static_cast<std::size_t>(part.VertexStart), static_cast<std::size_t>(part.VertexCount),
+				static_cast<std::size_t>(part.IndexStart), static_cast<std::size_t>(part.IndexCount), static_cast<std::size_t>(part.MaterialIdx));
+		}
+		return parts;
+	}
+
+	FVertexAttributeHandle FMeshCache::FindVertexAttribute(const std::string& name) const
+	{
+		FVertexAttributeHandle handle;
+
+		const FMeshCacheElement* elements = GetElements();
+		for (std::uint32_t i = 0; i < mHeader->ElementCount; ++i)
+		{
+			if (name == elements[i].SemanticName)
+			{
+				handle.Offset = elements[i].Offset;
+				handle.Format = static_cast<EDASH_FORMAT>(elements[i].Format);
+				break;
+			}
+		}
+		return handle;
+	}
+
+	std::shared_ptr<TriangleMesh> FMeshCache::CreateTriangleMesh(std::pmr::memory_resource* resource) const
+	{
+		ASSERT(IsOpen());
+
+		std::shared_ptr<TriangleMesh> mesh = std::allocate_shared<TriangleMesh>(std::pmr::polymorphic_allocator<TriangleMesh>(resource), resource);
+		mesh->InputElements = GetInputElements();
+		for (const InputLayoutElement& element : mesh->InputElements)
+		{
+			mesh->InputElementMap.emplace(element.SemanticName, element.AlignedByteOffset);
+		}
+		mesh->MeshParts = GetMeshParts();
+		mesh->VertexStride = GetVertexStride();
+		mesh->NumVertices = GetVertexCount();
+		mesh->NumIndices = GetIndexCount();
+		mesh->IndexType = GetIndexType();
+		mesh->Vertices.assign(GetVertexData(), GetVertexData() + GetVertexDataSize());
+		mesh->Indices.assign(GetIndexData(), GetIndexData() + GetIndexDataSize());
+		return mesh;
+	}
+}
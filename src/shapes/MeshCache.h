@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Shape.h"
+#include "../utility/MappedFile.h"
+
+namespace Dash
+{
+	/**
+	 * On-disk layout of a cached TriangleMesh, little endian. The header is followed by the element, part, vertex and
+	 * index sections, each starting on a SectionAlignment boundary so the blobs can be used straight from the mapping.
+	 */
+	struct FMeshCacheHeader
+	{
+		static constexpr std::uint32_t MagicNumber = 0x48534D44; // "DMSH"
+		static constexpr std::uint32_t CurrentVersion = 1;
+		static constexpr std::uint64_t SectionAlignment = 64;
+
+		std::uint32_t Magic = MagicNumber;
+		std::uint32_t Version = CurrentVersion;
+		std::uint64_t FileSize = 0;
+
+		std::uint32_t VertexStride = 0;
+		std::uint32_t IndexType = 0;
+		std::uint64_t VertexCount = 0;
+		std::uint64_t IndexCount = 0;
+
+		std::uint32_t ElementCount = 0;
+		std::uint32_t PartCount = 0;
+
+		float BoundsLower[3] = {};
+		float BoundsUpper[3] = {};
+
+		std::uint64_t ElementsOffset = 0;
+		std::uint64_t PartsOffset = 0;
+		std::uint64_t VerticesOffset = 0;
+		std::uint64_t VertexBytes = 0;
+		std::uint64_t IndicesOffset = 0;
+		std::uint64_t IndexBytes = 0;
+	};
+
+	struct FMeshCacheElement
+	{
+		char SemanticName[32] = {};
+		std::uint32_t SemanticIndex = 0;
+		std::uint32_t Format = 0;
+		std::uint32_t Offset = 0;
+		std::uint32_t Padding = 0;
+	};
+
+	struct FMeshCachePart
+	{
+		std::uint64_t VertexStart = 0;
+		std::uint64_t VertexCount = 0;
+		std::uint64_t IndexStart = 0;
+		std::uint64_t IndexCount = 0;
+		std::uint64_t MaterialIdx = 0;
+	};
+
+	/** Writes the mesh with its layout, parts and position bounds. */
+	bool SaveMeshCache(const std::string& fileName, const TriangleMesh& mesh);
+
+	/**
+	 * Memory-mapped mesh cache. Open only validates the header and section table, vertex and index data stay in the
+	 * mapping and are paged in on first use. Spans handed out are valid while the cache stays open.
+	 */
+	class FMeshCache
+	{
+	public:
+		FMeshCache() = default;
+
+		bool Open(const std::string& fileName);
+
+		void Close();
+
+		bool IsOpen() const { return mHeader != nullptr; }
+
+		const FMeshCacheHeader& GetHeader() const { return *mHeader; }
+
+		std::size_t GetVertexStride() const { return mHeader->VertexStride; }
+		std::size_t GetVertexCount() const { return static_cast<std::size_t>(mHeader->VertexCount); }
+		std::size_t GetIndexCount() const { return static_cast<std::size_t>(mHeader->IndexCount); }
+		EDASH_FORMAT GetIndexType() const { return static_cast<EDASH_FORMAT>(mHeader->IndexType); }
+
+		FBoundingBox GetBounds() const;
+
+		std::vector<InputLayoutElement> GetInputElements() const;
+
+		std::vector<MeshPart> GetMeshParts() const;
+
+		const std::uint8_t* GetVertexData() const { return mFile.GetData() + mHeader->VerticesOffset; }
+		std::size_t GetVertexDataSize() const { return static_cast<std::size_t>(mHeader->VertexBytes); }
+
+		const std::uint8_t* GetIndexData() const { return mFile.GetData() + mHeader->IndicesOffset; }
+		std::size_t GetIndexDataSize() const { return static_cast<std::size_t>(mHeader->IndexBytes); }
+
+		FVertexAttributeHandle FindVertexAttribute(const std::string& name) const;
+
+		/** Strided span over one attribute, pointing into the mapping. */
+		template<typename T>
+		TStridedSpan<const T> GetVertexAttribute(const FVertexAttributeHandle& handle) const
+		{
+			ASSERT(handle.IsValid() && handle.Format == GetFormatForType<T>());
+			return TStridedSpan<const T>(GetVertexData() + handle.Offset, GetVertexCount(), GetVertexStride());
+		}
+
+		/** Copies the cached mesh into a TriangleMesh allocated from resource, for code that needs to modify it. */
+		std::shared_ptr<TriangleMesh> CreateTriangleMesh(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+	private:
+		const FMeshCacheElement* GetElements() const { return reinterpret_cast<const FMeshCacheElement*>(mFile.GetData() + mHeader->ElementsOffset); }
+		const FMeshCachePart* GetParts() const { return reinterpret_cast<const FMeshCachePart*>(mFile.GetData() + mHeader->PartsOffset); }
+
+		FMappedFile mFile;
+		const FMeshCacheHeader* mHeader = nullptr;
+	};
+}
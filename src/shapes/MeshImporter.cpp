@@ -0,0 +1,970 @@
+#include "MeshImporter.h"
+#include "MeshTangents.h"
+#include "../utility/MappedFile.h"
+#include "../utility/ParallelFor.h"
+#include "../utility/LogManager.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <climits>
+#include <sstream>
+
+namespace Dash
+{
+	namespace
+	{
+		constexpr uint32_t MissingIndex = ~0u;
+
+		/** Attributes of the imported vertices, one entry per output vertex. */
+		struct FImportedGeometry
+		{
+			std::vector<FVector3f> Positions;
+			std::vector<FVector3f> Normals;
+			std::vector<FVector2f> TexCoords;
+			std::vector<uint8_t> HasNormal;
+
+			/** Source position of each vertex, generated normals are shared by vertices with the same id. */
+			std::vector<uint32_t> PositionIds;
+			std::size_t PositionCount = 0;
+
+			std::vector<uint32_t> Indices;
+
+			/** Material of each triangle, empty when there is only one. */
+			std::vector<uint32_t> TriangleMaterials;
+			std::size_t MaterialCount = 1;
+		};
+
+		std::shared_ptr<TriangleMesh> BuildMesh(FImportedGeometry& geometry, const FMeshImportSettings& settings, std::pmr::memory_resource* resource)
+		{
+			const std::size_t vertexCount = geometry.Positions.size();
+			const std::size_t triangleCount = geometry.Indices.size() / 3;
+
+			const bool anyMissing = std::find(geometry.HasNormal.begin(), geometry.HasNormal.end(), uint8_t{ 0 }) != geometry.HasNormal.end();
+			if (settings.GenerateNormals && anyMissing)
+			{
+				std::vector<FVector3f> accumulated(geometry.PositionCount, FVector3f{ 0, 0, 0 });
+				for (std::size_t t = 0; t < triangleCount; ++t)
+				{
+					const uint32_t* triangle = geometry.Indices.data() + t * 3;
+					const FVector3f& p0 = geometry.Positions[triangle[0]];
+					const FVector3f normal = FMath::Cross(geometry.Positions[triangle[1]] - p0, geometry.Positions[triangle[2]] - p0);
+					for (std::size_t k = 0; k < 3; ++k)
+					{
+						accumulated[geometry.PositionIds[triangle[k]]] += normal;
+					}
+				}
+
+				for (std::size_t v = 0; v < vertexCount; ++v)
+				{
+					if (!geometry.HasNormal[v])
+					{
+						const FVector3f& normal = accumulated[geometry.PositionIds[v]];
+						const Scalar length = FMath::Length(normal);
+						geometry.Normals[v] = length > 0 ? normal * (Scalar{ 1 } / length) : FVector3f{ 0, 0, 1 };
+					}
+				}
+			}
+
+			std::shared_ptr<TriangleMesh> mesh = std::allocate_shared<TriangleMesh>(std::pmr::polymorphic_allocator<TriangleMesh>(resource), resource);
+			mesh->SetVertexLayout<FStandardVertexLayout>();
+			mesh->NumVertices = vertexCount;
+			mesh->Vertices.resize(vertexCount * FStandardVertexLayout::Stride);
+
+			TStridedSpan<FVector3f> positions = mesh->GetVertexAttribute<FStandardVertexLayout, VertexAttribute::Position>();
+			TStridedSpan<FVector3f> normals = mesh->GetVertexAttribute<FStandardVertexLayout, VertexAttribute::Normal>();
+			TStridedSpan<FVector3f> tangents = mesh->GetVertexAttribute<FStandardVertexLayout, VertexAttribute::Tangent>();
+			TStridedSpan<FVector2f> texCoords = mesh->GetVertexAttribute<FStandardVertexLayout, VertexAttribute::TexCoord>();
+
+			ParallelFor(0, vertexCount, [&](std::size_t v)
+			{
+				positions[v] = geometry.Positions[v];
+				normals[v] = geometry.Normals[v];
+				tangents[v] = FVector3f{ 0, 0, 0 };
+
+				FVector2f texCoord = geometry.TexCoords[v];
+				if (settings.FlipTexCoordV)
+				{
+					texCoord.y = Scalar{ 1 } - texCoord.y;
+				}
+				texCoords[v] = texCoord;
+			}, 4096);
+
+			// group triangles by material with a stable counting sort
+			std::vector<std::size_t> materialStarts(geometry.MaterialCount + 1, 0);
+			std::vector<uint32_t> sorted;
+			const uint32_t* indices = geometry.Indices.data();
+			if (!geometry.TriangleMaterials.empty())
+			{
+				for (uint32_t material : geometry.TriangleMaterials)
+				{
+					materialStarts[material + 1]++;
+				}
+				for (std::size_t m = 0; m < geometry.MaterialCount; ++m)
+				{
+					materialStarts[m + 1] += materialStarts[m];
+				}
+
+				sorted.resize(geometry.Indices.size());
+				std::vector<std::size_t> cursor(materialStarts.begin(), materialStarts.end() - 1);
+				for (std::size_t t = 0; t < triangleCount; ++t)
+				{
+					std::memcpy(sorted.data() + cursor[geometry.TriangleMaterials[t]]++ * 3, indices + t * 3, 3 * sizeof(uint32_t));
+				}
+				indices = sorted.data();
+			}
+			else
+			{
+				materialStarts[1] = triangleCount;
+			}
+
+			mesh->NumIndices = geometry.Indices.size();
+			mesh->IndexType = vertexCount <= 0xFFFF ? EDASH_FORMAT::R16_UINT : EDASH_FORMAT::R32_UINT;
+			mesh->Indices.resize(mesh->NumIndices * GetByteSizeForFormat(mesh->IndexType));
+			mesh->WriteIndices(indices, 0, mesh->NumIndices);
+
+			for (std::size_t m = 0; m < geometry.MaterialCount; ++m)
+			{
+				const std::size_t count = materialStarts[m + 1] - materialStarts[m];
+				if (count > 0)
+				{
+					mesh->MeshParts.emplace_back(0, vertexCount, materialStarts[m] * 3, count * 3, m);
+				}
+			}
+
+			if (settings.GenerateTangents)
+			{
+				GenerateTangents(*mesh);
+			}
+
+			return mesh;
+		}
+
+		// -- OBJ -- //
+
+		/** Face corner as written, negative indices are stored relative to the chunk's first element. */
+		struct FOBJCorner
+		{
+			int32_t Index[3];
+			uint32_t RelativeMask;
+		};
+
+		struct FOBJChunk
+		{
+			std::vector<FVector3f> Positions;
+			std::vector<FVector2f> TexCoords;
+			std::vector<FVector3f> Normals;
+
+			std::vector<FOBJCorner> Corners;
+			std::vector<uint32_t> FaceSizes;
+
+			/** usemtl statements as (first face of the chunk using it, material name). */
+			std::vector<std::pair<std::size_t, std::string>> MaterialChanges;
+
+			/** Start of the first malformed line. */
+			const char* Error = nullptr;
+		};
+
+		FORCEINLINE bool IsBlank(char c)
+		{
+			return c == ' ' || c == '\t' || c == '\r';
+		}
+
+		FORCEINLINE const char* SkipBlanks(const char* p, const char* end)
+		{
+			while (p < end && IsBlank(*p))
+			{
+				++p;
+			}
+			return p;
+		}
+
+		FORCEINLINE bool ParseFloat(const char*& p, const char* end, float& value)
+		{
+			p = SkipBlanks(p, end);
+			if (p < end && *p == '+')
+			{
+				++p;
+			}
+
+			const std::from_chars_result result = std::from_chars(p, end, value);
+			if (result.ec != std::errc())
+			{
+				return false;
+			}
+
+			p = result.ptr;
+			return true;
+		}
+
+		FORCEINLINE bool ParseIndex(const char*& p, const char* end, int32_t& value)
+		{
+			const std::from_chars_result result = std::from_chars(p, end, value);
+			if (result.ec != std::errc() || value == 0)
+			{
+				return false;
+			}
+
+			p = result.ptr;
+			return true;
+		}
+
+		/** One based index to zero based, negative ones stay relative to the chunk. */
+		FORCEINLINE void SetCornerIndex(FOBJCorner& corner, std::size_t slot, int32_t value, std::size_t localCount)
+		{
+			if (value > 0)
+			{
+				corner.Index[slot] = value - 1;
+			}
+			else
+			{
+				corner.Index[slot] = static_cast<int32_t>(localCount) + value;
+				corner.RelativeMask |= 1u << slot;
+			}
+		}
+
+		void ParseOBJChunk(const char* begin, const char* end, FOBJChunk& chunk)
+		{
+			const char* p = begin;
+			while (p < end)
+			{
+				const char* lineStart = p;
+				p = SkipBlanks(p, end);
+				const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+				if (lineEnd == nullptr)
+				{
+					lineEnd = end;
+				}
+
+				const std::size_t length = lineEnd - p;
+				bool valid = true;
+
+				if (length >= 2 && p[0] == 'v' && IsBlank(p[1]))
+				{
+					FVector3f position;
+					p += 1;
+					valid = ParseFloat(p, lineEnd, position.x) && ParseFloat(p, lineEnd, position.y) && ParseFloat(p, lineEnd, position.z);
+					chunk.Positions.push_back(position);
+				}
+				else if (length >= 3 && p[0] == 'v' && p[1] == 't' && IsBlank(p[2]))
+				{
+					FVector2f texCoord{ 0, 0 };
+					p += 2;
+					valid = ParseFloat(p, lineEnd, texCoord.x);
+					if (valid && SkipBlanks(p, lineEnd) < lineEnd)
+					{
+						valid = ParseFloat(p, lineEnd, texCoord.y);
+					}
+					chunk.TexCoords.push_back(texCoord);
+				}
+				else if (length >= 3 && p[0] == 'v' && p[1] == 'n' && IsBlank(p[2]))
+				{
+					FVector3f normal;
+					p += 2;
+					valid = ParseFloat(p, lineEnd, normal.x) && ParseFloat(p, lineEnd, normal.y) && ParseFloat(p, lineEnd, normal.z);
+					chunk.Normals.push_back(normal);
+				}
+				else if (length >= 2 && p[0] == 'f' && IsBlank(p[1]))
+				{
+					p += 1;
+					uint32_t cornerCount = 0;
+					for (p = SkipBlanks(p, lineEnd); p < lineEnd && valid; p = SkipBlanks(p, lineEnd))
+					{
+						FOBJCorner corner{ { 0, INT32_MIN, INT32_MIN }, 0 };
+
+						int32_t value = 0;
+						valid = ParseIndex(p, lineEnd, value);
+						if (valid)
+						{
+							SetCornerIndex(corner, 0, value, chunk.Positions.size());
+						}
+
+						if (valid && p < lineEnd && *p == '/')
+						{
+							++p;
+							if (p < lineEnd && *p != '/')
+							{
+								valid = ParseIndex(p, lineEnd, value);
+								if (valid)
+								{
+									SetCornerIndex(corner, 1, value, chunk.TexCoords.size());
+								}
+							}
+							if (valid && p < lineEnd && *p == '/')
+							{
+								++p;
+								valid = ParseIndex(p, lineEnd, value);
+								if (valid)
+								{
+									SetCornerIndex(corner, 2, value, chunk.Normals.size());
+								}
+							}
+						}
+
+						chunk.Corners.push_back(corner);
+						cornerCount++;
+					}
+
+					valid = valid && cornerCount >= 3;
+					chunk.FaceSizes.push_back(cornerCount);
+				}
+				else if (length > 7 && std::memcmp(p, "usemtl", 6) == 0 && IsBlank(p[6]))
+				{
+					const char* name = SkipBlanks(p + 6, lineEnd);
+					const char* nameEnd = lineEnd;
+					while (nameEnd > name && IsBlank(nameEnd[-1]))
+					{
+						--nameEnd;
+					}
+					chunk.MaterialChanges.emplace_back(chunk.FaceSizes.size(), std::string(name, nameEnd));
+				}
+
+				if (!valid)
+				{
+					chunk.Error = lineStart;
+					return;
+				}
+
+				p = lineEnd + 1;
+			}
+		}
+
+		struct FVertexKey
+		{
+			uint32_t Position;
+			uint32_t TexCoord;
+			uint32_t Normal;
+
+			bool operator==(const FVertexKey& other) const
+			{
+				return Position == other.Position && TexCoord == other.TexCoord && Normal == other.Normal;
+			}
+		};
+
+		/** Open addressing table from corner keys to vertex indices, sized so it never exceeds 3/4 load. */
+		class FVertexDeduplicator
+		{
+		public:
+			explicit FVertexDeduplicator(std::size_t maxVertices)
+			{
+				std::size_t capacity = 16;
+				while (capacity * 3 < maxVertices * 4)
+				{
+					capacity *= 2;
+				}
+				mSlots.assign(capacity, MissingIndex);
+				Keys.reserve(maxVertices);
+			}
+
+			uint32_t Insert(const FVertexKey& key)
+			{
+				const std::size_t mask = mSlots.size() - 1;
+				uint32_t hash = key.Position * 0x9E3779B1u ^ key.TexCoord * 0x85EBCA77u ^ key.Normal * 0xC2B2AE3Du;
+				hash ^= hash >> 15;
+
+				for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask)
+				{
+					const uint32_t vertex = mSlots[slot];
+					if (vertex == MissingIndex)
+					{
+						mSlots[slot] = static_cast<uint32_t>(Keys.size());
+						Keys.push_back(key);
+						return mSlots[slot];
+					}
+
+					if (Keys[vertex] == key)
+					{
+						return vertex;
+					}
+				}
+			}
+
+			std::vector<FVertexKey> Keys;
+
+		private:
+			std::vector<uint32_t> mSlots;
+		};
+
+		// -- PLY -- //
+
+		enum class EPLYType : uint8_t
+		{
+			Int8,
+			UInt8,
+			Int16,
+			UInt16,
+			Int32,
+			UInt32,
+			Float32,
+			Float64,
+			Invalid,
+		};
+
+		struct FPLYProperty
+		{
+			std::string Name;
+			EPLYType Type = EPLYType::Invalid;
+
+			/** Count type of list properties, Invalid for scalars. */
+			EPLYType CountType = EPLYType::Invalid;
+		};
+
+		struct FPLYElement
+		{
+			std::string Name;
+			std::size_t Count = 0;
+			std::vector<FPLYProperty> Properties;
+		};
+
+		EPLYType ParsePLYType(const std::string& name)
+		{
+			if (name == "char" || name == "int8") return EPLYType::Int8;
+			if (name == "uchar" || name == "uint8") return EPLYType::UInt8;
+			if (name == "short" || name == "int16") return EPLYType::Int16;
+			if (name == "ushort" || name == "uint16") return EPLYType::UInt16;
+			if (name == "int" || name == "int32") return EPLYType::Int32;
+			if (name == "uint" || name == "uint32") return EPLYType::UInt32;
+			if (name == "float" || name == "float32") return EPLYType::Float32;
+			if (name == "double" || name == "float64") return EPLYType::Float64;
+			return EPLYType::Invalid;
+		}
+
+		std::size_t GetPLYTypeSize(EPLYType type)
+		{
+			switch (type)
+			{
+			case EPLYType::Int8:
+			case EPLYType::UInt8:
+				return 1;
+			case EPLYType::Int16:
+			case EPLYType::UInt16:
+				return 2;
+			case EPLYType::Int32:
+			case EPLYType::UInt32:
+			case EPLYType::Float32:
+				return 4;
+			case EPLYType::Float64:
+				return 8;
+			default:
+				return 0;
+			}
+		}
+
+		template<typename T>
+		FORCEINLINE T LoadPLYScalar(const uint8_t* p, bool swap)
+		{
+			uint8_t bytes[sizeof(T)];
+			std::memcpy(bytes, p, sizeof(T));
+			if (swap)
+			{
+				std::reverse(bytes, bytes + sizeof(T));
+			}
+
+			T value;
+			std::memcpy(&value, bytes, sizeof(T));
+			return value;
+		}
+
+		FORCEINLINE double LoadPLYValue(const uint8_t* p, EPLYType type, bool swap)
+		{
+			switch (type)
+			{
+			case EPLYType::Int8: return static_cast<int8_t>(*p);
+			case EPLYType::UInt8: return *p;
+			case EPLYType::Int16: return LoadPLYScalar<int16_t>(p, swap);
+			case EPLYType::UInt16: return LoadPLYScalar<uint16_t>(p, swap);
+			case EPLYType::Int32: return LoadPLYScalar<int32_t>(p, swap);
+			case EPLYType::UInt32: return LoadPLYScalar<uint32_t>(p, swap);
+			case EPLYType::Float32: return LoadPLYScalar<float>(p, swap);
+			case EPLYType::Float64: return LoadPLYScalar<double>(p, swap);
+			default: return 0;
+			}
+		}
+
+		/** Size of one element record at p, list properties make it variable. Zero when it runs past end. */
+		std::size_t GetPLYRecordSize(const FPLYElement& element, const uint8_t* p, const uint8_t* end, bool swap)
+		{
+			const uint8_t* record = p;
+			for (const FPLYProperty& property : element.Properties)
+			{
+				if (property.CountType == EPLYType::Invalid)
+				{
+					p += GetPLYTypeSize(property.Type);
+				}
+				else
+				{
+					const std::size_t countSize = GetPLYTypeSize(property.CountType);
+					if (p + countSize > end)
+					{
+						return 0;
+					}
+					const std::size_t count = static_cast<std::size_t>(LoadPLYValue(p, property.CountType, swap));
+					p += countSize + count * GetPLYTypeSize(property.Type);
+				}
+
+				if (p > end)
+				{
+					return 0;
+				}
+			}
+			return p - record;
+		}
+
+		int FindPLYProperty(const FPLYElement& element, std::initializer_list<const char*> names)
+		{
+			for (const char* name : names)
+			{
+				for (std::size_t i = 0; i < element.Properties.size(); ++i)
+				{
+					if (element.Properties[i].Name == name)
+					{
+						return static_cast<int>(i);
+					}
+				}
+			}
+			return -1;
+		}
+	}
+
+	FMeshImportResult ParseOBJMesh(const char* data, std::size_t size, const FMeshImportSettings& settings, std::pmr::memory_resource* resource)
+	{
+		const char* end = data + size;
+
+		// chunk boundaries just past a newline
+		std::vector<const char*> boundaries{ data };
+		const std::size_t chunkSize = std::max<std::size_t>(settings.ChunkSize, 256);
+		while (end - boundaries.back() > static_cast<std::ptrdiff_t>(chunkSize))
+		{
+			const char* split = boundaries.back() + chunkSize;
+			const char* newline = static_cast<const char*>(std::memchr(split, '\n', end - split));
+			if (newline == nullptr)
+			{
+				break;
+			}
+			boundaries.push_back(newline + 1);
+		}
+		boundaries.push_back(end);
+
+		const std::size_t chunkCount = boundaries.size() - 1;
+		std::vector<FOBJChunk> chunks(chunkCount);
+		ParallelFor(0, chunkCount, [&](std::size_t c)
+		{
+			ParseOBJChunk(boundaries[c], boundaries[c + 1], chunks[c]);
+		});
+
+		FMeshImportResult result;
+
+		std::size_t positionCount = 0, texCoordCount = 0, normalCount = 0, cornerCount = 0, triangleCount = 0;
+		for (const FOBJChunk& chunk : chunks)
+		{
+			if (chunk.Error)
+			{
+				const char* lineEnd = static_cast<const char*>(std::memchr(chunk.Error, '\n', end - chunk.Error));
+				const std::size_t line = std::count(data, chunk.Error, '\n') + 1;
+				LOG_ERROR << "Malformed OBJ line " << line << ": " << std::string(chunk.Error, lineEnd ? lineEnd : end).c_str();
+				return result;
+			}
+
+			positionCount += chunk.Positions.size();
+			texCoordCount += chunk.TexCoords.size();
+			normalCount += chunk.Normals.size();
+			cornerCount += chunk.Corners.size();
+			for (uint32_t faceSize : chunk.FaceSizes)
+			{
+				triangleCount += faceSize - 2;
+			}
+		}
+
+		FImportedGeometry geometry;
+		geometry.PositionCount = positionCount;
+		geometry.Indices.reserve(triangleCount * 3);
+
+		std::vector<FVector3f> positions;
+		std::vector<FVector2f> texCoords;
+		std::vector<FVector3f> normals;
+		positions.reserve(positionCount);
+		texCoords.reserve(texCoordCount);
+		normals.reserve(normalCount);
+
+		std::vector<uint32_t> faceMaterials;
+		uint32_t currentMaterial = 0;
+		bool hasMaterials = false;
+
+		FVertexDeduplicator deduplicator(cornerCount);
+		std::vector<uint32_t> faceVertices;
+
+		for (const FOBJChunk& chunk : chunks)
+		{
+			const std::size_t bases[3] = { positions.size(), texCoords.size(), normals.size() };
+			positions.insert(positions.end(), chunk.Positions.begin(), chunk.Positions.end());
+			texCoords.insert(texCoords.end(), chunk.TexCoords.begin(), chunk.TexCoords.end());
+			normals.insert(normals.end(), chunk.Normals.begin(), chunk.Normals.end());
+			const std::size_t counts[3] = { positions.size(), texCoords.size(), normals.size() };
+
+			std::size_t materialChange = 0;
+			const FOBJCorner* corner = chunk.Corners.data();
+			for (std::size_t face = 0; face < chunk.FaceSizes.size(); ++face)
+			{
+				for (; materialChange < chunk.MaterialChanges.size() && chunk.MaterialChanges[materialChange].first == face; ++materialChange)
+				{
+					const std::string& name = chunk.MaterialChanges[materialChange].second;
+					const auto found = std::find(result.MaterialNames.begin(), result.MaterialNames.end(), name);
+					currentMaterial = static_cast<uint32_t>(found - result.MaterialNames.begin());
+					if (found == result.MaterialNames.end())
+					{
+						result.MaterialNames.push_back(name);
+					}
+					hasMaterials = true;
+				}
+
+				faceVertices.clear();
+				for (uint32_t i = 0; i < chunk.FaceSizes[face]; ++i, ++corner)
+				{
+					FVertexKey key{ MissingIndex, MissingIndex, MissingIndex };
+					uint32_t* keyIndices = &key.Position;
+					for (std::size_t slot = 0; slot < 3; ++slot)
+					{
+						if (corner->Index[slot] == INT32_MIN)
+						{
+							continue;
+						}
+
+						const int64_t index = int64_t(corner->Index[slot]) + ((corner->RelativeMask >> slot) & 1 ? int64_t(bases[slot]) : 0);
+						if (index < 0 || index >= int64_t(counts[slot]))
+						{
+							LOG_ERROR << "OBJ face references a missing element " << index + 1;
+							return FMeshImportResult{};
+						}
+						keyIndices[slot] = static_cast<uint32_t>(index);
+					}
+
+					if (key.Position == MissingIndex)
+					{
+						LOG_ERROR << "OBJ face corner without a position";
+						return FMeshImportResult{};
+					}
+
+					faceVertices.push_back(deduplicator.Insert(key));
+				}
+
+				for (std::size_t i = 2; i < faceVertices.size(); ++i)
+				{
+					geometry.Indices.push_back(faceVertices[0]);
+					geometry.Indices.push_back(faceVertices[i - 1]);
+					geometry.Indices.push_back(faceVertices[i]);
+					faceMaterials.push_back(currentMaterial);
+				}
+			}
+		}
+
+		if (hasMaterials)
+		{
+			geometry.TriangleMaterials = std::move(faceMaterials);
+			geometry.MaterialCount = std::max<std::size_t>(result.MaterialNames.size(), 1);
+		}
+		else
+		{
+			result.MaterialNames.clear();
+		}
+
+		const std::size_t vertexCount = deduplicator.Keys.size();
+		geometry.Positions.resize(vertexCount);
+		geometry.Normals.resize(vertexCount);
+		geometry.TexCoords.resize(vertexCount);
+		geometry.HasNormal.resize(vertexCount);
+		geometry.PositionIds.resize(vertexCount);
+
+		ParallelFor(0, vertexCount, [&](std::size_t v)
+		{
+			const FVertexKey& key = deduplicator.Keys[v];
+			geometry.Positions[v] = positions[key.Position];
+			geometry.PositionIds[v] = key.Position;
+			geometry.TexCoords[v] = key.TexCoord != MissingIndex ? texCoords[key.TexCoord] : FVector2f{ 0, 0 };
+			geometry.HasNormal[v] = key.Normal != MissingIndex ? 1 : 0;
+			geometry.Normals[v] = key.Normal != MissingIndex ? normals[key.Normal] : FVector3f{ 0, 0, 1 };
+		}, 4096);
+
+		result.Mesh = BuildMesh(geometry, settings, resource);
+		return result;
+	}
+
+	FMeshImportResult ImportOBJMesh(const std::string& fileName, const FMeshImportSettings& settings, std::pmr::memory_resource* resource)
+	{
+		FMappedFile file;
+		if (!file.Open(fileName))
+		{
+			return FMeshImportResult{};
+		}
+
+		return ParseOBJMesh(reinterpret_cast<const char*>(file.GetData()), file.GetSize(), settings, resource);
+	}
+
+	FMeshImportResult ParsePLYMesh(const uint8_t* data, std::size_t size, const FMeshImportSettings& settings, std::pmr::memory_resource* resource)
+	{
+		static const char EndHeader[] = "end_header";
+		const char* text = reinterpret_cast<const char*>(data);
+		const char* headerEnd = std::search(text, text + size, EndHeader, EndHeader + sizeof(EndHeader) - 1);
+		const char* bodyStart = headerEnd + sizeof(EndHeader) - 1;
+		bodyStart = bodyStart < text + size ? static_cast<const char*>(std::memchr(bodyStart, '\n', text + size - bodyStart)) : nullptr;
+		if (size < 3 || std::memcmp(data, "ply", 3) != 0 || headerEnd == text + size || bodyStart == nullptr)
+		{
+			LOG_ERROR << "Not a PLY file";
+			return FMeshImportResult{};
+		}
+
+		bool swap = false;
+		std::vector<FPLYElement> elements;
+
+		std::istringstream header(std::string(text, headerEnd));
+		std::string line;
+		while (std::getline(header, line))
+		{
+			std::istringstream tokens(line);
+			std::string keyword;
+			tokens >> keyword;
+
+			if (keyword == "format")
+			{
+				std::string format;
+				tokens >> format;
+				if (format != "binary_little_endian" && format != "binary_big_endian")
+				{
+					LOG_ERROR << "Only binary PLY files are supported";
+					return FMeshImportResult{};
+				}
+				swap = format == "binary_big_endian";
+			}
+			else if (keyword == "element")
+			{
+				FPLYElement element;
+				tokens >> element.Name >> element.Count;
+				elements.push_back(element);
+			}
+			else if (keyword == "property" && !elements.empty())
+			{
+				FPLYProperty property;
+				std::string type;
+				tokens >> type;
+
+				const bool isList = type == "list";
+				if (isList)
+				{
+					std::string countType;
+					tokens >> countType >> type;
+					property.CountType = ParsePLYType(countType);
+				}
+				property.Type = ParsePLYType(type);
+				tokens >> property.Name;
+
+				if (property.Type == EPLYType::Invalid || (isList && property.CountType == EPLYType::Invalid))
+				{
+					LOG_ERROR << "Unknown PLY property type in: " << line.c_str();
+					return FMeshImportResult{};
+				}
+				elements.back().Properties.push_back(property);
+			}
+		}
+
+		FImportedGeometry geometry;
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(bodyStart + 1);
+		const uint8_t* end = data + size;
+		std::size_t vertexCount = 0;
+		bool hasNormals = false;
+
+		for (const FPLYElement& element : elements)
+		{
+			bool fixedSize = true;
+			std::size_t recordSize = 0;
+			for (const FPLYProperty& property : element.Properties)
+			{
+				fixedSize &= property.CountType == EPLYType::Invalid;
+				recordSize += GetPLYTypeSize(property.Type);
+			}
+
+			if (element.Name == "vertex")
+			{
+				const int position[3] = { FindPLYProperty(element, { "x" }), FindPLYProperty(element, { "y" }), FindPLYProperty(element, { "z" }) };
+				const int normal[3] = { FindPLYProperty(element, { "nx" }), FindPLYProperty(element, { "ny" }), FindPLYProperty(element, { "nz" }) };
+				const int texCoord[2] = { FindPLYProperty(element, { "u", "s", "texture_u", "texture_s" }), FindPLYProperty(element, { "v", "t", "texture_v", "texture_t" }) };
+
+				if (!fixedSize || position[0] < 0 || position[1] < 0 || position[2] < 0 || std::size_t(end - p) / std::max<std::size_t>(recordSize, 1) < element.Count)
+				{
+					LOG_ERROR << "Invalid PLY vertex element";
+					return FMeshImportResult{};
+				}
+
+				std::vector<std::size_t> offsets(element.Properties.size());
+				for (std::size_t i = 1; i < offsets.size(); ++i)
+				{
+					offsets[i] = offsets[i - 1] + GetPLYTypeSize(element.Properties[i - 1].Type);
+				}
+
+				hasNormals = normal[0] >= 0 && normal[1] >= 0 && normal[2] >= 0;
+				const bool hasTexCoords = texCoord[0] >= 0 && texCoord[1] >= 0;
+
+				vertexCount = element.Count;
+				geometry.Positions.resize(vertexCount);
+				geometry.Normals.resize(vertexCount, FVector3f{ 0, 0, 1 });
+				geometry.TexCoords.resize(vertexCount, FVector2f{ 0, 0 });
+
+				auto load = [&](const uint8_t* record, int property)
+				{
+					return static_cast<Scalar>(LoadPLYValue(record + offsets[property], element.Properties[property].Type, swap));
+				};
+
+				ParallelFor(0, vertexCount, [&](std::size_t v)
+				{
+					const uint8_t* record = p + v * recordSize;
+					geometry.Positions[v] = FVector3f{ load(record, position[0]), load(record, position[1]), load(record, position[2]) };
+					if (hasNormals)
+					{
+						geometry.Normals[v] = FVector3f{ load(record, normal[0]), load(record, normal[1]), load(record, normal[2]) };
+					}
+					if (hasTexCoords)
+					{
+						geometry.TexCoords[v] = FVector2f{ load(record, texCoord[0]), load(record, texCoord[1]) };
+					}
+				}, 4096);
+
+				p += vertexCount * recordSize;
+			}
+			else if (element.Name == "face")
+			{
+				const int list = FindPLYProperty(element, { "vertex_indices", "vertex_index" });
+				if (list < 0 || element.Properties[list].CountType == EPLYType::Invalid)
+				{
+					LOG_ERROR << "PLY face element without vertex_indices";
+					return FMeshImportResult{};
+				}
+
+				const FPLYProperty& indexProperty = element.Properties[list];
+				const std::size_t indexSize = GetPLYTypeSize(indexProperty.Type);
+				geometry.Indices.reserve(element.Count * 3);
+
+				for (std::size_t face = 0; face < element.Count; ++face)
+				{
+					const uint8_t* record = p;
+					bool truncated = false;
+					for (int i = 0; i < static_cast<int>(element.Properties.size()) && !truncated; ++i)
+					{
+						const FPLYProperty& property = element.Properties[i];
+						if (property.CountType == EPLYType::Invalid)
+						{
+							truncated = std::size_t(end - p) < GetPLYTypeSize(property.Type);
+							p += truncated ? 0 : GetPLYTypeSize(property.Type);
+							continue;
+						}
+
+						const std::size_t countSize = GetPLYTypeSize(property.CountType);
+						if (std::size_t(end - p) < countSize)
+						{
+							truncated = true;
+							break;
+						}
+						const std::size_t count = static_cast<std::size_t>(LoadPLYValue(p, property.CountType, swap));
+						p += countSize;
+
+						const std::size_t itemSize = GetPLYTypeSize(property.Type);
+						if (std::size_t(end - p) / itemSize < count)
+						{
+							truncated = true;
+							break;
+						}
+
+						if (i == list)
+						{
+							uint32_t first = 0, previous = 0;
+							for (std::size_t k = 0; k < count; ++k)
+							{
+								const double value = LoadPLYValue(p + k * indexSize, property.Type, swap);
+								if (value < 0 || value >= double(vertexCount))
+								{
+									LOG_ERROR << "PLY face references a missing vertex " << value;
+									return FMeshImportResult{};
+								}
+
+								const uint32_t index = static_cast<uint32_t>(value);
+								if (k == 0)
+								{
+									first = index;
+								}
+								else if (k >= 2)
+								{
+									geometry.Indices.push_back(first);
+									geometry.Indices.push_back(previous);
+									geometry.Indices.push_back(index);
+								}
+								previous = index;
+							}
+						}
+						p += count * itemSize;
+					}
+
+					if (truncated)
+					{
+						LOG_ERROR << "Truncated PLY face " << face << " at byte " << (record - data);
+						return FMeshImportResult{};
+					}
+				}
+			}
+			else if (fixedSize)
+			{
+				p += std::min<std::size_t>(element.Count * recordSize, end - p);
+			}
+			else
+			{
+				for (std::size_t i = 0; i < element.Count; ++i)
+				{
+					const std::size_t skip = GetPLYRecordSize(element, p, end, swap);
+					if (skip == 0)
+					{
+						LOG_ERROR << "Truncated PLY element " << element.Name.c_str();
+						return FMeshImportResult{};
+					}
+					p += skip;
+				}
+			}
+		}
+
+		geometry.PositionCount = vertexCount;
+		geometry.HasNormal.assign(vertexCount, hasNormals ? 1 : 0);
+		geometry.PositionIds.resize(vertexCount);
+		for (std::size_t v = 0; v < vertexCount; ++v)
+		{
+			geometry.PositionIds[v] = static_cast<uint32_t>(v);
+		}
+
+		FMeshImportResult result;
+		result.Mesh = BuildMesh(geometry, settings, resource);
+		return result;
+	}
+
+	FMeshImportResult ImportPLYMesh(const std::string& fileName, const FMeshImportSettings& settings, std::pmr::memory_resource* resource)
+	{
+		FMappedFile file;
+		if (!file.Open(fileName))
+		{
+			return FMeshImportResult{};
+		}
+
+		return ParsePLYMesh(file.GetData(), file.GetSize(), settings, resource);
+	}
+
+	FMeshImportResult ImportMesh(const std::string& fileName, const FMeshImportSettings& settings, std::pmr::memory_resource* resource)
+	{
+		const std::size_t dot = fileName.find_last_of('.');
+		std::string extension = dot == std::string::npos ? std::string{} : fileName.substr(dot + 1);
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+
+		if (extension == "obj")
+		{
+			return ImportOBJMesh(fileName, settings, resource);
+		}
+		if (extension == "ply")
+		{
+			return ImportPLYMesh(fileName, settings, resource);
+		}
+
+		LOG_ERROR << "Unsupported mesh file " << fileName.c_str();
+		return FMeshImportResult{};
+	}
+}
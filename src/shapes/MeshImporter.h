@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Shape.h"
+
+namespace Dash
+{
+	struct FMeshImportSettings
+	{
+		/** Area weighted normals, shared across UV seams, for vertices the file gives no normal. */
+		bool GenerateNormals = true;
+
+		/** Tangents from the texture coordinates with GenerateTangents, left zero otherwise. */
+		bool GenerateTangents = true;
+
+		/** OBJ and PLY texture coordinates have V pointing up, D3D samples with V pointing down. */
+		bool FlipTexCoordV = true;
+
+		/** Bytes of OBJ text one parse task handles, chunks end on line boundaries. */
+		std::size_t ChunkSize = 1 << 20;
+	};
+
+	struct FMeshImportResult
+	{
+		/** FStandardVertexLayout mesh, null when the file couldn't be read. */
+		std::shared_ptr<TriangleMesh> Mesh;
+
+		/** Material names in MeshPart::MaterialIdx order, OBJ usemtl names in order of first use. */
+		std::vector<std::string> MaterialNames;
+	};
+
+	/**
+	 * Wavefront OBJ. The file is memory mapped and split into chunks parsed in parallel, negative indices are resolved
+	 * once all chunks are counted. Corners are deduplicated on their position/texcoord/normal triple, polygons are fan
+	 * triangulated and triangles are grouped into one MeshPart per material.
+	 */
+	FMeshImportResult ImportOBJMesh(const std::string& fileName, const FMeshImportSettings& settings = FMeshImportSettings{},
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	/** Parses OBJ text already in memory. */
+	FMeshImportResult ParseOBJMesh(const char* data, std::size_t size, const FMeshImportSettings& settings = FMeshImportSettings{},
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	/**
+	 * Binary PLY, little or big endian. Reads x/y/z, nx/ny/nz and u/v (or s/t, texture_u/texture_v) of any scalar
+	 * type from the vertex element and vertex_indices from the face element, other elements and properties are skipped.
+	 * Vertex records are decoded in parallel.
+	 */
+	FMeshImportResult ImportPLYMesh(const std::string& fileName, const FMeshImportSettings& settings = FMeshImportSettings{},
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	FMeshImportResult ParsePLYMesh(const std::uint8_t* data, std::size_t size, const FMeshImportSettings& settings = FMeshImportSettings{},
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	/** Picks the importer from the file extension, .obj or .ply. */
+	FMeshImportResult ImportMesh(const std::string& fileName, const FMeshImportSettings& settings = FMeshImportSettings{},
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+}
@@ -0,0 +1,388 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace Dash
+{
+	namespace
+	{
+		constexpr uint32_t InvalidIndex = ~0u;
+
+		struct FTriangleAdjacency
+		{
+			std::vector<uint32_t> Offsets;
+			std::vector<uint32_t> Triangles;
+			std::vector<uint32_t> LiveCounts;
+		};
+
+		void BuildTriangleAdjacency(FTriangleAdjacency& adjacency, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+		{
+			adjacency.LiveCounts.assign(vertexCount, 0);
+			for (size_t i = 0; i < indexCount; ++i)
+			{
+				ASSERT(indices[i] < vertexCount);
+				adjacency.LiveCounts[indices[i]]++;
+			}
+
+			adjacency.Offsets.resize(vertexCount + 1);
+			adjacency.Offsets[0] = 0;
+			for (size_t v = 0; v < vertexCount; ++v)
+			{
+				adjacency.Offsets[v + 1] = adjacency.Offsets[v] + adjacency.LiveCounts[v];
+			}
+
+			std::vector<uint32_t> cursor(adjacency.Offsets.begin(), adjacency.Offsets.end() - 1);
+			adjacency.Triangles.resize(indexCount);
+			for (size_t i = 0; i < indexCount; ++i)
+			{
+				adjacency.Triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		/** Tipsify's next fanning vertex: the candidate that stays in the cache longest while it has triangles left. */
+		uint32_t GetNextVertex(const std::vector<uint32_t>& candidates, const std::vector<uint32_t>& cacheTimes, const std::vector<uint32_t>& liveCounts,
+			std::vector<uint32_t>& deadEnd, size_t& cursor, uint32_t timeStamp, size_t cacheSize, size_t vertexCount)
+		{
+			uint32_t best = InvalidIndex;
+			int bestPriority = -1;
+
+			for (uint32_t v : candidates)
+			{
+				if (liveCounts[v] == 0)
+				{
+					continue;
+				}
+
+				// vertices that would still be cached after fanning all of their triangles are preferred, oldest first
+				int priority = 0;
+				if (timeStamp - cacheTimes[v] + 2 * liveCounts[v] <= cacheSize)
+				{
+					priority = static_cast<int>(timeStamp - cacheTimes[v]);
+				}
+
+				if (priority > bestPriority)
+				{
+					bestPriority = priority;
+					best = v;
+				}
+			}
+
+			if (best != InvalidIndex)
+			{
+				return best;
+			}
+
+			while (!deadEnd.empty())
+			{
+				const uint32_t v = deadEnd.back();
+				deadEnd.pop_back();
+				if (liveCounts[v] > 0)
+				{
+					return v;
+				}
+			}
+
+			while (cursor < vertexCount)
+			{
+				if (liveCounts[cursor] > 0)
+				{
+					return static_cast<uint32_t>(cursor);
+				}
+				++cursor;
+			}
+
+			return InvalidIndex;
+		}
+
+		void AccumulateStats(FVertexCacheStats& total, const FVertexCacheStats& part)
+		{
+			total.VerticesTransformed += part.VerticesTransformed;
+			total.TriangleCount += part.TriangleCount;
+			total.VertexCount += part.VertexCount;
+			total.ACMR = total.TriangleCount > 0 ? float(total.VerticesTransformed) / total.TriangleCount : 0.0f;
+			total.ATVR = total.VertexCount > 0 ? float(total.VerticesTransformed) / total.VertexCount : 0.0f;
+		}
+	}
+
+	FVertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize)
+	{
+		ASSERT(indexCount % 3 == 0 && cacheSize > 0);
+
+		FVertexCacheStats stats;
+		stats.TriangleCount = indexCount / 3;
+
+		// a vertex is cached while fewer than cacheSize misses happened since it was loaded
+		std::vector<size_t> loadTimes(vertexCount, 0);
+		std::vector<bool> referenced(vertexCount, false);
+		size_t timeStamp = cacheSize + 1;
+
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			const uint32_t v = indices[i];
+			ASSERT(v < vertexCount);
+
+			if (timeStamp - loadTimes[v] > cacheSize)
+			{
+				loadTimes[v] = timeStamp++;
+				stats.VerticesTransformed++;
+			}
+
+			if (!referenced[v])
+			{
+				referenced[v] = true;
+				stats.VertexCount++;
+			}
+		}
+
+		stats.ACMR = stats.TriangleCount > 0 ? float(stats.VerticesTransformed) / stats.TriangleCount : 0.0f;
+		stats.ATVR = stats.VertexCount > 0 ? float(stats.VerticesTransformed) / stats.VertexCount : 0.0f;
+		return stats;
+	}
+
+	void OptimizeVertexCache(uint32_t* dest, const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize)
+	{
+		ASSERT(indexCount % 3 == 0 && cacheSize > 0);
+
+		if (indexCount == 0)
+		{
+			return;
+		}
+
+		FTriangleAdjacency adjacency;
+		BuildTriangleAdjacency(adjacency, indices, indexCount, vertexCount);
+
+		// dest may alias indices
+		std::vector<uint32_t> source(indices, indices + indexCount);
+		std::vector<uint32_t> result;
+		result.reserve(indexCount);
+
+		std::vector<uint32_t> cacheTimes(vertexCount, 0);
+		std::vector<bool> emitted(indexCount / 3, false);
+		std::vector<uint32_t> deadEnd;
+		std::vector<uint32_t> candidates;
+
+		uint32_t timeStamp = static_cast<uint32_t>(cacheSize) + 1;
+		size_t cursor = 0;
+
+		uint32_t fanVertex = source[0];
+		while (fanVertex != InvalidIndex)
+		{
+			candidates.clear();
+
+			for (uint32_t i = adjacency.Offsets[fanVertex]; i < adjacency.Offsets[fanVertex + 1]; ++i)
+			{
+				const uint32_t triangle = adjacency.Triangles[i];
+				if (emitted[triangle])
+				{
+					continue;
+				}
+
+				for (size_t k = 0; k < 3; ++k)
+				{
+					const uint32_t v = source[triangle * 3 + k];
+					result.push_back(v);
+					deadEnd.push_back(v);
+					candidates.push_back(v);
+					adjacency.LiveCounts[v]--;
+
+					if (timeStamp - cacheTimes[v] > cacheSize)
+					{
+						cacheTimes[v] = timeStamp++;
+					}
+				}
+
+				emitted[triangle] = true;
+			}
+
+			fanVertex = GetNextVertex(candidates, cacheTimes, adjacency.LiveCounts, deadEnd, cursor, timeStamp, cacheSize, vertexCount);
+		}
+
+		ASSERT(result.size() == indexCount);
+		std::copy(result.begin(), result.end(), dest);
+	}
+
+	void OptimizeOverdraw(uint32_t* dest, const uint32_t* indices, size_t indexCount, TStridedSpan<const FVector3f> positions,
+		size_t cacheSize, float threshold)
+	{
+		ASSERT(indexCount % 3 == 0);
+
+		const size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		const size_t vertexCount = positions.Size();
+		const float targetACMR = AnalyzeVertexCache(indices, indexCount, vertexCount, cacheSize).ACMR * threshold;
+
+		// clusters restart the cache simulation, they end once they are cache efficient enough to be moved freely
+		constexpr size_t MinClusterTriangles = 8;
+		std::vector<size_t> clusterStarts;
+		{
+			std::vector<size_t> loadTimes(vertexCount, 0);
+			size_t timeStamp = cacheSize + 1;
+			size_t clusterStart = 0;
+			size_t clusterMisses = 0;
+
+			clusterStarts.push_back(0);
+			for (size_t t = 0; t < triangleCount; ++t)
+			{
+				for (size_t k = 0; k < 3; ++k)
+				{
+					const uint32_t v = indices[t * 3 + k];
+					if (timeStamp - loadTimes[v] > cacheSize)
+					{
+						loadTimes[v] = timeStamp++;
+						clusterMisses++;
+					}
+				}
+
+				const size_t clusterTriangles = t + 1 - clusterStart;
+				if (t + 1 < triangleCount && clusterTriangles >= MinClusterTriangles && float(clusterMisses) / clusterTriangles <= targetACMR)
+				{
+					clusterStart = t + 1;
+					clusterMisses = 0;
+					timeStamp += cacheSize + 1;
+					clusterStarts.push_back(clusterStart);
+				}
+			}
+		}
+		clusterStarts.push_back(triangleCount);
+
+		const size_t clusterCount = clusterStarts.size() - 1;
+
+		FVector3f meshCentroid{ 0.0f, 0.0f, 0.0f };
+		float meshArea = 0.0f;
+
+		std::vector<FVector3f> clusterCentroids(clusterCount, FVector3f{ 0.0f, 0.0f, 0.0f });
+		std::vector<FVector3f> clusterNormals(clusterCount, FVector3f{ 0.0f, 0.0f, 0.0f });
+
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			float clusterArea = 0.0f;
+			for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t)
+			{
+				const FVector3f& p0 = positions[indices[t * 3 + 0]];
+				const FVector3f& p1 = positions[indices[t * 3 + 1]];
+				const FVector3f& p2 = positions[indices[t * 3 + 2]];
+
+				const FVector3f normal = FMath::Cross(p1 - p0, p2 - p0);
+				const float area = FMath::Length(normal);
+				const FVector3f centroid = (p0 + p1 + p2) * (1.0f / 3.0f);
+
+				clusterNormals[c] += normal;
+				clusterCentroids[c] += centroid * area;
+				clusterArea += area;
+
+				meshCentroid += centroid * area;
+				meshArea += area;
+			}
+
+			clusterCentroids[c] = clusterArea > 0.0f ? clusterCentroids[c] * (1.0f / clusterArea) : positions[indices[clusterStarts[c] * 3]];
+		}
+
+		meshCentroid = meshArea > 0.0f ? meshCentroid * (1.0f / meshArea) : meshCentroid;
+
+		std::vector<float> sortKeys(clusterCount);
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			const float normalLength = FMath::Length(clusterNormals[c]);
+			sortKeys[c] = normalLength > 0.0f ? FMath::Dot(clusterCentroids[c] - meshCentroid, clusterNormals[c]) / normalLength : 0.0f;
+		}
+
+		std::vector<size_t> order(clusterCount);
+		std::iota(order.begin(), order.end(), size_t{ 0 });
+		std::stable_sort(order.begin(), order.end(), [&sortKeys](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+		std::vector<uint32_t> result;
+		result.reserve(indexCount);
+		for (size_t c : order)
+		{
+			result.insert(result.end(), indices + clusterStarts[c] * 3, indices + clusterStarts[c + 1] * 3);
+		}
+
+		std::copy(result.begin(), result.end(), dest);
+	}
+
+	size_t BuildVertexFetchRemap(uint32_t* remap, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+	{
+		std::fill(remap, remap + vertexCount, InvalidIndex);
+
+		uint32_t next = 0;
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			ASSERT(indices[i] < vertexCount);
+			if (remap[indices[i]] == InvalidIndex)
+			{
+				remap[indices[i]] = next++;
+			}
+		}
+
+		const size_t referencedCount = next;
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			if (remap[v] == InvalidIndex)
+			{
+				remap[v] = next++;
+			}
+		}
+
+		return referencedCount;
+	}
+
+	FMeshOptimizeResult OptimizeMesh(TriangleMesh& mesh, size_t cacheSize, float overdrawThreshold)
+	{
+		std::vector<MeshPart> parts = mesh.MeshParts;
+		if (parts.empty())
+		{
+			parts.emplace_back(0, mesh.NumVertices, 0, mesh.NumIndices, 0);
+		}
+
+		const FVertexAttributeHandle positionHandle = mesh.FindVertexAttribute(VertexAttribute::Position::Name);
+
+		FMeshOptimizeResult result;
+		std::vector<uint32_t> indices;
+		std::vector<uint32_t> remap;
+		std::vector<uint8_t> vertices;
+
+		for (const MeshPart& part : parts)
+		{
+			mesh.ReadIndices(indices, part.IndexStart, part.IndexCount);
+
+			AccumulateStats(result.Before, AnalyzeVertexCache(indices.data(), indices.size(), part.VertexCount, cacheSize));
+
+			OptimizeVertexCache(indices.data(), indices.data(), indices.size(), part.VertexCount, cacheSize);
+
+			if (positionHandle.IsValid())
+			{
+				const TStridedSpan<const FVector3f> positions = std::as_const(mesh).GetVertexAttribute<FVector3f>(positionHandle)
+					.GetSubSpan(part.VertexStart, part.VertexCount);
+				OptimizeOverdraw(indices.data(), indices.data(), indices.size(), positions, cacheSize, overdrawThreshold);
+			}
+
+			// reorder the part's vertices into first use order so fetches walk the vertex buffer forwards
+			remap.resize(part.VertexCount);
+			BuildVertexFetchRemap(remap.data(), indices.data(), indices.size(), part.VertexCount);
+
+			const size_t stride = mesh.VertexStride;
+			uint8_t* partVertices = mesh.Vertices.data() + part.VertexStart * stride;
+			vertices.assign(partVertices, partVertices + part.VertexCount * stride);
+			for (size_t v = 0; v < part.VertexCount; ++v)
+			{
+				std::memcpy(partVertices + remap[v] * stride, vertices.data() + v * stride, stride);
+			}
+
+			for (uint32_t& index : indices)
+			{
+				index = remap[index];
+			}
+
+			AccumulateStats(result.After, AnalyzeVertexCache(indices.data(), indices.size(), part.VertexCount, cacheSize));
+
+			mesh.WriteIndices(indices.data(), part.IndexStart, indices.size());
+		}
+
+		return result;
+	}
+}
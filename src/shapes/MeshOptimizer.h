@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Shape.h"
+
+namespace Dash
+{
+	/** Post-transform vertex cache statistics from a FIFO cache simulation. */
+	struct FVertexCacheStats
+	{
+		size_t VerticesTransformed = 0;
+		size_t TriangleCount = 0;
+		size_t VertexCount = 0;
+
+		/** Average cache miss ratio: transformed vertices per triangle, 0.5 is the limit for regular grids, 3 the worst case. */
+		float ACMR = 0.0f;
+
+		/** Average transform to vertex ratio: transformed vertices per referenced vertex, 1 is optimal. */
+		float ATVR = 0.0f;
+	};
+
+	struct FMeshOptimizeResult
+	{
+		FVertexCacheStats Before;
+		FVertexCacheStats After;
+	};
+
+	FVertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize = 16);
+
+	/** Reorders triangles for the post-transform vertex cache with Tipsify, dest may alias indices. */
+	void OptimizeVertexCache(uint32_t* dest, const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize = 16);
+
+	/**
+	 * Splits a cache optimized index list into clusters whose ACMR stays within threshold times the ACMR of the whole
+	 * list and sorts the clusters front to back by how far they face out of the mesh, so the outer surface tends to be
+	 * drawn first from any view. dest may alias indices.
+	 */
+	void OptimizeOverdraw(uint32_t* dest, const uint32_t* indices, size_t indexCount, TStridedSpan<const FVector3f> positions,
+		size_t cacheSize = 16, float threshold = 1.05f);
+
+	/**
+	 * Builds the vertex remap that puts vertices in the order the index list first references them, unreferenced
+	 * vertices keep their relative order at the end. Returns the number of referenced vertices.
+	 */
+	size_t BuildVertexFetchRemap(uint32_t* remap, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+	/**
+	 * Runs vertex cache, overdraw and vertex fetch optimization on every mesh part of an R16_UINT or R32_UINT mesh.
+	 * Indices are taken relative to MeshPart::VertexStart, as a draw with that base vertex reads them.
+	 */
+	FMeshOptimizeResult OptimizeMesh(TriangleMesh& mesh, size_t cacheSize = 16, float overdrawThreshold = 1.05f);
+}
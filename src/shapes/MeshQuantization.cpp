@@ -0,0 +1,302 @@
+#include "MeshQuantization.h"
+#include <algorithm>
+#include <cstddef>
+
+namespace Dash
+{
+	namespace
+	{
+		constexpr float UNorm16Max = 65535.0f;
+		constexpr float SNorm16Max = 32767.0f;
+
+		FORCEINLINE int16_t EncodeSNorm16(float value)
+		{
+			return static_cast<int16_t>(FMath::Round(FMath::Clamp(value, -1.0f, 1.0f) * SNorm16Max));
+		}
+
+		FORCEINLINE float DecodeSNorm16(int16_t value)
+		{
+			return FMath::Max(value / SNorm16Max, -1.0f);
+		}
+
+		FORCEINLINE uint32_t LoadUInt32(const void* src)
+		{
+			uint32_t value;
+			std::memcpy(&value, src, sizeof(uint32_t));
+			return value;
+		}
+
+		FORCEINLINE void StoreVector3(FVector3f& dest, __m128 v)
+		{
+			float* p = &dest[0];
+			_mm_storel_pi(reinterpret_cast<__m64*>(p), v);
+			_mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+		}
+	}
+
+	FVector2f EncodeOctahedral(const FVector3f& n)
+	{
+		const float invL1 = 1.0f / (FMath::Abs(n[0]) + FMath::Abs(n[1]) + FMath::Abs(n[2]));
+		float x = n[0] * invL1;
+		float y = n[1] * invL1;
+
+		// fold the lower hemisphere over the diagonals
+		if (n[2] < 0.0f)
+		{
+			const float foldedX = (1.0f - FMath::Abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			const float foldedY = (1.0f - FMath::Abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = foldedX;
+			y = foldedY;
+		}
+
+		return FVector2f{ x, y };
+	}
+
+	FVector3f DecodeOctahedral(const FVector2f& e)
+	{
+		float x = e[0];
+		float y = e[1];
+		const float z = 1.0f - FMath::Abs(x) - FMath::Abs(y);
+		const float t = FMath::Max(-z, 0.0f);
+		x += x >= 0.0f ? -t : t;
+		y += y >= 0.0f ? -t : t;
+
+		const float invLength = 1.0f / FMath::Sqrt(x * x + y * y + z * z);
+		return FVector3f{ x * invLength, y * invLength, z * invLength };
+	}
+
+	FQuantizedMesh::FQuantizedMesh(std::pmr::memory_resource* resource)
+		: mVertices(resource)
+		, mIndices(resource)
+		, mNumIndices(0)
+		, mIndexType(EDASH_FORMAT::R32_UINT)
+	{
+	}
+
+	FQuantizedMesh::FQuantizedMesh(const TriangleMesh& mesh, std::pmr::memory_resource* resource)
+		: mVertices(mesh.NumVertices, resource)
+		, mIndices(mesh.Indices.begin(), mesh.Indices.end(), resource)
+		, mMeshParts(mesh.MeshParts)
+		, mNumIndices(mesh.NumIndices)
+		, mIndexType(mesh.IndexType)
+	{
+		const FVertexAttributeHandle positionHandle = mesh.FindVertexAttribute(VertexAttribute::Position::Name);
+		const FVertexAttributeHandle normalHandle = mesh.FindVertexAttribute(VertexAttribute::Normal::Name);
+		const FVertexAttributeHandle tangentHandle = mesh.FindVertexAttribute(VertexAttribute::Tangent::Name);
+		const FVertexAttributeHandle texCoordHandle = mesh.FindVertexAttribute(VertexAttribute::TexCoord::Name);
+
+		ASSERT(positionHandle.IsValid());
+
+		const TStridedSpan<const FVector3f> positions = mesh.GetVertexAttribute<FVector3f>(positionHandle);
+		for (const FVector3f& p : positions)
+		{
+			for (size_t i = 0; i < 3; ++i)
+			{
+				mBounds.Lower[i] = FMath::Min(mBounds.Lower[i], p[i]);
+				mBounds.Upper[i] = FMath::Max(mBounds.Upper[i], p[i]);
+			}
+		}
+
+		float scale[3];
+		for (size_t i = 0; i < 3; ++i)
+		{
+			const float extent = mBounds.Upper[i] - mBounds.Lower[i];
+			scale[i] = extent > 0.0f ? UNorm16Max / extent : 0.0f;
+		}
+
+		for (size_t v = 0; v < mVertices.size(); ++v)
+		{
+			FQuantizedVertex& vertex = mVertices[v];
+			for (size_t i = 0; i < 3; ++i)
+			{
+				const float q = (positions[v][i] - mBounds.Lower[i]) * scale[i] + 0.5f;
+				vertex.Position[i] = static_cast<uint16_t>(FMath::Clamp(q, 0.0f, UNorm16Max));
+			}
+			vertex.Position[3] = 0;
+		}
+
+		auto encodeDirections = [&](const FVertexAttributeHandle& handle, size_t componentOffset)
+		{
+			if (!handle.IsValid())
+			{
+				return;
+			}
+
+			const TStridedSpan<const FVector3f> directions = mesh.GetVertexAttribute<FVector3f>(handle);
+			for (size_t v = 0; v < mVertices.size(); ++v)
+			{
+				const FVector2f e = EncodeOctahedral(directions[v]);
+				const int16_t encoded[2] = { EncodeSNorm16(e[0]), EncodeSNorm16(e[1]) };
+				std::memcpy(reinterpret_cast<uint8_t*>(&mVertices[v]) + componentOffset, encoded, sizeof(encoded));
+			}
+		};
+
+		encodeDirections(normalHandle, offsetof(FQuantizedVertex, Normal));
+		encodeDirections(tangentHandle, offsetof(FQuantizedVertex, Tangent));
+
+		if (texCoordHandle.IsValid())
+		{
+			const TStridedSpan<const FVector2f> texCoords = mesh.GetVertexAttribute<FVector2f>(texCoordHandle);
+			for (size_t v = 0; v < mVertices.size(); ++v)
+			{
+				mVertices[v].TexCoord[0] = FloatToHalf(texCoords[v][0]);
+				mVertices[v].TexCoord[1] = FloatToHalf(texCoords[v][1]);
+			}
+		}
+	}
+
+	void FQuantizedMesh::GetVertexPosition(FVector3f& p, size_t vertexIndex) const
+	{
+		const FQuantizedVertex& vertex = mVertices[vertexIndex];
+		for (size_t i = 0; i < 3; ++i)
+		{
+			p[i] = mBounds.Lower[i] + vertex.Position[i] * ((mBounds.Upper[i] - mBounds.Lower[i]) / UNorm16Max);
+		}
+	}
+
+	void FQuantizedMesh::GetVertexNormal(FVector3f& n, size_t vertexIndex) const
+	{
+		const FQuantizedVertex& vertex = mVertices[vertexIndex];
+		n = Dash::DecodeOctahedral(FVector2f{ DecodeSNorm16(vertex.Normal[0]), DecodeSNorm16(vertex.Normal[1]) });
+	}
+
+	void FQuantizedMesh::GetVertexTangent(FVector3f& t, size_t vertexIndex) const
+	{
+		const FQuantizedVertex& vertex = mVertices[vertexIndex];
+		t = Dash::DecodeOctahedral(FVector2f{ DecodeSNorm16(vertex.Tangent[0]), DecodeSNorm16(vertex.Tangent[1]) });
+	}
+
+	void FQuantizedMesh::GetVertexTexCoord(FVector2f& uv, size_t vertexIndex) const
+	{
+		const FQuantizedVertex& vertex = mVertices[vertexIndex];
+		uv = FVector2f{ HalfToFloat(vertex.TexCoord[0]), HalfToFloat(vertex.TexCoord[1]) };
+	}
+
+	void FQuantizedMesh::DecodePositions(size_t firstVertex, TStridedSpan<FVector3f> dest) const
+	{
+		ASSERT(firstVertex + dest.Size() <= mVertices.size());
+
+		const __m128 lower = _mm_setr_ps(mBounds.Lower[0], mBounds.Lower[1], mBounds.Lower[2], 0.0f);
+		const __m128 scale = _mm_setr_ps((mBounds.Upper[0] - mBounds.Lower[0]) / UNorm16Max,
+			(mBounds.Upper[1] - mBounds.Lower[1]) / UNorm16Max, (mBounds.Upper[2] - mBounds.Lower[2]) / UNorm16Max, 0.0f);
+		const __m128i zero = _mm_setzero_si128();
+
+		const FQuantizedVertex* src = mVertices.data() + firstVertex;
+		for (size_t v = 0; v < dest.Size(); ++v)
+		{
+			const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src[v].Position));
+			const __m128 q = _mm_cvtepi32_ps(_mm_unpacklo_epi16(packed, zero));
+			StoreVector3(dest[v], _mm_add_ps(lower, _mm_mul_ps(q, scale)));
+		}
+	}
+
+	void FQuantizedMesh::DecodeNormals(size_t firstVertex, TStridedSpan<FVector3f> dest) const
+	{
+		DecodeOctahedral(firstVertex, offsetof(FQuantizedVertex, Normal), dest);
+	}
+
+	void FQuantizedMesh::DecodeTangents(size_t firstVertex, TStridedSpan<FVector3f> dest) const
+	{
+		DecodeOctahedral(firstVertex, offsetof(FQuantizedVertex, Tangent), dest);
+	}
+
+	void FQuantizedMesh::DecodeOctahedral(size_t firstVertex, size_t componentOffset, TStridedSpan<FVector3f> dest) const
+	{
+		ASSERT(firstVertex + dest.Size() <= mVertices.size());
+
+		const uint8_t* src = reinterpret_cast<const uint8_t*>(mVertices.data() + firstVertex) + componentOffset;
+		const size_t count = dest.Size();
+
+		const __m128 invMax = _mm_set1_ps(1.0f / SNorm16Max);
+		const __m128 minusOne = _mm_set1_ps(-1.0f);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+
+		size_t v = 0;
+		for (; v + 4 <= count; v += 4)
+		{
+			// four packed snorm pairs, x in the low and y in the high 16 bits
+			const __m128i packed = _mm_setr_epi32(
+				static_cast<int>(LoadUInt32(src + (v + 0) * sizeof(FQuantizedVertex))),
+				static_cast<int>(LoadUInt32(src + (v + 1) * sizeof(FQuantizedVertex))),
+				static_cast<int>(LoadUInt32(src + (v + 2) * sizeof(FQuantizedVertex))),
+				static_cast<int>(LoadUInt32(src + (v + 3) * sizeof(FQuantizedVertex))));
+
+			__m128 x = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(packed, 16), 16)), invMax), minusOne);
+			__m128 y = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(packed, 16)), invMax), minusOne);
+			__m128 z = _mm_sub_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, x)), _mm_andnot_ps(signMask, y));
+
+			// t moves the folded lower hemisphere back, against the sign of each component
+			const __m128 t = _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), z), _mm_setzero_ps());
+			x = _mm_sub_ps(x, _mm_or_ps(t, _mm_and_ps(_mm_cmplt_ps(x, _mm_setzero_ps()), signMask)));
+			y = _mm_sub_ps(y, _mm_or_ps(t, _mm_and_ps(_mm_cmplt_ps(y, _mm_setzero_ps()), signMask)));
+
+			const __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+			const __m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSquared));
+			x = _mm_mul_ps(x, invLength);
+			y = _mm_mul_ps(y, invLength);
+			z = _mm_mul_ps(z, invLength);
+
+			__m128 w = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+
+			StoreVector3(dest[v + 0], x);
+			StoreVector3(dest[v + 1], y);
+			StoreVector3(dest[v + 2], z);
+			StoreVector3(dest[v + 3], w);
+		}
+
+		for (; v < count; ++v)
+		{
+			int16_t e[2];
+			std::memcpy(e, src + v * sizeof(FQuantizedVertex), sizeof(e));
+			dest[v] = Dash::DecodeOctahedral(FVector2f{ DecodeSNorm16(e[0]), DecodeSNorm16(e[1]) });
+		}
+	}
+
+	void FQuantizedMesh::DecodeTexCoords(size_t firstVertex, TStridedSpan<FVector2f> dest) const
+	{
+		ASSERT(firstVertex + dest.Size() <= mVertices.size());
+
+		// gather the halves into a packed batch so ConvertHalfToFloat can use its vector path
+		constexpr size_t BatchSize = 256;
+		uint16_t halves[BatchSize * 2];
+		float floats[BatchSize * 2];
+
+		for (size_t begin = 0; begin < dest.Size(); begin += BatchSize)
+		{
+			const size_t count = std::min(BatchSize, dest.Size() - begin);
+			for (size_t v = 0; v < count; ++v)
+			{
+				std::memcpy(&halves[v * 2], mVertices[firstVertex + begin + v].TexCoord, sizeof(uint16_t) * 2);
+			}
+
+			ConvertHalfToFloat(halves, count * 2, floats);
+
+			for (size_t v = 0; v < count; ++v)
+			{
+				_mm_storel_pi(reinterpret_cast<__m64*>(&dest[begin + v][0]), _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(&floats[v * 2]))));
+			}
+		}
+	}
+
+	std::shared_ptr<TriangleMesh> FQuantizedMesh::Decode(std::pmr::memory_resource* resource) const
+	{
+		std::shared_ptr<TriangleMesh> triangleMesh = std::allocate_shared<TriangleMesh>(std::pmr::polymorphic_allocator<TriangleMesh>(resource), resource);
+		triangleMesh->IndexType = mIndexType;
+		triangleMesh->NumVertices = mVertices.size();
+		triangleMesh->NumIndices = mNumIndices;
+		triangleMesh->MeshParts = mMeshParts;
+		triangleMesh->SetVertexLayout<FStandardVertexLayout>();
+
+		triangleMesh->Vertices.resize(FStandardVertexLayout::Stride * mVertices.size());
+		triangleMesh->Indices.assign(mIndices.begin(), mIndices.end());
+
+		DecodePositions(0, triangleMesh->GetVertexAttribute<FStandardVertexLayout, VertexAttribute::Position>());
+		DecodeNormals(0, triangleMesh->GetVertexAttribute<FStandardVertexLayout, VertexAttribute::Normal>());
+		DecodeTangents(0, triangleMesh->GetVertexAttribute<FStandardVertexLayout, VertexAttribute::Tangent>());
+		DecodeTexCoords(0, triangleMesh->GetVertexAttribute<FStandardVertexLayout, VertexAttribute::TexCoord>());
+
+		return triangleMesh;
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Shape.h"
+
+namespace Dash
+{
+	/**
+	 * 20 byte vertex replacing the 44 byte FStandardVertexLayout vertex:
+	 * positions as 16 bit unorm against the mesh bounds, normals and tangents octahedral encoded as two 16 bit snorms,
+	 * texture coordinates as halves.
+	 */
+	struct FQuantizedVertex
+	{
+		/** xyz quantized against FQuantizedMesh::Bounds, w is padding so the position loads as one 8 byte lane. */
+		uint16_t Position[4];
+		int16_t Normal[2];
+		int16_t Tangent[2];
+		uint16_t TexCoord[2];
+	};
+
+	static_assert(sizeof(FQuantizedVertex) == 20);
+
+	/** Octahedral encoding of a unit vector, both components in [-1, 1]. */
+	FVector2f EncodeOctahedral(const FVector3f& n);
+
+	FVector3f DecodeOctahedral(const FVector2f& e);
+
+	class FQuantizedMesh
+	{
+	public:
+		explicit FQuantizedMesh(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		/** Encodes every vertex of mesh, attributes missing from its layout are stored as zero. */
+		explicit FQuantizedMesh(const TriangleMesh& mesh, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		size_t GetNumVertices() const { return mVertices.size(); }
+
+		size_t GetNumIndices() const { return mNumIndices; }
+
+		EDASH_FORMAT GetIndexType() const { return mIndexType; }
+
+		const FBoundingBox& GetBounds() const { return mBounds; }
+
+		const FQuantizedVertex* GetVertices() const { return mVertices.data(); }
+
+		const uint8_t* GetIndices() const { return mIndices.data(); }
+
+		const std::vector<MeshPart>& GetMeshParts() const { return mMeshParts; }
+
+		/** Bytes used by the vertex and index buffers. */
+		size_t GetMemorySize() const { return mVertices.size() * sizeof(FQuantizedVertex) + mIndices.size(); }
+
+		void GetVertexPosition(FVector3f& p, size_t vertexIndex) const;
+
+		void GetVertexNormal(FVector3f& n, size_t vertexIndex) const;
+
+		void GetVertexTangent(FVector3f& t, size_t vertexIndex) const;
+
+		void GetVertexTexCoord(FVector2f& uv, size_t vertexIndex) const;
+
+		/** Bulk SSE decoders, dest.Size() vertices starting at firstVertex. */
+		void DecodePositions(size_t firstVertex, TStridedSpan<FVector3f> dest) const;
+
+		void DecodeNormals(size_t firstVertex, TStridedSpan<FVector3f> dest) const;
+
+		void DecodeTangents(size_t firstVertex, TStridedSpan<FVector3f> dest) const;
+
+		void DecodeTexCoords(size_t firstVertex, TStridedSpan<FVector2f> dest) const;
+
+		/** Decodes back to a mesh in FStandardVertexLayout. */
+		std::shared_ptr<TriangleMesh> Decode(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+	private:
+		void DecodeOctahedral(size_t firstVertex, size_t componentOffset, TStridedSpan<FVector3f> dest) const;
+
+		FBoundingBox mBounds;
+		std::pmr::vector<FQuantizedVertex> mVertices;
+		std::pmr::vector<uint8_t> mIndices;
+		std::vector<MeshPart> mMeshParts;
+		size_t mNumIndices;
+		EDASH_FORMAT mIndexType;
+	};
+}
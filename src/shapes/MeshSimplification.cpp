@@ -0,0 +1,625 @@
+#include "MeshSimplification.h"
+#include "MeshOptimizer.h"
+#include "../graphic/Camera.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Dash
+{
+	namespace
+	{
+		constexpr uint32_t NoVertex = ~0u;
+		constexpr uint32_t MultipleVertices = ~0u - 1;
+
+		/** Border and seam edges get their plane constraints weighted up so boundaries keep their shape. */
+		constexpr Scalar BoundaryWeight = 10.0f;
+
+		enum class EVertexKind : uint8_t
+		{
+			Manifold,
+			Border,
+			Seam,
+			Locked,
+		};
+
+		/** Symmetric 4x4 quadric of summed squared plane distances, Weight is the summed plane weight. */
+		struct FQuadric
+		{
+			double A00 = 0, A01 = 0, A02 = 0, A11 = 0, A12 = 0, A22 = 0;
+			double B0 = 0, B1 = 0, B2 = 0;
+			double C = 0;
+			double Weight = 0;
+
+			void AddPlane(const FVector3f& n, Scalar d, Scalar weight)
+			{
+				A00 += weight * n.x * n.x; A01 += weight * n.x * n.y; A02 += weight * n.x * n.z;
+				A11 += weight * n.y * n.y; A12 += weight * n.y * n.z; A22 += weight * n.z * n.z;
+				B0 += weight * n.x * d; B1 += weight * n.y * d; B2 += weight * n.z * d;
+				C += weight * d * d;
+				Weight += weight;
+			}
+
+			FQuadric& operator+=(const FQuadric& q)
+			{
+				A00 += q.A00; A01 += q.A01; A02 += q.A02; A11 += q.A11; A12 += q.A12; A22 += q.A22;
+				B0 += q.B0; B1 += q.B1; B2 += q.B2;
+				C += q.C;
+				Weight += q.Weight;
+				return *this;
+			}
+
+			/** Weighted mean squared distance of p to the planes. */
+			double Evaluate(const FVector3f& p) const
+			{
+				const double x = p.x, y = p.y, z = p.z;
+				const double error = A00 * x * x + A11 * y * y + A22 * z * z
+					+ 2 * (A01 * x * y + A02 * x * z + A12 * y * z)
+					+ 2 * (B0 * x + B1 * y + B2 * z) + C;
+				return Weight > 0 ? std::max(error, 0.0) / Weight : 0.0;
+			}
+		};
+
+		struct FCollapse
+		{
+			uint32_t From;
+			uint32_t To;
+			double Cost;
+		};
+
+		FORCEINLINE uint64_t MakeEdgeKey(uint32_t a, uint32_t b)
+		{
+			return (uint64_t(a) << 32) | b;
+		}
+
+		FORCEINLINE void SetUniqueVertex(uint32_t& slot, uint32_t v)
+		{
+			slot = (slot == NoVertex || slot == v) ? v : MultipleVertices;
+		}
+
+		struct FPositionHash
+		{
+			size_t operator()(const FVector3f& p) const
+			{
+				uint32_t bits[3];
+				std::memcpy(bits, &p[0], sizeof(bits));
+				return (size_t(bits[0]) * 73856093u) ^ (size_t(bits[1]) * 19349663u) ^ (size_t(bits[2]) * 83492791u);
+			}
+		};
+
+		struct FPositionEqual
+		{
+			bool operator()(const FVector3f& a, const FVector3f& b) const
+			{
+				return a.x == b.x && a.y == b.y && a.z == b.z;
+			}
+		};
+
+		/** Maps every vertex to the first vertex with the same position. */
+		void BuildPositionRemap(std::vector<uint32_t>& positionIds, const TStridedSpan<const FVector3f>& positions)
+		{
+			std::unordered_map<FVector3f, uint32_t, FPositionHash, FPositionEqual> firstVertex;
+			firstVertex.reserve(positions.Size());
+
+			positionIds.resize(positions.Size());
+			for (size_t v = 0; v < positions.Size(); ++v)
+			{
+				positionIds[v] = firstVertex.emplace(positions[v], static_cast<uint32_t>(v)).first->second;
+			}
+		}
+
+		FVector3f GetTriangleNormal(const FVector3f& p0, const FVector3f& p1, const FVector3f& p2)
+		{
+			return FMath::Cross(p1 - p0, p2 - p0);
+		}
+	}
+
+	size_t SimplifyIndices(uint32_t* dest, const uint32_t* indices, size_t indexCount, TStridedSpan<const FVector3f> positions,
+		size_t targetIndexCount, Scalar targetError, Scalar* resultError)
+	{
+		ASSERT(indexCount % 3 == 0);
+
+		const size_t vertexCount = positions.Size();
+
+		std::vector<uint32_t> current(indices, indices + indexCount);
+
+		std::vector<uint32_t> positionIds;
+		BuildPositionRemap(positionIds, positions);
+
+		std::vector<FQuadric> quadrics(vertexCount);
+		std::vector<EVertexKind> kinds(vertexCount);
+		std::vector<uint32_t> openOut(vertexCount);
+		std::vector<uint32_t> openIn(vertexCount);
+		std::vector<uint8_t> hasBorderEdge(vertexCount);
+		std::vector<uint8_t> hasSeamEdge(vertexCount);
+		std::vector<uint32_t> wedgeCounts(vertexCount);
+		std::vector<uint32_t> otherWedge(vertexCount);
+		std::vector<uint32_t> remap(vertexCount);
+		std::vector<uint8_t> locked(vertexCount);
+		std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+		std::vector<uint32_t> adjacency;
+		std::vector<FCollapse> collapses;
+
+		std::unordered_set<uint64_t> edges;
+		std::unordered_set<uint64_t> positionEdges;
+
+		const double maxErrorSquared = double(targetError) * targetError;
+		double largestError = 0;
+		bool quadricsBuilt = false;
+
+		while (current.size() > targetIndexCount)
+		{
+			const size_t triangleCount = current.size() / 3;
+
+			// half edges by vertex and by position: an edge without a twin is open, a border when no position twin
+			// exists either and a seam otherwise
+			edges.clear();
+			positionEdges.clear();
+			for (size_t i = 0; i < current.size(); i += 3)
+			{
+				for (size_t k = 0; k < 3; ++k)
+				{
+					const uint32_t a = current[i + k];
+					const uint32_t b = current[i + (k + 1) % 3];
+					edges.insert(MakeEdgeKey(a, b));
+					positionEdges.insert(MakeEdgeKey(positionIds[a], positionIds[b]));
+				}
+			}
+
+			std::fill(openOut.begin(), openOut.end(), NoVertex);
+			std::fill(openIn.begin(), openIn.end(), NoVertex);
+			std::fill(hasBorderEdge.begin(), hasBorderEdge.end(), 0);
+			std::fill(hasSeamEdge.begin(), hasSeamEdge.end(), 0);
+
+			for (size_t i = 0; i < current.size(); i += 3)
+			{
+				for (size_t k = 0; k < 3; ++k)
+				{
+					const uint32_t a = current[i + k];
+					const uint32_t b = current[i + (k + 1) % 3];
+					if (edges.count(MakeEdgeKey(b, a)))
+					{
+						continue;
+					}
+
+					SetUniqueVertex(openOut[a], b);
+					SetUniqueVertex(openIn[b], a);
+
+					const bool seam = positionEdges.count(MakeEdgeKey(positionIds[b], positionIds[a])) != 0;
+					uint8_t& flagA = seam ? hasSeamEdge[a] : hasBorderEdge[a];
+					uint8_t& flagB = seam ? hasSeamEdge[b] : hasBorderEdge[b];
+					flagA = 1;
+					flagB = 1;
+				}
+			}
+
+			// wedges still referenced per position
+			std::fill(wedgeCounts.begin(), wedgeCounts.end(), 0);
+			std::fill(otherWedge.begin(), otherWedge.end(), NoVertex);
+			std::fill(locked.begin(), locked.end(), 0);
+			for (uint32_t v : current)
+			{
+				locked[v] = 1;
+			}
+			std::vector<uint32_t> firstWedge(vertexCount, NoVertex);
+			for (uint32_t v = 0; v < vertexCount; ++v)
+			{
+				if (!locked[v])
+				{
+					continue;
+				}
+
+				const uint32_t p = positionIds[v];
+				if (wedgeCounts[p]++ == 0)
+				{
+					firstWedge[p] = v;
+				}
+				else
+				{
+					otherWedge[v] = firstWedge[p];
+					otherWedge[firstWedge[p]] = v;
+				}
+			}
+
+			for (uint32_t v = 0; v < vertexCount; ++v)
+			{
+				const uint32_t wedges = wedgeCounts[positionIds[v]];
+				const bool uniqueOpen = openOut[v] < MultipleVertices && openIn[v] < MultipleVertices;
+				const bool closed = openOut[v] == NoVertex && openIn[v] == NoVertex;
+
+				if (wedges == 1)
+				{
+					kinds[v] = closed ? EVertexKind::Manifold : (uniqueOpen && !hasSeamEdge[v] ? EVertexKind::Border : EVertexKind::Locked);
+				}
+				else if (wedges == 2)
+				{
+					kinds[v] = uniqueOpen && !hasBorderEdge[v] ? EVertexKind::Seam : EVertexKind::Locked;
+				}
+				else
+				{
+					kinds[v] = EVertexKind::Locked;
+				}
+			}
+
+			// quadrics live on the position representative and accumulate over collapses
+			if (!quadricsBuilt)
+			{
+				quadricsBuilt = true;
+				for (size_t i = 0; i < current.size(); i += 3)
+				{
+					const FVector3f& p0 = positions[current[i + 0]];
+					const FVector3f& p1 = positions[current[i + 1]];
+					const FVector3f& p2 = positions[current[i + 2]];
+
+					FVector3f normal = GetTriangleNormal(p0, p1, p2);
+					const Scalar doubleArea = FMath::Length(normal);
+					if (doubleArea <= 0)
+					{
+						continue;
+					}
+					normal = normal * (Scalar{ 1 } / doubleArea);
+
+					const Scalar d = -FMath::Dot(normal, p0);
+					for (size_t k = 0; k < 3; ++k)
+					{
+						quadrics[positionIds[current[i + k]]].AddPlane(normal, d, doubleArea * Scalar{ 0.5 });
+					}
+
+					for (size_t k = 0; k < 3; ++k)
+					{
+						const uint32_t a = current[i + k];
+						const uint32_t b = current[i + (k + 1) % 3];
+						if (edges.count(MakeEdgeKey(b, a)))
+						{
+							continue;
+						}
+
+						// plane through the open edge perpendicular to the triangle
+						const FVector3f& pa = positions[a];
+						const FVector3f edge = positions[b] - pa;
+						const Scalar edgeLength = FMath::Length(edge);
+						if (edgeLength <= 0)
+						{
+							continue;
+						}
+
+						const FVector3f edgeNormal = FMath::Cross(edge, normal) * (Scalar{ 1 } / edgeLength);
+						const Scalar edgeD = -FMath::Dot(edgeNormal, pa);
+						const Scalar weight = edgeLength * edgeLength * BoundaryWeight;
+						quadrics[positionIds[a]].AddPlane(edgeNormal, edgeD, weight);
+						quadrics[positionIds[b]].AddPlane(edgeNormal, edgeD, weight);
+					}
+				}
+			}
+
+			// triangles around each position for the flip test
+			std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+			for (uint32_t v : current)
+			{
+				adjacencyOffsets[positionIds[v] + 1]++;
+			}
+			for (size_t v = 0; v < vertexCount; ++v)
+			{
+				adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+			}
+			adjacency.resize(current.size());
+			{
+				std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+				for (size_t i = 0; i < current.size(); ++i)
+				{
+					adjacency[cursor[positionIds[current[i]]]++] = static_cast<uint32_t>(i / 3);
+				}
+			}
+
+			auto isCollapseAllowed = [&](uint32_t from, uint32_t to)
+			{
+				if (positionIds[from] == positionIds[to])
+				{
+					return false;
+				}
+
+				switch (kinds[from])
+				{
+				case EVertexKind::Manifold:
+					return true;
+				case EVertexKind::Border:
+					return kinds[to] == EVertexKind::Border && (openOut[from] == to || openIn[from] == to);
+				case EVertexKind::Seam:
+				{
+					if (kinds[to] != EVertexKind::Seam || (openOut[from] != to && openIn[from] != to))
+					{
+						return false;
+					}
+
+					// the other side of the seam needs the matching edge to collapse along
+					const uint32_t fromTwin = otherWedge[from];
+					const uint32_t toTwin = otherWedge[to];
+					return fromTwin != NoVertex && toTwin != NoVertex
+						&& (edges.count(MakeEdgeKey(fromTwin, toTwin)) || edges.count(MakeEdgeKey(toTwin, fromTwin)));
+				}
+				default:
+					return false;
+				}
+			};
+
+			collapses.clear();
+			for (size_t i = 0; i < current.size(); i += 3)
+			{
+				for (size_t k = 0; k < 3; ++k)
+				{
+					const uint32_t a = current[i + k];
+					const uint32_t b = current[i + (k + 1) % 3];
+
+					for (const auto& [from, to] : { std::pair(a, b), std::pair(b, a) })
+					{
+						if (isCollapseAllowed(from, to))
+						{
+							FQuadric q = quadrics[positionIds[from]];
+							q += quadrics[positionIds[to]];
+							collapses.push_back(FCollapse{ from, to, q.Evaluate(positions[to]) });
+						}
+					}
+				}
+			}
+
+			std::sort(collapses.begin(), collapses.end(), [](const FCollapse& x, const FCollapse& y) { return x.Cost < y.Cost; });
+
+			for (uint32_t v = 0; v < vertexCount; ++v)
+			{
+				remap[v] = v;
+			}
+			std::fill(locked.begin(), locked.end(), 0);
+
+			const size_t targetTriangles = targetIndexCount / 3;
+			size_t removedTriangles = 0;
+			size_t collapseCount = 0;
+
+			for (const FCollapse& collapse : collapses)
+			{
+				if (collapse.Cost > maxErrorSquared || triangleCount - removedTriangles <= targetTriangles)
+				{
+					break;
+				}
+
+				const uint32_t fromPosition = positionIds[collapse.From];
+				const uint32_t toPosition = positionIds[collapse.To];
+				if (locked[fromPosition] || locked[toPosition])
+				{
+					continue;
+				}
+
+				// reject collapses that flip a remaining triangle around the moving position
+				const FVector3f& target = positions[collapse.To];
+				bool flips = false;
+				size_t collapsedTriangles = 0;
+				for (uint32_t a = adjacencyOffsets[fromPosition]; a < adjacencyOffsets[fromPosition + 1] && !flips; ++a)
+				{
+					const uint32_t triangle = adjacency[a];
+					FVector3f p[3];
+					FVector3f moved[3];
+					bool containsTarget = false;
+					for (size_t k = 0; k < 3; ++k)
+					{
+						const uint32_t v = current[triangle * 3 + k];
+						p[k] = positions[v];
+						moved[k] = positionIds[v] == fromPosition ? target : p[k];
+						containsTarget |= positionIds[v] == toPosition;
+					}
+
+					if (containsTarget)
+					{
+						collapsedTriangles++;
+						continue;
+					}
+
+					const FVector3f before = GetTriangleNormal(p[0], p[1], p[2]);
+					const FVector3f after = GetTriangleNormal(moved[0], moved[1], moved[2]);
+					flips = FMath::Dot(before, after) <= Scalar{ 0.25 } * FMath::Length(before) * FMath::Length(after);
+				}
+
+				if (flips)
+				{
+					continue;
+				}
+
+				remap[collapse.From] = collapse.To;
+				if (kinds[collapse.From] == EVertexKind::Seam)
+				{
+					remap[otherWedge[collapse.From]] = otherWedge[collapse.To];
+				}
+
+				quadrics[toPosition] += quadrics[fromPosition];
+				largestError = std::max(largestError, collapse.Cost);
+
+				// neighbours are locked too, their flip tests assumed the current positions
+				for (uint32_t a = adjacencyOffsets[fromPosition]; a < adjacencyOffsets[fromPosition + 1]; ++a)
+				{
+					for (size_t k = 0; k < 3; ++k)
+					{
+						locked[positionIds[current[adjacency[a] * 3 + k]]] = 1;
+					}
+				}
+
+				removedTriangles += collapsedTriangles;
+				collapseCount++;
+			}
+
+			if (collapseCount == 0)
+			{
+				break;
+			}
+
+			size_t writeIndex = 0;
+			for (size_t i = 0; i < current.size(); i += 3)
+			{
+				const uint32_t a = remap[current[i + 0]];
+				const uint32_t b = remap[current[i + 1]];
+				const uint32_t c = remap[current[i + 2]];
+				if (positionIds[a] == positionIds[b] || positionIds[b] == positionIds[c] || positionIds[a] == positionIds[c])
+				{
+					continue;
+				}
+
+				current[writeIndex++] = a;
+				current[writeIndex++] = b;
+				current[writeIndex++] = c;
+			}
+			current.resize(writeIndex);
+		}
+
+		if (resultError)
+		{
+			*resultError = static_cast<Scalar>(std::sqrt(largestError));
+		}
+
+		std::copy(current.begin(), current.end(), dest);
+		return current.size();
+	}
+
+	std::vector<FMeshLOD> GenerateLODChain(const TriangleMesh& mesh, const FLODChainSettings& settings, std::pmr::memory_resource* resource)
+	{
+		const FVertexAttributeHandle positionHandle = mesh.FindVertexAttribute(VertexAttribute::Position::Name);
+		ASSERT(positionHandle.IsValid());
+		const TStridedSpan<const FVector3f> positions = mesh.GetVertexAttribute<FVector3f>(positionHandle);
+
+		std::vector<MeshPart> parts = mesh.MeshParts;
+		if (parts.empty())
+		{
+			parts.emplace_back(0, mesh.NumVertices, 0, mesh.NumIndices, 0);
+		}
+
+		FBoundingBox bounds;
+		for (const FVector3f& p : positions)
+		{
+			for (size_t k = 0; k < 3; ++k)
+			{
+				bounds.Lower[k] = FMath::Min(bounds.Lower[k], p[k]);
+				bounds.Upper[k] = FMath::Max(bounds.Upper[k], p[k]);
+			}
+		}
+		const Scalar radius = positions.IsEmpty() ? Scalar{ 0 } : FMath::Length(bounds.Upper - bounds.Lower) * Scalar{ 0.5 };
+		const Scalar maxError = radius * settings.MaxRelativeError;
+
+		// per part index lists in absolute vertex indices, simplified level by level
+		std::vector<std::vector<uint32_t>> partIndices(parts.size());
+		for (size_t i = 0; i < parts.size(); ++i)
+		{
+			mesh.ReadPartIndices(partIndices[i], parts[i]);
+		}
+
+		std::vector<FMeshLOD> lods;
+		std::vector<uint32_t> remap(mesh.NumVertices);
+		std::vector<uint32_t> combined;
+		Scalar error = 0;
+
+		for (size_t level = 0; level < settings.MaxLevels; ++level)
+		{
+			size_t indexCount = 0;
+			if (level > 0)
+			{
+				size_t previousCount = 0;
+				Scalar levelError = 0;
+				for (std::vector<uint32_t>& indices : partIndices)
+				{
+					previousCount += indices.size();
+
+					// each level only knows its distance to the previous one, the budget left bounds the whole chain
+					const size_t target = static_cast<size_t>(indices.size() / 3 * settings.Reduction) * 3;
+					Scalar partError = 0;
+					indices.resize(SimplifyIndices(indices.data(), indices.data(), indices.size(), positions, target, maxError - error, &partError));
+					levelError = FMath::Max(levelError, partError);
+				}
+
+				for (const std::vector<uint32_t>& indices : partIndices)
+				{
+					indexCount += indices.size();
+				}
+
+				if (indexCount == 0 || indexCount > previousCount * 95 / 100)
+				{
+					break;
+				}
+
+				error += levelError;
+			}
+
+			combined.clear();
+			for (const std::vector<uint32_t>& indices : partIndices)
+			{
+				combined.insert(combined.end(), indices.begin(), indices.end());
+			}
+
+			const size_t vertexCount = BuildVertexFetchRemap(remap.data(), combined.data(), combined.size(), mesh.NumVertices);
+
+			std::shared_ptr<TriangleMesh> lodMesh = std::allocate_shared<TriangleMesh>(std::pmr::polymorphic_allocator<TriangleMesh>(resource), resource);
+			lodMesh->InputElements = mesh.InputElements;
+			lodMesh->InputElementMap = mesh.InputElementMap;
+			lodMesh->VertexStride = mesh.VertexStride;
+			lodMesh->NumVertices = vertexCount;
+			lodMesh->NumIndices = combined.size();
+			lodMesh->IndexType = vertexCount <= 0xFFFF ? EDASH_FORMAT::R16_UINT : EDASH_FORMAT::R32_UINT;
+
+			lodMesh->Vertices.resize(vertexCount * mesh.VertexStride);
+			for (size_t v = 0; v < mesh.NumVertices; ++v)
+			{
+				if (remap[v] < vertexCount)
+				{
+					std::memcpy(lodMesh->Vertices.data() + remap[v] * mesh.VertexStride, mesh.Vertices.data() + v * mesh.VertexStride, mesh.VertexStride);
+				}
+			}
+
+			for (uint32_t& index : combined)
+			{
+				index = remap[index];
+			}
+			lodMesh->Indices.resize(combined.size() * GetByteSizeForFormat(lodMesh->IndexType));
+			lodMesh->WriteIndices(combined.data(), 0, combined.size());
+
+			size_t indexStart = 0;
+			for (size_t i = 0; i < parts.size(); ++i)
+			{
+				lodMesh->MeshParts.emplace_back(0, vertexCount, indexStart, partIndices[i].size(), parts[i].MaterialIdx);
+				indexStart += partIndices[i].size();
+			}
+
+			lods.push_back(FMeshLOD{ lodMesh, error });
+		}
+
+		return lods;
+	}
+
+	Scalar GetProjectedError(const FCamera& camera, const FVector3f& position, Scalar error)
+	{
+		const FMatrix4x4 projection = camera.GetProjectionMatrix();
+		const Scalar halfHeight = static_cast<Scalar>(camera.GetPixelHeight()) * Scalar{ 0.5 };
+
+		// perspective projections put the view depth in w, orthographic ones keep w at one
+		const bool perspective = projection[3][3] == Scalar{ 0 };
+		if (!perspective)
+		{
+			return error * projection[1][1] * halfHeight;
+		}
+
+		const Scalar depth = FMath::Dot(position - camera.GetPosition(), camera.GetForward());
+		if (depth <= camera.GetNear())
+		{
+			return TScalarTraits<Scalar>::Max();
+		}
+
+		return error * projection[1][1] * halfHeight / depth;
+	}
+
+	size_t SelectLOD(const std::vector<FMeshLOD>& lods, const FCamera& camera, const FVector3f& objectCenter, Scalar objectScale, Scalar maxPixelError)
+	{
+		size_t selected = 0;
+		for (size_t i = 1; i < lods.size(); ++i)
+		{
+			if (GetProjectedError(camera, objectCenter, lods[i].Error * objectScale) > maxPixelError)
+			{
+				break;
+			}
+			selected = i;
+		}
+		return selected;
+	}
+}
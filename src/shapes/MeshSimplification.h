@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Shape.h"
+
+namespace Dash
+{
+	class FCamera;
+
+	/**
+	 * Quadric error metric simplification by edge collapse onto existing vertices, so attributes never need to be
+	 * interpolated. Vertices sharing a position with different attributes form seams, seam and border vertices only
+	 * collapse along their seam or border and both sides of a seam collapse together. Collapses that would flip a
+	 * triangle are rejected.
+	 *
+	 * Stops at targetIndexCount or when the next collapse would exceed targetError, an object space distance.
+	 * Returns the new index count, resultError receives the largest error introduced. dest may alias indices.
+	 */
+	size_t SimplifyIndices(uint32_t* dest, const uint32_t* indices, size_t indexCount, TStridedSpan<const FVector3f> positions,
+		size_t targetIndexCount, Scalar targetError, Scalar* resultError = nullptr);
+
+	struct FMeshLOD
+	{
+		std::shared_ptr<TriangleMesh> Mesh;
+
+		/**
+		 * Upper bound of the object space distance of the level from the full detail mesh, the sum of the errors of the
+		 * simplification steps that led to it.
+		 */
+		Scalar Error = 0;
+	};
+
+	struct FLODChainSettings
+	{
+		size_t MaxLevels = 6;
+
+		/** Index count of each level relative to the previous one. */
+		Scalar Reduction = 0.5f;
+
+		/** Limit of the accumulated error of the coarsest level, relative to the radius of the mesh bounds. */
+		Scalar MaxRelativeError = 0.05f;
+	};
+
+	/**
+	 * Level 0 is a copy of the mesh, every further level is simplified from the previous one and holds only the vertices
+	 * it references. Generation stops early once a level no longer shrinks noticeably.
+	 */
+	std::vector<FMeshLOD> GenerateLODChain(const TriangleMesh& mesh, const FLODChainSettings& settings = FLODChainSettings{},
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	/** Height in pixels an object space error covers on screen at the given world space position. */
+	Scalar GetProjectedError(const FCamera& camera, const FVector3f& position, Scalar error);
+
+	/** Coarsest level whose projected error stays below maxPixelError, objectScale converts object to world units. */
+	size_t SelectLOD(const std::vector<FMeshLOD>& lods, const FCamera& camera, const FVector3f& objectCenter, Scalar objectScale = 1, Scalar maxPixelError = 1);
+}
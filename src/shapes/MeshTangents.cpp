@@ -0,0 +1,171 @@
+#include "MeshTangents.h"
+#include "../utility/ParallelFor.h"
+
+namespace Dash
+{
+	namespace
+	{
+		/** Unit dP/du of a face and the sign of its UV area, zero for faces without a usable UV mapping. */
+		struct FFaceTangent
+		{
+			FVector3f Tangent;
+			Scalar Orientation;
+		};
+
+		FORCEINLINE FVector3f ProjectOnPlane(const FVector3f& v, const FVector3f& normal)
+		{
+			return v - normal * FMath::Dot(normal, v);
+		}
+
+		FORCEINLINE bool NormalizeSafe(FVector3f& v)
+		{
+			const Scalar length = FMath::Length(v);
+			if (length <= Scalar{ 1e-20f })
+			{
+				return false;
+			}
+
+			v = v * (Scalar{ 1 } / length);
+			return true;
+		}
+
+		/** Any unit vector perpendicular to the normal, for vertices whose faces have no usable UV derivative. */
+		FVector3f GetFallbackTangent(const FVector3f& normal)
+		{
+			FVector3f tangent = FMath::Abs(normal.x) < Scalar{ 0.9 } ? FVector3f{ 1, 0, 0 } : FVector3f{ 0, 1, 0 };
+			tangent = ProjectOnPlane(tangent, normal);
+			return NormalizeSafe(tangent) ? tangent : FVector3f{ 1, 0, 0 };
+		}
+	}
+
+	void GenerateTangents(TStridedSpan<const FVector3f> positions, TStridedSpan<const FVector3f> normals, TStridedSpan<const FVector2f> texCoords,
+		const uint32_t* indices, size_t indexCount, TStridedSpan<FVector3f> tangents, Scalar* bitangentSigns)
+	{
+		ASSERT(indexCount % 3 == 0);
+		ASSERT(normals.Size() == positions.Size() && texCoords.Size() == positions.Size() && tangents.Size() == positions.Size());
+
+		const size_t vertexCount = positions.Size();
+		const size_t triangleCount = indexCount / 3;
+
+		std::vector<FFaceTangent> faces(triangleCount);
+		ParallelFor(0, triangleCount, [&](size_t t)
+		{
+			const uint32_t* triangle = indices + t * 3;
+			const FVector3f& p0 = positions[triangle[0]];
+			const FVector2f& uv0 = texCoords[triangle[0]];
+
+			const FVector3f d1 = positions[triangle[1]] - p0;
+			const FVector3f d2 = positions[triangle[2]] - p0;
+			const FVector2f st1 = texCoords[triangle[1]] - uv0;
+			const FVector2f st2 = texCoords[triangle[2]] - uv0;
+
+			// dP/du up to the scale 1 / area, the sign of the UV area restores its direction on mirrored faces
+			const Scalar signedArea = st1.x * st2.y - st1.y * st2.x;
+			const Scalar orientation = signedArea < 0 ? Scalar{ -1 } : Scalar{ 1 };
+			FVector3f tangent = (d1 * st2.y - d2 * st1.y) * orientation;
+
+			const bool valid = FMath::Abs(signedArea) > Scalar{ 1e-20f } && NormalizeSafe(tangent);
+			faces[t].Tangent = valid ? tangent : FVector3f{ 0, 0, 0 };
+			faces[t].Orientation = valid ? orientation : Scalar{ 0 };
+		}, 1024);
+
+		// vertex to corner table so each vertex sums its own corners
+		std::vector<uint32_t> offsets(vertexCount + 1, 0);
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			offsets[indices[i] + 1]++;
+		}
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			offsets[v + 1] += offsets[v];
+		}
+
+		std::vector<uint32_t> vertexCorners(indexCount);
+		{
+			std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < indexCount; ++i)
+			{
+				vertexCorners[cursor[indices[i]]++] = static_cast<uint32_t>(i);
+			}
+		}
+
+		// corners are weighted by their angle in the tangent plane like MikkTSpace does
+		ParallelFor(0, vertexCount, [&](size_t v)
+		{
+			const FVector3f& normal = normals[v];
+			const FVector3f& position = positions[v];
+
+			FVector3f sum{ 0, 0, 0 };
+			Scalar orientation = 0;
+			for (uint32_t c = offsets[v]; c < offsets[v + 1]; ++c)
+			{
+				const uint32_t corner = vertexCorners[c];
+				const FFaceTangent& face = faces[corner / 3];
+				if (face.Orientation == 0)
+				{
+					continue;
+				}
+
+				const uint32_t* triangle = indices + corner / 3 * 3;
+				const uint32_t k = corner % 3;
+
+				FVector3f tangent = ProjectOnPlane(face.Tangent, normal);
+				const FVector3f edge0 = ProjectOnPlane(positions[triangle[(k + 1) % 3]] - position, normal);
+				const FVector3f edge1 = ProjectOnPlane(positions[triangle[(k + 2) % 3]] - position, normal);
+				if (!NormalizeSafe(tangent))
+				{
+					continue;
+				}
+
+				// atan2 of the unnormalized edges gives the same angle as acos of the normalized ones
+				const Scalar angle = std::atan2(FMath::Length(FMath::Cross(edge0, edge1)), FMath::Dot(edge0, edge1));
+				sum += tangent * angle;
+				orientation += face.Orientation * angle;
+			}
+
+			FVector3f tangent = ProjectOnPlane(sum, normal);
+			tangents[v] = NormalizeSafe(tangent) ? tangent : GetFallbackTangent(normal);
+
+			if (bitangentSigns)
+			{
+				bitangentSigns[v] = orientation < 0 ? Scalar{ -1 } : Scalar{ 1 };
+			}
+		}, 4096);
+	}
+
+	bool GenerateTangents(TriangleMesh& mesh)
+	{
+		const FVertexAttributeHandle positionHandle = mesh.FindVertexAttribute(VertexAttribute::Position::Name);
+		const FVertexAttributeHandle normalHandle = mesh.FindVertexAttribute(VertexAttribute::Normal::Name);
+		const FVertexAttributeHandle texCoordHandle = mesh.FindVertexAttribute(VertexAttribute::TexCoord::Name);
+		const FVertexAttributeHandle tangentHandle = mesh.FindVertexAttribute(VertexAttribute::Tangent::Name);
+		if (!positionHandle.IsValid() || !normalHandle.IsValid() || !texCoordHandle.IsValid() || !tangentHandle.IsValid())
+		{
+			return false;
+		}
+
+		const bool hasSign = tangentHandle.Format == EDASH_FORMAT::R32G32B32A32_FLOAT;
+		ASSERT(hasSign || tangentHandle.Format == EDASH_FORMAT::R32G32B32_FLOAT);
+
+		std::vector<uint32_t> indices;
+		mesh.ReadAbsoluteIndices(indices);
+
+		std::vector<Scalar> signs(hasSign ? mesh.NumVertices : 0);
+
+		const TriangleMesh& source = mesh;
+		TStridedSpan<FVector3f> tangents(mesh.Vertices.data() + tangentHandle.Offset, mesh.NumVertices, mesh.VertexStride);
+		GenerateTangents(source.GetVertexAttribute<FVector3f>(positionHandle), source.GetVertexAttribute<FVector3f>(normalHandle),
+			source.GetVertexAttribute<FVector2f>(texCoordHandle), indices.data(), indices.size(), tangents, hasSign ? signs.data() : nullptr);
+
+		if (hasSign)
+		{
+			TStridedSpan<Scalar> w(mesh.Vertices.data() + tangentHandle.Offset + sizeof(FVector3f), mesh.NumVertices, mesh.VertexStride);
+			for (size_t v = 0; v < mesh.NumVertices; ++v)
+			{
+				w[v] = signs[v];
+			}
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Shape.h"
+
+namespace Dash
+{
+	/**
+	 * MikkTSpace style tangents. Every corner projects its face's dP/du into the tangent plane of the vertex normal and
+	 * weights it by the corner angle, the bitangent sign is the UV orientation of the faces. Vertices are not split, so
+	 * a vertex shared by mirrored faces takes the orientation with the larger angle sum.
+	 *
+	 * Faces are evaluated in parallel into per corner contributions that are then gathered per vertex through a vertex to
+	 * corner table, so no two threads write the same vertex and the result doesn't depend on the thread count.
+	 * bitangentSigns is optional and receives +1 or -1 per vertex, bitangent = sign * cross(normal, tangent).
+	 */
+	void GenerateTangents(TStridedSpan<const FVector3f> positions, TStridedSpan<const FVector3f> normals, TStridedSpan<const FVector2f> texCoords,
+		const uint32_t* indices, size_t indexCount, TStridedSpan<FVector3f> tangents, Scalar* bitangentSigns = nullptr);
+
+	/**
+	 * Fills the mesh TANGENT attribute from its positions, normals and texture coordinates. A four component tangent
+	 * gets the bitangent sign in w. Returns false when one of the attributes is missing.
+	 */
+	bool GenerateTangents(TriangleMesh& mesh);
+}
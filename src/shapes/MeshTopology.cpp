@@ -0,0 +1,334 @@
+#include "MeshTopology.h"
+#include "../utility/ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace Dash
+{
+	namespace
+	{
+		struct FWeldKey
+		{
+			uint32_t Position[3];
+			uint32_t Vertex;
+
+			bool operator<(const FWeldKey& other) const
+			{
+				return std::tie(Position[0], Position[1], Position[2], Vertex) < std::tie(other.Position[0], other.Position[1], other.Position[2], other.Vertex);
+			}
+
+			bool IsSamePosition(const FWeldKey& other) const
+			{
+				return Position[0] == other.Position[0] && Position[1] == other.Position[1] && Position[2] == other.Position[2];
+			}
+		};
+
+		struct FEdgeKey
+		{
+			uint32_t V0;
+			uint32_t V1;
+			uint32_t HalfEdge;
+
+			bool operator<(const FEdgeKey& other) const
+			{
+				return std::tie(V0, V1, HalfEdge) < std::tie(other.V0, other.V1, other.HalfEdge);
+			}
+		};
+
+		/** Sort key of a coordinate: its bits with -0 folded onto 0, or its cell index on the tolerance grid. */
+		FORCEINLINE uint32_t GetWeldCoordinate(Scalar value, Scalar inverseTolerance)
+		{
+			if (inverseTolerance > 0)
+			{
+				return static_cast<uint32_t>(static_cast<int32_t>(std::floor(value * inverseTolerance + Scalar{ 0.5 })));
+			}
+
+			const float folded = value + 0.0f;
+			uint32_t bits;
+			std::memcpy(&bits, &folded, sizeof(bits));
+			return bits;
+		}
+
+		FORCEINLINE Scalar GetCornerAngle(const FVector3f& corner, const FVector3f& next, const FVector3f& prev)
+		{
+			const FVector3f edge0 = next - corner;
+			const FVector3f edge1 = prev - corner;
+			return std::atan2(FMath::Length(FMath::Cross(edge0, edge1)), FMath::Dot(edge0, edge1));
+		}
+	}
+
+	FMeshTopology::FMeshTopology(TStridedSpan<const FVector3f> positions, const uint32_t* indices, size_t indexCount, Scalar weldTolerance)
+		: mIndices(indices, indices + indexCount)
+	{
+		Build(positions, weldTolerance);
+	}
+
+	FMeshTopology::FMeshTopology(const TriangleMesh& mesh, Scalar weldTolerance)
+	{
+		const FVertexAttributeHandle positionHandle = mesh.FindVertexAttribute(VertexAttribute::Position::Name);
+		ASSERT(positionHandle.IsValid());
+
+		mesh.ReadAbsoluteIndices(mIndices);
+		Build(mesh.GetVertexAttribute<FVector3f>(positionHandle), weldTolerance);
+	}
+
+	void FMeshTopology::Build(TStridedSpan<const FVector3f> positions, Scalar weldTolerance)
+	{
+		ASSERT(mIndices.size() % 3 == 0);
+
+		const size_t vertexCount = positions.Size();
+		const size_t halfEdgeCount = mIndices.size();
+
+		// weld by sorting quantized positions, ids follow the sorted order
+		const Scalar inverseTolerance = weldTolerance > 0 ? Scalar{ 1 } / weldTolerance : Scalar{ 0 };
+		std::vector<FWeldKey> weldKeys(vertexCount);
+		ParallelFor(0, vertexCount, [&](size_t v)
+		{
+			const FVector3f& p = positions[v];
+			weldKeys[v] = FWeldKey{ { GetWeldCoordinate(p.x, inverseTolerance), GetWeldCoordinate(p.y, inverseTolerance), GetWeldCoordinate(p.z, inverseTolerance) }, static_cast<uint32_t>(v) };
+		}, 4096);
+		ParallelSort(weldKeys.begin(), weldKeys.end(), std::less<>{});
+
+		mWeldedIds.resize(vertexCount);
+		uint32_t weldedCount = 0;
+		for (size_t i = 0; i < vertexCount; ++i)
+		{
+			if (i > 0 && !weldKeys[i].IsSamePosition(weldKeys[i - 1]))
+			{
+				weldedCount++;
+			}
+			mWeldedIds[weldKeys[i].Vertex] = weldedCount;
+		}
+		weldedCount += vertexCount > 0 ? 1 : 0;
+
+		// half edges sharing both welded end points sort next to each other
+		std::vector<FEdgeKey> edgeKeys(halfEdgeCount);
+		ParallelFor(0, halfEdgeCount, [&](size_t h)
+		{
+			const uint32_t a = GetHalfEdgeStart(static_cast<uint32_t>(h));
+			const uint32_t b = GetHalfEdgeEnd(static_cast<uint32_t>(h));
+			edgeKeys[h] = FEdgeKey{ std::min(a, b), std::max(a, b), static_cast<uint32_t>(h) };
+		}, 4096);
+		ParallelSort(edgeKeys.begin(), edgeKeys.end(), std::less<>{});
+
+		mTwins.assign(halfEdgeCount, InvalidIndex);
+		mHalfEdgeEdges.resize(halfEdgeCount);
+		mEdges.clear();
+		mBorderEdgeCount = 0;
+		mNonManifoldEdgeCount = 0;
+
+		for (size_t i = 0; i < halfEdgeCount;)
+		{
+			size_t j = i + 1;
+			while (j < halfEdgeCount && edgeKeys[j].V0 == edgeKeys[i].V0 && edgeKeys[j].V1 == edgeKeys[i].V1)
+			{
+				++j;
+			}
+
+			const uint32_t edge = static_cast<uint32_t>(mEdges.size());
+			const uint32_t count = static_cast<uint32_t>(j - i);
+			mEdges.push_back(FMeshEdge{ edgeKeys[i].V0, edgeKeys[i].V1, edgeKeys[i].HalfEdge, count });
+			for (size_t k = i; k < j; ++k)
+			{
+				mHalfEdgeEdges[edgeKeys[k].HalfEdge] = edge;
+			}
+
+			if (count == 1)
+			{
+				mBorderEdgeCount++;
+			}
+			else if (count > 2)
+			{
+				mNonManifoldEdgeCount++;
+			}
+			else
+			{
+				// twins only when the two faces agree on the winding
+				const uint32_t h0 = edgeKeys[i].HalfEdge;
+				const uint32_t h1 = edgeKeys[i + 1].HalfEdge;
+				if (edgeKeys[i].V0 != edgeKeys[i].V1 && GetHalfEdgeStart(h0) != GetHalfEdgeStart(h1))
+				{
+					mTwins[h0] = h1;
+					mTwins[h1] = h0;
+				}
+			}
+
+			i = j;
+		}
+
+		// triangles around each welded vertex
+		mVertexTriangleOffsets.assign(weldedCount + 1, 0);
+		for (uint32_t index : mIndices)
+		{
+			mVertexTriangleOffsets[mWeldedIds[index] + 1]++;
+		}
+		for (size_t w = 0; w < weldedCount; ++w)
+		{
+			mVertexTriangleOffsets[w + 1] += mVertexTriangleOffsets[w];
+		}
+
+		mVertexTriangles.resize(halfEdgeCount);
+		std::vector<uint32_t> cursor(mVertexTriangleOffsets.begin(), mVertexTriangleOffsets.end() - 1);
+		for (size_t i = 0; i < halfEdgeCount; ++i)
+		{
+			mVertexTriangles[cursor[mWeldedIds[mIndices[i]]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	void FMeshTopology::ComputeVertexNormals(TStridedSpan<const FVector3f> positions, TStridedSpan<FVector3f> normals, ENormalWeighting weighting) const
+	{
+		ASSERT(positions.Size() == GetVertexCount() && normals.Size() == GetVertexCount());
+
+		const size_t triangleCount = GetTriangleCount();
+		const size_t weldedCount = GetWeldedVertexCount();
+
+		// cross products are twice the area, so they already carry the area weight
+		std::vector<FVector3f> faceNormals(triangleCount);
+		ParallelFor(0, triangleCount, [&](size_t t)
+		{
+			const FVector3f& p0 = positions[mIndices[t * 3 + 0]];
+			faceNormals[t] = FMath::Cross(positions[mIndices[t * 3 + 1]] - p0, positions[mIndices[t * 3 + 2]] - p0);
+		}, 4096);
+
+		std::vector<FVector3f> weldedNormals(weldedCount);
+		std::vector<uint8_t> valid(weldedCount);
+		ParallelFor(0, weldedCount, [&](size_t w)
+		{
+			FVector3f sum{ 0, 0, 0 };
+			for (uint32_t i = mVertexTriangleOffsets[w]; i < mVertexTriangleOffsets[w + 1]; ++i)
+			{
+				const uint32_t t = mVertexTriangles[i];
+				const FVector3f& faceNormal = faceNormals[t];
+				const Scalar length = FMath::Length(faceNormal);
+				if (length <= 0)
+				{
+					continue;
+				}
+
+				if (weighting == ENormalWeighting::Area)
+				{
+					sum += faceNormal;
+					continue;
+				}
+
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					if (mWeldedIds[mIndices[t * 3 + k]] == w)
+					{
+						const Scalar angle = GetCornerAngle(positions[mIndices[t * 3 + k]], positions[mIndices[t * 3 + (k + 1) % 3]], positions[mIndices[t * 3 + (k + 2) % 3]]);
+						sum += faceNormal * (angle / length);
+						break;
+					}
+				}
+			}
+
+			const Scalar length = FMath::Length(sum);
+			valid[w] = length > 0 ? 1 : 0;
+			weldedNormals[w] = length > 0 ? sum * (Scalar{ 1 } / length) : sum;
+		}, 4096);
+
+		// unreferenced vertices keep their normal
+		ParallelFor(0, GetVertexCount(), [&](size_t v)
+		{
+			const uint32_t w = mWeldedIds[v];
+			if (valid[w])
+			{
+				normals[v] = weldedNormals[w];
+			}
+		}, 4096);
+	}
+
+	bool RecomputeNormals(TriangleMesh& mesh, ENormalWeighting weighting, Scalar weldTolerance)
+	{
+		const FVertexAttributeHandle positionHandle = mesh.FindVertexAttribute(VertexAttribute::Position::Name);
+		const FVertexAttributeHandle normalHandle = mesh.FindVertexAttribute(VertexAttribute::Normal::Name);
+		if (!positionHandle.IsValid() || !normalHandle.IsValid())
+		{
+			return false;
+		}
+
+		const FMeshTopology topology(mesh, weldTolerance);
+		const TriangleMesh& source = mesh;
+		topology.ComputeVertexNormals(source.GetVertexAttribute<FVector3f>(positionHandle), mesh.GetVertexAttribute<FVector3f>(normalHandle), weighting);
+		return true;
+	}
+
+	size_t WeldVertices(TriangleMesh& mesh)
+	{
+		const size_t vertexCount = mesh.NumVertices;
+		const size_t stride = mesh.VertexStride;
+		const uint8_t* vertices = mesh.Vertices.data();
+
+		std::vector<uint32_t> order(vertexCount);
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			order[v] = static_cast<uint32_t>(v);
+		}
+
+		ParallelSort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+		{
+			const int compare = std::memcmp(vertices + a * stride, vertices + b * stride, stride);
+			return compare < 0 || (compare == 0 && a < b);
+		});
+
+		// the first vertex of each identical run represents it
+		std::vector<uint32_t> representative(vertexCount);
+		for (size_t i = 0; i < vertexCount; ++i)
+		{
+			const bool same = i > 0 && std::memcmp(vertices + order[i] * stride, vertices + order[i - 1] * stride, stride) == 0;
+			representative[order[i]] = same ? representative[order[i - 1]] : order[i];
+		}
+
+		// representatives keep their relative order, so every record moves to a lower or equal slot
+		std::vector<uint32_t> remap(vertexCount);
+		uint32_t weldedCount = 0;
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			if (representative[v] == v)
+			{
+				if (weldedCount != v)
+				{
+					std::memcpy(mesh.Vertices.data() + weldedCount * stride, vertices + v * stride, stride);
+				}
+				remap[v] = weldedCount++;
+			}
+			else
+			{
+				remap[v] = remap[representative[v]];
+			}
+		}
+
+		std::vector<uint32_t> indices;
+		mesh.ReadAbsoluteIndices(indices);
+		for (uint32_t& index : indices)
+		{
+			index = remap[index];
+		}
+
+		if (mesh.IndexType == EDASH_FORMAT::R16_UINT && weldedCount > 0x10000)
+		{
+			mesh.IndexType = EDASH_FORMAT::R32_UINT;
+			mesh.Indices.resize(mesh.NumIndices * sizeof(uint32_t));
+		}
+
+		// parts are read in order, so their index ranges map onto the concatenated list in the same order
+		if (mesh.MeshParts.empty())
+		{
+			mesh.WriteIndices(indices.data(), 0, indices.size());
+		}
+
+		size_t offset = 0;
+		for (MeshPart& part : mesh.MeshParts)
+		{
+			mesh.WriteIndices(indices.data() + offset, part.IndexStart, part.IndexCount);
+			offset += part.IndexCount;
+			part.VertexStart = 0;
+			part.VertexCount = weldedCount;
+		}
+
+		mesh.NumVertices = weldedCount;
+		mesh.Vertices.resize(weldedCount * stride);
+		return weldedCount;
+	}
+}
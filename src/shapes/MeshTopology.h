@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Shape.h"
+
+namespace Dash
+{
+	enum class ENormalWeighting : uint8_t
+	{
+		/** Face normals weighted by triangle area, favours large faces. */
+		Area,
+
+		/** Face normals weighted by the corner angle, independent of how the surface is triangulated. */
+		Angle,
+	};
+
+	struct FMeshEdge
+	{
+		/** Welded end points, V0 < V1. */
+		uint32_t V0;
+		uint32_t V1;
+
+		/** One of the half edges on this edge. */
+		uint32_t HalfEdge;
+
+		/** Triangles sharing the edge, 1 on borders and more than 2 on non-manifold edges. */
+		uint32_t TriangleCount;
+	};
+
+	/**
+	 * Compact half edge topology of a triangle list, built once and shared by the algorithms that need adjacency.
+	 * Half edge h runs from corner h to the next corner of triangle h / 3. Vertices with the same position are welded
+	 * into one topological vertex, so UV and normal seams don't show up as borders.
+	 *
+	 * Welding and edge matching sort keys with ParallelSort, face normals and per vertex gathers run with ParallelFor.
+	 */
+	class FMeshTopology
+	{
+	public:
+		static constexpr uint32_t InvalidIndex = ~0u;
+
+		FMeshTopology() = default;
+
+		/**
+		 * indices are absolute vertex indices. Positions that round to the same multiple of weldTolerance are welded,
+		 * a tolerance of zero welds bit-identical positions only.
+		 */
+		FMeshTopology(TStridedSpan<const FVector3f> positions, const uint32_t* indices, size_t indexCount, Scalar weldTolerance = 0);
+
+		/** All mesh parts, indices offset by each part's VertexStart. */
+		explicit FMeshTopology(const TriangleMesh& mesh, Scalar weldTolerance = 0);
+
+		size_t GetTriangleCount() const { return mIndices.size() / 3; }
+		size_t GetVertexCount() const { return mWeldedIds.size(); }
+		size_t GetWeldedVertexCount() const { return mVertexTriangleOffsets.empty() ? 0 : mVertexTriangleOffsets.size() - 1; }
+
+		/** Absolute vertex indices the topology was built from. */
+		const std::vector<uint32_t>& GetIndices() const { return mIndices; }
+
+		uint32_t GetWeldedVertex(uint32_t vertex) const { return mWeldedIds[vertex]; }
+
+		static uint32_t GetNextHalfEdge(uint32_t halfEdge) { return halfEdge - halfEdge % 3 + (halfEdge % 3 + 1) % 3; }
+		static uint32_t GetPrevHalfEdge(uint32_t halfEdge) { return halfEdge - halfEdge % 3 + (halfEdge % 3 + 2) % 3; }
+		static uint32_t GetHalfEdgeTriangle(uint32_t halfEdge) { return halfEdge / 3; }
+
+		uint32_t GetHalfEdgeStart(uint32_t halfEdge) const { return mWeldedIds[mIndices[halfEdge]]; }
+		uint32_t GetHalfEdgeEnd(uint32_t halfEdge) const { return mWeldedIds[mIndices[GetNextHalfEdge(halfEdge)]]; }
+
+		/** Opposite half edge, InvalidIndex on borders, non-manifold edges and edges between inconsistently wound faces. */
+		uint32_t GetTwin(uint32_t halfEdge) const { return mTwins[halfEdge]; }
+
+		/** Triangle across edge (corner edge, corner edge + 1), InvalidIndex when there is none. */
+		uint32_t GetAdjacentTriangle(uint32_t triangle, uint32_t edge) const
+		{
+			const uint32_t twin = mTwins[triangle * 3 + edge];
+			return twin == InvalidIndex ? InvalidIndex : twin / 3;
+		}
+
+		const std::vector<FMeshEdge>& GetEdges() const { return mEdges; }
+
+		uint32_t GetHalfEdgeEdge(uint32_t halfEdge) const { return mHalfEdgeEdges[halfEdge]; }
+
+		/** Triangles around a welded vertex, unordered. */
+		TStridedSpan<const uint32_t> GetVertexTriangles(uint32_t weldedVertex) const
+		{
+			const uint32_t first = mVertexTriangleOffsets[weldedVertex];
+			return TStridedSpan<const uint32_t>(reinterpret_cast<const uint8_t*>(mVertexTriangles.data() + first),
+				mVertexTriangleOffsets[weldedVertex + 1] - first);
+		}
+
+		bool IsBorderEdge(uint32_t halfEdge) const { return mEdges[mHalfEdgeEdges[halfEdge]].TriangleCount == 1; }
+
+		size_t GetBorderEdgeCount() const { return mBorderEdgeCount; }
+		size_t GetNonManifoldEdgeCount() const { return mNonManifoldEdgeCount; }
+
+		/** Smooth normals per welded vertex, written to every vertex of the weld group so seams shade continuously. */
+		void ComputeVertexNormals(TStridedSpan<const FVector3f> positions, TStridedSpan<FVector3f> normals, ENormalWeighting weighting = ENormalWeighting::Angle) const;
+
+	private:
+		void Build(TStridedSpan<const FVector3f> positions, Scalar weldTolerance);
+
+		std::vector<uint32_t> mIndices;
+		std::vector<uint32_t> mWeldedIds;
+		std::vector<uint32_t> mTwins;
+		std::vector<uint32_t> mHalfEdgeEdges;
+		std::vector<FMeshEdge> mEdges;
+		std::vector<uint32_t> mVertexTriangleOffsets;
+		std::vector<uint32_t> mVertexTriangles;
+		size_t mBorderEdgeCount = 0;
+		size_t mNonManifoldEdgeCount = 0;
+	};
+
+	/** Rewrites the mesh NORMAL attribute with smooth normals. Returns false without positions or normals. */
+	bool RecomputeNormals(TriangleMesh& mesh, ENormalWeighting weighting = ENormalWeighting::Angle, Scalar weldTolerance = 0);
+
+	/**
+	 * Merges vertices whose whole vertex record is byte identical, remaps the indices and compacts the vertex buffer.
+	 * Mesh parts end up with VertexStart 0 and absolute indices. Returns the new vertex count.
+	 */
+	size_t WeldVertices(TriangleMesh& mesh);
+}
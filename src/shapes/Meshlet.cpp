@@ -0,0 +1,299 @@
+#include "Meshlet.h"
+#include "../graphic/Camera.h"
+#include "../utility/ParallelFor.h"
+#include <algorithm>
+
+namespace Dash
+{
+	namespace
+	{
+		constexpr uint8_t NotInMeshlet = 0xFF;
+
+		FMeshletBounds ComputeMeshletBounds(const FMeshletData& data, const FMeshlet& meshlet, const TStridedSpan<const FVector3f>& positions)
+		{
+			FMeshletBounds bounds;
+
+			for (uint32_t i = 0; i < meshlet.VertexCount; ++i)
+			{
+				const FVector3f& p = positions[data.VertexIndices[meshlet.VertexOffset + i]];
+				for (size_t k = 0; k < 3; ++k)
+				{
+					bounds.Box.Lower[k] = FMath::Min(bounds.Box.Lower[k], p[k]);
+					bounds.Box.Upper[k] = FMath::Max(bounds.Box.Upper[k], p[k]);
+				}
+			}
+
+			bounds.Center = (bounds.Box.Lower + bounds.Box.Upper) * Scalar{ 0.5 };
+			for (uint32_t i = 0; i < meshlet.VertexCount; ++i)
+			{
+				const FVector3f& p = positions[data.VertexIndices[meshlet.VertexOffset + i]];
+				bounds.Radius = FMath::Max(bounds.Radius, FMath::Length(p - bounds.Center));
+			}
+
+			const uint8_t* primitives = data.PrimitiveIndices.data() + meshlet.TriangleOffset;
+			auto getTriangle = [&](uint32_t t, FVector3f& p0, FVector3f& normal)
+			{
+				p0 = positions[data.VertexIndices[meshlet.VertexOffset + primitives[t * 3 + 0]]];
+				const FVector3f& p1 = positions[data.VertexIndices[meshlet.VertexOffset + primitives[t * 3 + 1]]];
+				const FVector3f& p2 = positions[data.VertexIndices[meshlet.VertexOffset + primitives[t * 3 + 2]]];
+
+				normal = FMath::Cross(p1 - p0, p2 - p0);
+				const Scalar length = FMath::Length(normal);
+				if (length <= Scalar{ 0 })
+				{
+					return false;
+				}
+
+				normal = normal * (Scalar{ 1 } / length);
+				return true;
+			};
+
+			FVector3f axis{ 0, 0, 0 };
+			FVector3f p0;
+			FVector3f normal;
+			for (uint32_t t = 0; t < meshlet.TriangleCount; ++t)
+			{
+				if (getTriangle(t, p0, normal))
+				{
+					axis += normal;
+				}
+			}
+
+			bounds.ConeApex = bounds.Center;
+			bounds.ConeAxis = FVector3f{ 0, 0, 0 };
+			bounds.ConeCutoff = 1;
+
+			const Scalar axisLength = FMath::Length(axis);
+			if (axisLength <= Scalar{ 0 })
+			{
+				return bounds;
+			}
+			axis = axis * (Scalar{ 1 } / axisLength);
+
+			Scalar minDot = 1;
+			for (uint32_t t = 0; t < meshlet.TriangleCount; ++t)
+			{
+				if (getTriangle(t, p0, normal))
+				{
+					minDot = FMath::Min(minDot, FMath::Dot(axis, normal));
+				}
+			}
+
+			// cones wider than ~84 degrees hardly ever cull and make the apex unstable
+			if (minDot <= Scalar{ 0.1 })
+			{
+				return bounds;
+			}
+
+			// move the apex back along the axis until it is behind every triangle plane
+			Scalar maxT = 0;
+			for (uint32_t t = 0; t < meshlet.TriangleCount; ++t)
+			{
+				if (getTriangle(t, p0, normal))
+				{
+					maxT = FMath::Max(maxT, FMath::Dot(bounds.Center - p0, normal) / FMath::Dot(axis, normal));
+				}
+			}
+
+			bounds.ConeApex = bounds.Center - axis * maxT;
+			bounds.ConeAxis = axis;
+			bounds.ConeCutoff = FMath::Sqrt(Scalar{ 1 } - minDot * minDot);
+			return bounds;
+		}
+	}
+
+	FMeshletData BuildMeshlets(const TriangleMesh& mesh, size_t maxVertices, size_t maxTriangles)
+	{
+		ASSERT(maxVertices >= 3 && maxVertices < NotInMeshlet && maxTriangles >= 1);
+
+		const FVertexAttributeHandle positionHandle = mesh.FindVertexAttribute(VertexAttribute::Position::Name);
+		ASSERT(positionHandle.IsValid());
+		const TStridedSpan<const FVector3f> positions = mesh.GetVertexAttribute<FVector3f>(positionHandle);
+
+		std::vector<MeshPart> parts = mesh.MeshParts;
+		if (parts.empty())
+		{
+			parts.emplace_back(0, mesh.NumVertices, 0, mesh.NumIndices, 0);
+		}
+
+		FMeshletData data;
+
+		std::vector<uint32_t> indices;
+		std::vector<uint32_t> adjacencyOffsets;
+		std::vector<uint32_t> adjacency;
+		std::vector<uint8_t> localIndices(mesh.NumVertices, NotInMeshlet);
+		std::vector<bool> emitted;
+		std::vector<uint32_t> candidates;
+
+		for (const MeshPart& part : parts)
+		{
+			mesh.ReadPartIndices(indices, part);
+
+			const size_t triangleCount = indices.size() / 3;
+
+			adjacencyOffsets.assign(mesh.NumVertices + 1, 0);
+			for (uint32_t index : indices)
+			{
+				adjacencyOffsets[index + 1]++;
+			}
+			for (size_t v = 0; v < mesh.NumVertices; ++v)
+			{
+				adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+			}
+			adjacency.resize(indices.size());
+			{
+				std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+				for (size_t i = 0; i < indices.size(); ++i)
+				{
+					adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+				}
+			}
+
+			emitted.assign(triangleCount, false);
+			candidates.clear();
+
+			FMeshlet meshlet;
+			meshlet.VertexOffset = static_cast<uint32_t>(data.VertexIndices.size());
+			meshlet.TriangleOffset = static_cast<uint32_t>(data.PrimitiveIndices.size());
+
+			auto flush = [&]()
+			{
+				if (meshlet.TriangleCount == 0)
+				{
+					return;
+				}
+
+				for (uint32_t i = 0; i < meshlet.VertexCount; ++i)
+				{
+					localIndices[data.VertexIndices[meshlet.VertexOffset + i]] = NotInMeshlet;
+				}
+
+				data.Meshlets.push_back(meshlet);
+				data.Bounds.push_back(ComputeMeshletBounds(data, meshlet, positions));
+
+				meshlet = FMeshlet{};
+				meshlet.VertexOffset = static_cast<uint32_t>(data.VertexIndices.size());
+				meshlet.TriangleOffset = static_cast<uint32_t>(data.PrimitiveIndices.size());
+				candidates.clear();
+			};
+
+			size_t seedCursor = 0;
+			for (;;)
+			{
+				// neighbour that adds the fewest new vertices while still fitting
+				uint32_t best = ~0u;
+				size_t bestNewVertices = 4;
+				for (size_t i = 0; i < candidates.size();)
+				{
+					const uint32_t triangle = candidates[i];
+					if (emitted[triangle])
+					{
+						candidates[i] = candidates.back();
+						candidates.pop_back();
+						continue;
+					}
+
+					size_t newVertices = 0;
+					for (size_t k = 0; k < 3; ++k)
+					{
+						newVertices += localIndices[indices[triangle * 3 + k]] == NotInMeshlet ? 1 : 0;
+					}
+
+					if (meshlet.VertexCount + newVertices <= maxVertices && newVertices < bestNewVertices)
+					{
+						best = triangle;
+						bestNewVertices = newVertices;
+						if (newVertices == 0)
+						{
+							break;
+						}
+					}
+					++i;
+				}
+
+				if (best == ~0u)
+				{
+					flush();
+
+					while (seedCursor < triangleCount && emitted[seedCursor])
+					{
+						++seedCursor;
+					}
+					if (seedCursor == triangleCount)
+					{
+						break;
+					}
+					best = static_cast<uint32_t>(seedCursor);
+				}
+
+				for (size_t k = 0; k < 3; ++k)
+				{
+					const uint32_t v = indices[best * 3 + k];
+					if (localIndices[v] == NotInMeshlet)
+					{
+						localIndices[v] = static_cast<uint8_t>(meshlet.VertexCount++);
+						data.VertexIndices.push_back(v);
+
+						for (uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; ++a)
+						{
+							if (!emitted[adjacency[a]])
+							{
+								candidates.push_back(adjacency[a]);
+							}
+						}
+					}
+					data.PrimitiveIndices.push_back(localIndices[v]);
+				}
+
+				emitted[best] = true;
+				meshlet.TriangleCount++;
+
+				if (meshlet.TriangleCount == maxTriangles)
+				{
+					flush();
+				}
+			}
+		}
+
+		return data;
+	}
+
+	bool IsMeshletCulled(const FMeshletBounds& bounds, const FFrustum& frustum, const FVector3f& viewPosition)
+	{
+		if (!frustum.IntersectsSphere(bounds.Center, bounds.Radius))
+		{
+			return true;
+		}
+
+		const FVector3f toApex = bounds.ConeApex - viewPosition;
+		const Scalar distance = FMath::Length(toApex);
+		return distance > Scalar{ 0 } && FMath::Dot(toApex, bounds.ConeAxis) >= bounds.ConeCutoff * distance;
+	}
+
+	size_t CullMeshlets(const FMeshletData& meshlets, const FFrustum& frustum, const FVector3f& viewPosition, std::vector<uint32_t>& visibleMeshlets)
+	{
+		const size_t count = meshlets.Bounds.size();
+		std::vector<uint8_t> visible(count);
+
+		ParallelFor(0, count, [&](size_t i)
+		{
+			visible[i] = IsMeshletCulled(meshlets.Bounds[i], frustum, viewPosition) ? 0 : 1;
+		}, 256);
+
+		visibleMeshlets.clear();
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (visible[i])
+			{
+				visibleMeshlets.push_back(static_cast<uint32_t>(i));
+			}
+		}
+
+		return visibleMeshlets.size();
+	}
+
+	size_t CullMeshlets(const FMeshletData& meshlets, const FCamera& camera, std::vector<uint32_t>& visibleMeshlets)
+	{
+		return CullMeshlets(meshlets, camera.GetFrustum(), camera.GetPosition(), visibleMeshlets);
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Shape.h"
+#include "../math/Frustum.h"
+
+namespace Dash
+{
+	class FCamera;
+
+	struct FMeshlet
+	{
+		/** First entry of the meshlet in FMeshletData::VertexIndices. */
+		uint32_t VertexOffset = 0;
+
+		/** First entry of the meshlet in FMeshletData::PrimitiveIndices, three per triangle. */
+		uint32_t TriangleOffset = 0;
+
+		uint32_t VertexCount = 0;
+		uint32_t TriangleCount = 0;
+	};
+
+	struct FMeshletBounds
+	{
+		FVector3f Center;
+		Scalar Radius = 0;
+
+		FBoundingBox Box;
+
+		/**
+		 * Normal cone: every triangle normal is within the cone around ConeAxis. The meshlet is back facing for a viewer at
+		 * v when dot(normalize(ConeApex - v), ConeAxis) >= ConeCutoff. Meshlets with too wide a cone have a zero axis.
+		 */
+		FVector3f ConeApex;
+		FVector3f ConeAxis;
+		Scalar ConeCutoff = 1;
+	};
+
+	struct FMeshletData
+	{
+		static constexpr size_t MaxVertices = 64;
+		static constexpr size_t MaxTriangles = 124;
+
+		std::vector<FMeshlet> Meshlets;
+		std::vector<FMeshletBounds> Bounds;
+
+		/** Mesh vertex of each meshlet vertex. */
+		std::vector<uint32_t> VertexIndices;
+
+		/** Meshlet local vertex indices of the triangles. */
+		std::vector<uint8_t> PrimitiveIndices;
+	};
+
+	/**
+	 * Greedily grows meshlets over shared edges, each step takes the neighbouring triangle that adds the fewest new
+	 * vertices. Triangle normals follow cross(p1 - p0, p2 - p0).
+	 */
+	FMeshletData BuildMeshlets(const TriangleMesh& mesh, size_t maxVertices = FMeshletData::MaxVertices, size_t maxTriangles = FMeshletData::MaxTriangles);
+
+	/** Whether the meshlet can be skipped for a viewer at viewPosition, either outside the frustum or back facing. */
+	bool IsMeshletCulled(const FMeshletBounds& bounds, const FFrustum& frustum, const FVector3f& viewPosition);
+
+	/**
+	 * Tests all meshlets in parallel and writes the indices of the visible ones to visibleMeshlets in order.
+	 * Bounds are in the same space as the frustum.
+	 */
+	size_t CullMeshlets(const FMeshletData& meshlets, const FFrustum& frustum, const FVector3f& viewPosition, std::vector<uint32_t>& visibleMeshlets);
+
+	/** Culls against the camera frustum, the meshlet bounds are in world space. */
+	size_t CullMeshlets(const FMeshletData& meshlets, const FCamera& camera, std::vector<uint32_t>& visibleMeshlets);
+}
@@ -120,12 +120,12 @@ namespace Dash
 		return FBoundingBox{ bounds.Lower - epsilon, bounds.Upper + epsilon };
 	}
 
-	std::shared_ptr<TriangleMesh> Plane::ConvertToTriangleMesh() const noexcept
+	std::shared_ptr<TriangleMesh> Plane::ConvertToTriangleMesh(std::pmr::memory_resource* resource) const noexcept
 	{
-		return CreateTessellatedTriangleMesh(1, 1);
+		return CreateTessellatedTriangleMesh(1, 1, resource);
 	}
 
-	std::shared_ptr<TriangleMesh> Plane::CreateTessellatedTriangleMesh(uint16_t levels, uint16_t slices) const noexcept
+	std::shared_ptr<TriangleMesh> Plane::CreateTessellatedTriangleMesh(uint16_t levels, uint16_t slices, std::pmr::memory_resource* resource) const noexcept
 	{
 		FVector3f topLeft = mTopLeft;
 		FVector3f topRight = topLeft + mTangent * mWidth;
@@ -133,37 +133,24 @@ namespace Dash
 		FVector3f bottomLeft = topLeft + mBinormal * mHeight;
 		FVector3f bottomRight = topLeft + mTangent * mWidth + mBinormal * mHeight;
 
-		std::shared_ptr<TriangleMesh> triangleMesh = std::make_shared<TriangleMesh>();
+		std::shared_ptr<TriangleMesh> triangleMesh = std::allocate_shared<TriangleMesh>(std::pmr::polymorphic_allocator<TriangleMesh>(resource), resource);
 		triangleMesh->IndexType = EDASH_FORMAT::R16_UINT;
 		triangleMesh->NumVertices = (static_cast<size_t>(levels) + 1) * (static_cast<size_t>(slices) + 1);
-		triangleMesh->NumIndices = static_cast<size_t>(levels) * static_cast<size_t>(slices) * 2;
+		triangleMesh->NumIndices = static_cast<size_t>(levels) * static_cast<size_t>(slices) * 6;
 		triangleMesh->MeshParts.emplace_back(0, triangleMesh->NumVertices, 0, triangleMesh->NumIndices, 0);
 
-		triangleMesh->InputElements.emplace_back("POSITION", 0, Dash::EDASH_FORMAT::R32G32B32_FLOAT, 0);
-		triangleMesh->InputElements.emplace_back("NORMAL", 0, Dash::EDASH_FORMAT::R32G32B32_FLOAT, 12);
-		triangleMesh->InputElements.emplace_back("TANGENT", 0, Dash::EDASH_FORMAT::R32G32B32_FLOAT, 24);
-		triangleMesh->InputElements.emplace_back("TEXCOORD", 0, Dash::EDASH_FORMAT::R32G32_FLOAT, 36);
+		triangleMesh->SetVertexLayout<FStandardVertexLayout>();
 
-		triangleMesh->VertexStride = 0;
-		for (size_t i = 0; i < triangleMesh->InputElements.size(); i++)
-		{
-			triangleMesh->InputElementMap.insert(std::pair(triangleMesh->InputElements[i].SemanticName,
-				triangleMesh->InputElements[i].AlignedByteOffset));
-
-			triangleMesh->VertexStride += GetByteSizeForFormat(triangleMesh->InputElements[i].Format);
-		}
-
-		size_t positionOffset = triangleMesh->InputElementMap["POSITION"];
-		size_t normalOffset = triangleMesh->InputElementMap["NORMAL"];
-		size_t tangentOffset = triangleMesh->InputElementMap["TANGENT"];
-		size_t texCoordOffset = triangleMesh->InputElementMap["TEXCOORD"];
+		triangleMesh->Vertices.resize((size_t)(triangleMesh->VertexStride) * triangleMesh->NumVertices);
+		triangleMesh->Indices.resize((size_t)(GetByteSizeForFormat(triangleMesh->IndexType)) * triangleMesh->NumIndices);
 
-		triangleMesh->Vertices.reserve((size_t)(triangleMesh->VertexStride) * triangleMesh->NumVertices);
-		triangleMesh->Indices.reserve((size_t)(GetByteSizeForFormat(triangleMesh->IndexType)) * triangleMesh->NumIndices);
+		TStridedSpan<FVector3f> positions = triangleMesh->GetVertexAttribute<FStandardVertexLayout, VertexAttribute::Position>();
+		TStridedSpan<FVector3f> normals = triangleMesh->GetVertexAttribute<FStandardVertexLayout, VertexAttribute::Normal>();
+		TStridedSpan<FVector3f> tangents = triangleMesh->GetVertexAttribute<FStandardVertexLayout, VertexAttribute::Tangent>();
+		TStridedSpan<FVector2f> texCoords = triangleMesh->GetVertexAttribute<FStandardVertexLayout, VertexAttribute::TexCoord>();
 
 		//Write Vertex Attribute
 		size_t vertexIndex = 0;
-		size_t vertexDataBegin = vertexIndex * triangleMesh->VertexStride;
 
 		for (uint16_t j = 0; j < (levels + uint16_t{ 1 }); j++)
 		{
@@ -171,13 +158,12 @@ namespace Dash
 			{
 				FVector2f uv{ i / static_cast<Scalar>(slices) , j / static_cast<Scalar>(levels) };
 				FVector3f position = topLeft + mTangent * mWidth * uv.x + mBinormal * mHeight * uv.y;
-				WriteData(position, triangleMesh->Vertices.data(), vertexDataBegin + positionOffset);
-				WriteData(mNormal, triangleMesh->Vertices.data(), vertexDataBegin + normalOffset);
-				WriteData(mTangent, triangleMesh->Vertices.data(), vertexDataBegin + tangentOffset);
-				WriteData(uv, triangleMesh->Vertices.data(), vertexDataBegin + texCoordOffset);
+				positions[vertexIndex] = position;
+				normals[vertexIndex] = mNormal;
+				tangents[vertexIndex] = mTangent;
+				texCoords[vertexIndex] = uv;
 
 				++vertexIndex;
-				vertexDataBegin = vertexIndex * triangleMesh->VertexStride;
 			}
 		}
 
@@ -192,16 +178,16 @@ namespace Dash
 				uint16_t index0 = j * (slices + 1) + i;
 				uint16_t index1 = j * (slices + 1) + i + 1;
 				uint16_t index2 = (j + 1) * (slices + 1) + i;
-				WriteData(index0, triangleMesh->Indices.data(), vertexIndex++);
-				WriteData(index1, triangleMesh->Indices.data(), vertexIndex++);
-				WriteData(index2, triangleMesh->Indices.data(), vertexIndex++);
+				WriteData(index0, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
+				WriteData(index1, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
+				WriteData(index2, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
 
 				index0 = j * (slices + 1) + i + 1;
 				index1 = (j + 1) * (slices + 1) + i + 1;
 				index2 = (j + 1) * (slices + 1) + i;
-				WriteData(index0, triangleMesh->Indices.data(), vertexIndex++);
-				WriteData(index1, triangleMesh->Indices.data(), vertexIndex++);
-				WriteData(index2, triangleMesh->Indices.data(), vertexIndex++);
+				WriteData(index0, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
+				WriteData(index1, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
+				WriteData(index2, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
 			}
 		}
 
@@ -2,8 +2,10 @@
 
 #include "../math/MathType.h"
 #include "../math/Transform.h"
+#include "VertexLayout.h"
 
 #include <vector>
+#include <memory_resource>
 #include <string>
 #include <unordered_map>
 
@@ -17,22 +19,6 @@ namespace Dash
 		FVector2f TexCoord;
 	};
 
-	struct InputLayoutElement
-	{
-		std::string SemanticName;
-		std::size_t SemanticIndex;
-		EDASH_FORMAT Format;
-		std::size_t AlignedByteOffset;
-
-		InputLayoutElement(const std::string& name, std::size_t index, EDASH_FORMAT format, std::size_t offset)
-			: SemanticName(name)
-			, SemanticIndex(index)
-			, Format(format)
-			, AlignedByteOffset(offset)
-		{
-		}
-	};
-
 	struct MeshPart
 	{
 		std::size_t VertexStart;
@@ -50,8 +36,15 @@ namespace Dash
 		}
 	};
 
+	/** Vertex and index bytes are allocated from the resource given at construction, e.g. an FLinearArena or FPoolResource. */
 	struct TriangleMesh
 	{	
+		explicit TriangleMesh(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+			: Vertices(resource)
+			, Indices(resource)
+		{
+		}
+
 		void GetVertexPosition(FVector3f& p, std::size_t vertexIndex)
 		{
 			GetVertexProperty("POSITION", vertexIndex, p);
@@ -87,6 +80,142 @@ namespace Dash
 			return VertexStride * vertexIndex + iter->second;
 		}
 
+		/** Widens count indices starting at first to 32 bits. */
+		void ReadIndices(std::vector<std::uint32_t>& dest, std::size_t first, std::size_t count) const
+		{
+			ASSERT(IndexType == EDASH_FORMAT::R16_UINT || IndexType == EDASH_FORMAT::R32_UINT);
+
+			dest.resize(count);
+			if (IndexType == EDASH_FORMAT::R16_UINT)
+			{
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					std::uint16_t index;
+					std::memcpy(&index, Indices.data() + (first + i) * sizeof(std::uint16_t), sizeof(std::uint16_t));
+					dest[i] = index;
+				}
+			}
+			else
+			{
+				std::memcpy(dest.data(), Indices.data() + first * sizeof(std::uint32_t), count * sizeof(std::uint32_t));
+			}
+		}
+
+		/** Widens the indices of the part and offsets them by its VertexStart. */
+		void ReadPartIndices(std::vector<std::uint32_t>& dest, const MeshPart& part) const
+		{
+			ReadIndices(dest, part.IndexStart, part.IndexCount);
+			for (std::uint32_t& index : dest)
+			{
+				index += static_cast<std::uint32_t>(part.VertexStart);
+			}
+		}
+
+		/** Indices of all mesh parts offset by each part's VertexStart, the whole index buffer when there are no parts. */
+		void ReadAbsoluteIndices(std::vector<std::uint32_t>& dest) const
+		{
+			if (MeshParts.empty())
+			{
+				ReadIndices(dest, 0, NumIndices);
+				return;
+			}
+
+			std::vector<std::uint32_t> partIndices;
+			dest.clear();
+			dest.reserve(NumIndices);
+			for (const MeshPart& part : MeshParts)
+			{
+				ReadPartIndices(partIndices, part);
+				dest.insert(dest.end(), partIndices.begin(), partIndices.end());
+			}
+		}
+
+		/** Narrows count 32 bit indices to IndexType and stores them starting at first. */
+		void WriteIndices(const std::uint32_t* src, std::size_t first, std::size_t count)
+		{
+			ASSERT(IndexType == EDASH_FORMAT::R16_UINT || IndexType == EDASH_FORMAT::R32_UINT);
+
+			if (IndexType == EDASH_FORMAT::R16_UINT)
+			{
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					ASSERT(src[i] <= 0xFFFF);
+					const std::uint16_t index = static_cast<std::uint16_t>(src[i]);
+					std::memcpy(Indices.data() + (first + i) * sizeof(std::uint16_t), &index, sizeof(std::uint16_t));
+				}
+			}
+			else
+			{
+				std::memcpy(Indices.data() + first * sizeof(std::uint32_t), src, count * sizeof(std::uint32_t));
+			}
+		}
+
+		/** Replaces the input elements and stride with the compile-time layout. */
+		template<typename Layout>
+		void SetVertexLayout()
+		{
+			InputElements = Layout::GetInputElements();
+			InputElementMap.clear();
+			for (const InputLayoutElement& element : InputElements)
+			{
+				InputElementMap.emplace(element.SemanticName, element.AlignedByteOffset);
+			}
+			VertexStride = Layout::Stride;
+		}
+
+		/** Resolves an attribute by semantic name, the handle is invalid when the mesh has no such attribute. */
+		FVertexAttributeHandle FindVertexAttribute(const std::string& name) const
+		{
+			FVertexAttributeHandle handle;
+			for (const InputLayoutElement& element : InputElements)
+			{
+				if (element.SemanticName == name)
+				{
+					handle.Offset = element.AlignedByteOffset;
+					handle.Format = element.Format;
+					break;
+				}
+			}
+			return handle;
+		}
+
+		template<typename T>
+		void GetVertexProperty(const FVertexAttributeHandle& handle, std::size_t vertexIndex, T& value) const
+		{
+			ASSERT(handle.IsValid());
+			std::memcpy(&value, Vertices.data() + VertexStride * vertexIndex + handle.Offset, sizeof(T));
+		}
+
+		/** Strided span over one attribute of all vertices. */
+		template<typename T>
+		TStridedSpan<T> GetVertexAttribute(const FVertexAttributeHandle& handle)
+		{
+			ASSERT(handle.IsValid() && handle.Format == GetFormatForType<std::remove_const_t<T>>());
+			return TStridedSpan<T>(Vertices.data() + handle.Offset, NumVertices, VertexStride);
+		}
+
+		template<typename T>
+		TStridedSpan<const T> GetVertexAttribute(const FVertexAttributeHandle& handle) const
+		{
+			ASSERT(handle.IsValid() && handle.Format == GetFormatForType<T>());
+			return TStridedSpan<const T>(Vertices.data() + handle.Offset, NumVertices, VertexStride);
+		}
+
+		/** Strided span over one attribute of a mesh known to use Layout, the offset is a compile-time constant. */
+		template<typename Layout, typename Attribute>
+		TStridedSpan<typename Attribute::Type> GetVertexAttribute()
+		{
+			ASSERT(VertexStride == Layout::Stride);
+			return TStridedSpan<typename Attribute::Type>(Vertices.data() + Layout::template OffsetOf<Attribute>(), NumVertices, Layout::Stride);
+		}
+
+		template<typename Layout, typename Attribute>
+		TStridedSpan<const typename Attribute::Type> GetVertexAttribute() const
+		{
+			ASSERT(VertexStride == Layout::Stride);
+			return TStridedSpan<const typename Attribute::Type>(Vertices.data() + Layout::template OffsetOf<Attribute>(), NumVertices, Layout::Stride);
+		}
+
 		std::unordered_map<std::string, std::size_t> InputElementMap; // pair{ SemanticName, Offset }
 		std::vector<InputLayoutElement> InputElements;
 		std::vector<MeshPart> MeshParts;
@@ -94,8 +223,8 @@ namespace Dash
 		std::size_t NumVertices = 0;
 		std::size_t NumIndices = 0;
 		EDASH_FORMAT IndexType = EDASH_FORMAT::R32_UINT;
-		std::vector<std::uint8_t> Vertices;
-		std::vector<std::uint8_t> Indices;
+		std::pmr::vector<std::uint8_t> Vertices;
+		std::pmr::vector<std::uint8_t> Indices;
 	}; 
 
 	class Shape
@@ -113,7 +242,8 @@ namespace Dash
 		virtual FBoundingBox ObjectBound() const noexcept = 0;
 		virtual FBoundingBox WorldBound() const noexcept;
 
-		virtual std::shared_ptr<TriangleMesh> ConvertToTriangleMesh() const noexcept  = 0;
+		/** The mesh and its vertex and index buffers are allocated from resource. */
+		virtual std::shared_ptr<TriangleMesh> ConvertToTriangleMesh(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const noexcept  = 0;
 	
 		const FTransform& ObjectToWorld;
 		const FTransform& WorldToObject;
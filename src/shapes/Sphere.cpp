@@ -73,41 +73,29 @@ namespace Dash
 			GetCenter() + FVector3f{mRadius, mRadius, mRadius} };
 	}
 
-	std::shared_ptr<TriangleMesh> Sphere::ConvertToTriangleMesh() const noexcept
+	std::shared_ptr<TriangleMesh> Sphere::ConvertToTriangleMesh(std::pmr::memory_resource* resource) const noexcept
 	{
-		return CreateTessellatedTriangleMesh(16, 16);
+		return CreateTessellatedTriangleMesh(16, 16, resource);
 	}
 
-	std::shared_ptr<TriangleMesh> Sphere::CreateTessellatedTriangleMesh(uint16_t levels, uint16_t slices) const noexcept
+	std::shared_ptr<TriangleMesh> Sphere::CreateTessellatedTriangleMesh(uint16_t levels, uint16_t slices, std::pmr::memory_resource* resource) const noexcept
 	{
-		std::shared_ptr<TriangleMesh> triangleMesh = std::make_shared<TriangleMesh>();
+		std::shared_ptr<TriangleMesh> triangleMesh = std::allocate_shared<TriangleMesh>(std::pmr::polymorphic_allocator<TriangleMesh>(resource), resource);
 		triangleMesh->IndexType = EDASH_FORMAT::R16_UINT;
 		triangleMesh->NumVertices = size_t{ 2 } + (levels - size_t{ 1 }) * (slices + size_t{ 1 });
 		triangleMesh->NumIndices = size_t{ 6 } * (levels - size_t{ 1 }) * slices;
 		triangleMesh->MeshParts.emplace_back(0, triangleMesh->NumVertices, 0, triangleMesh->NumIndices, 0);
 
 
-		triangleMesh->InputElements.emplace_back("POSITION", 0, Dash::EDASH_FORMAT::R32G32B32_FLOAT, 0);
-		triangleMesh->InputElements.emplace_back("NORMAL", 0, Dash::EDASH_FORMAT::R32G32B32_FLOAT, 12);
-		triangleMesh->InputElements.emplace_back("TANGENT", 0, Dash::EDASH_FORMAT::R32G32B32_FLOAT, 24);
-		triangleMesh->InputElements.emplace_back("TEXCOORD", 0, Dash::EDASH_FORMAT::R32G32_FLOAT, 36);
+		triangleMesh->SetVertexLayout<FStandardVertexLayout>();
 
-		triangleMesh->VertexStride = 0;
-		for (size_t i = 0; i < triangleMesh->InputElements.size(); i++)
-		{
-			triangleMesh->InputElementMap.insert(std::pair(triangleMesh->InputElements[i].SemanticName,
-				triangleMesh->InputElements[i].AlignedByteOffset));
-
-			triangleMesh->VertexStride += GetByteSizeForFormat(triangleMesh->InputElements[i].Format);
-		}
-
-		std::size_t positionOffset = triangleMesh->InputElementMap["POSITION"];
-		std::size_t normalOffset = triangleMesh->InputElementMap["NORMAL"];
-		std::size_t tangentOffset = triangleMesh->InputElementMap["TANGENT"];
-		std::size_t texCoordOffset = triangleMesh->InputElementMap["TEXCOORD"];
+		triangleMesh->Vertices.resize((std::size_t)(triangleMesh->VertexStride) * triangleMesh->NumVertices);
+		triangleMesh->Indices.resize(GetByteSizeForFormat(triangleMesh->IndexType) * triangleMesh->NumIndices);
 
-		triangleMesh->Vertices.reserve((std::size_t)(triangleMesh->VertexStride) * triangleMesh->NumVertices);
-		triangleMesh->Indices.reserve(GetByteSizeForFormat(triangleMesh->IndexType) * triangleMesh->NumIndices);
+		TStridedSpan<FVector3f> positions = triangleMesh->GetVertexAttribute<FStandardVertexLayout, VertexAttribute::Position>();
+		TStridedSpan<FVector3f> normals = triangleMesh->GetVertexAttribute<FStandardVertexLayout, VertexAttribute::Normal>();
+		TStridedSpan<FVector3f> tangents = triangleMesh->GetVertexAttribute<FStandardVertexLayout, VertexAttribute::Tangent>();
+		TStridedSpan<FVector2f> texCoords = triangleMesh->GetVertexAttribute<FStandardVertexLayout, VertexAttribute::TexCoord>();
 
 		Scalar theta = 0.0f;
 		Scalar phi = 0.0f;
@@ -116,13 +104,12 @@ namespace Dash
 		Scalar thetaDelta = TScalarTraits<Scalar>::TwoPi() / slices;
 
 		std::size_t vertexIndex = 0;
-		std::size_t vertexDataBegin = vertexIndex * triangleMesh->VertexStride;
 
 		//Top point
-		WriteData(FVector3f{ 0.0f, mRadius, 0.0f }, triangleMesh->Vertices.data(), vertexDataBegin + positionOffset);
-		WriteData(FVector3f{ 0.0f, 1.0f, 0.0f }, triangleMesh->Vertices.data(), vertexDataBegin + normalOffset);
-		WriteData(FVector3f{ 1.0f, 0.0f, 0.0f }, triangleMesh->Vertices.data(), vertexDataBegin + tangentOffset);
-		WriteData(FVector2f{ 0.0f, 0.0f }, triangleMesh->Vertices.data(), vertexDataBegin + texCoordOffset);
+		positions[vertexIndex] = FVector3f{ 0.0f, mRadius, 0.0f };
+		normals[vertexIndex] = FVector3f{ 0.0f, 1.0f, 0.0f };
+		tangents[vertexIndex] = FVector3f{ 1.0f, 0.0f, 0.0f };
+		texCoords[vertexIndex] = FVector2f{ 0.0f, 0.0f };
 
 		++vertexIndex;
 
@@ -138,22 +125,20 @@ namespace Dash
 				FVector3f tangent{ -FMath::Sin(theta), 0.0f, FMath::Cos(theta) };
 				FVector2f uv{ theta * TScalarTraits<Scalar>::InvTwoPi(), phi * TScalarTraits<Scalar>::InvPi() };
 
-				vertexDataBegin = vertexIndex * triangleMesh->VertexStride;
-				WriteData(position, triangleMesh->Vertices.data(), vertexDataBegin + positionOffset);
-				WriteData(normal, triangleMesh->Vertices.data(), vertexDataBegin + normalOffset);
-				WriteData(tangent, triangleMesh->Vertices.data(), vertexDataBegin + tangentOffset);
-				WriteData(uv, triangleMesh->Vertices.data(), vertexDataBegin + texCoordOffset);
+				positions[vertexIndex] = position;
+				normals[vertexIndex] = normal;
+				tangents[vertexIndex] = tangent;
+				texCoords[vertexIndex] = uv;
 
 				++vertexIndex;
 			}
 		}
 
 		//Bottom point
-		vertexDataBegin = vertexIndex * triangleMesh->VertexStride;
-		WriteData(FVector3f{ 0.0f, -mRadius, 0.0f }, triangleMesh->Vertices.data(), vertexDataBegin + positionOffset);
-		WriteData(FVector3f{ 0.0f, -1.0f, 0.0f }, triangleMesh->Vertices.data(), vertexDataBegin + normalOffset);
-		WriteData(FVector3f{ -1.0f, 0.0f, 0.0f }, triangleMesh->Vertices.data(), vertexDataBegin + tangentOffset);
-		WriteData(FVector2f{ 0.0f, 1.0f }, triangleMesh->Vertices.data(), vertexDataBegin + texCoordOffset);
+		positions[vertexIndex] = FVector3f{ 0.0f, -mRadius, 0.0f };
+		normals[vertexIndex] = FVector3f{ 0.0f, -1.0f, 0.0f };
+		tangents[vertexIndex] = FVector3f{ -1.0f, 0.0f, 0.0f };
+		texCoords[vertexIndex] = FVector2f{ 0.0f, 1.0f };
 
 
 		//Write Index
@@ -167,9 +152,9 @@ namespace Dash
 				uint16_t index0 = 0;
 				uint16_t index1 = j % (slices + 1) + 1;
 				uint16_t index2 = j;
-				WriteData(index0, triangleMesh->Indices.data(), vertexIndex++);
-				WriteData(index1, triangleMesh->Indices.data(), vertexIndex++);
-				WriteData(index2, triangleMesh->Indices.data(), vertexIndex++);
+				WriteData(index0, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
+				WriteData(index1, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
+				WriteData(index2, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
 			}
 		}
 
@@ -180,16 +165,16 @@ namespace Dash
 				uint16_t index0 = (i - 1) * (slices + 1) + j;
 				uint16_t index1 = (i - 1) * (slices + 1) + j % (slices + 1) + 1;
 				uint16_t index2 = i * (slices + 1) + j % (slices + 1) + 1;
-				WriteData(index0, triangleMesh->Indices.data(), vertexIndex++);
-				WriteData(index1, triangleMesh->Indices.data(), vertexIndex++);
-				WriteData(index2, triangleMesh->Indices.data(), vertexIndex++);
+				WriteData(index0, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
+				WriteData(index1, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
+				WriteData(index2, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
 
 				index0 = i * (slices + 1) + j % (slices + 1) + 1;
 				index1 = i * (slices + 1) + j;
 				index2 = (i - 1) * (slices + 1) + j;
-				WriteData(index0, triangleMesh->Indices.data(), vertexIndex++);
-				WriteData(index1, triangleMesh->Indices.data(), vertexIndex++);
-				WriteData(index2, triangleMesh->Indices.data(), vertexIndex++);
+				WriteData(index0, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
+				WriteData(index1, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
+				WriteData(index2, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
 			}
 		}
 
@@ -200,9 +185,9 @@ namespace Dash
 				uint16_t index0 = (levels - 2) * (slices + 1) + j;
 				uint16_t index1 = (levels - 2) * (slices + 1) + j % (slices + 1) + 1;
 				uint16_t index2 = (levels - 1) * (slices + 1) + 1;
-				WriteData(index0, triangleMesh->Indices.data(), vertexIndex++);
-				WriteData(index1, triangleMesh->Indices.data(), vertexIndex++);
-				WriteData(index2, triangleMesh->Indices.data(), vertexIndex++);
+				WriteData(index0, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
+				WriteData(index1, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
+				WriteData(index2, triangleMesh->Indices.data(), sizeof(uint16_t) * vertexIndex++);
 			}
 		}
 
@@ -19,9 +19,10 @@ namespace Dash
 		virtual FBoundingBox ObjectBound() const noexcept override;
 		virtual FBoundingBox WorldBound() const noexcept override;
 
-		virtual std::shared_ptr<TriangleMesh> ConvertToTriangleMesh() const noexcept override;
+		virtual std::shared_ptr<TriangleMesh> ConvertToTriangleMesh(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const noexcept override;
 
-		std::shared_ptr<TriangleMesh> CreateTessellatedTriangleMesh(uint16_t levels, uint16_t slices) const noexcept;
+		std::shared_ptr<TriangleMesh> CreateTessellatedTriangleMesh(uint16_t levels, uint16_t slices,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const noexcept;
 
 	private:
 		Scalar mRadius;
@@ -9,7 +9,7 @@ namespace Dash
 		, mVertexIndex(nullptr)
 		, mFaceIndex(faceId)
 	{
-		mVertexIndex = reinterpret_cast<std::uint32_t*>(&(mMesh->Indices[3 * (std::size_t)faceId]));
+		mVertexIndex = reinterpret_cast<std::uint32_t*>(&(mMesh->Indices[3 * sizeof(std::uint32_t) * (std::size_t)faceId]));
 	}
 
 	Triangle::~Triangle()
@@ -79,9 +79,9 @@ namespace Dash
 		return FMath::Union(FBoundingBox{ ObjectToWorld.TransformPoint(p0), ObjectToWorld.TransformPoint(p1) }, ObjectToWorld.TransformPoint(p2));
 	}
 
-	std::shared_ptr<TriangleMesh> Triangle::ConvertToTriangleMesh() const noexcept
+	std::shared_ptr<TriangleMesh> Triangle::ConvertToTriangleMesh(std::pmr::memory_resource* resource) const noexcept
 	{
-		std::shared_ptr<TriangleMesh> triangleMesh = std::make_shared<TriangleMesh>();
+		std::shared_ptr<TriangleMesh> triangleMesh = std::allocate_shared<TriangleMesh>(std::pmr::polymorphic_allocator<TriangleMesh>(resource), resource);
 		triangleMesh->IndexType = mMesh->IndexType;
 		triangleMesh->NumVertices = 3;
 		triangleMesh->NumIndices = 3;
@@ -92,10 +92,14 @@ namespace Dash
 		triangleMesh->VertexStride = mMesh->VertexStride;
 
 
-		triangleMesh->Vertices.reserve((std::size_t)(triangleMesh->VertexStride) * 3);
-		triangleMesh->Indices.reserve(GetByteSizeForFormat(triangleMesh->IndexType) * 3);
+		triangleMesh->Vertices.resize((std::size_t)(triangleMesh->VertexStride) * 3);
+		triangleMesh->Indices.resize(GetByteSizeForFormat(triangleMesh->IndexType) * 3);
 
-		std::memcpy(triangleMesh->Vertices.data(), mMesh->Vertices.data() + mMesh->VertexStride * 3 * mFaceIndex, mMesh->VertexStride * 3);
+		for (std::size_t i = 0; i < 3; ++i)
+		{
+			std::memcpy(triangleMesh->Vertices.data() + mMesh->VertexStride * i,
+				mMesh->Vertices.data() + mMesh->VertexStride * mVertexIndex[i], mMesh->VertexStride);
+		}
 
 		if (triangleMesh->IndexType == EDASH_FORMAT::R16_UINT)
 		{
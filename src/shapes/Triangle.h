@@ -12,6 +12,8 @@ namespace Dash
 		FVector2f TexCoord;
 	};
 
+	static_assert(sizeof(RayTraceTrianglePoint) == FStandardVertexLayout::Stride, "RayTraceTrianglePoint must match FStandardVertexLayout");
+
 	class Triangle : public Shape
 	{
 	public:
@@ -23,7 +25,7 @@ namespace Dash
 		virtual FBoundingBox ObjectBound() const noexcept override;
 		virtual FBoundingBox WorldBound() const noexcept override;
 
-		virtual std::shared_ptr<TriangleMesh> ConvertToTriangleMesh() const noexcept override;
+		virtual std::shared_ptr<TriangleMesh> ConvertToTriangleMesh(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const noexcept override;
 
 	private:
 		std::shared_ptr<TriangleMesh> mMesh;
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "../math/MathType.h"
+#include "../utility/StridedSpan.h"
+
+#include <string>
+#include <vector>
+#include <type_traits>
+
+namespace Dash
+{
+	struct InputLayoutElement
+	{
+		std::string SemanticName;
+		std::size_t SemanticIndex;
+		EDASH_FORMAT Format;
+		std::size_t AlignedByteOffset;
+
+		InputLayoutElement(const std::string& name, std::size_t index, EDASH_FORMAT format, std::size_t offset)
+			: SemanticName(name)
+			, SemanticIndex(index)
+			, Format(format)
+			, AlignedByteOffset(offset)
+		{
+		}
+	};
+
+	/** Attribute tags for TVertexLayout: the element type, its semantic name and its format. */
+	namespace VertexAttribute
+	{
+		struct Position
+		{
+			using Type = FVector3f;
+			static constexpr const char* Name = "POSITION";
+			static constexpr EDASH_FORMAT Format = EDASH_FORMAT::R32G32B32_FLOAT;
+		};
+
+		struct Normal
+		{
+			using Type = FVector3f;
+			static constexpr const char* Name = "NORMAL";
+			static constexpr EDASH_FORMAT Format = EDASH_FORMAT::R32G32B32_FLOAT;
+		};
+
+		struct Tangent
+		{
+			using Type = FVector3f;
+			static constexpr const char* Name = "TANGENT";
+			static constexpr EDASH_FORMAT Format = EDASH_FORMAT::R32G32B32_FLOAT;
+		};
+
+		struct TexCoord
+		{
+			using Type = FVector2f;
+			static constexpr const char* Name = "TEXCOORD";
+			static constexpr EDASH_FORMAT Format = EDASH_FORMAT::R32G32_FLOAT;
+		};
+	}
+
+	/** Interleaved vertex layout known at compile time, attributes are packed in the order given. */
+	template<typename... Attributes>
+	struct TVertexLayout
+	{
+		static constexpr std::size_t AttributeCount = sizeof...(Attributes);
+
+		static constexpr std::size_t Stride = (std::size_t{ 0 } + ... + sizeof(typename Attributes::Type));
+
+		template<typename Attribute>
+		static constexpr bool Contains()
+		{
+			return (std::is_same_v<Attribute, Attributes> || ...);
+		}
+
+		template<typename Attribute>
+		static constexpr std::size_t OffsetOf()
+		{
+			static_assert(Contains<Attribute>(), "Attribute is not part of the vertex layout");
+
+			std::size_t offset = 0;
+			bool found = false;
+			((found = found || std::is_same_v<Attribute, Attributes>, offset += found ? 0 : sizeof(typename Attributes::Type)), ...);
+			return offset;
+		}
+
+		static std::vector<InputLayoutElement> GetInputElements()
+		{
+			std::vector<InputLayoutElement> elements;
+			elements.reserve(AttributeCount);
+			(elements.emplace_back(Attributes::Name, 0, Attributes::Format, OffsetOf<Attributes>()), ...);
+			return elements;
+		}
+	};
+
+	/** Layout of the meshes generated by the built-in shapes. */
+	using FStandardVertexLayout = TVertexLayout<VertexAttribute::Position, VertexAttribute::Normal, VertexAttribute::Tangent, VertexAttribute::TexCoord>;
+
+	static_assert(FStandardVertexLayout::Stride == 44 && FStandardVertexLayout::OffsetOf<VertexAttribute::TexCoord>() == 36);
+
+	/** Attribute of a runtime layout resolved once by name, so per-vertex access does not look the name up again. */
+	struct FVertexAttributeHandle
+	{
+		static constexpr std::size_t InvalidOffset = ~std::size_t{ 0 };
+
+		std::size_t Offset = InvalidOffset;
+		EDASH_FORMAT Format = EDASH_FORMAT::UnKwon;
+
+		bool IsValid() const { return Offset != InvalidOffset; }
+	};
+}
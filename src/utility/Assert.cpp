@@ -1,6 +1,10 @@
 #include "Assert.h"
-#include <Windows.h>
 #include <stdio.h>
+#include <stdarg.h>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#endif
 
 namespace Dash
 {
@@ -11,19 +15,16 @@ namespace Dash
 			const char* file,
 			const int line)
 		{
-			const UINT64 BufferSize = 2048;
+			const size_t BufferSize = 2048;
 			char buffer[BufferSize];
-			sprintf_s(buffer, BufferSize, "%s(%d): Assert Failure: ", file, line);
-
-			if (condition != NULL)
-				sprintf_s(buffer, BufferSize, "%s'%s' ", buffer, condition);
-
-			if (msg != NULL)
-				sprintf_s(buffer, BufferSize, "%s%s", buffer, msg);
-
-			sprintf_s(buffer, BufferSize, "%s\n", buffer);
+			snprintf(buffer, BufferSize, "%s(%d): Assert Failure: %s%s%s%s\n", file, line,
+				condition != NULL ? "'" : "", condition != NULL ? condition : "", condition != NULL ? "' " : "", msg != NULL ? msg : "");
 
+#if defined(_WIN32)
 			OutputDebugStringA(buffer);
+#else
+			fputs(buffer, stderr);
+#endif
 
 			return Assert::FailBehavior::Break;
 		}
@@ -57,7 +58,7 @@ namespace Dash
 			{
 				va_list args;
 				va_start(args, msg);
-				vsnprintf_s(messageBuffer, 1024, 1024, msg, args);
+				vsnprintf(messageBuffer, 1024, msg, args);
 				va_end(args);
 			}
 
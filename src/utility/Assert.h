@@ -31,7 +31,11 @@ namespace Dash {
 	}
 }
 
+#if defined(_MSC_VER)
 #define ASSERT_BREAK() __debugbreak()
+#else
+#define ASSERT_BREAK() __builtin_trap()
+#endif
 #define ASSERT_UNUSED(x) do { (void)sizeof(x); } while(0)
 
 #ifdef USE_ASSERTS
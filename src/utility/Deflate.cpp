@@ -0,0 +1,1227 @@
+#include "Deflate.h"
+#include <algorithm>
+#include <cstring>
+#include <queue>
+
+namespace Dash
+{
+	namespace
+	{
+		constexpr std::size_t DEFLATE_WINDOW_SIZE = 32768;
+		constexpr std::size_t DEFLATE_MIN_MATCH = 3;
+		constexpr std::size_t DEFLATE_MAX_MATCH = 258;
+		constexpr uint32_t DEFLATE_MAX_BITS = 15;
+		constexpr uint32_t DEFLATE_NUM_LITLEN = 286;
+		constexpr uint32_t DEFLATE_NUM_DIST = 30;
+		constexpr uint32_t DEFLATE_NUM_CODELEN = 19;
+
+		constexpr uint16_t LengthBase[29] = {
+			3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+			35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+
+		constexpr uint8_t LengthExtra[29] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+			3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+		constexpr uint16_t DistBase[30] = {
+			1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+			257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+
+		constexpr uint8_t DistExtra[30] = {
+			0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+			7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+		constexpr uint8_t CodeLengthOrder[DEFLATE_NUM_CODELEN] = {
+			16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+		// search depth of the hash chains for compression levels 0..9
+		constexpr int MaxChainForLevel[10] = { 0, 4, 8, 16, 32, 64, 128, 256, 1024, 4096 };
+
+		uint32_t ReverseBits(uint32_t code, uint32_t length)
+		{
+			uint32_t result = 0;
+			for (uint32_t i = 0; i < length; ++i)
+			{
+				result = (result << 1) | (code & 1);
+				code >>= 1;
+			}
+			return result;
+		}
+
+		uint32_t GetLengthCode(uint32_t length)
+		{
+			uint32_t code = 0;
+			while (code < 28 && LengthBase[code + 1] <= length)
+			{
+				++code;
+			}
+			return code;
+		}
+
+		uint32_t GetDistCode(uint32_t dist)
+		{
+			if (dist <= 4)
+			{
+				return dist - 1;
+			}
+
+			// two codes per power of two above 4
+			uint32_t highBit = 31;
+			uint32_t value = dist - 1;
+			while ((value >> highBit) == 0)
+			{
+				--highBit;
+			}
+			return highBit * 2 + ((value >> (highBit - 1)) & 1);
+		}
+
+		/** Builds length-limited Huffman code lengths from symbol frequencies. */
+		void BuildCodeLengths(const uint32_t* freqs, uint32_t count, uint32_t maxLength, uint8_t* lengths)
+		{
+			std::memset(lengths, 0, count);
+
+			std::vector<uint32_t> symbols;
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				if (freqs[i] > 0)
+				{
+					symbols.push_back(i);
+				}
+			}
+
+			if (symbols.empty())
+			{
+				return;
+			}
+
+			if (symbols.size() == 1)
+			{
+				lengths[symbols[0]] = 1;
+				return;
+			}
+
+			struct FNode
+			{
+				uint64_t Freq;
+				int32_t Left;
+				int32_t Right;
+			};
+
+			std::vector<FNode> nodes;
+			nodes.reserve(symbols.size() * 2);
+
+			using FQueueItem = std::pair<uint64_t, int32_t>;
+			std::priority_queue<FQueueItem, std::vector<FQueueItem>, std::greater<FQueueItem>> queue;
+
+			for (uint32_t symbol : symbols)
+			{
+				queue.emplace(freqs[symbol], static_cast<int32_t>(nodes.size()));
+				nodes.push_back(FNode{ freqs[symbol], -1, -1 });
+			}
+
+			while (queue.size() > 1)
+			{
+				FQueueItem a = queue.top(); queue.pop();
+				FQueueItem b = queue.top(); queue.pop();
+				queue.emplace(a.first + b.first, static_cast<int32_t>(nodes.size()));
+				nodes.push_back(FNode{ a.first + b.first, a.second, b.second });
+			}
+
+			// count the leaves at each depth, deeper leaves are clamped to 32 and fixed up below
+			uint32_t lengthCounts[33] = { 0 };
+			std::vector<std::pair<int32_t, uint32_t>> stack;
+			stack.emplace_back(queue.top().second, 0);
+			while (!stack.empty())
+			{
+				auto [nodeIndex, depth] = stack.back();
+				stack.pop_back();
+
+				const FNode& node = nodes[nodeIndex];
+				if (node.Left < 0)
+				{
+					++lengthCounts[std::min<uint32_t>(depth, 32)];
+				}
+				else
+				{
+					stack.emplace_back(node.Left, depth + 1);
+					stack.emplace_back(node.Right, depth + 1);
+				}
+			}
+
+			// move overlong codes to the maximum length, then rebalance until the Kraft sum is exactly one
+			for (uint32_t i = maxLength + 1; i <= 32; ++i)
+			{
+				lengthCounts[maxLength] += lengthCounts[i];
+				lengthCounts[i] = 0;
+			}
+
+			uint32_t total = 0;
+			for (uint32_t i = maxLength; i > 0; --i)
+			{
+				total += lengthCounts[i] << (maxLength - i);
+			}
+
+			while (total != (1u << maxLength))
+			{
+				--lengthCounts[maxLength];
+				for (uint32_t i = maxLength - 1; i > 0; --i)
+				{
+					if (lengthCounts[i] != 0)
+					{
+						--lengthCounts[i];
+						lengthCounts[i + 1] += 2;
+						break;
+					}
+				}
+				--total;
+			}
+
+			// the least frequent symbols get the longest codes
+			std::stable_sort(symbols.begin(), symbols.end(), [freqs](uint32_t a, uint32_t b) { return freqs[a] < freqs[b]; });
+
+			std::size_t next = 0;
+			for (uint32_t length = maxLength; length > 0; --length)
+			{
+				for (uint32_t i = 0; i < lengthCounts[length]; ++i)
+				{
+					lengths[symbols[next++]] = static_cast<uint8_t>(length);
+				}
+			}
+		}
+
+		/** Canonical codes for the given lengths, bit-reversed for LSB-first output. */
+		void BuildCanonicalCodes(const uint8_t* lengths, uint32_t count, uint16_t* codes)
+		{
+			uint32_t lengthCounts[DEFLATE_MAX_BITS + 1] = { 0 };
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				++lengthCounts[lengths[i]];
+			}
+			lengthCounts[0] = 0;
+
+			uint32_t nextCode[DEFLATE_MAX_BITS + 1] = { 0 };
+			uint32_t code = 0;
+			for (uint32_t bits = 1; bits <= DEFLATE_MAX_BITS; ++bits)
+			{
+				code = (code + lengthCounts[bits - 1]) << 1;
+				nextCode[bits] = code;
+			}
+
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				codes[i] = lengths[i] ? static_cast<uint16_t>(ReverseBits(nextCode[lengths[i]]++, lengths[i])) : 0;
+			}
+		}
+	}
+
+	// -- FInflater -- //
+
+	FInflater::FInflater()
+		: mReader(nullptr)
+		, mWriter(nullptr)
+		, mInputPos(0)
+		, mInputSize(0)
+		, mPadBytes(0)
+		, mInputEnd(false)
+		, mBitBuffer(0)
+		, mBitCount(0)
+		, mWindowPos(0)
+		, mFlushedPos(0)
+		, mAdler(1)
+	{
+		uint8_t lengths[288];
+		std::fill(lengths, lengths + 144, uint8_t(8));
+		std::fill(lengths + 144, lengths + 256, uint8_t(9));
+		std::fill(lengths + 256, lengths + 280, uint8_t(7));
+		std::fill(lengths + 280, lengths + 288, uint8_t(8));
+		BuildTable(mFixedLitLen, lengths, 288);
+
+		std::fill(lengths, lengths + 32, uint8_t(5));
+		BuildTable(mFixedDist, lengths, 32);
+	}
+
+	bool FInflater::Inflate(const ReadFunc& reader, const WriteFunc& writer, bool zlibWrapper)
+	{
+		mReader = &reader;
+		mWriter = &writer;
+
+		mInput.resize(64 * 1024);
+		mInputPos = 0;
+		mInputSize = 0;
+		mPadBytes = 0;
+		mInputEnd = false;
+		mBitBuffer = 0;
+		mBitCount = 0;
+
+		// 32KB of history followed by room for decoded output
+		mWindow.resize(DEFLATE_WINDOW_SIZE * 3);
+		mWindowPos = 0;
+		mFlushedPos = 0;
+		mAdler = 1;
+
+		if (zlibWrapper)
+		{
+			if (!NeedBits(16))
+			{
+				return false;
+			}
+
+			uint32_t cmf = GetBits(8);
+			uint32_t flg = GetBits(8);
+			if ((cmf & 0x0F) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20) != 0)
+			{
+				return false;
+			}
+		}
+
+		FHuffmanTable litLen;
+		FHuffmanTable dist;
+
+		uint32_t finalBlock = 0;
+		do
+		{
+			if (!NeedBits(3))
+			{
+				return false;
+			}
+
+			finalBlock = GetBits(1);
+			uint32_t blockType = GetBits(2);
+
+			bool succeeded = false;
+			switch (blockType)
+			{
+			case 0:
+				succeeded = InflateStored();
+				break;
+			case 1:
+				succeeded = InflateBlock(mFixedLitLen, mFixedDist);
+				break;
+			case 2:
+				succeeded = ReadDynamicTables(litLen, dist) && InflateBlock(litLen, dist);
+				break;
+			default:
+				break;
+			}
+
+			if (!succeeded)
+			{
+				return false;
+			}
+		} while (finalBlock == 0);
+
+		if (!FlushOutput(false))
+		{
+			return false;
+		}
+
+		if (zlibWrapper)
+		{
+			GetBits(mBitCount & 7);
+			if (!NeedBits(32))
+			{
+				return false;
+			}
+
+			uint32_t adler = 0;
+			for (int i = 0; i < 4; ++i)
+			{
+				adler = (adler << 8) | GetBits(8);
+			}
+
+			if (adler != mAdler)
+			{
+				return false;
+			}
+		}
+
+		return mBitCount >= mPadBytes * 8;
+	}
+
+	bool FInflater::Inflate(const uint8_t* data, std::size_t size, const WriteFunc& writer, bool zlibWrapper)
+	{
+		ReadFunc reader = [&data, &size](uint8_t* dest, std::size_t destSize)
+		{
+			std::size_t count = std::min(destSize, size);
+			std::memcpy(dest, data, count);
+			data += count;
+			size -= count;
+			return count;
+		};
+
+		return Inflate(reader, writer, zlibWrapper);
+	}
+
+	bool FInflater::BuildTable(FHuffmanTable& table, const uint8_t* lengths, uint32_t count)
+	{
+		uint32_t lengthCounts[DEFLATE_MAX_BITS + 1] = { 0 };
+		uint32_t maxBits = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			++lengthCounts[lengths[i]];
+			maxBits = std::max<uint32_t>(maxBits, lengths[i]);
+		}
+		lengthCounts[0] = 0;
+
+		table.MaxBits = maxBits;
+		table.Entries.clear();
+
+		if (maxBits == 0)
+		{
+			// a distance tree without codes is legal as long as no match is encoded
+			return true;
+		}
+
+		// reject over-subscribed codes, incomplete codes are allowed for single-symbol trees
+		int32_t left = 1;
+		for (uint32_t bits = 1; bits <= DEFLATE_MAX_BITS; ++bits)
+		{
+			left = (left << 1) - static_cast<int32_t>(lengthCounts[bits]);
+			if (left < 0)
+			{
+				return false;
+			}
+		}
+
+		uint32_t nextCode[DEFLATE_MAX_BITS + 1] = { 0 };
+		uint32_t code = 0;
+		for (uint32_t bits = 1; bits <= DEFLATE_MAX_BITS; ++bits)
+		{
+			code = (code + lengthCounts[bits - 1]) << 1;
+			nextCode[bits] = code;
+		}
+
+		const uint32_t tableSize = 1u << maxBits;
+		table.Entries.assign(tableSize, 0);
+
+		for (uint32_t symbol = 0; symbol < count; ++symbol)
+		{
+			uint32_t length = lengths[symbol];
+			if (length == 0)
+			{
+				continue;
+			}
+
+			uint16_t entry = static_cast<uint16_t>((symbol << 4) | length);
+			for (uint32_t index = ReverseBits(nextCode[length]++, length); index < tableSize; index += 1u << length)
+			{
+				table.Entries[index] = entry;
+			}
+		}
+
+		return true;
+	}
+
+	bool FInflater::Refill()
+	{
+		if (mInputEnd)
+		{
+			return false;
+		}
+
+		mInputSize = (*mReader)(mInput.data(), mInput.size());
+		mInputPos = 0;
+		mInputEnd = mInputSize == 0;
+
+		return !mInputEnd;
+	}
+
+	bool FInflater::NeedBits(uint32_t count)
+	{
+		while (mBitCount < count)
+		{
+			if (mInputPos == mInputSize && !Refill())
+			{
+				// table lookups may peek past the end of the stream, pad with zeros but fail on real overruns
+				if (++mPadBytes > 4)
+				{
+					return false;
+				}
+				mBitCount += 8;
+				continue;
+			}
+
+			mBitBuffer |= static_cast<uint64_t>(mInput[mInputPos++]) << mBitCount;
+			mBitCount += 8;
+		}
+
+		return true;
+	}
+
+	uint32_t FInflater::GetBits(uint32_t count)
+	{
+		uint32_t value = static_cast<uint32_t>(mBitBuffer & ((1ull << count) - 1));
+		mBitBuffer >>= count;
+		mBitCount -= count;
+		return value;
+	}
+
+	bool FInflater::DecodeSymbol(const FHuffmanTable& table, uint32_t& symbol)
+	{
+		if (table.MaxBits == 0 || !NeedBits(table.MaxBits))
+		{
+			return false;
+		}
+
+		uint16_t entry = table.Entries[mBitBuffer & ((1ull << table.MaxBits) - 1)];
+		uint32_t length = entry & 0xF;
+		if (length == 0)
+		{
+			return false;
+		}
+
+		GetBits(length);
+		symbol = entry >> 4;
+		return true;
+	}
+
+	bool FInflater::InflateStored()
+	{
+		GetBits(mBitCount & 7);
+		if (!NeedBits(32))
+		{
+			return false;
+		}
+
+		uint32_t length = GetBits(16);
+		uint32_t invLength = GetBits(16);
+		if ((length ^ 0xFFFF) != invLength)
+		{
+			return false;
+		}
+
+		while (length > 0)
+		{
+			if (mWindowPos == mWindow.size() && !FlushOutput(true))
+			{
+				return false;
+			}
+
+			std::size_t chunk = std::min<std::size_t>(length, mWindow.size() - mWindowPos);
+
+			// drain whole bytes still held in the bit buffer before copying from the input buffer
+			while (chunk > 0 && mBitCount >= 8)
+			{
+				mWindow[mWindowPos++] = static_cast<uint8_t>(GetBits(8));
+				--chunk;
+				--length;
+			}
+
+			if (chunk == 0)
+			{
+				continue;
+			}
+
+			if (mInputPos == mInputSize && !Refill())
+			{
+				return false;
+			}
+
+			chunk = std::min(chunk, mInputSize - mInputPos);
+			std::memcpy(&mWindow[mWindowPos], &mInput[mInputPos], chunk);
+			mWindowPos += chunk;
+			mInputPos += chunk;
+			length -= static_cast<uint32_t>(chunk);
+		}
+
+		return mBitCount >= mPadBytes * 8;
+	}
+
+	bool FInflater::InflateBlock(const FHuffmanTable& litLen, const FHuffmanTable& dist)
+	{
+		for (;;)
+		{
+			if (mWindowPos + DEFLATE_MAX_MATCH > mWindow.size() && !FlushOutput(true))
+			{
+				return false;
+			}
+
+			uint32_t symbol = 0;
+			if (!DecodeSymbol(litLen, symbol))
+			{
+				return false;
+			}
+
+			if (symbol < 256)
+			{
+				mWindow[mWindowPos++] = static_cast<uint8_t>(symbol);
+				continue;
+			}
+
+			if (symbol == 256)
+			{
+				return mBitCount >= mPadBytes * 8;
+			}
+
+			symbol -= 257;
+			if (symbol >= 29 || !NeedBits(LengthExtra[symbol]))
+			{
+				return false;
+			}
+
+			std::size_t length = LengthBase[symbol] + GetBits(LengthExtra[symbol]);
+
+			uint32_t distSymbol = 0;
+			if (!DecodeSymbol(dist, distSymbol) || distSymbol >= 30 || !NeedBits(DistExtra[distSymbol]))
+			{
+				return false;
+			}
+
+			std::size_t distance = DistBase[distSymbol] + GetBits(DistExtra[distSymbol]);
+			if (distance > mWindowPos)
+			{
+				return false;
+			}
+
+			uint8_t* dest = &mWindow[mWindowPos];
+			const uint8_t* src = dest - distance;
+			if (distance >= length)
+			{
+				std::memcpy(dest, src, length);
+			}
+			else
+			{
+				for (std::size_t i = 0; i < length; ++i)
+				{
+					dest[i] = src[i];
+				}
+			}
+			mWindowPos += length;
+		}
+	}
+
+	bool FInflater::ReadDynamicTables(FHuffmanTable& litLen, FHuffmanTable& dist)
+	{
+		if (!NeedBits(14))
+		{
+			return false;
+		}
+
+		uint32_t numLitLen = GetBits(5) + 257;
+		uint32_t numDist = GetBits(5) + 1;
+		uint32_t numCodeLen = GetBits(4) + 4;
+
+		if (numLitLen > DEFLATE_NUM_LITLEN || numDist > DEFLATE_NUM_DIST)
+		{
+			return false;
+		}
+
+		uint8_t codeLengthLengths[DEFLATE_NUM_CODELEN] = { 0 };
+		for (uint32_t i = 0; i < numCodeLen; ++i)
+		{
+			if (!NeedBits(3))
+			{
+				return false;
+			}
+			codeLengthLengths[CodeLengthOrder[i]] = static_cast<uint8_t>(GetBits(3));
+		}
+
+		FHuffmanTable codeLengthTable;
+		if (!BuildTable(codeLengthTable, codeLengthLengths, DEFLATE_NUM_CODELEN))
+		{
+			return false;
+		}
+
+		uint8_t lengths[DEFLATE_NUM_LITLEN + DEFLATE_NUM_DIST] = { 0 };
+		const uint32_t total = numLitLen + numDist;
+		uint32_t count = 0;
+		while (count < total)
+		{
+			uint32_t symbol = 0;
+			if (!DecodeSymbol(codeLengthTable, symbol))
+			{
+				return false;
+			}
+
+			if (symbol < 16)
+			{
+				lengths[count++] = static_cast<uint8_t>(symbol);
+				continue;
+			}
+
+			uint8_t value = 0;
+			uint32_t repeat = 0;
+			if (!NeedBits(7))
+			{
+				return false;
+			}
+
+			if (symbol == 16)
+			{
+				if (count == 0)
+				{
+					return false;
+				}
+				value = lengths[count - 1];
+				repeat = 3 + GetBits(2);
+			}
+			else if (symbol == 17)
+			{
+				repeat = 3 + GetBits(3);
+			}
+			else
+			{
+				repeat = 11 + GetBits(7);
+			}
+
+			if (count + repeat > total)
+			{
+				return false;
+			}
+
+			std::memset(&lengths[count], value, repeat);
+			count += repeat;
+		}
+
+		if (lengths[256] == 0)
+		{
+			return false;
+		}
+
+		return BuildTable(litLen, lengths, numLitLen) && BuildTable(dist, lengths + numLitLen, numDist);
+	}
+
+	bool FInflater::FlushOutput(bool keepHistory)
+	{
+		if (mWindowPos > mFlushedPos)
+		{
+			const uint8_t* data = &mWindow[mFlushedPos];
+			std::size_t size = mWindowPos - mFlushedPos;
+
+			mAdler = UpdateAdler32(mAdler, data, size);
+			if (!(*mWriter)(data, size))
+			{
+				return false;
+			}
+		}
+
+		if (keepHistory && mWindowPos > DEFLATE_WINDOW_SIZE)
+		{
+			std::memmove(mWindow.data(), &mWindow[mWindowPos - DEFLATE_WINDOW_SIZE], DEFLATE_WINDOW_SIZE);
+			mWindowPos = DEFLATE_WINDOW_SIZE;
+		}
+
+		mFlushedPos = mWindowPos;
+		return true;
+	}
+
+	// -- FDeflater -- //
+
+	namespace
+	{
+		constexpr uint32_t DEFLATE_HASH_BITS = 15;
+		constexpr std::size_t DEFLATE_BUFFER_SIZE = DEFLATE_WINDOW_SIZE * 3;
+		constexpr std::size_t DEFLATE_OUTPUT_FLUSH_SIZE = 16 * 1024;
+		constexpr std::size_t DEFLATE_MAX_STORED = 65535;
+	}
+
+	FDeflater::FDeflater(const WriteFunc& writer, int level, bool zlibWrapper)
+		: mWriter(writer)
+		, mMaxChain(MaxChainForLevel[std::clamp(level, 0, 9)])
+		, mZlibWrapper(zlibWrapper)
+		, mHeaderWritten(false)
+		, mWindowSize(0)
+		, mProcessedPos(0)
+		, mBitBuffer(0)
+		, mBitCount(0)
+		, mAdler(1)
+	{
+		mWindow.resize(DEFLATE_BUFFER_SIZE);
+
+		if (mMaxChain > 0)
+		{
+			mHashHead.assign(std::size_t(1) << DEFLATE_HASH_BITS, -1);
+			mHashPrev.assign(DEFLATE_BUFFER_SIZE, -1);
+			mSymbols.reserve(DEFLATE_BUFFER_SIZE);
+		}
+	}
+
+	bool FDeflater::Write(const uint8_t* data, std::size_t size)
+	{
+		mAdler = UpdateAdler32(mAdler, data, size);
+
+		while (size > 0)
+		{
+			std::size_t count = std::min(size, mWindow.size() - mWindowSize);
+			std::memcpy(&mWindow[mWindowSize], data, count);
+			mWindowSize += count;
+			data += count;
+			size -= count;
+
+			if (mWindowSize == mWindow.size() && !CompressWindow(false))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool FDeflater::Finish()
+	{
+		if (!CompressWindow(true))
+		{
+			return false;
+		}
+
+		AlignToByte();
+
+		if (mZlibWrapper)
+		{
+			for (int shift = 24; shift >= 0; shift -= 8)
+			{
+				PutBits((mAdler >> shift) & 0xFF, 8);
+			}
+		}
+
+		return FlushBits(true);
+	}
+
+	bool FDeflater::Compress(const uint8_t* data, std::size_t size, std::vector<uint8_t>& result, int level, bool zlibWrapper)
+	{
+		result.clear();
+
+		FDeflater deflater([&result](const uint8_t* chunk, std::size_t chunkSize)
+			{
+				result.insert(result.end(), chunk, chunk + chunkSize);
+				return true;
+			}, level, zlibWrapper);
+
+		return deflater.Write(data, size) && deflater.Finish();
+	}
+
+	bool FDeflater::CompressWindow(bool finish)
+	{
+		if (!mHeaderWritten)
+		{
+			if (mZlibWrapper)
+			{
+				uint32_t cmf = 0x78;
+				uint32_t flevel = mMaxChain == 0 ? 0 : (mMaxChain <= 8 ? 1 : (mMaxChain <= 128 ? 2 : 3));
+				uint32_t flg = flevel << 6;
+				flg += (31 - ((cmf << 8) | flg) % 31) % 31;
+				PutBits(cmf, 8);
+				PutBits(flg, 8);
+			}
+			mHeaderWritten = true;
+		}
+
+		// leave a full match of lookahead unless this is the end of the stream
+		std::size_t limit = finish ? mWindowSize : (mWindowSize > DEFLATE_MAX_MATCH ? mWindowSize - DEFLATE_MAX_MATCH : 0);
+		std::size_t blockStart = mProcessedPos;
+		std::size_t pos = mProcessedPos;
+
+		if (mMaxChain == 0)
+		{
+			pos = std::max(pos, limit);
+		}
+		else
+		{
+			mSymbols.clear();
+
+			while (pos < limit)
+			{
+				std::size_t bestLength = 0;
+				std::size_t bestDist = 0;
+
+				if (pos + DEFLATE_MIN_MATCH <= mWindowSize)
+				{
+					const std::size_t maxLength = std::min(DEFLATE_MAX_MATCH, mWindowSize - pos);
+					const uint8_t* current = &mWindow[pos];
+
+					uint32_t hash = Hash(pos);
+					int32_t candidate = mHashHead[hash];
+					int chain = mMaxChain;
+
+					while (candidate >= 0 && pos - candidate <= DEFLATE_WINDOW_SIZE && chain-- > 0)
+					{
+						const uint8_t* match = &mWindow[candidate];
+						if (match[bestLength] == current[bestLength] && match[0] == current[0])
+						{
+							std::size_t length = 0;
+							while (length < maxLength && match[length] == current[length])
+							{
+								++length;
+							}
+
+							if (length > bestLength)
+							{
+								bestLength = length;
+								bestDist = pos - candidate;
+								if (length == maxLength)
+								{
+									break;
+								}
+							}
+						}
+						candidate = mHashPrev[candidate];
+					}
+
+					mHashPrev[pos] = mHashHead[hash];
+					mHashHead[hash] = static_cast<int32_t>(pos);
+				}
+
+				if (bestLength >= DEFLATE_MIN_MATCH)
+				{
+					mSymbols.push_back(FSymbol{ static_cast<uint16_t>(bestLength), static_cast<uint16_t>(bestDist) });
+
+					for (std::size_t i = 1; i < bestLength; ++i)
+					{
+						std::size_t insertPos = pos + i;
+						if (insertPos + DEFLATE_MIN_MATCH <= mWindowSize)
+						{
+							uint32_t hash = Hash(insertPos);
+							mHashPrev[insertPos] = mHashHead[hash];
+							mHashHead[hash] = static_cast<int32_t>(insertPos);
+						}
+					}
+					pos += bestLength;
+				}
+				else
+				{
+					mSymbols.push_back(FSymbol{ mWindow[pos], 0 });
+					++pos;
+				}
+			}
+		}
+
+		if (pos > blockStart || finish)
+		{
+			if (!EmitBlock(finish, blockStart, pos))
+			{
+				return false;
+			}
+		}
+
+		mProcessedPos = pos;
+
+		if (!finish && mProcessedPos > DEFLATE_WINDOW_SIZE)
+		{
+			// slide so that exactly one window of history precedes the next unprocessed byte
+			const std::size_t shift = mProcessedPos - DEFLATE_WINDOW_SIZE;
+			std::memmove(mWindow.data(), &mWindow[shift], mWindowSize - shift);
+			mWindowSize -= shift;
+			mProcessedPos -= shift;
+
+			if (mMaxChain > 0)
+			{
+				auto rebase = [shift](int32_t& value) { value = value >= static_cast<int32_t>(shift) ? value - static_cast<int32_t>(shift) : -1; };
+				std::for_each(mHashHead.begin(), mHashHead.end(), rebase);
+				std::memmove(mHashPrev.data(), &mHashPrev[shift], (mHashPrev.size() - shift) * sizeof(int32_t));
+				std::for_each(mHashPrev.begin(), mHashPrev.begin() + (mHashPrev.size() - shift), rebase);
+				std::fill(mHashPrev.begin() + (mHashPrev.size() - shift), mHashPrev.end(), -1);
+			}
+		}
+
+		return FlushBits(false);
+	}
+
+	bool FDeflater::EmitBlock(bool finalBlock, std::size_t blockStart, std::size_t blockEnd)
+	{
+		if (mMaxChain == 0 || blockEnd == blockStart)
+		{
+			EmitStoredBlock(finalBlock, blockStart, blockEnd);
+			return true;
+		}
+
+		uint32_t litLenFreqs[DEFLATE_NUM_LITLEN] = { 0 };
+		uint32_t distFreqs[DEFLATE_NUM_DIST] = { 0 };
+
+		for (const FSymbol& symbol : mSymbols)
+		{
+			if (symbol.Dist == 0)
+			{
+				++litLenFreqs[symbol.LitLen];
+			}
+			else
+			{
+				++litLenFreqs[257 + GetLengthCode(symbol.LitLen)];
+				++distFreqs[GetDistCode(symbol.Dist)];
+			}
+		}
+		litLenFreqs[256] = 1;
+
+		uint8_t litLenLengths[DEFLATE_NUM_LITLEN];
+		uint8_t distLengths[DEFLATE_NUM_DIST];
+		BuildCodeLengths(litLenFreqs, DEFLATE_NUM_LITLEN, DEFLATE_MAX_BITS, litLenLengths);
+		BuildCodeLengths(distFreqs, DEFLATE_NUM_DIST, DEFLATE_MAX_BITS, distLengths);
+
+		// some decoders reject an empty distance tree
+		if (std::all_of(distLengths, distLengths + DEFLATE_NUM_DIST, [](uint8_t length) { return length == 0; }))
+		{
+			distLengths[0] = 1;
+		}
+
+		uint32_t numLitLen = DEFLATE_NUM_LITLEN;
+		while (numLitLen > 257 && litLenLengths[numLitLen - 1] == 0)
+		{
+			--numLitLen;
+		}
+
+		uint32_t numDist = DEFLATE_NUM_DIST;
+		while (numDist > 1 && distLengths[numDist - 1] == 0)
+		{
+			--numDist;
+		}
+
+		uint8_t lengths[DEFLATE_NUM_LITLEN + DEFLATE_NUM_DIST];
+		std::memcpy(lengths, litLenLengths, numLitLen);
+		std::memcpy(lengths + numLitLen, distLengths, numDist);
+		const uint32_t numLengths = numLitLen + numDist;
+
+		// run-length encode the code lengths: each entry is (symbol, extra bits value)
+		std::vector<std::pair<uint8_t, uint8_t>> codeLengthSymbols;
+		codeLengthSymbols.reserve(numLengths);
+		uint32_t codeLengthFreqs[DEFLATE_NUM_CODELEN] = { 0 };
+
+		for (uint32_t i = 0; i < numLengths;)
+		{
+			uint8_t value = lengths[i];
+			uint32_t run = 1;
+			while (i + run < numLengths && lengths[i + run] == value)
+			{
+				++run;
+			}
+			i += run;
+
+			if (value == 0)
+			{
+				while (run >= 11)
+				{
+					uint32_t count = std::min<uint32_t>(run, 138);
+					codeLengthSymbols.emplace_back(uint8_t(18), static_cast<uint8_t>(count - 11));
+					run -= count;
+				}
+				if (run >= 3)
+				{
+					codeLengthSymbols.emplace_back(uint8_t(17), static_cast<uint8_t>(run - 3));
+					run = 0;
+				}
+			}
+			else
+			{
+				codeLengthSymbols.emplace_back(value, uint8_t(0));
+				--run;
+				while (run >= 3)
+				{
+					uint32_t count = std::min<uint32_t>(run, 6);
+					codeLengthSymbols.emplace_back(uint8_t(16), static_cast<uint8_t>(count - 3));
+					run -= count;
+				}
+			}
+
+			for (; run > 0; --run)
+			{
+				codeLengthSymbols.emplace_back(value, uint8_t(0));
+			}
+		}
+
+		for (const auto& symbol : codeLengthSymbols)
+		{
+			++codeLengthFreqs[symbol.first];
+		}
+
+		uint8_t codeLengthLengths[DEFLATE_NUM_CODELEN];
+		BuildCodeLengths(codeLengthFreqs, DEFLATE_NUM_CODELEN, 7, codeLengthLengths);
+
+		uint32_t numCodeLen = DEFLATE_NUM_CODELEN;
+		while (numCodeLen > 4 && codeLengthLengths[CodeLengthOrder[numCodeLen - 1]] == 0)
+		{
+			--numCodeLen;
+		}
+
+		// compare against storing the block verbatim
+		uint64_t dynamicBits = 3 + 14 + 3 * numCodeLen;
+		for (const auto& symbol : codeLengthSymbols)
+		{
+			dynamicBits += codeLengthLengths[symbol.first];
+			dynamicBits += symbol.first == 16 ? 2 : (symbol.first == 17 ? 3 : (symbol.first == 18 ? 7 : 0));
+		}
+		for (uint32_t i = 0; i < DEFLATE_NUM_LITLEN; ++i)
+		{
+			dynamicBits += uint64_t(litLenFreqs[i]) * (litLenLengths[i] + (i > 256 ? LengthExtra[i - 257] : 0));
+		}
+		for (uint32_t i = 0; i < DEFLATE_NUM_DIST; ++i)
+		{
+			dynamicBits += uint64_t(distFreqs[i]) * (distLengths[i] + DistExtra[i]);
+		}
+
+		const std::size_t blockSize = blockEnd - blockStart;
+		uint64_t storedBits = (blockSize + 5 * (blockSize / DEFLATE_MAX_STORED + 1)) * 8 + 7;
+		if (storedBits <= dynamicBits)
+		{
+			EmitStoredBlock(finalBlock, blockStart, blockEnd);
+			return true;
+		}
+
+		uint16_t litLenCodes[DEFLATE_NUM_LITLEN];
+		uint16_t distCodes[DEFLATE_NUM_DIST];
+		uint16_t codeLengthCodes[DEFLATE_NUM_CODELEN];
+		BuildCanonicalCodes(litLenLengths, DEFLATE_NUM_LITLEN, litLenCodes);
+		BuildCanonicalCodes(distLengths, DEFLATE_NUM_DIST, distCodes);
+		BuildCanonicalCodes(codeLengthLengths, DEFLATE_NUM_CODELEN, codeLengthCodes);
+
+		PutBits(finalBlock ? 1 : 0, 1);
+		PutBits(2, 2);
+		PutBits(numLitLen - 257, 5);
+		PutBits(numDist - 1, 5);
+		PutBits(numCodeLen - 4, 4);
+
+		for (uint32_t i = 0; i < numCodeLen; ++i)
+		{
+			PutBits(codeLengthLengths[CodeLengthOrder[i]], 3);
+		}
+
+		for (const auto& symbol : codeLengthSymbols)
+		{
+			PutHuffman(codeLengthCodes[symbol.first], codeLengthLengths[symbol.first]);
+			if (symbol.first >= 16)
+			{
+				PutBits(symbol.second, symbol.first == 16 ? 2 : (symbol.first == 17 ? 3 : 7));
+			}
+		}
+
+		for (const FSymbol& symbol : mSymbols)
+		{
+			if (symbol.Dist == 0)
+			{
+				PutHuffman(litLenCodes[symbol.LitLen], litLenLengths[symbol.LitLen]);
+			}
+			else
+			{
+				uint32_t lengthCode = GetLengthCode(symbol.LitLen);
+				PutHuffman(litLenCodes[257 + lengthCode], litLenLengths[257 + lengthCode]);
+				PutBits(symbol.LitLen - LengthBase[lengthCode], LengthExtra[lengthCode]);
+
+				uint32_t distCode = GetDistCode(symbol.Dist);
+				PutHuffman(distCodes[distCode], distLengths[distCode]);
+				PutBits(symbol.Dist - DistBase[distCode], DistExtra[distCode]);
+			}
+
+			if (mOutput.size() >= DEFLATE_OUTPUT_FLUSH_SIZE && !FlushBits(false))
+			{
+				return false;
+			}
+		}
+
+		PutHuffman(litLenCodes[256], litLenLengths[256]);
+		return true;
+	}
+
+	void FDeflater::EmitStoredBlock(bool finalBlock, std::size_t blockStart, std::size_t blockEnd)
+	{
+		do
+		{
+			std::size_t count = std::min(blockEnd - blockStart, DEFLATE_MAX_STORED);
+			bool last = finalBlock && blockStart + count == blockEnd;
+
+			PutBits(last ? 1 : 0, 1);
+			PutBits(0, 2);
+			AlignToByte();
+			PutBits(static_cast<uint32_t>(count), 16);
+			PutBits(static_cast<uint32_t>(count ^ 0xFFFF), 16);
+
+			mOutput.insert(mOutput.end(), &mWindow[blockStart], &mWindow[blockStart] + count);
+			blockStart += count;
+		} while (blockStart < blockEnd);
+	}
+
+	void FDeflater::PutBits(uint32_t bits, uint32_t count)
+	{
+		mBitBuffer |= static_cast<uint64_t>(bits) << mBitCount;
+		mBitCount += count;
+
+		while (mBitCount >= 8)
+		{
+			mOutput.push_back(static_cast<uint8_t>(mBitBuffer));
+			mBitBuffer >>= 8;
+			mBitCount -= 8;
+		}
+	}
+
+	void FDeflater::PutHuffman(uint32_t code, uint32_t length)
+	{
+		PutBits(code, length);
+	}
+
+	void FDeflater::AlignToByte()
+	{
+		if (mBitCount > 0)
+		{
+			PutBits(0, 8 - mBitCount);
+		}
+	}
+
+	bool FDeflater::FlushBits(bool force)
+	{
+		if (mOutput.empty() || (!force && mOutput.size() < DEFLATE_OUTPUT_FLUSH_SIZE))
+		{
+			return true;
+		}
+
+		bool succeeded = mWriter(mOutput.data(), mOutput.size());
+		mOutput.clear();
+		return succeeded;
+	}
+
+	uint32_t FDeflater::Hash(std::size_t pos) const
+	{
+		uint32_t value = (uint32_t(mWindow[pos]) << 16) | (uint32_t(mWindow[pos + 1]) << 8) | mWindow[pos + 2];
+		return (value * 2654435761u) >> (32 - DEFLATE_HASH_BITS);
+	}
+
+	// -- Checksums -- //
+
+	uint32_t UpdateAdler32(uint32_t adler, const uint8_t* data, std::size_t size)
+	{
+		// largest n such that 255n(n+1)/2 + (n+1)(BASE-1) fits in 32 bits
+		constexpr uint32_t Base = 65521;
+		constexpr std::size_t MaxRun = 5552;
+
+		uint32_t a = adler & 0xFFFF;
+		uint32_t b = adler >> 16;
+
+		while (size > 0)
+		{
+			std::size_t run = std::min(size, MaxRun);
+			size -= run;
+
+			for (std::size_t i = 0; i < run; ++i)
+			{
+				a += data[i];
+				b += a;
+			}
+			data += run;
+
+			a %= Base;
+			b %= Base;
+		}
+
+		return (b << 16) | a;
+	}
+
+	uint32_t UpdateCRC32(uint32_t crc, const uint8_t* data, std::size_t size)
+	{
+		static const auto CRCTable = []()
+		{
+			std::vector<uint32_t> table(256);
+			for (uint32_t i = 0; i < 256; ++i)
+			{
+				uint32_t value = i;
+				for (int bit = 0; bit < 8; ++bit)
+				{
+					value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+				}
+				table[i] = value;
+			}
+			return table;
+		}();
+
+		crc = ~crc;
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			crc = CRCTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return ~crc;
+	}
+}
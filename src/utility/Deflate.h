@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <functional>
+
+namespace Dash
+{
+	/**
+	 * Streaming zlib (RFC 1950) / deflate (RFC 1951) decoder.
+	 * Compressed bytes are pulled from the reader on demand and decoded bytes are pushed to the writer
+	 * in chunks, so only the 32KB history window is kept in memory.
+	 */
+	class FInflater
+	{
+	public:
+		/** Returns the number of bytes copied into dest, 0 on end of input. */
+		using ReadFunc = std::function<std::size_t(uint8_t* dest, std::size_t size)>;
+
+		/** Returns false to abort decoding. */
+		using WriteFunc = std::function<bool(const uint8_t* data, std::size_t size)>;
+
+		FInflater();
+
+		bool Inflate(const ReadFunc& reader, const WriteFunc& writer, bool zlibWrapper = true);
+
+		bool Inflate(const uint8_t* data, std::size_t size, const WriteFunc& writer, bool zlibWrapper = true);
+
+	private:
+		struct FHuffmanTable
+		{
+			// entry = (symbol << 4) | codeLength, indexed by the next MaxBits bits of the stream
+			std::vector<uint16_t> Entries;
+			uint32_t MaxBits = 0;
+		};
+
+		bool BuildTable(FHuffmanTable& table, const uint8_t* lengths, uint32_t count);
+
+		bool Refill();
+		bool NeedBits(uint32_t count);
+		uint32_t GetBits(uint32_t count);
+		bool DecodeSymbol(const FHuffmanTable& table, uint32_t& symbol);
+
+		bool InflateStored();
+		bool InflateBlock(const FHuffmanTable& litLen, const FHuffmanTable& dist);
+		bool ReadDynamicTables(FHuffmanTable& litLen, FHuffmanTable& dist);
+
+		bool FlushOutput(bool keepHistory);
+
+		const ReadFunc* mReader;
+		const WriteFunc* mWriter;
+
+		std::vector<uint8_t> mInput;
+		std::size_t mInputPos;
+		std::size_t mInputSize;
+		std::size_t mPadBytes;
+		bool mInputEnd;
+
+		uint64_t mBitBuffer;
+		uint32_t mBitCount;
+
+		std::vector<uint8_t> mWindow;
+		std::size_t mWindowPos;
+		std::size_t mFlushedPos;
+
+		uint32_t mAdler;
+
+		FHuffmanTable mFixedLitLen;
+		FHuffmanTable mFixedDist;
+	};
+
+	/**
+	 * Streaming zlib / deflate encoder using greedy hash-chain LZ77 and dynamic Huffman blocks.
+	 * Uncompressed bytes are appended with Write, compressed bytes are pushed to the writer as blocks complete.
+	 */
+	class FDeflater
+	{
+	public:
+		using WriteFunc = std::function<bool(const uint8_t* data, std::size_t size)>;
+
+		/** level 0 stores the data, 1..9 trade speed for ratio through the hash-chain search depth. */
+		FDeflater(const WriteFunc& writer, int level = 6, bool zlibWrapper = true);
+
+		bool Write(const uint8_t* data, std::size_t size);
+
+		bool Finish();
+
+		static bool Compress(const uint8_t* data, std::size_t size, std::vector<uint8_t>& result, int level = 6, bool zlibWrapper = true);
+
+	private:
+		struct FSymbol
+		{
+			uint16_t LitLen;
+			uint16_t Dist;
+		};
+
+		bool CompressWindow(bool finish);
+		bool EmitBlock(bool finalBlock, std::size_t blockStart, std::size_t blockEnd);
+		void EmitStoredBlock(bool finalBlock, std::size_t blockStart, std::size_t blockEnd);
+
+		void PutBits(uint32_t bits, uint32_t count);
+		void PutHuffman(uint32_t code, uint32_t length);
+		void AlignToByte();
+		bool FlushBits(bool force);
+
+		uint32_t Hash(std::size_t pos) const;
+
+		WriteFunc mWriter;
+		int mMaxChain;
+		bool mZlibWrapper;
+		bool mHeaderWritten;
+
+		std::vector<uint8_t> mWindow;
+		std::size_t mWindowSize;
+		std::size_t mProcessedPos;
+
+		std::vector<int32_t> mHashHead;
+		std::vector<int32_t> mHashPrev;
+
+		std::vector<FSymbol> mSymbols;
+
+		std::vector<uint8_t> mOutput;
+		uint64_t mBitBuffer;
+		uint32_t mBitCount;
+
+		uint32_t mAdler;
+	};
+
+	uint32_t UpdateAdler32(uint32_t adler, const uint8_t* data, std::size_t size);
+
+	uint32_t UpdateCRC32(uint32_t crc, const uint8_t* data, std::size_t size);
+}
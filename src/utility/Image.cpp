@@ -1,5 +1,6 @@
 #include "Image.h"
-#include "ImageHelper.h"
+#include <cstring>
+#include <utility>
 
 namespace Dash
 {
@@ -9,22 +10,28 @@ namespace Dash
 		, mFormat(EDASH_FORMAT::UnKwon)
 		, mBitPerPixel(0)
 		, mRowAlignment(1)
+		, mLayout(ETextureLayout::Linear)
 	{
 	}
 
 	FTexture::FTexture(size_t width, size_t height, EDASH_FORMAT format, size_t alignment)
+		: FTexture(width, height, format, ETextureLayout::Linear, alignment)
+	{
+	}
+
+	FTexture::FTexture(size_t width, size_t height, EDASH_FORMAT format, ETextureLayout layout, size_t alignment, std::pmr::memory_resource* resource)
 		: mWidth(width)
 		, mHeight(height)
 		, mFormat(format)
 		, mBitPerPixel(GetByteSizeForFormat(format) * 8)
 		, mRowAlignment(alignment)
+		, mLayout(layout)
+		, mData(resource)
 	{
 		ASSERT(mRowAlignment >= 1);
 
 		//չΪ1ֽ(8 bit)ı
-		size_t picRowPitch = (size_t(mWidth) * size_t(mBitPerPixel) + (mRowAlignment * 8) - 1) / (mRowAlignment * 8);
-
-		mData.resize(picRowPitch * height);
+		mData.resize(GetDataSize());
 	}
 
 	FTexture::FTexture(const FTexture& other)
@@ -33,6 +40,7 @@ namespace Dash
 		, mFormat(other.mFormat)
 		, mBitPerPixel(other.mBitPerPixel)
 		, mRowAlignment(other.mRowAlignment)
+		, mLayout(other.mLayout)
 		, mData(other.mData)
 	{
 	}
@@ -43,6 +51,7 @@ namespace Dash
 		, mFormat(std::exchange(other.mFormat, EDASH_FORMAT::UnKwon))
 		, mBitPerPixel(std::exchange(other.mBitPerPixel, 0))
 		, mRowAlignment(std::exchange(other.mRowAlignment, 1))
+		, mLayout(std::exchange(other.mLayout, ETextureLayout::Linear))
 		, mData(std::move(other.mData))
 	{
 	}
@@ -56,6 +65,7 @@ namespace Dash
 			mFormat = other.mFormat;
 			mBitPerPixel = other.mBitPerPixel;
 			mRowAlignment = other.mRowAlignment;
+			mLayout = other.mLayout;
 			mData = other.mData;
 		}
 		return *this;
@@ -70,23 +80,18 @@ namespace Dash
 			mFormat = std::exchange(other.mFormat, EDASH_FORMAT::UnKwon);
 			mBitPerPixel = std::exchange(other.mBitPerPixel, 0);
 			mRowAlignment = std::exchange(other.mRowAlignment, 1);
+			mLayout = std::exchange(other.mLayout, ETextureLayout::Linear);
 			mData = std::move(other.mData);
 		}
 		return *this;
 	}
 
-	DXGI_FORMAT FTexture::GetDXGIFormat() const
-	{
-		return DashFormatToDXGIFormat(mFormat);
-	}
-
 	void FTexture::Resize(size_t x, size_t y)
 	{
 		mWidth = x;
 		mHeight = y;
 
-		size_t picRowPitch = (size_t(mWidth) * size_t(mBitPerPixel) + (mRowAlignment * 8) - 1) / (mRowAlignment * 8);
-		mData.resize(picRowPitch * mHeight);
+		mData.resize(GetDataSize());
 	}
 
 	void FTexture::Resize(const FVector2i& size)
@@ -94,4 +99,118 @@ namespace Dash
 		Resize(size.x, size.y);
 	}
 
+	FTexture FTexture::ConvertLayout(ETextureLayout layout) const
+	{
+		FTexture result(mWidth, mHeight, mFormat, layout, mRowAlignment, GetMemoryResource());
+
+		const size_t bytePerPixel = mBitPerPixel / 8;
+
+		// tile rows are contiguous in the linear and tiled layouts, Morton order has to go pixel by pixel
+		const bool copyTileRows = mLayout != ETextureLayout::Morton && layout != ETextureLayout::Morton;
+
+		for (size_t y = 0; y < mHeight; ++y)
+		{
+			for (size_t x = 0; x < mWidth; x += TileSize)
+			{
+				const size_t count = std::min(TileSize, mWidth - x);
+				if (copyTileRows)
+				{
+					std::memcpy(&result.mData[result.GetPixelOffset(x, y)], &mData[GetPixelOffset(x, y)], count * bytePerPixel);
+					continue;
+				}
+
+				for (size_t i = 0; i < count; ++i)
+				{
+					std::memcpy(&result.mData[result.GetPixelOffset(x + i, y)], &mData[GetPixelOffset(x + i, y)], bytePerPixel);
+				}
+			}
+		}
+
+		return result;
+	}
+
+	void FillPixels(uint8_t* dest, size_t count, const void* pixel, size_t pixelSize)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(pixel);
+		const size_t size = count * pixelSize;
+
+		if (std::all_of(bytes, bytes + pixelSize, [bytes](uint8_t value) { return value == bytes[0]; }))
+		{
+			std::memset(dest, bytes[0], size);
+			return;
+		}
+
+		if (pixelSize > 16)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				std::memcpy(dest + i * pixelSize, bytes, pixelSize);
+			}
+			return;
+		}
+
+		// the pixel pattern repeats every lcm(pixelSize, 16) bytes: 16 for power of two pixels, 48 for 12 byte pixels
+		size_t patternSize = pixelSize;
+		while (patternSize % 16 != 0)
+		{
+			patternSize += pixelSize;
+		}
+
+		alignas(16) uint8_t pattern[256];
+		for (size_t i = 0; i < patternSize; ++i)
+		{
+			pattern[i] = bytes[i % pixelSize];
+		}
+
+		size_t offset = 0;
+		if (patternSize == 16)
+		{
+			const __m128i value = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern));
+			for (; offset + 64 <= size; offset += 64)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + offset), value);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + offset + 16), value);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + offset + 32), value);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + offset + 48), value);
+			}
+			for (; offset + 16 <= size; offset += 16)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + offset), value);
+			}
+		}
+		else if (patternSize == 48)
+		{
+			const __m128i value0 = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern));
+			const __m128i value1 = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern + 16));
+			const __m128i value2 = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern + 32));
+			for (; offset + 48 <= size; offset += 48)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + offset), value0);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + offset + 16), value1);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + offset + 32), value2);
+			}
+		}
+		else
+		{
+			for (; offset + patternSize <= size; offset += patternSize)
+			{
+				std::memcpy(dest + offset, pattern, patternSize);
+			}
+		}
+
+		std::memcpy(dest + offset, pattern, size - offset);
+	}
+
+	size_t FTexture::GetDataSize() const
+	{
+		if (mLayout == ETextureLayout::Linear)
+		{
+			return GetRowPitch() * mHeight;
+		}
+
+		const size_t tileCountX = (mWidth + TileSize - 1) / TileSize;
+		const size_t tileCountY = (mHeight + TileSize - 1) / TileSize;
+		return tileCountX * tileCountY * TileSize * TileSize * (mBitPerPixel / 8);
+	}
+
 }
\ No newline at end of file
@@ -1,7 +1,8 @@
 #pragma once
 
 #include "../math/MathType.h"
-#include <d3d12.h>
+#include "TextureView.h"
+#include "MemoryResource.h"
 #include <vector>
 #include <fstream>
 #include <vector>
@@ -9,11 +10,24 @@
 
 namespace Dash
 {
+	/** Memory order of the pixels of a texture. */
+	enum class ETextureLayout : uint8_t
+	{
+		/** Row-major, rows padded to the row alignment. */
+		Linear,
+		/** 8x8 pixel tiles, row-major inside the tile, tiles stored row-major. */
+		Tiled8x8,
+		/** 8x8 pixel tiles in Morton (Z) order inside the tile, tiles stored row-major. */
+		Morton,
+	};
+
 	class FTexture
 	{
 	public:
 		FTexture();
 		FTexture(size_t width, size_t height, EDASH_FORMAT format, size_t rowAlignment = 1);	
+		FTexture(size_t width, size_t height, EDASH_FORMAT format, ETextureLayout layout, size_t rowAlignment = 1,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 		FTexture(const FTexture& other);
 		FTexture(FTexture&& other) noexcept;
 		~FTexture() {};
@@ -23,11 +37,12 @@ namespace Dash
 
 		EDASH_FORMAT GetFormat() const { return mFormat; }
 
-		DXGI_FORMAT GetDXGIFormat() const;
-
 		size_t GetBitPerPixel() const { return mBitPerPixel; }
 
-		size_t GetRowPitch() const { return (size_t(mWidth) * size_t(mBitPerPixel) + (mRowAlignment * 8) - 1) / (mRowAlignment * 8); }
+		ETextureLayout GetLayout() const { return mLayout; }
+
+		/** Row pitch of the linear layout, raw rows are only meaningful for linear textures. */
+		size_t GetRowPitch() const { return (size_t(mWidth) * size_t(mBitPerPixel) + (mRowAlignment * 8) - 1) / (mRowAlignment * 8) * mRowAlignment; }
 
 		size_t GetRowAlignment() const { return mRowAlignment; }
 
@@ -39,6 +54,15 @@ namespace Dash
 
 		uint8_t* GetRawData() { return mData.data(); }
 
+		/** Resource the pixel storage is allocated from, copies of the texture go back to the default resource. */
+		std::pmr::memory_resource* GetMemoryResource() const { return mData.get_allocator().resource(); }
+
+		/** Byte offset of the pixel in the raw data for the current layout. */
+		size_t GetPixelOffset(size_t x, size_t y) const;
+
+		/** Returns a copy of the texture stored in the given layout, allocated from the same resource. */
+		FTexture ConvertLayout(ETextureLayout layout) const;
+
 		template<typename T>
 		void SetPixel(const T& value, size_t x, size_t y);
 
@@ -51,14 +75,28 @@ namespace Dash
 		template<typename T>
 		const T& GetPixel(const FVector2i& index) const;
 
+		/** Typed view over the rows, only for the linear layout. */
+		template<typename T>
+		TTextureView<T> GetView();
+
+		template<typename T>
+		TTextureView<const T> GetView() const;
+
 		template<typename T>
 		void ClearImage(const T& value = T{ FZero{} });
 
+		template<typename T>
+		void FillRect(const T& value, size_t x, size_t y, size_t width, size_t height);
+
 		void Resize(size_t x, size_t y);
 
 		void Resize(const FVector2i& size);
 
+		static constexpr size_t TileSize = 8;
+
 	private:
+		size_t GetDataSize() const;
+
 		size_t mWidth;
 		size_t mHeight;
 		
@@ -66,14 +104,39 @@ namespace Dash
 		size_t mRowAlignment;
 		size_t mBitPerPixel;
 		EDASH_FORMAT mFormat;
-		std::vector<uint8_t> mData;
+		ETextureLayout mLayout;
+		std::pmr::vector<uint8_t> mData;
 	};
 
+	FORCEINLINE size_t FTexture::GetPixelOffset(size_t x, size_t y) const
+	{
+		const size_t bytePerPixel = mBitPerPixel / 8;
+
+		if (mLayout == ETextureLayout::Linear)
+		{
+			return y * GetRowPitch() + x * bytePerPixel;
+		}
+
+		const size_t tileCountX = (mWidth + TileSize - 1) / TileSize;
+		const size_t tileStart = ((y / TileSize) * tileCountX + x / TileSize) * TileSize * TileSize;
+		const size_t localX = x % TileSize;
+		const size_t localY = y % TileSize;
+
+		if (mLayout == ETextureLayout::Tiled8x8)
+		{
+			return (tileStart + localY * TileSize + localX) * bytePerPixel;
+		}
+
+		// interleave the three bits of x and y
+		auto spread = [](size_t v) { return (v & 1) | ((v & 2) << 1) | ((v & 4) << 2); };
+		return (tileStart + (spread(localX) | (spread(localY) << 1))) * bytePerPixel;
+	}
+
 	template<typename T>
 	FORCEINLINE void FTexture::SetPixel(const T& value, size_t x, size_t y)
 	{
 		ASSERT(x < mWidth&& y < mHeight);
-		reinterpret_cast<T&>(mData[x + y * mWidth]) = value;
+		reinterpret_cast<T&>(mData[GetPixelOffset(x, y)]) = value;
 	}
 
 	template<typename T>
@@ -89,24 +152,63 @@ namespace Dash
 
 		ASSERT(mFormat == GetFormatForType<T>());
 
-		return reinterpret_cast<const T&>(mData[x + y * mWidth]);
+		return reinterpret_cast<const T&>(mData[GetPixelOffset(x, y)]);
 	}
 
 	template<typename T>
 	FORCEINLINE const T& FTexture::GetPixel(const FVector2i& index) const
 	{
-		GetPixel(index.x, index.y);
+		return GetPixel<T>(index.x, index.y);
+	}
+
+	template<typename T>
+	FORCEINLINE TTextureView<T> FTexture::GetView()
+	{
+		ASSERT(mLayout == ETextureLayout::Linear);
+		ASSERT(sizeof(T) * 8 == mBitPerPixel);
+		return TTextureView<T>(mData.data(), mWidth, mHeight, GetRowPitch());
+	}
+
+	template<typename T>
+	FORCEINLINE TTextureView<const T> FTexture::GetView() const
+	{
+		ASSERT(mLayout == ETextureLayout::Linear);
+		ASSERT(sizeof(T) * 8 == mBitPerPixel);
+		return TTextureView<const T>(mData.data(), mWidth, mHeight, GetRowPitch());
 	}
 
 	template<typename T>
 	FORCEINLINE void FTexture::ClearImage(const T& value)
 	{
-		for (size_t h = 0; h < mHeight; h++)
+		ASSERT(sizeof(T) * 8 == mBitPerPixel);
+
+		// tiled layouts and unpadded rows are one dense run of pixels, padding pixels included
+		if (mLayout != ETextureLayout::Linear || GetRowPitch() == mWidth * sizeof(T))
 		{
-			for (size_t w = 0; w < mWidth; w++)
+			FillPixels(mData.data(), mData.size() / sizeof(T), &value, sizeof(T));
+			return;
+		}
+
+		GetView<T>().ForEachRow([this, &value](size_t, T* row) { FillRow(row, mWidth, value); });
+	}
+
+	template<typename T>
+	FORCEINLINE void FTexture::FillRect(const T& value, size_t x, size_t y, size_t width, size_t height)
+	{
+		ASSERT(x + width <= mWidth && y + height <= mHeight);
+
+		if (mLayout != ETextureLayout::Linear)
+		{
+			for (size_t row = y; row < y + height; ++row)
 			{
-				SetPixel(value, w, h);
+				for (size_t column = x; column < x + width; ++column)
+				{
+					SetPixel(value, column, row);
+				}
 			}
+			return;
 		}
+
+		GetView<T>().GetSubView(x, y, width, height).ForEachRow([width, &value](size_t, T* row) { FillRow(row, width, value); });
 	}
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "ImageHelper.h"
+#include "ImageIO.h"
 #include "Exception.h"
 #include <wrl.h>
 
@@ -68,40 +69,9 @@ namespace Dash
 
 	FORCEINLINE void SavePPMImage(const FTexture* image, const std::string& name)
 	{
-		std::ofstream output;
-		output.open(name, std::ios::binary);
-
-		if (output.fail())
-		{
-			output.close();
-			return;
-		}
-
-		std::size_t imageWidth = image->GetWidth();
-		std::size_t imageHeight = image->GetHeight();
-
-		output << "P6\n" << imageWidth << " " << imageHeight << "\n";
-
-		float maxValue = 255.0f;
-		output << maxValue << "\n";
-
-		for (std::size_t i = 0; i < imageHeight; ++i)
-		{
-			for (std::size_t j = 0; j < imageWidth; ++j)
-			{
-				FColor color;
-
-				GetImageColor(color, FVector2i{ j, i }, image);
-
-				std::uint8_t r = color.r;
-				std::uint8_t g = color.g;
-				std::uint8_t b = color.b;
-
-				output << r << g << b;
-			}
-		}
+		ASSERT(image != nullptr);
 
-		output.close();
+		ExportPPMTexture(name, *image);
 	}
 
 	FORCEINLINE FTexture LoadPPMImage(const std::string& name)
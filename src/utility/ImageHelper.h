@@ -2,6 +2,7 @@
 
 #include "Image.h"
 #include "DDS.h"
+#include <d3d12.h>
 #include <wincodec.h>
 #include <wrl.h>
 
@@ -0,0 +1,2252 @@
+#include "ImageIO.h"
+#include "LogManager.h"
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cctype>
+#include <cstdio>
+#include <future>
+#if defined(__AVX__) || defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace Dash
+{
+	namespace
+	{
+		const uint8_t PNGSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+		// Adam7 passes: x start, y start, x step, y step. Entry 7 covers a non-interlaced image.
+		const uint32_t PNGPasses[8][4] = {
+			{ 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 },
+			{ 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 }, { 0, 0, 1, 1 } };
+
+		constexpr std::size_t PNG_IDAT_SIZE = 64 * 1024;
+
+		constexpr int32_t EXR_MAGIC = 20000630;
+		constexpr uint32_t EXR_ZIP_LINES = 16;
+
+		enum EEXRCompression : uint8_t
+		{
+			EXR_COMPRESSION_NONE = 0,
+			EXR_COMPRESSION_RLE = 1,
+			EXR_COMPRESSION_ZIPS = 2,
+			EXR_COMPRESSION_ZIP = 3,
+		};
+
+		enum EEXRPixelType : int32_t
+		{
+			EXR_PIXEL_UINT = 0,
+			EXR_PIXEL_HALF = 1,
+			EXR_PIXEL_FLOAT = 2,
+		};
+
+		uint32_t ReadBE32(const uint8_t* data)
+		{
+			return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | uint32_t(data[3]);
+		}
+
+		void WriteBE32(uint8_t* data, uint32_t value)
+		{
+			data[0] = uint8_t(value >> 24);
+			data[1] = uint8_t(value >> 16);
+			data[2] = uint8_t(value >> 8);
+			data[3] = uint8_t(value);
+		}
+
+		uint32_t ReadLE32(const uint8_t* data)
+		{
+			return uint32_t(data[0]) | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+		}
+
+		void WriteLE32(std::vector<uint8_t>& data, uint32_t value)
+		{
+			for (int i = 0; i < 4; ++i)
+			{
+				data.push_back(uint8_t(value >> (i * 8)));
+			}
+		}
+
+		void WriteLE64(uint8_t* data, uint64_t value)
+		{
+			for (int i = 0; i < 8; ++i)
+			{
+				data[i] = uint8_t(value >> (i * 8));
+			}
+		}
+
+		bool IsLittleEndianHost()
+		{
+			const uint16_t probe = 1;
+			uint8_t firstByte = 0;
+			std::memcpy(&firstByte, &probe, 1);
+			return firstByte == 1;
+		}
+
+		void SwapBytes16(uint8_t* data, std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; ++i, data += 2)
+			{
+				std::swap(data[0], data[1]);
+			}
+		}
+
+		void SwapBytes32(uint8_t* data, std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; ++i, data += 4)
+			{
+				std::swap(data[0], data[3]);
+				std::swap(data[1], data[2]);
+			}
+		}
+
+		float ReadFloatLE(const uint8_t* data)
+		{
+			uint32_t bits = ReadLE32(data);
+			float value;
+			std::memcpy(&value, &bits, sizeof(float));
+			return value;
+		}
+
+		uint8_t UnitToByte(float value)
+		{
+			return static_cast<uint8_t>(FMath::Clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+		}
+
+		const uint8_t* GetTextureRow(const FTexture& texture, std::size_t y)
+		{
+			ASSERT(texture.GetLayout() == ETextureLayout::Linear);
+			return texture.GetRawData() + y * texture.GetRowPitch();
+		}
+
+		uint8_t* GetTextureRow(FTexture& texture, std::size_t y)
+		{
+			ASSERT(texture.GetLayout() == ETextureLayout::Linear);
+			return texture.GetRawData() + y * texture.GetRowPitch();
+		}
+
+		std::string GetLowerExtension(const std::string& fileName)
+		{
+			std::size_t dot = fileName.find_last_of('.');
+			if (dot == std::string::npos)
+			{
+				return std::string{};
+			}
+
+			std::string extension = fileName.substr(dot + 1);
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return extension;
+		}
+
+		/** Reads the next whitespace separated token of a PNM / PFM header, skipping comments. */
+		bool ReadHeaderToken(std::istream& input, std::string& token)
+		{
+			token.clear();
+
+			int c = input.get();
+			while (c != EOF)
+			{
+				if (c == '#')
+				{
+					while (c != EOF && c != '\n')
+					{
+						c = input.get();
+					}
+				}
+				else if (!std::isspace(c))
+				{
+					break;
+				}
+				c = input.get();
+			}
+
+			while (c != EOF && !std::isspace(c))
+			{
+				token.push_back(static_cast<char>(c));
+				c = input.get();
+			}
+
+			// the single whitespace after the last token has been consumed, binary data follows
+			return !token.empty();
+		}
+
+		bool ParseSize(const std::string& token, std::size_t& value)
+		{
+			char* end = nullptr;
+			unsigned long long parsed = std::strtoull(token.c_str(), &end, 10);
+			if (end == token.c_str() || *end != '\0' || parsed == 0 || parsed > 0x7FFFFFFF)
+			{
+				return false;
+			}
+
+			value = static_cast<std::size_t>(parsed);
+			return true;
+		}
+	}
+
+	// -- PNG -- //
+
+	FPNGDecoder::FPNGDecoder(std::istream& input)
+		: mInput(input)
+		, mBitDepth(0)
+		, mColorType(0)
+		, mInterlace(0)
+		, mChannels(0)
+		, mFilterStride(0)
+		, mTransparentKey{ 0, 0, 0 }
+		, mHasTransparentKey(false)
+		, mChunkType{ 0, 0, 0, 0 }
+		, mChunkRemaining(0)
+		, mChunkCRC(0)
+		, mPass(0)
+		, mLastPass(0)
+		, mPassWidth(0)
+		, mPassHeight(0)
+		, mPassRow(0)
+		, mRowBytes(0)
+		, mRowFill(0)
+	{
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			mPalette[i][0] = mPalette[i][1] = mPalette[i][2] = 0;
+			mPalette[i][3] = 255;
+		}
+	}
+
+	bool FPNGDecoder::ReadHeader()
+	{
+		uint8_t signature[8];
+		if (!mInput.read(reinterpret_cast<char*>(signature), 8) || std::memcmp(signature, PNGSignature, 8) != 0)
+		{
+			return false;
+		}
+
+		uint8_t header[13];
+		if (!ReadChunkHeader() || std::memcmp(mChunkType, "IHDR", 4) != 0 || mChunkRemaining != 13 ||
+			!ReadChunkData(header, 13) || !EndChunk())
+		{
+			return false;
+		}
+
+		mInfo.Width = ReadBE32(header);
+		mInfo.Height = ReadBE32(header + 4);
+		mBitDepth = header[8];
+		mColorType = header[9];
+		mInterlace = header[12];
+
+		if (mInfo.Width == 0 || mInfo.Height == 0 || mInfo.Width > 0x7FFFFFFF || mInfo.Height > 0x7FFFFFFF ||
+			header[10] != 0 || header[11] != 0 || mInterlace > 1)
+		{
+			return false;
+		}
+
+		switch (mColorType)
+		{
+		case 0:
+			mChannels = 1;
+			if (mBitDepth != 1 && mBitDepth != 2 && mBitDepth != 4 && mBitDepth != 8 && mBitDepth != 16) return false;
+			break;
+		case 3:
+			mChannels = 1;
+			if (mBitDepth != 1 && mBitDepth != 2 && mBitDepth != 4 && mBitDepth != 8) return false;
+			break;
+		case 2:
+		case 4:
+		case 6:
+			mChannels = mColorType == 2 ? 3 : (mColorType == 4 ? 2 : 4);
+			if (mBitDepth != 8 && mBitDepth != 16) return false;
+			break;
+		default:
+			return false;
+		}
+
+		mFilterStride = std::max<std::size_t>(1, mChannels * mBitDepth / 8);
+		mInfo.Format = mBitDepth == 16 ? EDASH_FORMAT::R16G16B16A16_UNORM : EDASH_FORMAT::R8G8B8A8_UNORM;
+
+		// ancillary chunks up to the first IDAT
+		for (;;)
+		{
+			if (!ReadChunkHeader())
+			{
+				return false;
+			}
+
+			if (std::memcmp(mChunkType, "IDAT", 4) == 0)
+			{
+				return true;
+			}
+
+			if (std::memcmp(mChunkType, "PLTE", 4) == 0)
+			{
+				uint32_t count = mChunkRemaining / 3;
+				uint8_t palette[256 * 3];
+				if (mChunkRemaining % 3 != 0 || count > 256 || !ReadChunkData(palette, mChunkRemaining) || !EndChunk())
+				{
+					return false;
+				}
+
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					mPalette[i][0] = palette[i * 3];
+					mPalette[i][1] = palette[i * 3 + 1];
+					mPalette[i][2] = palette[i * 3 + 2];
+				}
+			}
+			else if (std::memcmp(mChunkType, "tRNS", 4) == 0)
+			{
+				uint8_t data[256];
+				uint32_t size = mChunkRemaining;
+				if (size > 256 || !ReadChunkData(data, size) || !EndChunk())
+				{
+					return false;
+				}
+
+				if (mColorType == 3)
+				{
+					for (uint32_t i = 0; i < size; ++i)
+					{
+						mPalette[i][3] = data[i];
+					}
+				}
+				else if ((mColorType == 0 && size >= 2) || (mColorType == 2 && size >= 6))
+				{
+					for (uint32_t i = 0; i < (mColorType == 0 ? 1u : 3u); ++i)
+					{
+						mTransparentKey[i] = static_cast<uint16_t>((data[i * 2] << 8) | data[i * 2 + 1]);
+					}
+					mHasTransparentKey = true;
+				}
+			}
+			else if (std::memcmp(mChunkType, "IEND", 4) == 0)
+			{
+				return false;
+			}
+			else if ((mChunkType[0] & 0x20) == 0)
+			{
+				// unknown critical chunk
+				return false;
+			}
+			else if (!SkipChunk())
+			{
+				return false;
+			}
+		}
+	}
+
+	bool FPNGDecoder::DecodeRows(const RowFunc& onRow)
+	{
+		if (std::memcmp(mChunkType, "IDAT", 4) != 0)
+		{
+			return false;
+		}
+
+		const std::size_t outPixelSize = GetByteSizeForFormat(mInfo.Format);
+		const std::size_t maxRowBytes = (mInfo.Width * mChannels * mBitDepth + 7) / 8;
+
+		mCurrentRow.resize(maxRowBytes + 1);
+		mPreviousRow.resize(maxRowBytes);
+		mExpandedRow.resize(mInfo.Width * outPixelSize);
+		mRowFill = 0;
+
+		if (mInterlace)
+		{
+			mInterlacedImage.assign(mInfo.Width * mInfo.Height * outPixelSize, 0);
+			mLastPass = 6;
+			BeginPass(0);
+		}
+		else
+		{
+			mLastPass = 7;
+			BeginPass(7);
+		}
+
+		bool succeeded = true;
+
+		FInflater::ReadFunc reader = [this](uint8_t* dest, std::size_t size) -> std::size_t
+		{
+			// IDAT data may be split across any number of consecutive chunks
+			while (mChunkRemaining == 0)
+			{
+				if (!EndChunk() || !ReadChunkHeader() || std::memcmp(mChunkType, "IDAT", 4) != 0)
+				{
+					return 0;
+				}
+			}
+
+			std::size_t count = std::min<std::size_t>(size, mChunkRemaining);
+			return ReadChunkData(dest, count) ? count : 0;
+		};
+
+		FInflater::WriteFunc writer = [this, &onRow, &succeeded](const uint8_t* data, std::size_t size)
+		{
+			while (size > 0 && mPass <= mLastPass)
+			{
+				std::size_t count = std::min(size, mRowBytes + 1 - mRowFill);
+				std::memcpy(&mCurrentRow[mRowFill], data, count);
+				mRowFill += count;
+				data += count;
+				size -= count;
+
+				if (mRowFill == mRowBytes + 1)
+				{
+					mRowFill = 0;
+					if (!ProcessScanline(onRow))
+					{
+						succeeded = false;
+						return false;
+					}
+				}
+			}
+			return true;
+		};
+
+		FInflater inflater;
+		bool inflated = inflater.Inflate(reader, writer);
+
+		// trailing chunks after the image data are not needed
+		return inflated && succeeded && mPass > mLastPass;
+	}
+
+	bool FPNGDecoder::ReadChunkHeader()
+	{
+		uint8_t header[8];
+		if (!mInput.read(reinterpret_cast<char*>(header), 8))
+		{
+			return false;
+		}
+
+		mChunkRemaining = ReadBE32(header);
+		std::memcpy(mChunkType, header + 4, 4);
+		mChunkCRC = UpdateCRC32(0, header + 4, 4);
+
+		return mChunkRemaining <= 0x7FFFFFFF;
+	}
+
+	bool FPNGDecoder::ReadChunkData(uint8_t* dest, std::size_t size)
+	{
+		if (size > mChunkRemaining || !mInput.read(reinterpret_cast<char*>(dest), size))
+		{
+			return false;
+		}
+
+		mChunkCRC = UpdateCRC32(mChunkCRC, dest, size);
+		mChunkRemaining -= static_cast<uint32_t>(size);
+		return true;
+	}
+
+	bool FPNGDecoder::EndChunk()
+	{
+		uint8_t crc[4];
+		if (mChunkRemaining != 0 || !mInput.read(reinterpret_cast<char*>(crc), 4))
+		{
+			return false;
+		}
+
+		return ReadBE32(crc) == mChunkCRC;
+	}
+
+	bool FPNGDecoder::SkipChunk()
+	{
+		mInput.ignore(std::streamsize(mChunkRemaining) + 4);
+		mChunkRemaining = 0;
+		return mInput.good();
+	}
+
+	void FPNGDecoder::BeginPass(uint32_t pass)
+	{
+		for (; pass <= mLastPass; ++pass)
+		{
+			const uint32_t* passInfo = PNGPasses[pass];
+			mPassWidth = mInfo.Width > passInfo[0] ? (mInfo.Width - passInfo[0] + passInfo[2] - 1) / passInfo[2] : 0;
+			mPassHeight = mInfo.Height > passInfo[1] ? (mInfo.Height - passInfo[1] + passInfo[3] - 1) / passInfo[3] : 0;
+
+			// empty passes carry no data, not even filter bytes
+			if (mPassWidth > 0 && mPassHeight > 0)
+			{
+				break;
+			}
+		}
+
+		mPass = pass;
+		mPassRow = 0;
+		mRowBytes = (mPassWidth * mChannels * mBitDepth + 7) / 8;
+		std::fill(mPreviousRow.begin(), mPreviousRow.end(), uint8_t(0));
+	}
+
+	bool FPNGDecoder::ProcessScanline(const RowFunc& onRow)
+	{
+		uint8_t* row = &mCurrentRow[1];
+		const uint8_t* previous = mPreviousRow.data();
+		const std::size_t stride = mFilterStride;
+		const std::size_t count = mRowBytes;
+
+		switch (mCurrentRow[0])
+		{
+		case 0:
+			break;
+		case 1:
+			for (std::size_t i = stride; i < count; ++i)
+			{
+				row[i] = uint8_t(row[i] + row[i - stride]);
+			}
+			break;
+		case 2:
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				row[i] = uint8_t(row[i] + previous[i]);
+			}
+			break;
+		case 3:
+			for (std::size_t i = 0; i < std::min(stride, count); ++i)
+			{
+				row[i] = uint8_t(row[i] + (previous[i] >> 1));
+			}
+			for (std::size_t i = stride; i < count; ++i)
+			{
+				row[i] = uint8_t(row[i] + ((uint32_t(row[i - stride]) + previous[i]) >> 1));
+			}
+			break;
+		case 4:
+			for (std::size_t i = 0; i < std::min(stride, count); ++i)
+			{
+				row[i] = uint8_t(row[i] + previous[i]);
+			}
+			for (std::size_t i = stride; i < count; ++i)
+			{
+				int32_t a = row[i - stride];
+				int32_t b = previous[i];
+				int32_t c = previous[i - stride];
+				int32_t pa = std::abs(b - c);
+				int32_t pb = std::abs(a - c);
+				int32_t pc = std::abs(a + b - 2 * c);
+				int32_t predictor = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+				row[i] = uint8_t(row[i] + predictor);
+			}
+			break;
+		default:
+			return false;
+		}
+
+		ExpandScanline(row, mPassWidth, mExpandedRow.data());
+		std::memcpy(mPreviousRow.data(), row, count);
+
+		if (mPass == 7)
+		{
+			if (!onRow(mPassRow, mExpandedRow.data()))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			const uint32_t* passInfo = PNGPasses[mPass];
+			const std::size_t pixelSize = GetByteSizeForFormat(mInfo.Format);
+			uint8_t* dest = &mInterlacedImage[((passInfo[1] + mPassRow * passInfo[3]) * mInfo.Width + passInfo[0]) * pixelSize];
+
+			for (std::size_t x = 0; x < mPassWidth; ++x)
+			{
+				std::memcpy(dest + x * passInfo[2] * pixelSize, &mExpandedRow[x * pixelSize], pixelSize);
+			}
+		}
+
+		if (++mPassRow == mPassHeight)
+		{
+			BeginPass(mPass + 1);
+
+			if (mPass > mLastPass && mInterlace)
+			{
+				const std::size_t rowSize = mInfo.Width * GetByteSizeForFormat(mInfo.Format);
+				for (std::size_t y = 0; y < mInfo.Height; ++y)
+				{
+					if (!onRow(y, &mInterlacedImage[y * rowSize]))
+					{
+						return false;
+					}
+				}
+			}
+		}
+
+		return true;
+	}
+
+	void FPNGDecoder::ExpandScanline(const uint8_t* src, std::size_t width, uint8_t* dest) const
+	{
+		if (mBitDepth == 16)
+		{
+			uint16_t* dest16 = reinterpret_cast<uint16_t*>(dest);
+			auto sample = [src](std::size_t index) { return static_cast<uint16_t>((src[index * 2] << 8) | src[index * 2 + 1]); };
+
+			for (std::size_t x = 0; x < width; ++x, dest16 += 4)
+			{
+				switch (mColorType)
+				{
+				case 0:
+					dest16[0] = dest16[1] = dest16[2] = sample(x);
+					dest16[3] = (mHasTransparentKey && sample(x) == mTransparentKey[0]) ? 0 : 0xFFFF;
+					break;
+				case 2:
+					dest16[0] = sample(x * 3);
+					dest16[1] = sample(x * 3 + 1);
+					dest16[2] = sample(x * 3 + 2);
+					dest16[3] = (mHasTransparentKey && dest16[0] == mTransparentKey[0] && dest16[1] == mTransparentKey[1] && dest16[2] == mTransparentKey[2]) ? 0 : 0xFFFF;
+					break;
+				case 4:
+					dest16[0] = dest16[1] = dest16[2] = sample(x * 2);
+					dest16[3] = sample(x * 2 + 1);
+					break;
+				default:
+					dest16[0] = sample(x * 4);
+					dest16[1] = sample(x * 4 + 1);
+					dest16[2] = sample(x * 4 + 2);
+					dest16[3] = sample(x * 4 + 3);
+					break;
+				}
+			}
+			return;
+		}
+
+		if (mBitDepth < 8)
+		{
+			// packed gray or palette indices, most significant bits first
+			const uint32_t mask = (1u << mBitDepth) - 1;
+			const uint32_t scale = 255 / mask;
+
+			for (std::size_t x = 0; x < width; ++x, dest += 4)
+			{
+				std::size_t bit = x * mBitDepth;
+				uint32_t value = (src[bit >> 3] >> (8 - mBitDepth - (bit & 7))) & mask;
+
+				if (mColorType == 3)
+				{
+					std::memcpy(dest, mPalette[value], 4);
+				}
+				else
+				{
+					dest[0] = dest[1] = dest[2] = uint8_t(value * scale);
+					dest[3] = (mHasTransparentKey && value == mTransparentKey[0]) ? 0 : 255;
+				}
+			}
+			return;
+		}
+
+		switch (mColorType)
+		{
+		case 0:
+			for (std::size_t x = 0; x < width; ++x, dest += 4)
+			{
+				dest[0] = dest[1] = dest[2] = src[x];
+				dest[3] = (mHasTransparentKey && src[x] == mTransparentKey[0]) ? 0 : 255;
+			}
+			break;
+		case 2:
+			for (std::size_t x = 0; x < width; ++x, dest += 4, src += 3)
+			{
+				dest[0] = src[0];
+				dest[1] = src[1];
+				dest[2] = src[2];
+				dest[3] = (mHasTransparentKey && src[0] == mTransparentKey[0] && src[1] == mTransparentKey[1] && src[2] == mTransparentKey[2]) ? 0 : 255;
+			}
+			break;
+		case 3:
+			for (std::size_t x = 0; x < width; ++x, dest += 4)
+			{
+				std::memcpy(dest, mPalette[src[x]], 4);
+			}
+			break;
+		case 4:
+			for (std::size_t x = 0; x < width; ++x, dest += 4, src += 2)
+			{
+				dest[0] = dest[1] = dest[2] = src[0];
+				dest[3] = src[1];
+			}
+			break;
+		default:
+			std::memcpy(dest, src, width * 4);
+			break;
+		}
+	}
+
+	FPNGEncoder::FPNGEncoder(std::ostream& output, int compressionLevel)
+		: mOutput(output)
+		, mCompressionLevel(compressionLevel)
+		, mHeight(0)
+		, mRowBytes(0)
+		, mFilterStride(0)
+		, mBitDepth(0)
+		, mRowsWritten(0)
+	{
+	}
+
+	bool FPNGEncoder::Begin(std::size_t width, std::size_t height, uint32_t channels, uint32_t bitDepth)
+	{
+		static const uint8_t ColorTypes[5] = { 0, 0, 4, 2, 6 };
+
+		if (width == 0 || height == 0 || width > 0x7FFFFFFF || height > 0x7FFFFFFF ||
+			channels < 1 || channels > 4 || (bitDepth != 8 && bitDepth != 16))
+		{
+			return false;
+		}
+
+		mHeight = height;
+		mBitDepth = bitDepth;
+		mFilterStride = channels * bitDepth / 8;
+		mRowBytes = width * mFilterStride;
+		mRowsWritten = 0;
+
+		mCurrentRow.resize(mRowBytes);
+		mPreviousRow.assign(mRowBytes, 0);
+		mFilteredRows.resize((mRowBytes + 1) * 5);
+		mIDAT.clear();
+		mIDAT.reserve(PNG_IDAT_SIZE);
+
+		uint8_t header[13];
+		WriteBE32(header, static_cast<uint32_t>(width));
+		WriteBE32(header + 4, static_cast<uint32_t>(height));
+		header[8] = static_cast<uint8_t>(bitDepth);
+		header[9] = ColorTypes[channels];
+		header[10] = 0;
+		header[11] = 0;
+		header[12] = 0;
+
+		mOutput.write(reinterpret_cast<const char*>(PNGSignature), 8);
+		if (!WriteChunk("IHDR", header, 13))
+		{
+			return false;
+		}
+
+		mDeflater = std::make_unique<FDeflater>([this](const uint8_t* data, std::size_t size)
+			{
+				mIDAT.insert(mIDAT.end(), data, data + size);
+				return FlushIDAT(false);
+			}, mCompressionLevel);
+
+		return true;
+	}
+
+	bool FPNGEncoder::WriteRow(const uint8_t* row)
+	{
+		if (mDeflater == nullptr || mRowsWritten >= mHeight)
+		{
+			return false;
+		}
+
+		std::memcpy(mCurrentRow.data(), row, mRowBytes);
+		if (mBitDepth == 16 && IsLittleEndianHost())
+		{
+			SwapBytes16(mCurrentRow.data(), mRowBytes / 2);
+		}
+
+		const uint8_t* current = mCurrentRow.data();
+		const uint8_t* previous = mPreviousRow.data();
+		const std::size_t stride = mFilterStride;
+
+		// all five filters, the one with the smallest sum of absolute signed residuals wins
+		uint64_t bestCost = ~0ull;
+		uint32_t bestFilter = 0;
+		const uint32_t filterCount = mCompressionLevel == 0 ? 1 : 5;
+
+		for (uint32_t filter = 0; filter < filterCount; ++filter)
+		{
+			uint8_t* dest = &mFilteredRows[filter * (mRowBytes + 1)];
+			dest[0] = static_cast<uint8_t>(filter);
+			++dest;
+
+			uint64_t cost = 0;
+			for (std::size_t i = 0; i < mRowBytes; ++i)
+			{
+				uint32_t a = i >= stride ? current[i - stride] : 0;
+				uint32_t b = previous[i];
+				uint32_t c = i >= stride ? previous[i - stride] : 0;
+
+				uint32_t predictor = 0;
+				switch (filter)
+				{
+				case 1: predictor = a; break;
+				case 2: predictor = b; break;
+				case 3: predictor = (a + b) >> 1; break;
+				case 4:
+				{
+					int32_t pa = std::abs(int32_t(b) - int32_t(c));
+					int32_t pb = std::abs(int32_t(a) - int32_t(c));
+					int32_t pc = std::abs(int32_t(a) + int32_t(b) - 2 * int32_t(c));
+					predictor = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+					break;
+				}
+				default: break;
+				}
+
+				uint8_t residual = static_cast<uint8_t>(current[i] - predictor);
+				dest[i] = residual;
+				cost += static_cast<uint64_t>(std::abs(static_cast<int8_t>(residual)));
+			}
+
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestFilter = filter;
+			}
+		}
+
+		std::swap(mCurrentRow, mPreviousRow);
+		++mRowsWritten;
+
+		return mDeflater->Write(&mFilteredRows[bestFilter * (mRowBytes + 1)], mRowBytes + 1);
+	}
+
+	bool FPNGEncoder::End()
+	{
+		if (mDeflater == nullptr || mRowsWritten != mHeight)
+		{
+			return false;
+		}
+
+		bool succeeded = mDeflater->Finish() && FlushIDAT(true) && WriteChunk("IEND", nullptr, 0);
+		mDeflater.reset();
+
+		return succeeded && mOutput.good();
+	}
+
+	bool FPNGEncoder::WriteChunk(const char* type, const uint8_t* data, std::size_t size)
+	{
+		uint8_t header[8];
+		WriteBE32(header, static_cast<uint32_t>(size));
+		std::memcpy(header + 4, type, 4);
+
+		uint8_t crc[4];
+		WriteBE32(crc, UpdateCRC32(UpdateCRC32(0, header + 4, 4), data, size));
+
+		mOutput.write(reinterpret_cast<const char*>(header), 8);
+		if (size > 0)
+		{
+			mOutput.write(reinterpret_cast<const char*>(data), size);
+		}
+		mOutput.write(reinterpret_cast<const char*>(crc), 4);
+
+		return mOutput.good();
+	}
+
+	bool FPNGEncoder::FlushIDAT(bool force)
+	{
+		if (mIDAT.empty() || (!force && mIDAT.size() < PNG_IDAT_SIZE))
+		{
+			return true;
+		}
+
+		bool succeeded = WriteChunk("IDAT", mIDAT.data(), mIDAT.size());
+		mIDAT.clear();
+		return succeeded;
+	}
+
+	FTexture LoadPNGTexture(const std::string& fileName)
+	{
+		std::ifstream input(fileName, std::ios::binary);
+		if (!input)
+		{
+			LOG_ERROR << "Can't open image file " << fileName.c_str();
+			return FTexture{};
+		}
+
+		FPNGDecoder decoder(input);
+		if (!decoder.ReadHeader())
+		{
+			LOG_ERROR << "Invalid or unsupported PNG file " << fileName.c_str();
+			return FTexture{};
+		}
+
+		const FImageInfo& info = decoder.GetInfo();
+		FTexture texture(info.Width, info.Height, info.Format);
+		const std::size_t rowSize = info.Width * GetByteSizeForFormat(info.Format);
+
+		bool succeeded = decoder.DecodeRows([&texture, rowSize](std::size_t y, const uint8_t* row)
+			{
+				std::memcpy(GetTextureRow(texture, y), row, rowSize);
+				return true;
+			});
+
+		if (!succeeded)
+		{
+			LOG_ERROR << "Corrupted PNG file " << fileName.c_str();
+			return FTexture{};
+		}
+
+		return texture;
+	}
+
+	bool ExportPNGTexture(const std::string& fileName, const FTexture& texture, int compressionLevel)
+	{
+		if (texture.GetLayout() != ETextureLayout::Linear)
+		{
+			return ExportPNGTexture(fileName, texture.ConvertLayout(ETextureLayout::Linear), compressionLevel);
+		}
+
+		const std::size_t width = texture.GetWidth();
+		const std::size_t height = texture.GetHeight();
+
+		uint32_t channels = 4;
+		uint32_t bitDepth = 8;
+
+		switch (texture.GetFormat())
+		{
+		case EDASH_FORMAT::R8_UNORM:
+		case EDASH_FORMAT::A8_UNORM:
+		case EDASH_FORMAT::R32_FLOAT:
+			channels = 1;
+			break;
+		case EDASH_FORMAT::R16_UNORM:
+			channels = 1;
+			bitDepth = 16;
+			break;
+		case EDASH_FORMAT::R16G16B16A16_UNORM:
+			bitDepth = 16;
+			break;
+		case EDASH_FORMAT::R32G32B32_FLOAT:
+			channels = 3;
+			break;
+		case EDASH_FORMAT::R8G8B8A8_UNORM:
+		case EDASH_FORMAT::R8G8B8A8_UINT:
+		case EDASH_FORMAT::B8G8R8A8_UNORM:
+		case EDASH_FORMAT::B8G8R8X8_UNORM:
+		case EDASH_FORMAT::R32G32B32A32_FLOAT:
+			break;
+		default:
+			LOG_ERROR << "PNG export doesn't support the texture format " << static_cast<uint32_t>(texture.GetFormat());
+			return false;
+		}
+
+		std::ofstream output(fileName, std::ios::binary);
+		if (!output)
+		{
+			LOG_ERROR << "Can't create image file " << fileName.c_str();
+			return false;
+		}
+
+		FPNGEncoder encoder(output, compressionLevel);
+		if (!encoder.Begin(width, height, channels, bitDepth))
+		{
+			return false;
+		}
+
+		std::vector<uint8_t> scratch(width * channels);
+
+		for (std::size_t y = 0; y < height; ++y)
+		{
+			const uint8_t* row = GetTextureRow(texture, y);
+
+			switch (texture.GetFormat())
+			{
+			case EDASH_FORMAT::B8G8R8A8_UNORM:
+			case EDASH_FORMAT::B8G8R8X8_UNORM:
+			{
+				const bool opaque = texture.GetFormat() == EDASH_FORMAT::B8G8R8X8_UNORM;
+				for (std::size_t x = 0; x < width; ++x)
+				{
+					scratch[x * 4] = row[x * 4 + 2];
+					scratch[x * 4 + 1] = row[x * 4 + 1];
+					scratch[x * 4 + 2] = row[x * 4];
+					scratch[x * 4 + 3] = opaque ? 255 : row[x * 4 + 3];
+				}
+				row = scratch.data();
+				break;
+			}
+			case EDASH_FORMAT::R32_FLOAT:
+			case EDASH_FORMAT::R32G32B32_FLOAT:
+			case EDASH_FORMAT::R32G32B32A32_FLOAT:
+			{
+				// linear float color is stored as 8 bit sRGB, alpha stays linear
+				const float* src = reinterpret_cast<const float*>(row);
+				QuantizeLinearToUNorm8(src, width * channels, scratch.data(), true);
+				for (std::size_t x = 0; channels == 4 && x < width; ++x)
+				{
+					scratch[x * 4 + 3] = UnitToByte(src[x * 4 + 3]);
+				}
+				row = scratch.data();
+				break;
+			}
+			default:
+				break;
+			}
+
+			if (!encoder.WriteRow(row))
+			{
+				LOG_ERROR << "Failed to write image file " << fileName.c_str();
+				return false;
+			}
+		}
+
+		if (!encoder.End())
+		{
+			LOG_ERROR << "Failed to write image file " << fileName.c_str();
+			return false;
+		}
+
+		return true;
+	}
+
+	// -- PPM -- //
+
+	FTexture LoadPPMTexture(const std::string& fileName)
+	{
+		std::ifstream input(fileName, std::ios::binary);
+		if (!input)
+		{
+			LOG_ERROR << "Can't open image file " << fileName.c_str();
+			return FTexture{};
+		}
+
+		std::string magic, widthToken, heightToken, maxToken;
+		std::size_t width = 0, height = 0, maxValue = 0;
+
+		if (!ReadHeaderToken(input, magic) || (magic != "P6" && magic != "P5") ||
+			!ReadHeaderToken(input, widthToken) || !ParseSize(widthToken, width) ||
+			!ReadHeaderToken(input, heightToken) || !ParseSize(heightToken, height) ||
+			!ReadHeaderToken(input, maxToken) || !ParseSize(maxToken, maxValue) || maxValue > 65535)
+		{
+			LOG_ERROR << "Invalid or unsupported PPM file " << fileName.c_str();
+			return FTexture{};
+		}
+
+		const bool color = magic == "P6";
+		const bool wide = maxValue > 255;
+		const std::size_t channels = color ? 3 : 1;
+		const std::size_t sampleSize = wide ? 2 : 1;
+		const uint32_t fullScale = wide ? 65535 : 255;
+
+		EDASH_FORMAT format = color ? (wide ? EDASH_FORMAT::R16G16B16A16_UNORM : EDASH_FORMAT::R8G8B8A8_UNORM)
+			: (wide ? EDASH_FORMAT::R16_UNORM : EDASH_FORMAT::R8_UNORM);
+
+		FTexture texture(width, height, format);
+		const std::size_t fileRowSize = width * channels * sampleSize;
+
+		for (std::size_t y = 0; y < height; ++y)
+		{
+			// read straight into the texture row, then widen to RGBA in place from the back
+			uint8_t* row = GetTextureRow(texture, y);
+			if (!input.read(reinterpret_cast<char*>(row), fileRowSize))
+			{
+				LOG_ERROR << "Truncated PPM file " << fileName.c_str();
+				return FTexture{};
+			}
+
+			if (wide)
+			{
+				if (IsLittleEndianHost())
+				{
+					SwapBytes16(row, width * channels);
+				}
+
+				uint16_t* samples = reinterpret_cast<uint16_t*>(row);
+				if (maxValue != fullScale)
+				{
+					for (std::size_t i = 0; i < width * channels; ++i)
+					{
+						samples[i] = static_cast<uint16_t>((FMath::Min<std::size_t>(samples[i], maxValue) * fullScale + maxValue / 2) / maxValue);
+					}
+				}
+
+				if (color)
+				{
+					for (std::size_t x = width; x-- > 0;)
+					{
+						uint16_t r = samples[x * 3], g = samples[x * 3 + 1], b = samples[x * 3 + 2];
+						samples[x * 4] = r;
+						samples[x * 4 + 1] = g;
+						samples[x * 4 + 2] = b;
+						samples[x * 4 + 3] = 0xFFFF;
+					}
+				}
+			}
+			else
+			{
+				if (maxValue != fullScale)
+				{
+					for (std::size_t i = 0; i < width * channels; ++i)
+					{
+						row[i] = static_cast<uint8_t>((FMath::Min<std::size_t>(row[i], maxValue) * fullScale + maxValue / 2) / maxValue);
+					}
+				}
+
+				if (color)
+				{
+					for (std::size_t x = width; x-- > 0;)
+					{
+						uint8_t r = row[x * 3], g = row[x * 3 + 1], b = row[x * 3 + 2];
+						row[x * 4] = r;
+						row[x * 4 + 1] = g;
+						row[x * 4 + 2] = b;
+						row[x * 4 + 3] = 255;
+					}
+				}
+			}
+		}
+
+		return texture;
+	}
+
+	namespace
+	{
+		// images above this size are converted and written in chunks on a background thread
+		constexpr std::size_t PPM_ASYNC_THRESHOLD = 16 * 1024 * 1024;
+		constexpr std::size_t PPM_CHUNK_SIZE = 4 * 1024 * 1024;
+
+		/** Drops the fourth byte of every pixel, optionally swapping the first and third. */
+		void PackRGBA8ToRGB8(const uint8_t* src, std::size_t width, bool swapRedBlue, uint8_t* dest)
+		{
+			std::size_t x = 0;
+
+#if defined(__AVX__) || defined(__SSSE3__)
+			const __m128i shuffle = swapRedBlue
+				? _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)
+				: _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+			// 16 bytes are stored for 12 bytes of output, the tail is overwritten by the next iteration and the
+			// loop stops while 6 pixels remain so the last store stays inside the row
+			for (; x + 6 <= width; x += 4)
+			{
+				__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + x * 3), _mm_shuffle_epi8(pixels, shuffle));
+			}
+#endif
+
+			for (; x < width; ++x)
+			{
+				dest[x * 3] = src[x * 4 + (swapRedBlue ? 2 : 0)];
+				dest[x * 3 + 1] = src[x * 4 + 1];
+				dest[x * 3 + 2] = src[x * 4 + (swapRedBlue ? 0 : 2)];
+			}
+		}
+
+		/** Converts one source row to the PPM sample layout, scratch holds at least width * 4 bytes. */
+		void ConvertPPMRow(const uint8_t* src, std::size_t width, EDASH_FORMAT format, bool bSRGB, uint8_t* scratch, uint8_t* dest)
+		{
+			const float* floats = reinterpret_cast<const float*>(src);
+
+			switch (format)
+			{
+			case EDASH_FORMAT::R8_UNORM:
+			case EDASH_FORMAT::A8_UNORM:
+				std::memcpy(dest, src, width);
+				break;
+			case EDASH_FORMAT::R32_FLOAT:
+			case EDASH_FORMAT::R32G32B32_FLOAT:
+				QuantizeLinearToUNorm8(floats, width * (format == EDASH_FORMAT::R32_FLOAT ? 1 : 3), dest, bSRGB);
+				break;
+			case EDASH_FORMAT::R32G32_FLOAT:
+				QuantizeLinearToUNorm8(floats, width * 2, scratch, bSRGB);
+				for (std::size_t x = 0; x < width; ++x)
+				{
+					dest[x * 3] = scratch[x * 2];
+					dest[x * 3 + 1] = scratch[x * 2 + 1];
+					dest[x * 3 + 2] = 0;
+				}
+				break;
+			case EDASH_FORMAT::R32G32B32A32_FLOAT:
+				QuantizeLinearToUNorm8(floats, width * 4, scratch, bSRGB);
+				PackRGBA8ToRGB8(scratch, width, false, dest);
+				break;
+			case EDASH_FORMAT::B8G8R8A8_UNORM:
+			case EDASH_FORMAT::B8G8R8X8_UNORM:
+				PackRGBA8ToRGB8(src, width, true, dest);
+				break;
+			case EDASH_FORMAT::R16_UNORM:
+				for (std::size_t x = 0; x < width; ++x)
+				{
+					dest[x * 2] = src[x * 2 + 1];
+					dest[x * 2 + 1] = src[x * 2];
+				}
+				break;
+			case EDASH_FORMAT::R16G16B16A16_UNORM:
+				for (std::size_t x = 0; x < width; ++x)
+				{
+					for (std::size_t c = 0; c < 3; ++c)
+					{
+						dest[x * 6 + c * 2] = src[x * 8 + c * 2 + 1];
+						dest[x * 6 + c * 2 + 1] = src[x * 8 + c * 2];
+					}
+				}
+				break;
+			default:
+				PackRGBA8ToRGB8(src, width, false, dest);
+				break;
+			}
+		}
+	}
+
+	bool ExportPPMImage(const std::string& fileName, const uint8_t* data, std::size_t width, std::size_t height, std::size_t rowPitch, EDASH_FORMAT format, bool bSRGB)
+	{
+		bool color = true;
+		bool wide = false;
+
+		switch (format)
+		{
+		case EDASH_FORMAT::R8_UNORM:
+		case EDASH_FORMAT::A8_UNORM:
+		case EDASH_FORMAT::R32_FLOAT:
+			color = false;
+			break;
+		case EDASH_FORMAT::R16_UNORM:
+			color = false;
+			wide = true;
+			break;
+		case EDASH_FORMAT::R16G16B16A16_UNORM:
+			wide = true;
+			break;
+		case EDASH_FORMAT::R8G8B8A8_UNORM:
+		case EDASH_FORMAT::R8G8B8A8_UINT:
+		case EDASH_FORMAT::B8G8R8A8_UNORM:
+		case EDASH_FORMAT::B8G8R8X8_UNORM:
+		case EDASH_FORMAT::R32G32_FLOAT:
+		case EDASH_FORMAT::R32G32B32_FLOAT:
+		case EDASH_FORMAT::R32G32B32A32_FLOAT:
+			break;
+		default:
+			LOG_ERROR << "PPM export doesn't support the texture format " << static_cast<uint32_t>(format);
+			return false;
+		}
+
+		std::ofstream output(fileName, std::ios::binary);
+		if (!output)
+		{
+			LOG_ERROR << "Can't create image file " << fileName.c_str();
+			return false;
+		}
+
+		output << (color ? "P6\n" : "P5\n") << width << " " << height << "\n" << (wide ? 65535 : 255) << "\n";
+
+		const std::size_t fileRowSize = width * (color ? 3 : 1) * (wide ? 2 : 1);
+		const std::size_t fileSize = fileRowSize * height;
+		std::vector<uint8_t> scratch(width * 4);
+
+		bool succeeded = true;
+		if (fileSize <= PPM_ASYNC_THRESHOLD)
+		{
+			std::vector<uint8_t> buffer(fileSize);
+			for (std::size_t y = 0; y < height; ++y)
+			{
+				ConvertPPMRow(data + y * rowPitch, width, format, bSRGB, scratch.data(), &buffer[y * fileRowSize]);
+			}
+
+			output.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+			succeeded = output.good();
+		}
+		else
+		{
+			// double buffered: the next chunk is converted while the previous one is written
+			const std::size_t rowsPerChunk = FMath::Max<std::size_t>(1, PPM_CHUNK_SIZE / fileRowSize);
+			std::vector<uint8_t> buffers[2];
+			std::future<bool> pendingWrite;
+
+			for (std::size_t firstRow = 0, index = 0; firstRow < height && succeeded; firstRow += rowsPerChunk, index ^= 1)
+			{
+				const std::size_t rowCount = FMath::Min(rowsPerChunk, height - firstRow);
+				std::vector<uint8_t>& buffer = buffers[index];
+				buffer.resize(rowCount * fileRowSize);
+
+				for (std::size_t y = 0; y < rowCount; ++y)
+				{
+					ConvertPPMRow(data + (firstRow + y) * rowPitch, width, format, bSRGB, scratch.data(), &buffer[y * fileRowSize]);
+				}
+
+				if (pendingWrite.valid())
+				{
+					succeeded = pendingWrite.get();
+				}
+
+				pendingWrite = std::async(std::launch::async, [&output, &buffer]()
+					{
+						output.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+						return output.good();
+					});
+			}
+
+			if (pendingWrite.valid())
+			{
+				succeeded = pendingWrite.get() && succeeded;
+			}
+		}
+
+		if (!succeeded)
+		{
+			LOG_ERROR << "Failed to write image file " << fileName.c_str();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool ExportPPMTexture(const std::string& fileName, const FTexture& texture, bool bSRGB)
+	{
+		if (texture.GetLayout() != ETextureLayout::Linear)
+		{
+			return ExportPPMTexture(fileName, texture.ConvertLayout(ETextureLayout::Linear), bSRGB);
+		}
+
+		return ExportPPMImage(fileName, texture.GetRawData(), texture.GetWidth(), texture.GetHeight(), texture.GetRowPitch(), texture.GetFormat(), bSRGB);
+	}
+
+	// -- PFM -- //
+
+	FTexture LoadPFMTexture(const std::string& fileName)
+	{
+		std::ifstream input(fileName, std::ios::binary);
+		if (!input)
+		{
+			LOG_ERROR << "Can't open image file " << fileName.c_str();
+			return FTexture{};
+		}
+
+		std::string magic, widthToken, heightToken, scaleToken;
+		std::size_t width = 0, height = 0;
+
+		if (!ReadHeaderToken(input, magic) || (magic != "PF" && magic != "Pf") ||
+			!ReadHeaderToken(input, widthToken) || !ParseSize(widthToken, width) ||
+			!ReadHeaderToken(input, heightToken) || !ParseSize(heightToken, height) ||
+			!ReadHeaderToken(input, scaleToken))
+		{
+			LOG_ERROR << "Invalid or unsupported PFM file " << fileName.c_str();
+			return FTexture{};
+		}
+
+		// a negative scale marks little endian data
+		const double scale = std::strtod(scaleToken.c_str(), nullptr);
+		const bool swap = (scale < 0.0) != IsLittleEndianHost();
+		const bool color = magic == "PF";
+		const std::size_t channels = color ? 3 : 1;
+
+		FTexture texture(width, height, color ? EDASH_FORMAT::R32G32B32_FLOAT : EDASH_FORMAT::R32_FLOAT);
+
+		// rows are stored bottom to top
+		for (std::size_t y = height; y-- > 0;)
+		{
+			uint8_t* row = GetTextureRow(texture, y);
+			if (!input.read(reinterpret_cast<char*>(row), width * channels * sizeof(float)))
+			{
+				LOG_ERROR << "Truncated PFM file " << fileName.c_str();
+				return FTexture{};
+			}
+
+			if (swap)
+			{
+				SwapBytes32(row, width * channels);
+			}
+		}
+
+		return texture;
+	}
+
+	bool ExportPFMTexture(const std::string& fileName, const FTexture& texture)
+	{
+		if (texture.GetLayout() != ETextureLayout::Linear)
+		{
+			return ExportPFMTexture(fileName, texture.ConvertLayout(ETextureLayout::Linear));
+		}
+
+		const std::size_t width = texture.GetWidth();
+		const std::size_t height = texture.GetHeight();
+		const EDASH_FORMAT format = texture.GetFormat();
+
+		if (format != EDASH_FORMAT::R32_FLOAT && format != EDASH_FORMAT::R32G32B32_FLOAT && format != EDASH_FORMAT::R32G32B32A32_FLOAT)
+		{
+			LOG_ERROR << "PFM export doesn't support the texture format " << static_cast<uint32_t>(format);
+			return false;
+		}
+
+		std::ofstream output(fileName, std::ios::binary);
+		if (!output)
+		{
+			LOG_ERROR << "Can't create image file " << fileName.c_str();
+			return false;
+		}
+
+		const bool color = format != EDASH_FORMAT::R32_FLOAT;
+		output << (color ? "PF\n" : "Pf\n") << width << " " << height << "\n" << (IsLittleEndianHost() ? "-1.0" : "1.0") << "\n";
+
+		std::vector<float> scratch;
+		for (std::size_t y = height; y-- > 0;)
+		{
+			const float* row = reinterpret_cast<const float*>(GetTextureRow(texture, y));
+
+			if (format == EDASH_FORMAT::R32G32B32A32_FLOAT)
+			{
+				scratch.resize(width * 3);
+				for (std::size_t x = 0; x < width; ++x)
+				{
+					scratch[x * 3] = row[x * 4];
+					scratch[x * 3 + 1] = row[x * 4 + 1];
+					scratch[x * 3 + 2] = row[x * 4 + 2];
+				}
+				row = scratch.data();
+			}
+
+			output.write(reinterpret_cast<const char*>(row), width * (color ? 3 : 1) * sizeof(float));
+		}
+
+		if (!output.good())
+		{
+			LOG_ERROR << "Failed to write image file " << fileName.c_str();
+			return false;
+		}
+
+		return true;
+	}
+
+	// -- Radiance HDR -- //
+
+	namespace
+	{
+		bool ReadHDRScanline(std::istream& input, uint8_t* scanline, std::size_t width)
+		{
+			uint8_t header[4];
+			if (!input.read(reinterpret_cast<char*>(header), 4))
+			{
+				return false;
+			}
+
+			const bool runLength = width >= 8 && width <= 0x7FFF && header[0] == 2 && header[1] == 2 && (header[2] & 0x80) == 0;
+			if (!runLength)
+			{
+				// flat RGBE pixels
+				std::memcpy(scanline, header, 4);
+				return width == 1 || static_cast<bool>(input.read(reinterpret_cast<char*>(scanline + 4), (width - 1) * 4));
+			}
+
+			if (((std::size_t(header[2]) << 8) | header[3]) != width)
+			{
+				return false;
+			}
+
+			// each component is run length encoded separately
+			for (std::size_t component = 0; component < 4; ++component)
+			{
+				std::size_t x = 0;
+				while (x < width)
+				{
+					uint8_t code[2];
+					if (!input.read(reinterpret_cast<char*>(code), 1))
+					{
+						return false;
+					}
+
+					if (code[0] > 128)
+					{
+						std::size_t run = code[0] - 128;
+						if (x + run > width || !input.read(reinterpret_cast<char*>(code + 1), 1))
+						{
+							return false;
+						}
+
+						for (std::size_t i = 0; i < run; ++i)
+						{
+							scanline[(x++) * 4 + component] = code[1];
+						}
+					}
+					else
+					{
+						std::size_t count = code[0];
+						uint8_t literal[128];
+						if (count == 0 || x + count > width || !input.read(reinterpret_cast<char*>(literal), count))
+						{
+							return false;
+						}
+
+						for (std::size_t i = 0; i < count; ++i)
+						{
+							scanline[(x++) * 4 + component] = literal[i];
+						}
+					}
+				}
+			}
+
+			return true;
+		}
+
+		void WriteHDRComponent(std::vector<uint8_t>& output, const uint8_t* data, std::size_t width)
+		{
+			constexpr std::size_t MinRun = 4;
+
+			std::size_t x = 0;
+			while (x < width)
+			{
+				std::size_t run = 1;
+				while (x + run < width && run < 127 && data[x + run] == data[x])
+				{
+					++run;
+				}
+
+				if (run >= MinRun)
+				{
+					output.push_back(static_cast<uint8_t>(128 + run));
+					output.push_back(data[x]);
+					x += run;
+					continue;
+				}
+
+				// literal bytes up to the next worthwhile run
+				std::size_t start = x;
+				while (x < width && x - start < 128)
+				{
+					std::size_t ahead = 1;
+					while (x + ahead < width && ahead < MinRun && data[x + ahead] == data[x])
+					{
+						++ahead;
+					}
+
+					if (ahead >= MinRun && x > start)
+					{
+						break;
+					}
+					++x;
+				}
+
+				output.push_back(static_cast<uint8_t>(x - start));
+				output.insert(output.end(), data + start, data + x);
+			}
+		}
+	}
+
+	FTexture LoadHDRTexture(const std::string& fileName)
+	{
+		std::ifstream input(fileName, std::ios::binary);
+		if (!input)
+		{
+			LOG_ERROR << "Can't open image file " << fileName.c_str();
+			return FTexture{};
+		}
+
+		std::string line;
+		if (!std::getline(input, line) || line.compare(0, 2, "#?") != 0)
+		{
+			LOG_ERROR << "Invalid or unsupported HDR file " << fileName.c_str();
+			return FTexture{};
+		}
+
+		bool validFormat = true;
+		while (std::getline(input, line) && !line.empty())
+		{
+			if (line.compare(0, 7, "FORMAT=") == 0)
+			{
+				validFormat = line.compare(7, std::string::npos, "32-bit_rle_rgbe") == 0;
+			}
+		}
+
+		char yAxis[3] = { 0 };
+		char xAxis[3] = { 0 };
+		unsigned long height = 0;
+		unsigned long width = 0;
+
+		if (!validFormat || !std::getline(input, line) ||
+			std::sscanf(line.c_str(), "%2s %lu %2s %lu", yAxis, &height, xAxis, &width) != 4 ||
+			(std::strcmp(yAxis, "-Y") != 0 && std::strcmp(yAxis, "+Y") != 0) || std::strcmp(xAxis, "+X") != 0 ||
+			width == 0 || height == 0 || width > 0x7FFFFFFF || height > 0x7FFFFFFF)
+		{
+			LOG_ERROR << "Invalid or unsupported HDR file " << fileName.c_str();
+			return FTexture{};
+		}
+
+		const bool bottomUp = yAxis[0] == '+';
+
+		FTexture texture(width, height, EDASH_FORMAT::R32G32B32A32_FLOAT);
+		std::vector<uint8_t> scanline(width * 4);
+
+		for (std::size_t y = 0; y < height; ++y)
+		{
+			if (!ReadHDRScanline(input, scanline.data(), width))
+			{
+				LOG_ERROR << "Corrupted HDR file " << fileName.c_str();
+				return FTexture{};
+			}
+
+			float* row = reinterpret_cast<float*>(GetTextureRow(texture, bottomUp ? height - 1 - y : y));
+			for (std::size_t x = 0; x < width; ++x)
+			{
+				const uint8_t* rgbe = &scanline[x * 4];
+
+				// Radiance convention: value = (mantissa + 0.5) * 2^(exponent - 136)
+				float scale = rgbe[3] == 0 ? 0.0f : std::ldexp(1.0f, int32_t(rgbe[3]) - 136);
+				row[x * 4] = rgbe[3] == 0 ? 0.0f : (rgbe[0] + 0.5f) * scale;
+				row[x * 4 + 1] = rgbe[3] == 0 ? 0.0f : (rgbe[1] + 0.5f) * scale;
+				row[x * 4 + 2] = rgbe[3] == 0 ? 0.0f : (rgbe[2] + 0.5f) * scale;
+				row[x * 4 + 3] = 1.0f;
+			}
+		}
+
+		return texture;
+	}
+
+	bool ExportHDRTexture(const std::string& fileName, const FTexture& texture)
+	{
+		if (texture.GetLayout() != ETextureLayout::Linear)
+		{
+			return ExportHDRTexture(fileName, texture.ConvertLayout(ETextureLayout::Linear));
+		}
+
+		const std::size_t width = texture.GetWidth();
+		const std::size_t height = texture.GetHeight();
+		const EDASH_FORMAT format = texture.GetFormat();
+
+		std::size_t stride = 0;
+		switch (format)
+		{
+		case EDASH_FORMAT::R32_FLOAT: stride = 1; break;
+		case EDASH_FORMAT::R32G32B32_FLOAT: stride = 3; break;
+		case EDASH_FORMAT::R32G32B32A32_FLOAT: stride = 4; break;
+		default:
+			LOG_ERROR << "HDR export doesn't support the texture format " << static_cast<uint32_t>(format);
+			return false;
+		}
+
+		std::ofstream output(fileName, std::ios::binary);
+		if (!output)
+		{
+			LOG_ERROR << "Can't create image file " << fileName.c_str();
+			return false;
+		}
+
+		output << "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " << height << " +X " << width << "\n";
+
+		const bool runLength = width >= 8 && width <= 0x7FFF;
+		std::vector<uint8_t> scanline(width * 4);
+		std::vector<uint8_t> planar(width);
+		std::vector<uint8_t> encoded;
+		encoded.reserve(width * 5 + 4);
+
+		for (std::size_t y = 0; y < height; ++y)
+		{
+			const float* row = reinterpret_cast<const float*>(GetTextureRow(texture, y));
+			for (std::size_t x = 0; x < width; ++x)
+			{
+				const float* src = row + x * stride;
+				float r = FMath::Max(src[0], 0.0f);
+				float g = stride == 1 ? r : FMath::Max(src[1], 0.0f);
+				float b = stride == 1 ? r : FMath::Max(src[2], 0.0f);
+				float maxComponent = FMath::Max(r, FMath::Max(g, b));
+
+				uint8_t* rgbe = &scanline[x * 4];
+				if (maxComponent < 1e-32f)
+				{
+					rgbe[0] = rgbe[1] = rgbe[2] = rgbe[3] = 0;
+				}
+				else
+				{
+					int32_t exponent = 0;
+					float scale = std::frexp(maxComponent, &exponent) * 255.9999f / maxComponent;
+					rgbe[0] = static_cast<uint8_t>(r * scale);
+					rgbe[1] = static_cast<uint8_t>(g * scale);
+					rgbe[2] = static_cast<uint8_t>(b * scale);
+					rgbe[3] = static_cast<uint8_t>(exponent + 128);
+				}
+			}
+
+			if (!runLength)
+			{
+				output.write(reinterpret_cast<const char*>(scanline.data()), scanline.size());
+				continue;
+			}
+
+			encoded.clear();
+			encoded.push_back(2);
+			encoded.push_back(2);
+			encoded.push_back(static_cast<uint8_t>(width >> 8));
+			encoded.push_back(static_cast<uint8_t>(width & 0xFF));
+
+			for (std::size_t component = 0; component < 4; ++component)
+			{
+				for (std::size_t x = 0; x < width; ++x)
+				{
+					planar[x] = scanline[x * 4 + component];
+				}
+				WriteHDRComponent(encoded, planar.data(), width);
+			}
+
+			output.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+		}
+
+		if (!output.good())
+		{
+			LOG_ERROR << "Failed to write image file " << fileName.c_str();
+			return false;
+		}
+
+		return true;
+	}
+
+	// -- OpenEXR -- //
+
+	namespace
+	{
+		struct FEXRChannel
+		{
+			std::string Name;
+			int32_t PixelType;
+			int32_t Component;
+		};
+
+		std::size_t GetEXRSampleSize(int32_t pixelType)
+		{
+			return pixelType == EXR_PIXEL_HALF ? 2 : 4;
+		}
+
+		bool ReadEXRString(std::istream& input, std::string& value)
+		{
+			value.clear();
+			for (int c = input.get(); c != 0; c = input.get())
+			{
+				if (c == EOF || value.size() > 255)
+				{
+					return false;
+				}
+				value.push_back(static_cast<char>(c));
+			}
+			return true;
+		}
+
+		/** Undoes the byte delta predictor and splits the two interleaved byte halves used by RLE and ZIP blocks. */
+		void DecodeEXRPredictor(const std::vector<uint8_t>& src, std::vector<uint8_t>& dest)
+		{
+			const std::size_t size = src.size();
+			std::vector<uint8_t> delta(src);
+			for (std::size_t i = 1; i < size; ++i)
+			{
+				delta[i] = static_cast<uint8_t>(delta[i - 1] + delta[i] - 128);
+			}
+
+			dest.resize(size);
+			const std::size_t half = (size + 1) / 2;
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				dest[i] = (i & 1) ? delta[half + i / 2] : delta[i / 2];
+			}
+		}
+
+		void EncodeEXRPredictor(const std::vector<uint8_t>& src, std::vector<uint8_t>& dest)
+		{
+			const std::size_t size = src.size();
+			const std::size_t half = (size + 1) / 2;
+
+			dest.resize(size);
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				dest[(i & 1) ? half + i / 2 : i / 2] = src[i];
+			}
+
+			for (std::size_t i = size; i-- > 1;)
+			{
+				dest[i] = static_cast<uint8_t>(dest[i] - dest[i - 1] + 128);
+			}
+		}
+
+		bool DecodeEXRRunLength(const std::vector<uint8_t>& src, std::vector<uint8_t>& dest, std::size_t expectedSize)
+		{
+			dest.clear();
+			std::size_t pos = 0;
+			while (pos < src.size())
+			{
+				int32_t count = static_cast<int8_t>(src[pos++]);
+				if (count < 0)
+				{
+					std::size_t literal = static_cast<std::size_t>(-count);
+					if (pos + literal > src.size())
+					{
+						return false;
+					}
+					dest.insert(dest.end(), src.begin() + pos, src.begin() + pos + literal);
+					pos += literal;
+				}
+				else
+				{
+					if (pos >= src.size())
+					{
+						return false;
+					}
+					dest.insert(dest.end(), std::size_t(count) + 1, src[pos++]);
+				}
+
+				if (dest.size() > expectedSize)
+				{
+					return false;
+				}
+			}
+
+			return dest.size() == expectedSize;
+		}
+	}
+
+	FTexture LoadEXRTexture(const std::string& fileName)
+	{
+		std::ifstream input(fileName, std::ios::binary);
+		if (!input)
+		{
+			LOG_ERROR << "Can't open image file " << fileName.c_str();
+			return FTexture{};
+		}
+
+		auto fail = [&fileName](const char* reason)
+		{
+			LOG_ERROR << reason << " " << fileName.c_str();
+			return FTexture{};
+		};
+
+		uint8_t preamble[8];
+		if (!input.read(reinterpret_cast<char*>(preamble), 8) || int32_t(ReadLE32(preamble)) != EXR_MAGIC)
+		{
+			return fail("Invalid EXR file");
+		}
+
+		// version 2, no tiles, deep data or multiple parts
+		uint32_t version = ReadLE32(preamble + 4);
+		if ((version & 0xFF) != 2 || (version & (0x200 | 0x800 | 0x1000)) != 0)
+		{
+			return fail("Unsupported EXR file");
+		}
+
+		std::vector<FEXRChannel> channels;
+		int32_t dataWindow[4] = { 0, 0, -1, -1 };
+		uint8_t compression = EXR_COMPRESSION_NONE;
+		bool hasDataWindow = false;
+
+		std::string name, type;
+		std::vector<uint8_t> value;
+		for (;;)
+		{
+			if (!ReadEXRString(input, name))
+			{
+				return fail("Invalid EXR header");
+			}
+
+			if (name.empty())
+			{
+				break;
+			}
+
+			uint8_t sizeBytes[4];
+			if (!ReadEXRString(input, type) || !input.read(reinterpret_cast<char*>(sizeBytes), 4))
+			{
+				return fail("Invalid EXR header");
+			}
+
+			uint32_t size = ReadLE32(sizeBytes);
+			if (size > (1u << 24))
+			{
+				return fail("Invalid EXR header");
+			}
+
+			value.resize(size);
+			if (size > 0 && !input.read(reinterpret_cast<char*>(value.data()), size))
+			{
+				return fail("Invalid EXR header");
+			}
+
+			if (name == "channels" && type == "chlist")
+			{
+				std::size_t pos = 0;
+				while (pos < value.size() && value[pos] != 0)
+				{
+					std::size_t end = pos;
+					while (end < value.size() && value[end] != 0)
+					{
+						++end;
+					}
+
+					if (end + 17 > value.size())
+					{
+						return fail("Invalid EXR channel list");
+					}
+
+					FEXRChannel channel;
+					channel.Name.assign(reinterpret_cast<const char*>(&value[pos]), end - pos);
+					channel.PixelType = int32_t(ReadLE32(&value[end + 1]));
+					int32_t xSampling = int32_t(ReadLE32(&value[end + 9]));
+					int32_t ySampling = int32_t(ReadLE32(&value[end + 13]));
+
+					if (channel.PixelType < EXR_PIXEL_UINT || channel.PixelType > EXR_PIXEL_FLOAT || xSampling != 1 || ySampling != 1)
+					{
+						return fail("Unsupported EXR channel");
+					}
+
+					// layered names like "diffuse.R" are matched by their last component
+					std::size_t dot = channel.Name.find_last_of('.');
+					std::string baseName = dot == std::string::npos ? channel.Name : channel.Name.substr(dot + 1);
+					channel.Component = baseName == "R" ? 0 : baseName == "G" ? 1 : baseName == "B" ? 2 : baseName == "A" ? 3 : baseName == "Y" ? 4 : -1;
+
+					channels.push_back(channel);
+					pos = end + 17;
+				}
+			}
+			else if (name == "compression" && size == 1)
+			{
+				compression = value[0];
+			}
+			else if (name == "dataWindow" && size == 16)
+			{
+				for (int i = 0; i < 4; ++i)
+				{
+					dataWindow[i] = int32_t(ReadLE32(&value[i * 4]));
+				}
+				hasDataWindow = true;
+			}
+		}
+
+		if (!hasDataWindow || channels.empty() || dataWindow[2] < dataWindow[0] || dataWindow[3] < dataWindow[1])
+		{
+			return fail("Invalid EXR header");
+		}
+
+		if (compression > EXR_COMPRESSION_ZIP)
+		{
+			return fail("Unsupported EXR compression");
+		}
+
+		const std::size_t width = std::size_t(int64_t(dataWindow[2]) - dataWindow[0] + 1);
+		const std::size_t height = std::size_t(int64_t(dataWindow[3]) - dataWindow[1] + 1);
+		const std::size_t linesPerBlock = compression == EXR_COMPRESSION_ZIP ? EXR_ZIP_LINES : 1;
+		const std::size_t blockCount = (height + linesPerBlock - 1) / linesPerBlock;
+
+		std::size_t lineSize = 0;
+		for (const FEXRChannel& channel : channels)
+		{
+			lineSize += width * GetEXRSampleSize(channel.PixelType);
+		}
+
+		std::vector<uint8_t> offsetTable(blockCount * 8);
+		if (!input.read(reinterpret_cast<char*>(offsetTable.data()), offsetTable.size()))
+		{
+			return fail("Truncated EXR file");
+		}
+
+		FTexture texture(width, height, EDASH_FORMAT::R32G32B32A32_FLOAT);
+		for (std::size_t y = 0; y < height; ++y)
+		{
+			float* row = reinterpret_cast<float*>(GetTextureRow(texture, y));
+			for (std::size_t x = 0; x < width; ++x)
+			{
+				row[x * 4] = row[x * 4 + 1] = row[x * 4 + 2] = 0.0f;
+				row[x * 4 + 3] = 1.0f;
+			}
+		}
+
+		std::vector<uint8_t> packed;
+		std::vector<uint8_t> unpacked;
+		std::vector<uint8_t> block;
+		std::vector<uint16_t> halfSamples(width);
+		std::vector<float> floatSamples(width);
+
+		for (std::size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+		{
+			uint64_t offset = uint64_t(ReadLE32(&offsetTable[blockIndex * 8])) | (uint64_t(ReadLE32(&offsetTable[blockIndex * 8 + 4])) << 32);
+
+			uint8_t blockHeader[8];
+			input.seekg(std::streamoff(offset));
+			if (!input.read(reinterpret_cast<char*>(blockHeader), 8))
+			{
+				return fail("Truncated EXR file");
+			}
+
+			int64_t firstLine = int64_t(int32_t(ReadLE32(blockHeader))) - dataWindow[1];
+			uint32_t packedSize = ReadLE32(blockHeader + 4);
+			if (firstLine < 0 || std::size_t(firstLine) >= height || packedSize > lineSize * linesPerBlock + 1024)
+			{
+				return fail("Corrupted EXR file");
+			}
+
+			const std::size_t lineCount = std::min(linesPerBlock, height - std::size_t(firstLine));
+			const std::size_t expectedSize = lineCount * lineSize;
+
+			packed.resize(packedSize);
+			if (!input.read(reinterpret_cast<char*>(packed.data()), packedSize))
+			{
+				return fail("Truncated EXR file");
+			}
+
+			// blocks that would not shrink are stored uncompressed
+			if (packedSize == expectedSize || compression == EXR_COMPRESSION_NONE)
+			{
+				block.swap(packed);
+			}
+			else if (compression == EXR_COMPRESSION_RLE)
+			{
+				if (!DecodeEXRRunLength(packed, unpacked, expectedSize))
+				{
+					return fail("Corrupted EXR file");
+				}
+				DecodeEXRPredictor(unpacked, block);
+			}
+			else
+			{
+				unpacked.clear();
+				FInflater inflater;
+				bool inflated = inflater.Inflate(packed.data(), packed.size(), [&unpacked, expectedSize](const uint8_t* data, std::size_t size)
+					{
+						if (unpacked.size() + size > expectedSize)
+						{
+							return false;
+						}
+						unpacked.insert(unpacked.end(), data, data + size);
+						return true;
+					});
+
+				if (!inflated || unpacked.size() != expectedSize)
+				{
+					return fail("Corrupted EXR file");
+				}
+				DecodeEXRPredictor(unpacked, block);
+			}
+
+			if (block.size() != expectedSize)
+			{
+				return fail("Corrupted EXR file");
+			}
+
+			// each line holds all samples of the first channel, then the second, ...
+			const uint8_t* src = block.data();
+			for (std::size_t line = 0; line < lineCount; ++line)
+			{
+				float* row = reinterpret_cast<float*>(GetTextureRow(texture, std::size_t(firstLine) + line));
+				for (const FEXRChannel& channel : channels)
+				{
+					const std::size_t sampleSize = GetEXRSampleSize(channel.PixelType);
+					if (channel.Component < 0)
+					{
+						src += width * sampleSize;
+						continue;
+					}
+
+					if (channel.PixelType == EXR_PIXEL_HALF)
+					{
+						for (std::size_t x = 0; x < width; ++x)
+						{
+							halfSamples[x] = static_cast<uint16_t>(src[x * 2] | (src[x * 2 + 1] << 8));
+						}
+						ConvertHalfToFloat(halfSamples.data(), width, floatSamples.data());
+					}
+
+					for (std::size_t x = 0; x < width; ++x, src += sampleSize)
+					{
+						float sample = channel.PixelType == EXR_PIXEL_HALF ? floatSamples[x]
+							: channel.PixelType == EXR_PIXEL_FLOAT ? ReadFloatLE(src) : static_cast<float>(ReadLE32(src));
+
+						if (channel.Component == 4)
+						{
+							row[x * 4] = row[x * 4 + 1] = row[x * 4 + 2] = sample;
+						}
+						else
+						{
+							row[x * 4 + channel.Component] = sample;
+						}
+					}
+				}
+			}
+		}
+
+		return texture;
+	}
+
+	bool ExportEXRTexture(const std::string& fileName, const FTexture& texture)
+	{
+		if (texture.GetLayout() != ETextureLayout::Linear)
+		{
+			return ExportEXRTexture(fileName, texture.ConvertLayout(ETextureLayout::Linear));
+		}
+
+		const std::size_t width = texture.GetWidth();
+		const std::size_t height = texture.GetHeight();
+		const EDASH_FORMAT format = texture.GetFormat();
+
+		// channels are stored in alphabetical order, component index into the source pixel
+		std::vector<std::pair<const char*, std::size_t>> channels;
+		std::size_t stride = 0;
+		switch (format)
+		{
+		case EDASH_FORMAT::R16_FLOAT:
+		case EDASH_FORMAT::R32_FLOAT:
+			channels = { { "Y", 0 } };
+			stride = 1;
+			break;
+		case EDASH_FORMAT::R32G32B32_FLOAT:
+			channels = { { "B", 2 }, { "G", 1 }, { "R", 0 } };
+			stride = 3;
+			break;
+		case EDASH_FORMAT::R16G16B16A16_FLOAT:
+		case EDASH_FORMAT::R32G32B32A32_FLOAT:
+			channels = { { "A", 3 }, { "B", 2 }, { "G", 1 }, { "R", 0 } };
+			stride = 4;
+			break;
+		default:
+			LOG_ERROR << "EXR export doesn't support the texture format " << static_cast<uint32_t>(format);
+			return false;
+		}
+
+		// half textures are written as HALF channels without a round trip through float
+		const bool halfSamples = format == EDASH_FORMAT::R16_FLOAT || format == EDASH_FORMAT::R16G16B16A16_FLOAT;
+
+		if (width == 0 || height == 0 || width > 0x7FFFFFFF || height > 0x7FFFFFFF)
+		{
+			return false;
+		}
+
+		std::vector<uint8_t> header;
+		WriteLE32(header, uint32_t(EXR_MAGIC));
+		WriteLE32(header, 2);
+
+		auto addAttribute = [&header](const char* name, const char* type, const std::vector<uint8_t>& data)
+		{
+			header.insert(header.end(), name, name + std::strlen(name) + 1);
+			header.insert(header.end(), type, type + std::strlen(type) + 1);
+			WriteLE32(header, static_cast<uint32_t>(data.size()));
+			header.insert(header.end(), data.begin(), data.end());
+		};
+
+		auto floatBits = [](float value)
+		{
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(float));
+			return bits;
+		};
+
+		std::vector<uint8_t> data;
+		for (const auto& channel : channels)
+		{
+			data.insert(data.end(), channel.first, channel.first + std::strlen(channel.first) + 1);
+			WriteLE32(data, halfSamples ? EXR_PIXEL_HALF : EXR_PIXEL_FLOAT);
+			WriteLE32(data, 0); // pLinear and reserved bytes
+			WriteLE32(data, 1);
+			WriteLE32(data, 1);
+		}
+		data.push_back(0);
+		addAttribute("channels", "chlist", data);
+
+		addAttribute("compression", "compression", { EXR_COMPRESSION_ZIP });
+
+		data.clear();
+		WriteLE32(data, 0);
+		WriteLE32(data, 0);
+		WriteLE32(data, uint32_t(width - 1));
+		WriteLE32(data, uint32_t(height - 1));
+		addAttribute("dataWindow", "box2i", data);
+		addAttribute("displayWindow", "box2i", data);
+
+		addAttribute("lineOrder", "lineOrder", { 0 });
+
+		data.clear();
+		WriteLE32(data, floatBits(1.0f));
+		addAttribute("pixelAspectRatio", "float", data);
+
+		data.clear();
+		WriteLE32(data, floatBits(0.0f));
+		WriteLE32(data, floatBits(0.0f));
+		addAttribute("screenWindowCenter", "v2f", data);
+
+		data.clear();
+		WriteLE32(data, floatBits(1.0f));
+		addAttribute("screenWindowWidth", "float", data);
+
+		header.push_back(0);
+
+		std::ofstream output(fileName, std::ios::binary);
+		if (!output)
+		{
+			LOG_ERROR << "Can't create image file " << fileName.c_str();
+			return false;
+		}
+
+		const std::size_t blockCount = (height + EXR_ZIP_LINES - 1) / EXR_ZIP_LINES;
+		std::vector<uint8_t> offsetTable(blockCount * 8, 0);
+
+		output.write(reinterpret_cast<const char*>(header.data()), header.size());
+		output.write(reinterpret_cast<const char*>(offsetTable.data()), offsetTable.size());
+
+		uint64_t offset = header.size() + offsetTable.size();
+		std::vector<uint8_t> raw;
+		std::vector<uint8_t> predicted;
+		std::vector<uint8_t> packed;
+
+		for (std::size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+		{
+			const std::size_t firstLine = blockIndex * EXR_ZIP_LINES;
+			const std::size_t lineCount = std::min<std::size_t>(EXR_ZIP_LINES, height - firstLine);
+
+			raw.clear();
+			for (std::size_t line = firstLine; line < firstLine + lineCount; ++line)
+			{
+				const uint8_t* row = GetTextureRow(texture, line);
+				for (const auto& channel : channels)
+				{
+					for (std::size_t x = 0; x < width; ++x)
+					{
+						if (halfSamples)
+						{
+							uint16_t sample = reinterpret_cast<const uint16_t*>(row)[x * stride + channel.second];
+							raw.push_back(uint8_t(sample));
+							raw.push_back(uint8_t(sample >> 8));
+						}
+						else
+						{
+							WriteLE32(raw, floatBits(reinterpret_cast<const float*>(row)[x * stride + channel.second]));
+						}
+					}
+				}
+			}
+
+			EncodeEXRPredictor(raw, predicted);
+			if (!FDeflater::Compress(predicted.data(), predicted.size(), packed) || packed.size() >= raw.size())
+			{
+				packed = raw;
+			}
+
+			uint8_t blockHeader[8];
+			uint32_t lineIndex = static_cast<uint32_t>(firstLine);
+			uint32_t packedSize = static_cast<uint32_t>(packed.size());
+			for (int i = 0; i < 4; ++i)
+			{
+				blockHeader[i] = uint8_t(lineIndex >> (i * 8));
+				blockHeader[4 + i] = uint8_t(packedSize >> (i * 8));
+			}
+
+			WriteLE64(&offsetTable[blockIndex * 8], offset);
+			output.write(reinterpret_cast<const char*>(blockHeader), 8);
+			output.write(reinterpret_cast<const char*>(packed.data()), packed.size());
+			offset += 8 + packed.size();
+		}
+
+		output.seekp(std::streamoff(header.size()));
+		output.write(reinterpret_cast<const char*>(offsetTable.data()), offsetTable.size());
+
+		if (!output.good())
+		{
+			LOG_ERROR << "Failed to write image file " << fileName.c_str();
+			return false;
+		}
+
+		return true;
+	}
+
+	// -- Dispatch -- //
+
+	FTexture LoadTexture(const std::string& fileName)
+	{
+		const std::string extension = GetLowerExtension(fileName);
+
+		if (extension == "png") return LoadPNGTexture(fileName);
+		if (extension == "ppm" || extension == "pgm" || extension == "pnm") return LoadPPMTexture(fileName);
+		if (extension == "pfm") return LoadPFMTexture(fileName);
+		if (extension == "hdr") return LoadHDRTexture(fileName);
+		if (extension == "exr") return LoadEXRTexture(fileName);
+
+		LOG_ERROR << "Unknown image file type " << fileName.c_str();
+		return FTexture{};
+	}
+
+	bool ExportTexture(const std::string& fileName, const FTexture& texture)
+	{
+		const std::string extension = GetLowerExtension(fileName);
+
+		if (extension == "png") return ExportPNGTexture(fileName, texture);
+		if (extension == "ppm" || extension == "pgm" || extension == "pnm") return ExportPPMTexture(fileName, texture);
+		if (extension == "pfm") return ExportPFMTexture(fileName, texture);
+		if (extension == "hdr") return ExportHDRTexture(fileName, texture);
+		if (extension == "exr") return ExportEXRTexture(fileName, texture);
+
+		LOG_ERROR << "Unknown image file type " << fileName.c_str();
+		return false;
+	}
+}
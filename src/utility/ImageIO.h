@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Image.h"
+#include "Deflate.h"
+#include <istream>
+#include <ostream>
+#include <memory>
+#include <string>
+
+namespace Dash
+{
+	struct FImageInfo
+	{
+		std::size_t Width = 0;
+		std::size_t Height = 0;
+
+		/** Format of the rows handed out by the decoder. */
+		EDASH_FORMAT Format = EDASH_FORMAT::UnKwon;
+	};
+
+	/**
+	 * Streaming PNG decoder. IDAT data is inflated chunk by chunk and every completed scanline is expanded to
+	 * R8G8B8A8_UNORM (R16G16B16A16_UNORM for 16 bit sources) and passed to the row callback.
+	 * Interlaced images are deinterlaced into a full frame before the rows are emitted.
+	 */
+	class FPNGDecoder
+	{
+	public:
+		/** Returns false to abort decoding. */
+		using RowFunc = std::function<bool(std::size_t y, const uint8_t* row)>;
+
+		explicit FPNGDecoder(std::istream& input);
+
+		bool ReadHeader();
+
+		const FImageInfo& GetInfo() const { return mInfo; }
+
+		bool DecodeRows(const RowFunc& onRow);
+
+	private:
+		bool ReadChunkHeader();
+		bool ReadChunkData(uint8_t* dest, std::size_t size);
+		bool EndChunk();
+		bool SkipChunk();
+
+		void BeginPass(uint32_t pass);
+		bool ProcessScanline(const RowFunc& onRow);
+		void ExpandScanline(const uint8_t* src, std::size_t width, uint8_t* dest) const;
+
+		std::istream& mInput;
+		FImageInfo mInfo;
+
+		uint32_t mBitDepth;
+		uint32_t mColorType;
+		uint32_t mInterlace;
+		uint32_t mChannels;
+		std::size_t mFilterStride;
+
+		uint8_t mPalette[256][4];
+		uint16_t mTransparentKey[3];
+		bool mHasTransparentKey;
+
+		char mChunkType[4];
+		uint32_t mChunkRemaining;
+		uint32_t mChunkCRC;
+
+		// scanline state, pass 7 is the whole image of a non-interlaced file
+		uint32_t mPass;
+		uint32_t mLastPass;
+		std::size_t mPassWidth;
+		std::size_t mPassHeight;
+		std::size_t mPassRow;
+		std::size_t mRowBytes;
+		std::size_t mRowFill;
+		std::vector<uint8_t> mCurrentRow;
+		std::vector<uint8_t> mPreviousRow;
+		std::vector<uint8_t> mExpandedRow;
+		std::vector<uint8_t> mInterlacedImage;
+	};
+
+	/**
+	 * Streaming PNG encoder. Rows are filtered with the per-row filter that minimizes the sum of absolute
+	 * differences and compressed straight into IDAT chunks.
+	 * Rows are tightly packed in PNG channel order, 16 bit samples in native byte order.
+	 */
+	class FPNGEncoder
+	{
+	public:
+		explicit FPNGEncoder(std::ostream& output, int compressionLevel = 6);
+
+		/** channels: 1 gray, 2 gray alpha, 3 rgb, 4 rgba; bitDepth: 8 or 16. */
+		bool Begin(std::size_t width, std::size_t height, uint32_t channels, uint32_t bitDepth);
+
+		bool WriteRow(const uint8_t* row);
+
+		bool End();
+
+	private:
+		bool WriteChunk(const char* type, const uint8_t* data, std::size_t size);
+		bool FlushIDAT(bool force);
+
+		std::ostream& mOutput;
+		int mCompressionLevel;
+
+		std::size_t mHeight;
+		std::size_t mRowBytes;
+		std::size_t mFilterStride;
+		uint32_t mBitDepth;
+		std::size_t mRowsWritten;
+
+		std::vector<uint8_t> mCurrentRow;
+		std::vector<uint8_t> mPreviousRow;
+		std::vector<uint8_t> mFilteredRows;
+		std::vector<uint8_t> mIDAT;
+
+		std::unique_ptr<FDeflater> mDeflater;
+	};
+
+	FTexture LoadPNGTexture(const std::string& fileName);
+
+	bool ExportPNGTexture(const std::string& fileName, const FTexture& texture, int compressionLevel = 6);
+
+	/** Binary PPM (P6) and PGM (P5), 8 or 16 bit. */
+	FTexture LoadPPMTexture(const std::string& fileName);
+
+	/**
+	 * Converts the whole image to 8 bit RGB (gray for single channel formats, 16 bit for 16 bit UNORM formats) in one
+	 * SIMD pass and writes it with a single write. Large images are converted in chunks while the previous chunk is
+	 * written on a background thread. Float formats are quantized with optional sRGB encoding.
+	 */
+	bool ExportPPMImage(const std::string& fileName, const uint8_t* data, std::size_t width, std::size_t height, std::size_t rowPitch, EDASH_FORMAT format, bool bSRGB = true);
+
+	bool ExportPPMTexture(const std::string& fileName, const FTexture& texture, bool bSRGB = true);
+
+	/** Portable float map, PF (R32G32B32_FLOAT) and Pf (R32_FLOAT). */
+	FTexture LoadPFMTexture(const std::string& fileName);
+
+	bool ExportPFMTexture(const std::string& fileName, const FTexture& texture);
+
+	/** Radiance RGBE, decoded to R32G32B32A32_FLOAT. */
+	FTexture LoadHDRTexture(const std::string& fileName);
+
+	bool ExportHDRTexture(const std::string& fileName, const FTexture& texture);
+
+	/**
+	 * Single-part scanline OpenEXR with NONE, RLE, ZIPS or ZIP compression and HALF / FLOAT channels,
+	 * decoded to R32G32B32A32_FLOAT. Export writes ZIP compressed FLOAT channels, HALF for half float textures.
+	 */
+	FTexture LoadEXRTexture(const std::string& fileName);
+
+	bool ExportEXRTexture(const std::string& fileName, const FTexture& texture);
+
+	/** Picks the loader from the file extension. */
+	FTexture LoadTexture(const std::string& fileName);
+
+	bool ExportTexture(const std::string& fileName, const FTexture& texture);
+}
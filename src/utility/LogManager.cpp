@@ -4,6 +4,8 @@
 
 #include <vector>
 #include <atomic>
+#include <thread>
+#include <algorithm>
 
 
 namespace Dash
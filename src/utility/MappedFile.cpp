@@ -0,0 +1,139 @@
+#include "MappedFile.h"
+#include "LogManager.h"
+#include <utility>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Dash
+{
+	FMappedFile::~FMappedFile()
+	{
+		Close();
+	}
+
+	FMappedFile::FMappedFile(FMappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	FMappedFile& FMappedFile::operator=(FMappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+			mData = std::exchange(other.mData, nullptr);
+			mSize = std::exchange(other.mSize, 0);
+#if defined(_WIN32)
+			mFileHandle = std::exchange(other.mFileHandle, nullptr);
+			mMappingHandle = std::exchange(other.mMappingHandle, nullptr);
+#endif
+		}
+		return *this;
+	}
+
+#if defined(_WIN32)
+	bool FMappedFile::Open(const std::string& fileName)
+	{
+		Close();
+
+		HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			LOG_ERROR << "Can't open file " << fileName.c_str();
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			LOG_ERROR << "Can't map empty file " << fileName.c_str();
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (view == nullptr)
+		{
+			LOG_ERROR << "Can't map file " << fileName.c_str();
+			if (mapping)
+			{
+				CloseHandle(mapping);
+			}
+			CloseHandle(file);
+			return false;
+		}
+
+		mFileHandle = file;
+		mMappingHandle = mapping;
+		mData = static_cast<const std::uint8_t*>(view);
+		mSize = static_cast<std::size_t>(size.QuadPart);
+		return true;
+	}
+
+	void FMappedFile::Close()
+	{
+		if (mData)
+		{
+			UnmapViewOfFile(mData);
+			CloseHandle(mMappingHandle);
+			CloseHandle(mFileHandle);
+		}
+
+		mData = nullptr;
+		mSize = 0;
+		mFileHandle = nullptr;
+		mMappingHandle = nullptr;
+	}
+#else
+	bool FMappedFile::Open(const std::string& fileName)
+	{
+		Close();
+
+		const int file = open(fileName.c_str(), O_RDONLY);
+		if (file < 0)
+		{
+			LOG_ERROR << "Can't open file " << fileName.c_str();
+			return false;
+		}
+
+		struct stat info;
+		if (fstat(file, &info) != 0 || info.st_size == 0)
+		{
+			LOG_ERROR << "Can't map empty file " << fileName.c_str();
+			close(file);
+			return false;
+		}
+
+		void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+		if (view == MAP_FAILED)
+		{
+			LOG_ERROR << "Can't map file " << fileName.c_str();
+			return false;
+		}
+
+		mData = static_cast<const std::uint8_t*>(view);
+		mSize = static_cast<std::size_t>(info.st_size);
+		return true;
+	}
+
+	void FMappedFile::Close()
+	{
+		if (mData)
+		{
+			munmap(const_cast<std::uint8_t*>(mData), mSize);
+		}
+
+		mData = nullptr;
+		mSize = 0;
+	}
+#endif
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace Dash
+{
+	/** Read-only memory mapping of a whole file. Pages are loaded on first touch, so opening is cheap for any file size. */
+	class FMappedFile
+	{
+	public:
+		FMappedFile() = default;
+		~FMappedFile();
+
+		FMappedFile(const FMappedFile&) = delete;
+		FMappedFile& operator=(const FMappedFile&) = delete;
+
+		FMappedFile(FMappedFile&& other) noexcept;
+		FMappedFile& operator=(FMappedFile&& other) noexcept;
+
+		/** Closes any previous mapping first. Empty files can't be mapped and fail to open. */
+		bool Open(const std::string& fileName);
+
+		void Close();
+
+		bool IsOpen() const { return mData != nullptr; }
+
+		const std::uint8_t* GetData() const { return mData; }
+
+		std::size_t GetSize() const { return mSize; }
+
+	private:
+		const std::uint8_t* mData = nullptr;
+		std::size_t mSize = 0;
+
+#if defined(_WIN32)
+		void* mFileHandle = nullptr;
+		void* mMappingHandle = nullptr;
+#endif
+	};
+}
@@ -0,0 +1,264 @@
+#include "MemoryResource.h"
+#include "../consolid/consolid.h"
+#include <algorithm>
+
+namespace Dash
+{
+	namespace
+	{
+		constexpr std::size_t AlignUp(std::size_t value, std::size_t alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+
+		void UpdatePeak(std::atomic<std::size_t>& peak, std::size_t value)
+		{
+			std::size_t current = peak.load(std::memory_order_relaxed);
+			while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+			{
+			}
+		}
+	}
+
+	FCountingResource::FCountingResource(std::pmr::memory_resource* upstream)
+		: mUpstream(upstream)
+		, mAllocationCount(0)
+		, mBytesAllocated(0)
+		, mBytesInUse(0)
+		, mPeakBytesInUse(0)
+	{
+		ASSERT(upstream != nullptr);
+	}
+
+	FMemoryStats FCountingResource::GetStats() const
+	{
+		FMemoryStats stats;
+		stats.AllocationCount = mAllocationCount.load(std::memory_order_relaxed);
+		stats.UpstreamAllocationCount = stats.AllocationCount;
+		stats.BytesAllocated = mBytesAllocated.load(std::memory_order_relaxed);
+		stats.PeakBytesInUse = mPeakBytesInUse.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void FCountingResource::ResetStats()
+	{
+		mAllocationCount = 0;
+		mBytesAllocated = 0;
+		mPeakBytesInUse = mBytesInUse.load(std::memory_order_relaxed);
+	}
+
+	void* FCountingResource::do_allocate(std::size_t bytes, std::size_t alignment)
+	{
+		void* p = mUpstream->allocate(bytes, alignment);
+
+		mAllocationCount.fetch_add(1, std::memory_order_relaxed);
+		mBytesAllocated.fetch_add(bytes, std::memory_order_relaxed);
+		UpdatePeak(mPeakBytesInUse, mBytesInUse.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+
+		return p;
+	}
+
+	void FCountingResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+	{
+		mBytesInUse.fetch_sub(bytes, std::memory_order_relaxed);
+		mUpstream->deallocate(p, bytes, alignment);
+	}
+
+	bool FCountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+	{
+		return this == &other;
+	}
+
+	FLinearArena::FLinearArena(std::size_t blockSize, std::pmr::memory_resource* upstream)
+		: mUpstream(upstream)
+		, mBlockSize(blockSize)
+		, mCurrentBlock(0)
+		, mOffset(0)
+		, mBytesInUse(0)
+	{
+		ASSERT(upstream != nullptr && blockSize > 0);
+	}
+
+	FLinearArena::~FLinearArena()
+	{
+		for (const FBlock& block : mBlocks)
+		{
+			mUpstream->deallocate(block.Data, block.Size, alignof(std::max_align_t));
+		}
+	}
+
+	void FLinearArena::Reset()
+	{
+		mCurrentBlock = 0;
+		mOffset = 0;
+		mBytesInUse = 0;
+	}
+
+	std::size_t FLinearArena::GetCapacity() const
+	{
+		std::size_t capacity = 0;
+		for (const FBlock& block : mBlocks)
+		{
+			capacity += block.Size;
+		}
+		return capacity;
+	}
+
+	void* FLinearArena::do_allocate(std::size_t bytes, std::size_t alignment)
+	{
+		bytes = std::max<std::size_t>(bytes, 1);
+
+		// blocks come aligned to max_align_t, larger alignments are satisfied by padding inside the block
+		const std::size_t padding = alignment > alignof(std::max_align_t) ? alignment : 0;
+
+		while (mCurrentBlock < mBlocks.size())
+		{
+			FBlock& block = mBlocks[mCurrentBlock];
+			const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block.Data);
+			const std::size_t offset = AlignUp(base + mOffset, alignment) - base;
+
+			if (offset + bytes <= block.Size)
+			{
+				mOffset = offset + bytes;
+				mBytesInUse += bytes;
+
+				mStats.AllocationCount++;
+				mStats.BytesAllocated += bytes;
+				mStats.PeakBytesInUse = std::max(mStats.PeakBytesInUse, mBytesInUse);
+
+				return block.Data + offset;
+			}
+
+			// the remaining blocks may still be large enough, they are kept in allocation order after a reset
+			mCurrentBlock++;
+			mOffset = 0;
+		}
+
+		FBlock block;
+		block.Size = std::max(mBlockSize, bytes + padding);
+		block.Data = static_cast<uint8_t*>(mUpstream->allocate(block.Size, alignof(std::max_align_t)));
+		mBlocks.push_back(block);
+		mStats.UpstreamAllocationCount++;
+
+		mCurrentBlock = mBlocks.size() - 1;
+		mOffset = 0;
+
+		return do_allocate(bytes, alignment);
+	}
+
+	void FLinearArena::do_deallocate(void* /*p*/, std::size_t /*bytes*/, std::size_t /*alignment*/)
+	{
+	}
+
+	bool FLinearArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+	{
+		return this == &other;
+	}
+
+	FPoolResource::FPoolResource(std::size_t maxClassSize, std::pmr::memory_resource* upstream)
+		: mUpstream(upstream)
+		, mMaxClassSize(MinClassSize)
+		, mBytesInUse(0)
+	{
+		ASSERT(upstream != nullptr);
+
+		while (mMaxClassSize < maxClassSize)
+		{
+			mMaxClassSize <<= 1;
+		}
+
+		mFreeLists.resize(GetClassIndex(mMaxClassSize) + 1);
+	}
+
+	FPoolResource::~FPoolResource()
+	{
+		Trim();
+	}
+
+	void FPoolResource::Trim()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		for (std::size_t classIndex = 0; classIndex < mFreeLists.size(); ++classIndex)
+		{
+			const std::size_t classSize = MinClassSize << classIndex;
+			for (void* p : mFreeLists[classIndex])
+			{
+				mUpstream->deallocate(p, classSize, alignof(std::max_align_t));
+			}
+			mFreeLists[classIndex].clear();
+		}
+	}
+
+	FMemoryStats FPoolResource::GetStats() const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mStats;
+	}
+
+	std::size_t FPoolResource::GetClassIndex(std::size_t bytes) const
+	{
+		std::size_t classIndex = 0;
+		std::size_t classSize = MinClassSize;
+		while (classSize < bytes)
+		{
+			classSize <<= 1;
+			classIndex++;
+		}
+		return classIndex;
+	}
+
+	void* FPoolResource::do_allocate(std::size_t bytes, std::size_t alignment)
+	{
+		// over-aligned and oversized requests bypass the size classes
+		const bool pooled = bytes <= mMaxClassSize && alignment <= alignof(std::max_align_t);
+		const std::size_t classIndex = pooled ? GetClassIndex(bytes) : 0;
+		const std::size_t allocSize = pooled ? MinClassSize << classIndex : bytes;
+
+		void* p = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			mStats.AllocationCount++;
+			mStats.BytesAllocated += bytes;
+			mBytesInUse += allocSize;
+			mStats.PeakBytesInUse = std::max(mStats.PeakBytesInUse, mBytesInUse);
+
+			if (pooled && !mFreeLists[classIndex].empty())
+			{
+				p = mFreeLists[classIndex].back();
+				mFreeLists[classIndex].pop_back();
+				return p;
+			}
+
+			mStats.UpstreamAllocationCount++;
+		}
+
+		return mUpstream->allocate(allocSize, pooled ? alignof(std::max_align_t) : alignment);
+	}
+
+	void FPoolResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+	{
+		const bool pooled = bytes <= mMaxClassSize && alignment <= alignof(std::max_align_t);
+		const std::size_t classIndex = pooled ? GetClassIndex(bytes) : 0;
+		const std::size_t allocSize = pooled ? MinClassSize << classIndex : bytes;
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mBytesInUse -= allocSize;
+
+			if (pooled)
+			{
+				mFreeLists[classIndex].push_back(p);
+				return;
+			}
+		}
+
+		mUpstream->deallocate(p, bytes, alignment);
+	}
+
+	bool FPoolResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+	{
+		return this == &other;
+	}
+}
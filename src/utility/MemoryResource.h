@@ -0,0 +1,131 @@
+#pragma once
+
+#include <memory_resource>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace Dash
+{
+	struct FMemoryStats
+	{
+		/** Allocations requested from the resource. */
+		std::size_t AllocationCount = 0;
+
+		/** Allocations the resource had to forward to its upstream resource, the heap for the default upstream. */
+		std::size_t UpstreamAllocationCount = 0;
+
+		std::size_t BytesAllocated = 0;
+		std::size_t PeakBytesInUse = 0;
+	};
+
+	/**
+	 * Forwards to the upstream resource and counts the calls. Placed between the heap and an arena or pool it shows
+	 * how many heap calls the arena or pool saves.
+	 */
+	class FCountingResource : public std::pmr::memory_resource
+	{
+	public:
+		explicit FCountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+		FMemoryStats GetStats() const;
+
+		void ResetStats();
+
+	protected:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+		void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+	private:
+		std::pmr::memory_resource* mUpstream;
+
+		std::atomic<std::size_t> mAllocationCount;
+		std::atomic<std::size_t> mBytesAllocated;
+		std::atomic<std::size_t> mBytesInUse;
+		std::atomic<std::size_t> mPeakBytesInUse;
+	};
+
+	/**
+	 * Frame arena: allocations bump a pointer through blocks taken from the upstream resource, deallocation is a no-op
+	 * and Reset releases everything at once while keeping the blocks for the next frame. Not thread safe.
+	 */
+	class FLinearArena : public std::pmr::memory_resource
+	{
+	public:
+		explicit FLinearArena(std::size_t blockSize = 1024 * 1024, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+		~FLinearArena();
+
+		FLinearArena(const FLinearArena&) = delete;
+		FLinearArena& operator=(const FLinearArena&) = delete;
+
+		/** Invalidates every allocation made since the last reset. */
+		void Reset();
+
+		FMemoryStats GetStats() const { return mStats; }
+
+		std::size_t GetCapacity() const;
+
+	protected:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+		void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+	private:
+		struct FBlock
+		{
+			uint8_t* Data;
+			std::size_t Size;
+		};
+
+		std::pmr::memory_resource* mUpstream;
+		std::size_t mBlockSize;
+
+		std::vector<FBlock> mBlocks;
+		std::size_t mCurrentBlock;
+		std::size_t mOffset;
+
+		FMemoryStats mStats;
+		std::size_t mBytesInUse;
+	};
+
+	/**
+	 * Size-class pool: requests are rounded up to a power of two and freed blocks go to a per-class free list instead of
+	 * back to the upstream resource. Requests above the largest class go straight upstream. Thread safe.
+	 */
+	class FPoolResource : public std::pmr::memory_resource
+	{
+	public:
+		static constexpr std::size_t MinClassSize = 16;
+
+		explicit FPoolResource(std::size_t maxClassSize = 64 * 1024 * 1024, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+		~FPoolResource();
+
+		FPoolResource(const FPoolResource&) = delete;
+		FPoolResource& operator=(const FPoolResource&) = delete;
+
+		/** Returns every free block to the upstream resource. */
+		void Trim();
+
+		FMemoryStats GetStats() const;
+
+	protected:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+		void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+	private:
+		std::size_t GetClassIndex(std::size_t bytes) const;
+
+		std::pmr::memory_resource* mUpstream;
+		std::size_t mMaxClassSize;
+
+		std::vector<std::vector<void*>> mFreeLists;
+
+		mutable std::mutex mMutex;
+		FMemoryStats mStats;
+		std::size_t mBytesInUse;
+	};
+}
@@ -0,0 +1,100 @@
+#include "ParallelFor.h"
+
+namespace Dash
+{
+	FParallelForPool::FParallelForPool()
+	{
+		const size_t hardwareThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		mThreads.reserve(hardwareThreads - 1);
+		for (size_t i = 1; i < hardwareThreads; ++i)
+		{
+			mThreads.emplace_back(&FParallelForPool::WorkerLoop, this);
+		}
+	}
+
+	FParallelForPool::~FParallelForPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStop = true;
+		}
+		mJobAdded.notify_all();
+
+		for (std::thread& thread : mThreads)
+		{
+			thread.join();
+		}
+	}
+
+	void FParallelForPool::Run(FJob& job, size_t chunkCount)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mJobs.push_back(&job);
+		}
+
+		// the calling thread takes one chunk, wake a worker for each of the others
+		const size_t helpers = std::min(chunkCount - 1, mThreads.size());
+		for (size_t i = 0; i < helpers; ++i)
+		{
+			mJobAdded.notify_one();
+		}
+
+		RunChunks(job);
+
+		// once the job is out of the queue no worker can join it, wait for the ones still inside
+		std::unique_lock<std::mutex> lock(mMutex);
+		auto it = std::find(mJobs.begin(), mJobs.end(), &job);
+		if (it != mJobs.end())
+		{
+			mJobs.erase(it);
+		}
+		mJobLeft.wait(lock, [&job]() { return job.Helpers == 0; });
+	}
+
+	void FParallelForPool::RunChunks(FJob& job)
+	{
+		for (;;)
+		{
+			const size_t chunkBegin = job.Next.fetch_add(job.ChunkSize);
+			if (chunkBegin >= job.End)
+			{
+				break;
+			}
+
+			job.RunChunk(job.Body, chunkBegin, std::min(chunkBegin + job.ChunkSize, job.End));
+		}
+	}
+
+	void FParallelForPool::WorkerLoop()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		for (;;)
+		{
+			mJobAdded.wait(lock, [this]() { return mStop || !mJobs.empty(); });
+			if (mStop)
+			{
+				return;
+			}
+
+			FJob* job = mJobs.front();
+			job->Helpers++;
+
+			lock.unlock();
+			RunChunks(*job);
+			lock.lock();
+
+			// every chunk is taken, later workers shouldn't pick the job up again
+			auto it = std::find(mJobs.begin(), mJobs.end(), job);
+			if (it != mJobs.end())
+			{
+				mJobs.erase(it);
+			}
+
+			if (--job->Helpers == 0)
+			{
+				mJobLeft.notify_all();
+			}
+		}
+	}
+}
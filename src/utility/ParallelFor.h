@@ -0,0 +1,154 @@
+#pragma once
+
+#include "../design_patterns/Singleton.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Dash
+{
+	/**
+	 * Worker threads shared by every ParallelFor, started on first use and kept until exit, so a parallel loop costs a
+	 * wake up instead of creating and joining threads. The calling thread works on its own loop and idle workers join
+	 * in, so nested loops still finish when every worker is busy.
+	 */
+	class FParallelForPool : public TSingleton<FParallelForPool>
+	{
+	public:
+		struct FJob
+		{
+			void (*RunChunk)(void* body, size_t begin, size_t end);
+			void* Body;
+			size_t End;
+			size_t ChunkSize;
+			std::atomic<size_t> Next;
+
+			/** Workers inside the job, guarded by the pool mutex. */
+			size_t Helpers = 0;
+		};
+
+		FParallelForPool();
+		~FParallelForPool();
+
+		/** Worker threads plus the calling thread. */
+		size_t GetThreadCount() const { return mThreads.size() + 1; }
+
+		/** Runs the chunks of the job on the calling thread and idle workers, returns once all of them are done. */
+		void Run(FJob& job, size_t chunkCount);
+
+	private:
+		static void RunChunks(FJob& job);
+
+		void WorkerLoop();
+
+		std::mutex mMutex;
+		std::condition_variable mJobAdded;
+		std::condition_variable mJobLeft;
+		std::deque<FJob*> mJobs;
+		std::vector<std::thread> mThreads;
+		bool mStop = false;
+	};
+
+	/**
+	 * Runs body(index) for every index in [begin, end) on the calling thread and the FParallelForPool workers.
+	 * Indices are handed out in chunks of at least grainSize, small ranges run inline.
+	 */
+	template<typename Func>
+	void ParallelFor(size_t begin, size_t end, Func&& body, size_t grainSize = 1)
+	{
+		if (end <= begin)
+		{
+			return;
+		}
+
+		const size_t count = end - begin;
+		grainSize = std::max<size_t>(grainSize, 1);
+
+		FParallelForPool* pool = FParallelForPool::Get();
+		const size_t threadCount = std::min(pool->GetThreadCount(), (count + grainSize - 1) / grainSize);
+
+		if (threadCount <= 1)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				body(i);
+			}
+			return;
+		}
+
+		// a few chunks per thread keeps the threads busy when the iterations are uneven
+		const size_t chunkSize = std::max(grainSize, count / (threadCount * 4));
+
+		using FBody = std::remove_reference_t<Func>;
+		FParallelForPool::FJob job;
+		job.RunChunk = [](void* context, size_t chunkBegin, size_t chunkEnd)
+		{
+			FBody& func = *static_cast<FBody*>(context);
+			for (size_t i = chunkBegin; i < chunkEnd; ++i)
+			{
+				func(i);
+			}
+		};
+		job.Body = const_cast<void*>(static_cast<const void*>(std::addressof(body)));
+		job.End = end;
+		job.ChunkSize = chunkSize;
+		job.Next = begin;
+
+		pool->Run(job, (count + chunkSize - 1) / chunkSize);
+	}
+
+	/**
+	 * Sorts chunks of at least grainSize elements in parallel, then merges neighbouring runs pass by pass with each
+	 * pass's merges running in parallel. Not stable.
+	 */
+	template<typename RandomIt, typename Compare>
+	void ParallelSort(RandomIt first, RandomIt last, Compare comp, size_t grainSize = 1 << 14)
+	{
+		using ValueType = typename std::iterator_traits<RandomIt>::value_type;
+
+		const size_t count = static_cast<size_t>(last - first);
+		const size_t hardwareThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		const size_t chunkCount = std::min(hardwareThreads, count / std::max<size_t>(grainSize, 1));
+		if (chunkCount <= 1)
+		{
+			std::sort(first, last, comp);
+			return;
+		}
+
+		std::vector<size_t> bounds(chunkCount + 1);
+		for (size_t i = 0; i <= chunkCount; ++i)
+		{
+			bounds[i] = count * i / chunkCount;
+		}
+
+		ParallelFor(0, chunkCount, [&](size_t i)
+		{
+			std::sort(first + bounds[i], first + bounds[i + 1], comp);
+		});
+
+		// ping-pong between two buffers, every pass halves the number of sorted runs
+		std::vector<ValueType> source(std::make_move_iterator(first), std::make_move_iterator(last));
+		std::vector<ValueType> dest(count);
+		for (size_t width = 1; width < chunkCount; width *= 2)
+		{
+			ParallelFor(0, (chunkCount + 2 * width - 1) / (2 * width), [&](size_t pair)
+			{
+				const size_t begin = bounds[pair * 2 * width];
+				const size_t middle = bounds[std::min(pair * 2 * width + width, chunkCount)];
+				const size_t end = bounds[std::min(pair * 2 * width + 2 * width, chunkCount)];
+				std::merge(std::make_move_iterator(source.begin() + begin), std::make_move_iterator(source.begin() + middle),
+					std::make_move_iterator(source.begin() + middle), std::make_move_iterator(source.begin() + end), dest.begin() + begin, comp);
+			});
+			source.swap(dest);
+		}
+
+		std::move(source.begin(), source.end(), first);
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "../consolid/consolid.h"
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace Dash
+{
+	/**
+	 * Non-owning view over count elements of type T placed stride bytes apart, e.g. one attribute of an interleaved
+	 * vertex buffer. T may be const to get a read-only span.
+	 */
+	template<typename T>
+	class TStridedSpan
+	{
+	public:
+		using ByteType = std::conditional_t<std::is_const_v<T>, const uint8_t, uint8_t>;
+
+		class FIterator
+		{
+		public:
+			using iterator_category = std::random_access_iterator_tag;
+			using value_type = std::remove_const_t<T>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = T*;
+			using reference = T&;
+
+			FIterator() = default;
+			FIterator(ByteType* data, size_t stride) : mData(data), mStride(stride) {}
+
+			FORCEINLINE T& operator*() const { return *reinterpret_cast<T*>(mData); }
+			FORCEINLINE T* operator->() const { return reinterpret_cast<T*>(mData); }
+			FORCEINLINE T& operator[](difference_type n) const { return *reinterpret_cast<T*>(mData + n * static_cast<difference_type>(mStride)); }
+
+			FORCEINLINE FIterator& operator++() { mData += mStride; return *this; }
+			FORCEINLINE FIterator operator++(int) { FIterator result = *this; mData += mStride; return result; }
+			FORCEINLINE FIterator& operator--() { mData -= mStride; return *this; }
+			FORCEINLINE FIterator operator--(int) { FIterator result = *this; mData -= mStride; return result; }
+
+			FORCEINLINE FIterator& operator+=(difference_type n) { mData += n * static_cast<difference_type>(mStride); return *this; }
+			FORCEINLINE FIterator& operator-=(difference_type n) { mData -= n * static_cast<difference_type>(mStride); return *this; }
+			FORCEINLINE FIterator operator+(difference_type n) const { FIterator result = *this; return result += n; }
+			FORCEINLINE FIterator operator-(difference_type n) const { FIterator result = *this; return result -= n; }
+			FORCEINLINE difference_type operator-(const FIterator& other) const { return (mData - other.mData) / static_cast<difference_type>(mStride); }
+
+			FORCEINLINE bool operator==(const FIterator& other) const { return mData == other.mData; }
+			FORCEINLINE bool operator!=(const FIterator& other) const { return mData != other.mData; }
+			FORCEINLINE bool operator<(const FIterator& other) const { return mData < other.mData; }
+
+		private:
+			ByteType* mData = nullptr;
+			size_t mStride = sizeof(T);
+		};
+
+		TStridedSpan() = default;
+
+		TStridedSpan(ByteType* data, size_t count, size_t stride = sizeof(T))
+			: mData(data)
+			, mCount(count)
+			, mStride(stride)
+		{
+			ASSERT(stride >= sizeof(T));
+		}
+
+		/** Read-only spans can be made from mutable ones. */
+		template<typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+		TStridedSpan(const TStridedSpan<U>& other)
+			: TStridedSpan(other.GetRawData(), other.Size(), other.GetStride())
+		{
+		}
+
+		size_t Size() const { return mCount; }
+
+		bool IsEmpty() const { return mCount == 0; }
+
+		size_t GetStride() const { return mStride; }
+
+		ByteType* GetRawData() const { return mData; }
+
+		/** True when the elements are packed and the span can be handed to code expecting a plain array. */
+		bool IsContiguous() const { return mStride == sizeof(T); }
+
+		FORCEINLINE T& operator[](size_t index) const
+		{
+			ASSERT(index < mCount);
+			return *reinterpret_cast<T*>(mData + index * mStride);
+		}
+
+		FIterator begin() const { return FIterator(mData, mStride); }
+
+		FIterator end() const { return FIterator(mData + mCount * mStride, mStride); }
+
+		/** Span over count elements starting at first. */
+		TStridedSpan GetSubSpan(size_t first, size_t count) const
+		{
+			ASSERT(first + count <= mCount);
+			return TStridedSpan(mData + first * mStride, count, mStride);
+		}
+
+	private:
+		ByteType* mData = nullptr;
+		size_t mCount = 0;
+		size_t mStride = sizeof(T);
+	};
+}
@@ -0,0 +1,324 @@
+#include "TextureSampler.h"
+#include <cmath>
+#include <cstring>
+
+namespace Dash
+{
+	namespace
+	{
+		FLinearColor ReadTexel(const FTexture& texture, size_t x, size_t y, bool bSRGB)
+		{
+			const uint8_t* texel = texture.GetRawData() + texture.GetPixelOffset(x, y);
+			const float* floats = reinterpret_cast<const float*>(texel);
+			const uint16_t* halfs = reinterpret_cast<const uint16_t*>(texel);
+
+			auto unorm8 = [bSRGB](uint8_t value) { return bSRGB ? FLinearColor::sRGBToLinearTable[value] : value / 255.0f; };
+
+			switch (texture.GetFormat())
+			{
+			case EDASH_FORMAT::R8_UNORM:
+				return FLinearColor(texel[0] / 255.0f, 0.0f, 0.0f);
+			case EDASH_FORMAT::A8_UNORM:
+				return FLinearColor(0.0f, 0.0f, 0.0f, texel[0] / 255.0f);
+			case EDASH_FORMAT::R16_UNORM:
+				return FLinearColor(halfs[0] / 65535.0f, 0.0f, 0.0f);
+			case EDASH_FORMAT::R16_FLOAT:
+				return FLinearColor(HalfToFloat(halfs[0]), 0.0f, 0.0f);
+			case EDASH_FORMAT::R32_FLOAT:
+				return FLinearColor(floats[0], 0.0f, 0.0f);
+			case EDASH_FORMAT::R32G32_FLOAT:
+				return FLinearColor(floats[0], floats[1], 0.0f);
+			case EDASH_FORMAT::R32G32B32_FLOAT:
+				return FLinearColor(floats[0], floats[1], floats[2]);
+			case EDASH_FORMAT::R32G32B32A32_FLOAT:
+				return FLinearColor(floats[0], floats[1], floats[2], floats[3]);
+			case EDASH_FORMAT::R16G16B16A16_FLOAT:
+				return FLinearColor(HalfToFloat(halfs[0]), HalfToFloat(halfs[1]), HalfToFloat(halfs[2]), HalfToFloat(halfs[3]));
+			case EDASH_FORMAT::R16G16B16A16_UNORM:
+				return FLinearColor(halfs[0] / 65535.0f, halfs[1] / 65535.0f, halfs[2] / 65535.0f, halfs[3] / 65535.0f);
+			case EDASH_FORMAT::R8G8B8A8_UINT:
+			case EDASH_FORMAT::R8G8B8A8_UNORM:
+				return FLinearColor(unorm8(texel[0]), unorm8(texel[1]), unorm8(texel[2]), texel[3] / 255.0f);
+			case EDASH_FORMAT::B8G8R8A8_UNORM:
+				return FLinearColor(unorm8(texel[2]), unorm8(texel[1]), unorm8(texel[0]), texel[3] / 255.0f);
+			case EDASH_FORMAT::B8G8R8X8_UNORM:
+				return FLinearColor(unorm8(texel[2]), unorm8(texel[1]), unorm8(texel[0]));
+			default:
+				ASSERT_FAIL("Unsupported texture format for sampling!");
+				return FLinearColor(0.0f, 0.0f, 0.0f, 0.0f);
+			}
+		}
+
+		FORCEINLINE __m128 FloorPS(__m128 x)
+		{
+			__m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+			return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.0f)));
+		}
+
+		/** Maps integral texel coordinates stored as floats into [0, size). */
+		FORCEINLINE __m128i AddressPS(__m128 coord, float size, ESamplerAddressMode mode)
+		{
+			const __m128 sizeVector = _mm_set1_ps(size);
+			const __m128 last = _mm_set1_ps(size - 1.0f);
+
+			switch (mode)
+			{
+			case ESamplerAddressMode::Wrap:
+				coord = _mm_sub_ps(coord, _mm_mul_ps(FloorPS(_mm_div_ps(coord, sizeVector)), sizeVector));
+				break;
+			case ESamplerAddressMode::Mirror:
+			{
+				const __m128 period = _mm_set1_ps(size * 2.0f);
+				coord = _mm_sub_ps(coord, _mm_mul_ps(FloorPS(_mm_div_ps(coord, period)), period));
+				coord = _mm_min_ps(coord, _mm_sub_ps(_mm_sub_ps(period, _mm_set1_ps(1.0f)), coord));
+				break;
+			}
+			default:
+				break;
+			}
+
+			// also catches the rounding of the wrap division on huge coordinates
+			return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(coord, _mm_setzero_ps()), last));
+		}
+
+		FORCEINLINE __m128 LoadTexel(const FTexture& level, int32_t x, int32_t y)
+		{
+			return _mm_loadu_ps(&level.GetPixel<FLinearColor>(x, y).r);
+		}
+
+		FORCEINLINE __m128 LerpPS(__m128 a, __m128 b, __m128 t)
+		{
+			return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+		}
+	}
+
+	FMipChain::FMipChain(const FTexture& texture, bool generateMips, bool bSRGB)
+	{
+		const size_t width = texture.GetWidth();
+		const size_t height = texture.GetHeight();
+
+		FTexture base(width, height, EDASH_FORMAT::R32G32B32A32_FLOAT);
+		for (size_t y = 0; y < height; ++y)
+		{
+			for (size_t x = 0; x < width; ++x)
+			{
+				base.SetPixel(ReadTexel(texture, x, y, bSRGB), x, y);
+			}
+		}
+		mLevels.push_back(std::move(base));
+
+		while (generateMips && (mLevels.back().GetWidth() > 1 || mLevels.back().GetHeight() > 1))
+		{
+			const FTexture& source = mLevels.back();
+			const size_t sourceWidth = source.GetWidth();
+			const size_t sourceHeight = source.GetHeight();
+
+			FTexture level(std::max<size_t>(1, sourceWidth / 2), std::max<size_t>(1, sourceHeight / 2), EDASH_FORMAT::R32G32B32A32_FLOAT);
+			const __m128 quarter = _mm_set1_ps(0.25f);
+
+			for (size_t y = 0; y < level.GetHeight(); ++y)
+			{
+				const int32_t y0 = static_cast<int32_t>(std::min(y * 2, sourceHeight - 1));
+				const int32_t y1 = static_cast<int32_t>(std::min(y * 2 + 1, sourceHeight - 1));
+
+				for (size_t x = 0; x < level.GetWidth(); ++x)
+				{
+					const int32_t x0 = static_cast<int32_t>(std::min(x * 2, sourceWidth - 1));
+					const int32_t x1 = static_cast<int32_t>(std::min(x * 2 + 1, sourceWidth - 1));
+
+					__m128 sum = _mm_add_ps(_mm_add_ps(LoadTexel(source, x0, y0), LoadTexel(source, x1, y0)),
+						_mm_add_ps(LoadTexel(source, x0, y1), LoadTexel(source, x1, y1)));
+
+					FLinearColor color;
+					_mm_storeu_ps(&color.r, _mm_mul_ps(sum, quarter));
+					level.SetPixel(color, x, y);
+				}
+			}
+
+			mLevels.push_back(std::move(level));
+		}
+	}
+
+	FSampler::FSampler(const FSamplerDesc& desc)
+		: mDesc(desc)
+	{
+		ASSERT(mDesc.MaxAnisotropy >= 1);
+	}
+
+	FLinearColor FSampler::Sample(const FMipChain& texture, const FVector2f& uv, float lod) const
+	{
+		__m128 result[4];
+		SampleTrilinear(texture, _mm_set1_ps(uv.x), _mm_set1_ps(uv.y), 1, lod + mDesc.MipLODBias, result);
+
+		FLinearColor color;
+		_mm_storeu_ps(&color.r, result[0]);
+		return color;
+	}
+
+	FLinearColor FSampler::SampleGrad(const FMipChain& texture, const FVector2f& uv, const FVector2f& ddx, const FVector2f& ddy) const
+	{
+		__m128 result[4];
+		SampleAnisotropic(texture, _mm_set1_ps(uv.x), _mm_set1_ps(uv.y), 1, ddx, ddy, result);
+
+		FLinearColor color;
+		_mm_storeu_ps(&color.r, result[0]);
+		return color;
+	}
+
+	void FSampler::Sample4(const FMipChain& texture, const float u[4], const float v[4], float lod, FLinearColor result[4]) const
+	{
+		__m128 colors[4];
+		SampleTrilinear(texture, _mm_loadu_ps(u), _mm_loadu_ps(v), 4, lod + mDesc.MipLODBias, colors);
+
+		for (size_t i = 0; i < 4; ++i)
+		{
+			_mm_storeu_ps(&result[i].r, colors[i]);
+		}
+	}
+
+	void FSampler::SampleGrad4(const FMipChain& texture, const float u[4], const float v[4], const FVector2f& ddx, const FVector2f& ddy, FLinearColor result[4]) const
+	{
+		__m128 colors[4];
+		SampleAnisotropic(texture, _mm_loadu_ps(u), _mm_loadu_ps(v), 4, ddx, ddy, colors);
+
+		for (size_t i = 0; i < 4; ++i)
+		{
+			_mm_storeu_ps(&result[i].r, colors[i]);
+		}
+	}
+
+	void FSampler::SampleLevel(const FTexture& level, __m128 u, __m128 v, size_t count, bool bilinear, __m128 result[4]) const
+	{
+		const float width = static_cast<float>(level.GetWidth());
+		const float height = static_cast<float>(level.GetHeight());
+
+		__m128 x = _mm_mul_ps(u, _mm_set1_ps(width));
+		__m128 y = _mm_mul_ps(v, _mm_set1_ps(height));
+
+		if (!bilinear)
+		{
+			alignas(16) int32_t ix[4];
+			alignas(16) int32_t iy[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(ix), AddressPS(FloorPS(x), width, mDesc.AddressU));
+			_mm_store_si128(reinterpret_cast<__m128i*>(iy), AddressPS(FloorPS(y), height, mDesc.AddressV));
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				result[i] = LoadTexel(level, ix[i], iy[i]);
+			}
+			return;
+		}
+
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 one = _mm_set1_ps(1.0f);
+
+		x = _mm_sub_ps(x, half);
+		y = _mm_sub_ps(y, half);
+		const __m128 x0 = FloorPS(x);
+		const __m128 y0 = FloorPS(y);
+
+		alignas(16) float fx[4];
+		alignas(16) float fy[4];
+		_mm_store_ps(fx, _mm_sub_ps(x, x0));
+		_mm_store_ps(fy, _mm_sub_ps(y, y0));
+
+		alignas(16) int32_t ix0[4];
+		alignas(16) int32_t ix1[4];
+		alignas(16) int32_t iy0[4];
+		alignas(16) int32_t iy1[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(ix0), AddressPS(x0, width, mDesc.AddressU));
+		_mm_store_si128(reinterpret_cast<__m128i*>(ix1), AddressPS(_mm_add_ps(x0, one), width, mDesc.AddressU));
+		_mm_store_si128(reinterpret_cast<__m128i*>(iy0), AddressPS(y0, height, mDesc.AddressV));
+		_mm_store_si128(reinterpret_cast<__m128i*>(iy1), AddressPS(_mm_add_ps(y0, one), height, mDesc.AddressV));
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const __m128 tx = _mm_set1_ps(fx[i]);
+			__m128 top = LerpPS(LoadTexel(level, ix0[i], iy0[i]), LoadTexel(level, ix1[i], iy0[i]), tx);
+			__m128 bottom = LerpPS(LoadTexel(level, ix0[i], iy1[i]), LoadTexel(level, ix1[i], iy1[i]), tx);
+			result[i] = LerpPS(top, bottom, _mm_set1_ps(fy[i]));
+		}
+	}
+
+	void FSampler::SampleTrilinear(const FMipChain& texture, __m128 u, __m128 v, size_t count, float lod, __m128 result[4]) const
+	{
+		ASSERT(texture.GetLevelCount() > 0);
+
+		const float maxLevel = static_cast<float>(texture.GetLevelCount() - 1);
+		lod = lod > 0.0f ? std::min(lod, maxLevel) : 0.0f;
+
+		if (mDesc.Filter == ESamplerFilter::Point || mDesc.Filter == ESamplerFilter::Bilinear)
+		{
+			const size_t level = static_cast<size_t>(lod + 0.5f);
+			SampleLevel(texture.GetLevel(level), u, v, count, mDesc.Filter == ESamplerFilter::Bilinear, result);
+			return;
+		}
+
+		const size_t level = static_cast<size_t>(lod);
+		const float fraction = lod - static_cast<float>(level);
+
+		SampleLevel(texture.GetLevel(level), u, v, count, true, result);
+		if (fraction > 0.0f)
+		{
+			__m128 next[4];
+			SampleLevel(texture.GetLevel(level + 1), u, v, count, true, next);
+
+			const __m128 t = _mm_set1_ps(fraction);
+			for (size_t i = 0; i < count; ++i)
+			{
+				result[i] = LerpPS(result[i], next[i], t);
+			}
+		}
+	}
+
+	void FSampler::SampleAnisotropic(const FMipChain& texture, __m128 u, __m128 v, size_t count, const FVector2f& ddx, const FVector2f& ddy, __m128 result[4]) const
+	{
+		ASSERT(texture.GetLevelCount() > 0);
+
+		// footprint axes in texels of the top level
+		const float width = static_cast<float>(texture.GetLevel(0).GetWidth());
+		const float height = static_cast<float>(texture.GetLevel(0).GetHeight());
+		const float lengthX = std::sqrt(ddx.x * ddx.x * width * width + ddx.y * ddx.y * height * height);
+		const float lengthY = std::sqrt(ddy.x * ddy.x * width * width + ddy.y * ddy.y * height * height);
+
+		const float major = std::max(lengthX, lengthY);
+		if (mDesc.Filter != ESamplerFilter::Anisotropic || major <= 0.0f)
+		{
+			SampleTrilinear(texture, u, v, count, major > 0.0f ? std::log2(major) + mDesc.MipLODBias : 0.0f, result);
+			return;
+		}
+
+		const float minor = std::min(lengthX, lengthY);
+		const float ratio = minor > 0.0f ? std::ceil(major / minor) : static_cast<float>(mDesc.MaxAnisotropy);
+		const uint32_t tapCount = static_cast<uint32_t>(std::min(ratio, static_cast<float>(mDesc.MaxAnisotropy)));
+		const float lod = std::log2(major / tapCount) + mDesc.MipLODBias;
+
+		if (tapCount <= 1)
+		{
+			SampleTrilinear(texture, u, v, count, lod, result);
+			return;
+		}
+
+		// taps are spread evenly along the major axis, centered on the sample position
+		const FVector2f& axis = lengthX >= lengthY ? ddx : ddy;
+		const __m128 weight = _mm_set1_ps(1.0f / tapCount);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			result[i] = _mm_setzero_ps();
+		}
+
+		for (uint32_t tap = 0; tap < tapCount; ++tap)
+		{
+			const float offset = (tap + 0.5f) / tapCount - 0.5f;
+
+			__m128 taps[4];
+			SampleTrilinear(texture, _mm_add_ps(u, _mm_set1_ps(axis.x * offset)), _mm_add_ps(v, _mm_set1_ps(axis.y * offset)), count, lod, taps);
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				result[i] = _mm_add_ps(result[i], _mm_mul_ps(taps[i], weight));
+			}
+		}
+	}
+}
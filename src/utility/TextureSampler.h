@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Image.h"
+#include <vector>
+
+namespace Dash
+{
+	enum class ESamplerFilter : uint8_t
+	{
+		Point,
+		/** Bilinear inside the nearest mip level. */
+		Bilinear,
+		/** Bilinear in the two nearest mip levels, blended by the fractional LOD. */
+		Trilinear,
+		/** Up to MaxAnisotropy trilinear taps along the major axis of the pixel footprint. */
+		Anisotropic,
+	};
+
+	enum class ESamplerAddressMode : uint8_t
+	{
+		Wrap,
+		Clamp,
+		Mirror,
+	};
+
+	struct FSamplerDesc
+	{
+		ESamplerFilter Filter = ESamplerFilter::Bilinear;
+		ESamplerAddressMode AddressU = ESamplerAddressMode::Wrap;
+		ESamplerAddressMode AddressV = ESamplerAddressMode::Wrap;
+		uint32_t MaxAnisotropy = 8;
+		float MipLODBias = 0.0f;
+	};
+
+	/**
+	 * Mip chain in R32G32B32A32_FLOAT, the storage the sampler filters from.
+	 * 8 bit color formats are decoded from sRGB when bSRGB is set, the levels are box filtered in linear space.
+	 */
+	class FMipChain
+	{
+	public:
+		FMipChain() = default;
+		explicit FMipChain(const FTexture& texture, bool generateMips = true, bool bSRGB = false);
+
+		size_t GetLevelCount() const { return mLevels.size(); }
+
+		const FTexture& GetLevel(size_t level) const { return mLevels[level]; }
+
+	private:
+		std::vector<FTexture> mLevels;
+	};
+
+	/**
+	 * CPU texture sampler over FMipChain. The four-wide entry points compute the addressing and filter weights of four
+	 * UVs at once with SSE and blend the texels as __m128 colors.
+	 */
+	class FSampler
+	{
+	public:
+		explicit FSampler(const FSamplerDesc& desc = FSamplerDesc{});
+
+		const FSamplerDesc& GetDesc() const { return mDesc; }
+
+		/** Samples with an explicit LOD, anisotropic filtering falls back to trilinear. */
+		FLinearColor Sample(const FMipChain& texture, const FVector2f& uv, float lod = 0.0f) const;
+
+		/** Samples with the LOD and footprint derived from the UV derivatives. */
+		FLinearColor SampleGrad(const FMipChain& texture, const FVector2f& uv, const FVector2f& ddx, const FVector2f& ddy) const;
+
+		/** Samples four UVs sharing one LOD. */
+		void Sample4(const FMipChain& texture, const float u[4], const float v[4], float lod, FLinearColor result[4]) const;
+
+		/** Samples four UVs with the LOD and footprint derived from the UV derivatives of the quad. */
+		void SampleGrad4(const FMipChain& texture, const float u[4], const float v[4], const FVector2f& ddx, const FVector2f& ddy, FLinearColor result[4]) const;
+
+	private:
+		void SampleLevel(const FTexture& level, __m128 u, __m128 v, size_t count, bool bilinear, __m128 result[4]) const;
+
+		void SampleTrilinear(const FMipChain& texture, __m128 u, __m128 v, size_t count, float lod, __m128 result[4]) const;
+
+		void SampleAnisotropic(const FMipChain& texture, __m128 u, __m128 v, size_t count, const FVector2f& ddx, const FVector2f& ddy, __m128 result[4]) const;
+
+		FSamplerDesc mDesc;
+	};
+}
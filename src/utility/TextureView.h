@@ -0,0 +1,99 @@
+#pragma once
+
+#include "ParallelFor.h"
+#include "../consolid/consolid.h"
+#include <cstdint>
+#include <type_traits>
+
+namespace Dash
+{
+	/**
+	 * Typed view over linearly laid out pixel rows. Rows start rowPitch bytes apart, so padded rows and sub-rectangles
+	 * are addressed correctly. Row access is unchecked apart from debug asserts.
+	 * T may be const to get a read-only view.
+	 */
+	template<typename T>
+	class TTextureView
+	{
+	public:
+		using ByteType = std::conditional_t<std::is_const_v<T>, const uint8_t, uint8_t>;
+
+		TTextureView() = default;
+
+		TTextureView(ByteType* data, size_t width, size_t height, size_t rowPitch)
+			: mData(data)
+			, mWidth(width)
+			, mHeight(height)
+			, mRowPitch(rowPitch)
+		{
+			ASSERT(rowPitch >= width * sizeof(T));
+		}
+
+		/** Read-only views can be made from mutable ones. */
+		template<typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+		TTextureView(const TTextureView<U>& other)
+			: TTextureView(other.GetRawData(), other.GetWidth(), other.GetHeight(), other.GetRowPitch())
+		{
+		}
+
+		size_t GetWidth() const { return mWidth; }
+
+		size_t GetHeight() const { return mHeight; }
+
+		size_t GetRowPitch() const { return mRowPitch; }
+
+		ByteType* GetRawData() const { return mData; }
+
+		FORCEINLINE T* GetRow(size_t y) const
+		{
+			ASSERT(y < mHeight);
+			return reinterpret_cast<T*>(mData + y * mRowPitch);
+		}
+
+		FORCEINLINE T& operator()(size_t x, size_t y) const
+		{
+			ASSERT(x < mWidth);
+			return GetRow(y)[x];
+		}
+
+		/** View of the rectangle starting at (x, y), sharing the row pitch. */
+		TTextureView GetSubView(size_t x, size_t y, size_t width, size_t height) const
+		{
+			ASSERT(x + width <= mWidth && y + height <= mHeight);
+			return TTextureView(mData + y * mRowPitch + x * sizeof(T), width, height, mRowPitch);
+		}
+
+		/** func(y, row) with row pointing at mWidth pixels. */
+		template<typename Func>
+		void ForEachRow(Func&& func) const
+		{
+			for (size_t y = 0; y < mHeight; ++y)
+			{
+				func(y, GetRow(y));
+			}
+		}
+
+		/** Same as ForEachRow with the rows spread over worker threads, func must be safe to call concurrently. */
+		template<typename Func>
+		void ParallelForEachRow(Func&& func, size_t rowsPerTask = 16) const
+		{
+			ParallelFor(0, mHeight, [this, &func](size_t y) { func(y, GetRow(y)); }, rowsPerTask);
+		}
+
+	private:
+		ByteType* mData = nullptr;
+		size_t mWidth = 0;
+		size_t mHeight = 0;
+		size_t mRowPitch = 0;
+	};
+
+	/** Fills count pixels of pixelSize bytes with the given pixel, memset when all its bytes match, SIMD stores otherwise. */
+	void FillPixels(uint8_t* dest, size_t count, const void* pixel, size_t pixelSize);
+
+	template<typename T>
+	FORCEINLINE void FillRow(T* row, size_t count, const T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "FillRow needs trivially copyable pixels");
+		FillPixels(reinterpret_cast<uint8_t*>(row), count, &value, sizeof(T));
+	}
+}